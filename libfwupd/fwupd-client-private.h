@@ -188,6 +188,18 @@ fwupd_client_download_bytes2_async(FwupdClient *self,
 
 #ifdef HAVE_GIO_UNIX
 void
+fwupd_client_download_stream2_async(FwupdClient *self,
+				    GPtrArray *urls,
+				    FwupdClientDownloadFlags flags,
+				    const gchar *checksum,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data) G_GNUC_NON_NULL(1, 2, 4);
+GUnixInputStream *
+fwupd_client_download_stream2_finish(FwupdClient *self,
+				     GAsyncResult *res,
+				     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+void
 fwupd_client_get_details_stream_async(FwupdClient *self,
 				      GUnixInputStream *istr,
 				      GCancellable *cancellable,
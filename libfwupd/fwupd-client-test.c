@@ -6,6 +6,9 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+
+#include "fwupd-client-private.h"
 #include "fwupd-client-sync.h"
 #include "fwupd-error.h"
 #include "fwupd-test.h"
@@ -40,6 +43,147 @@ fwupd_client_download_func(void)
 	g_assert_null(blob2);
 }
 
+static void
+fwupd_client_download_if_modified_set_mtime(const gchar *fn, guint64 mtime)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(fn);
+
+	ret = g_file_set_attribute_uint64(file,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  mtime,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fwupd_client_download_if_modified_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autofree gchar *uri = NULL;
+	g_autoptr(FwupdClient) client1 = fwupd_client_new();
+	g_autoptr(FwupdClient) client2 = fwupd_client_new();
+	g_autoptr(FwupdClient) client3 = fwupd_client_new();
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob3 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = g_dir_make_tmp("fwupd-client-test-XXXXXX", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn = g_build_filename(tmpdir, "firmware.xml.gz.jcat", NULL);
+	ret = g_file_set_contents(fn, "hello world", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fwupd_client_download_if_modified_set_mtime(fn, 1700000000);
+
+	fwupd_client_set_user_agent_for_package(client1, PACKAGE_NAME, PACKAGE_VERSION);
+	uri = g_strdup_printf("file://%s", fn);
+	blob1 = fwupd_client_download_bytes(client1,
+					    uri,
+					    FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED,
+					    NULL,
+					    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob1);
+
+	/* the validator is saved, so a new client does not download the unchanged file */
+	blob2 = fwupd_client_download_bytes(client2,
+					    uri,
+					    FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED,
+					    NULL,
+					    &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
+	g_assert_null(blob2);
+	g_clear_error(&error);
+
+	/* changed on the server */
+	fwupd_client_download_if_modified_set_mtime(fn, 1700000060);
+	blob3 = fwupd_client_download_bytes(client3,
+					    uri,
+					    FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED,
+					    NULL,
+					    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob3);
+	g_assert_cmpint(g_bytes_get_size(blob3), ==, 11);
+
+	/* clean up */
+	g_unlink(fn);
+	g_rmdir(tmpdir);
+}
+
+#ifdef HAVE_GIO_UNIX
+typedef struct {
+	GMainLoop *loop;
+	GUnixInputStream *istr;
+	GError *error;
+} FwupdClientTestHelper;
+
+static void
+fwupd_client_download_stream_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientTestHelper *helper = (FwupdClientTestHelper *)user_data;
+	helper->istr =
+	    fwupd_client_download_stream2_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+static void
+fwupd_client_download_stream_func(void)
+{
+	const gchar *fn = "/etc/os-release";
+	gboolean ret;
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *uri = NULL;
+	g_autoptr(FwupdClient) client = fwupd_client_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
+	gsize bufsz = 0;
+	FwupdClientTestHelper helper = {.loop = loop};
+
+	/* sanity check */
+	if (!g_file_test(fn, G_FILE_TEST_EXISTS)) {
+		g_test_skip("no installed os-release");
+		return;
+	}
+	ret = g_file_get_contents(fn, &buf, &bufsz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum = g_compute_checksum_for_data(G_CHECKSUM_SHA256, (const guchar *)buf, bufsz);
+
+	/* downloaded to a file, and the checksum verified on the way */
+	fwupd_client_set_user_agent_for_package(client, PACKAGE_NAME, PACKAGE_VERSION);
+	uri = g_strdup_printf("file://%s", fn);
+	g_ptr_array_add(urls, g_strdup(uri));
+	fwupd_client_download_stream2_async(client,
+					    urls,
+					    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					    checksum,
+					    NULL,
+					    fwupd_client_download_stream_cb,
+					    &helper);
+	g_main_loop_run(loop);
+	g_assert_no_error(helper.error);
+	g_assert_nonnull(helper.istr);
+	blob = g_input_stream_read_bytes(G_INPUT_STREAM(helper.istr), bufsz + 1, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	g_assert_cmpmem(g_bytes_get_data(blob, NULL), g_bytes_get_size(blob), buf, bufsz);
+	g_object_unref(helper.istr);
+}
+#endif
+
 static void
 fwupd_client_api_undefined_setter(void)
 {
@@ -373,7 +517,10 @@ int
 main(int argc, char **argv)
 {
 	g_autofree gchar *testsdir = g_build_filename(SRCDIR, "tests", NULL);
+	g_autofree gchar *cachedir = g_dir_make_tmp("fwupd-client-cache-XXXXXX", NULL);
 	(void)g_setenv("XDG_CONFIG_HOME", testsdir, TRUE);
+	if (cachedir != NULL)
+		(void)g_setenv("XDG_CACHE_HOME", cachedir, TRUE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/client/api", fwupd_client_api);
 	if (g_test_undefined()) {
@@ -388,5 +535,10 @@ main(int argc, char **argv)
 		g_test_add_func("/fwupd/client/devices", fwupd_client_devices_func);
 	}
 	g_test_add_func("/fwupd/client/download", fwupd_client_download_func);
+	g_test_add_func("/fwupd/client/download{if-modified}",
+			fwupd_client_download_if_modified_func);
+#ifdef HAVE_GIO_UNIX
+	g_test_add_func("/fwupd/client/download{stream}", fwupd_client_download_stream_func);
+#endif
 	return g_test_run();
 }
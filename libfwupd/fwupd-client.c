@@ -15,11 +15,16 @@
 #include <sys/utsname.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
+#include <glib/gstdio.h>
 #include <locale.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#ifdef HAVE_GIO_UNIX
+#include <unistd.h>
+#endif
 
 #include "fwupd-bios-setting.h"
 #include "fwupd-client-private.h"
@@ -90,6 +95,8 @@ typedef struct {
 	GPtrArray *hwids;		/* FwupdClientHwid */
 	GMutex download_items_mutex; /* for @download_items */
 	GPtrArray *download_items;   /* element-type FwupdClientDownloadItem */
+	GMutex validators_mutex;     /* for @validators */
+	GHashTable *validators;	     /* (nullable) str:FwupdClientValidator */
 	FwupdClientSyncImpl impl;
 	gpointer impl_userdata;
 	GDestroyNotify impl_userdata_destroy; /* nullable */
@@ -100,8 +107,24 @@ typedef struct {
 	CURL *curl;
 	curl_mime *mime;
 	struct curl_slist *headers;
+	FwupdClientDownloadFlags download_flags;
+	gchar *etag; /* from the last response */
+	gint fd;     /* download to a file rather than memory when >= 0 */
+	goffset fd_offset;
+	GChecksum *checksum; /* of the data written to @fd */
+	gchar *checksum_expected;
+	GByteArray *buf_error; /* the response body when the server returns an error */
 } FwupdCurlHelper;
 
+/* what the server told us about the last download of a URI */
+typedef struct {
+	gchar *etag;	 /* nullable */
+	gint64 mtime;	 /* UNIX timestamp from the server, or 0 for unknown */
+	gchar *checksum; /* (nullable) SHA256 of the payload */
+} FwupdClientValidator;
+
+#define FWUPD_CLIENT_VALIDATOR_GROUP_PREFIX "Validator "
+
 typedef struct {
 	gchar *key;
 	gchar *value;
@@ -164,9 +187,159 @@ fwupd_client_curl_helper_free(FwupdCurlHelper *helper)
 		curl_slist_free_all(helper->headers);
 	if (helper->urls != NULL)
 		g_ptr_array_unref(helper->urls);
+	g_free(helper->etag);
+	if (helper->fd >= 0)
+		g_close(helper->fd, NULL);
+	if (helper->checksum != NULL)
+		g_checksum_free(helper->checksum);
+	g_free(helper->checksum_expected);
 	g_free(helper);
 }
 
+static void
+fwupd_client_validator_free(FwupdClientValidator *validator)
+{
+	g_free(validator->etag);
+	g_free(validator->checksum);
+	g_free(validator);
+}
+
+/* the validators are saved so that the next process can make a conditional request too */
+static gchar *
+fwupd_client_validators_get_filename(void)
+{
+	return g_build_filename(g_get_user_cache_dir(), "fwupd", "validators.ini", NULL);
+}
+
+/* must be called with the validators mutex held */
+static void
+fwupd_client_validators_ensure(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *fn = NULL;
+	g_auto(GStrv) groups = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+
+	if (priv->validators != NULL)
+		return;
+	priv->validators = g_hash_table_new_full(g_str_hash,
+						 g_str_equal,
+						 g_free,
+						 (GDestroyNotify)fwupd_client_validator_free);
+	fn = fwupd_client_validators_get_filename();
+	if (!g_key_file_load_from_file(kf, fn, G_KEY_FILE_NONE, &error_local)) {
+		if (!g_error_matches(error_local, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			g_debug("ignoring %s: %s", fn, error_local->message);
+		return;
+	}
+	groups = g_key_file_get_groups(kf, NULL);
+	for (guint i = 0; groups[i] != NULL; i++) {
+		FwupdClientValidator *validator;
+		if (!g_str_has_prefix(groups[i], FWUPD_CLIENT_VALIDATOR_GROUP_PREFIX))
+			continue;
+		validator = g_new0(FwupdClientValidator, 1);
+		validator->etag = g_key_file_get_string(kf, groups[i], "ETag", NULL);
+		validator->mtime = g_key_file_get_int64(kf, groups[i], "LastModified", NULL);
+		validator->checksum = g_key_file_get_string(kf, groups[i], "Checksum", NULL);
+		g_hash_table_insert(priv->validators,
+				    g_strdup(groups[i] + strlen(FWUPD_CLIENT_VALIDATOR_GROUP_PREFIX)),
+				    validator);
+	}
+}
+
+/* must be called with the validators mutex held */
+static void
+fwupd_client_validators_save(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autofree gchar *fn = fwupd_client_validators_get_filename();
+	g_autofree gchar *dirname = g_path_get_dirname(fn);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+
+	g_hash_table_iter_init(&iter, priv->validators);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		FwupdClientValidator *validator = (FwupdClientValidator *)value;
+		g_autofree gchar *group = NULL;
+
+		/* not valid in a group name */
+		if (strpbrk((const gchar *)key, "[]\n") != NULL)
+			continue;
+		group = g_strdup_printf("%s%s", FWUPD_CLIENT_VALIDATOR_GROUP_PREFIX, (const gchar *)key);
+		if (validator->etag != NULL)
+			g_key_file_set_string(kf, group, "ETag", validator->etag);
+		if (validator->mtime > 0)
+			g_key_file_set_int64(kf, group, "LastModified", validator->mtime);
+		if (validator->checksum != NULL)
+			g_key_file_set_string(kf, group, "Checksum", validator->checksum);
+	}
+	if (g_mkdir_with_parents(dirname, 0700) == -1) {
+		g_debug("failed to create %s: %s", dirname, g_strerror(errno));
+		return;
+	}
+	if (!g_key_file_save_to_file(kf, fn, &error_local))
+		g_debug("failed to save %s: %s", fn, error_local->message);
+}
+
+static gboolean
+fwupd_client_validator_lookup(FwupdClient *self,
+			      const gchar *url,
+			      gchar **etag,
+			      gint64 *mtime,
+			      gchar **checksum)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	FwupdClientValidator *validator;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->validators_mutex);
+
+	fwupd_client_validators_ensure(self);
+	validator = g_hash_table_lookup(priv->validators, url);
+	if (validator == NULL)
+		return FALSE;
+	if (etag != NULL)
+		*etag = g_strdup(validator->etag);
+	if (mtime != NULL)
+		*mtime = validator->mtime;
+	if (checksum != NULL)
+		*checksum = g_strdup(validator->checksum);
+	return TRUE;
+}
+
+static void
+fwupd_client_validator_insert(FwupdClient *self,
+			      const gchar *url,
+			      const gchar *etag,
+			      gint64 mtime,
+			      const gchar *checksum)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	FwupdClientValidator *validator;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->validators_mutex);
+
+	fwupd_client_validators_ensure(self);
+	validator = g_new0(FwupdClientValidator, 1);
+	validator->etag = g_strdup(etag);
+	validator->mtime = mtime;
+	validator->checksum = g_strdup(checksum);
+	g_hash_table_insert(priv->validators, g_strdup(url), validator);
+	fwupd_client_validators_save(self);
+}
+
+static void
+fwupd_client_validator_remove(FwupdClient *self, const gchar *url)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->validators_mutex);
+
+	fwupd_client_validators_ensure(self);
+	if (g_hash_table_remove(priv->validators, url))
+		fwupd_client_validators_save(self);
+}
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdCurlHelper, fwupd_client_curl_helper_free)
 
 typedef struct {
@@ -933,6 +1106,9 @@ fwupd_client_curl_new(FwupdClient *self, GError **error)
 	FwupdClientPrivate *priv = GET_PRIVATE(self);
 	g_autoptr(FwupdCurlHelper) helper = g_new0(FwupdCurlHelper, 1);
 
+	/* set before anything can fail */
+	helper->fd = -1;
+
 	/* check the user agent is sane */
 	if (!fwupd_client_ensure_networking(self, error))
 		return NULL;
@@ -3862,6 +4038,61 @@ fwupd_client_install_release_download_cb(GObject *source, GAsyncResult *res, gpo
 					 g_steal_pointer(&task));
 }
 
+#ifdef HAVE_GIO_UNIX
+static void
+fwupd_client_install_release_stream_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
+	g_autoptr(GUnixInputStream) istr = NULL;
+	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
+	GCancellable *cancellable = g_task_get_cancellable(task);
+
+	/* the checksum was verified while downloading */
+	istr = fwupd_client_download_stream2_finish(FWUPD_CLIENT(source), res, &error);
+	if (istr == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	fwupd_client_install_stream_async(FWUPD_CLIENT(source),
+					  fwupd_device_get_id(data->device),
+					  istr,
+					  NULL,
+					  data->install_flags,
+					  cancellable,
+					  fwupd_client_install_release_bytes_cb,
+					  g_steal_pointer(&task));
+}
+#endif
+
+/* stream large payloads to a file rather than keeping them in memory */
+static void
+fwupd_client_install_release_download(FwupdClient *self, GTask *task, GPtrArray *urls)
+{
+	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
+	GCancellable *cancellable = g_task_get_cancellable(task);
+#ifdef HAVE_GIO_UNIX
+	const gchar *checksum =
+	    fwupd_checksum_get_best(fwupd_release_get_checksums(data->release));
+	if (checksum != NULL) {
+		fwupd_client_download_stream2_async(self,
+						    urls,
+						    data->download_flags,
+						    checksum,
+						    cancellable,
+						    fwupd_client_install_release_stream_cb,
+						    g_object_ref(task));
+		return;
+	}
+#endif
+	fwupd_client_download_bytes2_async(self,
+					   urls,
+					   data->download_flags,
+					   cancellable,
+					   fwupd_client_install_release_download_cb,
+					   g_object_ref(task));
+}
+
 static gboolean
 fwupd_client_is_url_http(const gchar *perhaps_url)
 {
@@ -3999,12 +4230,7 @@ fwupd_client_install_release_remote_cb(GObject *source, GAsyncResult *res, gpoin
 	}
 
 	/* download file */
-	fwupd_client_download_bytes2_async(FWUPD_CLIENT(source),
-					   uris_built,
-					   data->download_flags,
-					   cancellable,
-					   fwupd_client_install_release_download_cb,
-					   g_steal_pointer(&task));
+	fwupd_client_install_release_download(FWUPD_CLIENT(source), task, uris_built);
 }
 
 static GPtrArray *
@@ -4085,12 +4311,9 @@ fwupd_client_install_release_async(FwupdClient *self,
 	/* work out what remote-specific URI fields this should use */
 	remote_id = fwupd_release_get_remote_id(release);
 	if (remote_id == NULL) {
-		fwupd_client_download_bytes2_async(self,
-						   fwupd_release_get_locations(release),
-						   download_flags,
-						   cancellable,
-						   fwupd_client_install_release_download_cb,
-						   g_steal_pointer(&task));
+		fwupd_client_install_release_download(self,
+						      task,
+						      fwupd_release_get_locations(release));
 		return;
 	}
 
@@ -4788,6 +5011,7 @@ fwupd_client_update_metadata_bytes_finish(FwupdClient *self, GAsyncResult *res,
 typedef struct {
 	FwupdRemote *remote;
 	FwupdClientDownloadFlags download_flags;
+	gchar *uri_sig;
 	GBytes *signature;
 	GBytes *metadata;
 } FwupdClientRefreshRemoteData;
@@ -4800,9 +5024,20 @@ fwupd_client_refresh_remote_data_free(FwupdClientRefreshRemoteData *data)
 	if (data->metadata != NULL)
 		g_bytes_unref(data->metadata);
 	g_object_unref(data->remote);
+	g_free(data->uri_sig);
 	g_free(data);
 }
 
+/* the signature has to be downloaded again if anything after it failed */
+static void
+fwupd_client_refresh_remote_return_error(GTask *task, GError *error)
+{
+	FwupdClient *self = g_task_get_source_object(task);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
+	fwupd_client_validator_remove(self, data->uri_sig);
+	g_task_return_error(task, error);
+}
+
 static void
 fwupd_client_refresh_remote_update_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -4811,7 +5046,7 @@ fwupd_client_refresh_remote_update_cb(GObject *source, GAsyncResult *res, gpoint
 
 	/* save metadata */
 	if (!fwupd_client_update_metadata_bytes_finish(FWUPD_CLIENT(source), res, &error)) {
-		g_task_return_error(task, g_steal_pointer(&error));
+		fwupd_client_refresh_remote_return_error(task, g_steal_pointer(&error));
 		return;
 	}
 
@@ -4835,7 +5070,7 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 		g_prefix_error(&error,
 			       "Failed to download metadata for %s: ",
 			       fwupd_remote_get_id(data->remote));
-		g_task_return_error(task, g_steal_pointer(&error));
+		fwupd_client_refresh_remote_return_error(task, g_steal_pointer(&error));
 		return;
 	}
 	data->metadata = g_steal_pointer(&bytes);
@@ -4847,12 +5082,14 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 		g_autofree gchar *checksum =
 		    g_compute_checksum_for_bytes(checksum_kind, data->metadata);
 		if (g_strcmp0(checksum, fwupd_remote_get_checksum_metadata(data->remote)) != 0) {
-			g_task_return_new_error(task,
-						FWUPD_ERROR,
-						FWUPD_ERROR_INVALID_FILE,
-						"metadata checksum expected %s and got %s",
-						fwupd_remote_get_checksum_metadata(data->remote),
-						checksum);
+			g_set_error(&error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "metadata checksum expected %s and got %s",
+				    fwupd_remote_get_checksum_metadata(data->remote),
+				    checksum);
+			/* nocheck:error-false-return */
+			fwupd_client_refresh_remote_return_error(task, g_steal_pointer(&error));
 			return;
 		}
 	}
@@ -4867,6 +5104,40 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 						 g_steal_pointer(&task));
 }
 
+static void
+fwupd_client_refresh_remote_not_modified_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
+
+	/* older daemons do not support this, so the age is not updated */
+	if (!fwupd_client_modify_remote_finish(FWUPD_CLIENT(source), res, &error)) {
+		g_debug("ignoring failure to mark %s as refreshed: %s",
+			fwupd_remote_get_id(data->remote),
+			error->message);
+		g_task_return_boolean(task, TRUE);
+		return;
+	}
+	fwupd_remote_set_mtime(data->remote, (guint64)g_get_real_time() / G_USEC_PER_SEC);
+	g_task_return_boolean(task, TRUE);
+}
+
+/* the daemon already has this signature, so only the age of the metadata has to be reset */
+static void
+fwupd_client_refresh_remote_not_modified(GTask *task)
+{
+	FwupdClient *self = g_task_get_source_object(task);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
+	fwupd_client_modify_remote_async(self,
+					 fwupd_remote_get_id(data->remote),
+					 "MetadataNotModified",
+					 fwupd_remote_get_checksum(data->remote),
+					 g_task_get_cancellable(task),
+					 fwupd_client_refresh_remote_not_modified_cb,
+					 task);
+}
+
 static void
 fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -4881,6 +5152,12 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 	/* save signature */
 	bytes = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
 	if (bytes == NULL) {
+		if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+			g_info("metadata signature of %s is not modified, skipping",
+			       fwupd_remote_get_id(data->remote));
+			fwupd_client_refresh_remote_not_modified(g_steal_pointer(&task));
+			return;
+		}
 		g_prefix_error(&error,
 			       "Failed to download metadata for %s: ",
 			       fwupd_remote_get_id(data->remote));
@@ -4890,7 +5167,7 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 	data->signature = g_steal_pointer(&bytes);
 	if (!fwupd_remote_load_signature_bytes(data->remote, data->signature, &error)) {
 		g_prefix_error_literal(&error, "Failed to load signature: ");
-		g_task_return_error(task, g_steal_pointer(&error));
+		fwupd_client_refresh_remote_return_error(task, g_steal_pointer(&error));
 		return;
 	}
 
@@ -4905,7 +5182,7 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 		if (g_strcmp0(checksum, fwupd_remote_get_checksum(data->remote)) == 0) {
 			g_info("metadata signature of %s is unchanged, skipping",
 			       fwupd_remote_get_id(data->remote));
-			g_task_return_boolean(task, TRUE);
+			fwupd_client_refresh_remote_not_modified(g_steal_pointer(&task));
 			return;
 		}
 	}
@@ -4925,7 +5202,7 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 	if ((data->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P) == 0) {
 		g_autofree gchar *uri = fwupd_remote_build_metadata_uri(data->remote, &error);
 		if (uri == NULL) {
-			g_task_return_error(task, g_steal_pointer(&error));
+			fwupd_client_refresh_remote_return_error(task, g_steal_pointer(&error));
 			return;
 		}
 		g_ptr_array_add(urls, g_steal_pointer(&uri));
@@ -4949,6 +5226,9 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
  *
  * Refreshes a remote by downloading new metadata.
  *
+ * If @download_flags includes %FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED then the signature is only
+ * downloaded if the server reports it has changed since the daemon last got it.
+ *
  * NOTE: This method is thread-safe, but progress signals will be
  * emitted in the global default main context, if not explicitly set with
  * [method@Client.set_main_context].
@@ -5007,9 +5287,21 @@ fwupd_client_refresh_remote_async(FwupdClient *self,
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
+	data = g_task_get_task_data(task);
+	data->uri_sig = g_strdup(uri);
+
+	/* the saved ETag and Last-Modified are only valid for the signature the daemon has */
+	download_flags &= ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P;
+	if (download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED) {
+		g_autofree gchar *checksum = NULL;
+		if (!fwupd_client_validator_lookup(self, uri, NULL, NULL, &checksum) ||
+		    fwupd_remote_get_checksum(remote) == NULL ||
+		    g_strcmp0(checksum, fwupd_remote_get_checksum(remote)) != 0)
+			fwupd_client_validator_remove(self, uri);
+	}
 	fwupd_client_download_bytes_async(self,
 					  uri,
-					  download_flags & ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P,
+					  download_flags,
 					  cancellable,
 					  fwupd_client_refresh_remote_signature_cb,
 					  g_steal_pointer(&task));
@@ -6132,9 +6424,148 @@ fwupd_client_download_ipfs(FwupdClient *self,
 	return g_steal_pointer(&bstdout);
 }
 
+static size_t
+fwupd_client_download_header_callback_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdCurlHelper *helper = (FwupdCurlHelper *)userdata;
+	gsize realsize = size * nmemb;
+	g_autofree gchar *line = g_strndup(ptr, realsize);
+
+	/* only the headers of the final response after any redirects matter */
+	if (g_str_has_prefix(line, "HTTP/")) {
+		g_clear_pointer(&helper->etag, g_free);
+	} else if (g_ascii_strncasecmp(line, "ETag:", 5) == 0) {
+		g_free(helper->etag);
+		helper->etag = g_strstrip(g_strdup(line + 5));
+	}
+	return realsize;
+}
+
+static void
+fwupd_client_download_http_ensure_validator(FwupdClient *self,
+					    FwupdCurlHelper *helper,
+					    const gchar *url)
+{
+	CURL *curl = helper->curl;
+	gint64 mtime = 0;
+	g_autofree gchar *etag = NULL;
+
+	if (helper->headers != NULL) {
+		curl_slist_free_all(helper->headers);
+		helper->headers = NULL;
+	}
+	if (fwupd_client_validator_lookup(self, url, &etag, &mtime, NULL) && etag != NULL) {
+		g_autofree gchar *header = g_strdup_printf("If-None-Match: %s", etag);
+		helper->headers = curl_slist_append(helper->headers, header);
+	}
+	(void)curl_easy_setopt(curl, CURLOPT_HTTPHEADER, helper->headers);
+	if (mtime > 0) {
+		(void)curl_easy_setopt(curl,
+				       CURLOPT_TIMECONDITION,
+				       (glong)CURL_TIMECOND_IFMODSINCE);
+		(void)curl_easy_setopt(curl, CURLOPT_TIMEVALUE_LARGE, (curl_off_t)mtime);
+	} else {
+		(void)curl_easy_setopt(curl, CURLOPT_TIMECONDITION, (glong)CURL_TIMECOND_NONE);
+	}
+	(void)curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+	(void)curl_easy_setopt(curl,
+			       CURLOPT_HEADERFUNCTION,
+			       fwupd_client_download_header_callback_cb);
+	(void)curl_easy_setopt(curl, CURLOPT_HEADERDATA, helper);
+	g_clear_pointer(&helper->etag, g_free);
+}
+
+#ifdef HAVE_GIO_UNIX
+static gboolean
+fwupd_client_download_fd_write(FwupdCurlHelper *helper,
+			       const guint8 *buf,
+			       gsize bufsz,
+			       GError **error)
+{
+	gsize done = 0;
+
+	while (done < bufsz) {
+		gssize rc = write(helper->fd, buf + done, bufsz - done);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_WRITE,
+				    "failed to write: %s",
+				    fwupd_strerror(errno));
+			return FALSE;
+		}
+		done += rc;
+	}
+	g_checksum_update(helper->checksum, buf, bufsz);
+	helper->fd_offset += bufsz;
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_download_fd_reset(FwupdCurlHelper *helper, GError **error)
+{
+	if (helper->fd_offset == 0)
+		return TRUE;
+	if (ftruncate(helper->fd, 0) < 0 || lseek(helper->fd, 0, SEEK_SET) < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_WRITE,
+			    "failed to truncate: %s",
+			    fwupd_strerror(errno));
+		return FALSE;
+	}
+	g_checksum_reset(helper->checksum);
+	helper->fd_offset = 0;
+	return TRUE;
+}
+
+static size_t
+fwupd_client_download_fd_write_callback_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdCurlHelper *helper = (FwupdCurlHelper *)userdata;
+	gsize realsize = size * nmemb;
+	glong status_code = 0;
+	g_autoptr(GError) error_local = NULL;
+
+	/* do not write the error page to the payload */
+	curl_easy_getinfo(helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	if (status_code >= 400) {
+		g_byte_array_append(helper->buf_error, (const guint8 *)ptr, realsize);
+		return realsize;
+	}
+	if (!fwupd_client_download_fd_write(helper, (const guint8 *)ptr, realsize, &error_local)) {
+		g_warning("%s", error_local->message);
+		return 0;
+	}
+	return realsize;
+}
+
+static void
+fwupd_client_download_http_ensure_fd(FwupdCurlHelper *helper, GByteArray *buf_error)
+{
+	CURL *curl = helper->curl;
+
+	/* continue from where the last attempt failed */
+	helper->buf_error = buf_error;
+	if (helper->fd_offset > 0)
+		g_info("resuming download from 0x%x", (guint)helper->fd_offset);
+	(void)curl_easy_setopt(curl,
+			       CURLOPT_WRITEFUNCTION,
+			       fwupd_client_download_fd_write_callback_cb);
+	(void)curl_easy_setopt(curl, CURLOPT_WRITEDATA, helper);
+	(void)curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)helper->fd_offset);
+}
+#endif
+
 static GBytes *
-fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+fwupd_client_download_http(FwupdClient *self,
+			   FwupdCurlHelper *helper,
+			   const gchar *url,
+			   GError **error)
 {
+	CURL *curl = helper->curl;
 	CURLcode res;
 	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
 	glong status_code = 0;
@@ -6156,9 +6587,30 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 			       CURLOPT_WRITEFUNCTION,
 			       fwupd_client_download_write_callback_cb);
 	(void)curl_easy_setopt(curl, CURLOPT_WRITEDATA, buf);
+#ifdef HAVE_GIO_UNIX
+	if (helper->fd >= 0)
+		fwupd_client_download_http_ensure_fd(helper, buf);
+#endif
+	if (helper->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED)
+		fwupd_client_download_http_ensure_validator(self, helper, url);
 	res = curl_easy_perform(curl);
 	fwupd_client_set_percentage(self, 100.0);
-	if (res == CURLE_SEND_ERROR || res == CURLE_RECV_ERROR || res == CURLE_HTTP2_STREAM) {
+#ifdef HAVE_GIO_UNIX
+	helper->buf_error = NULL;
+	if (helper->fd >= 0 && res == CURLE_RANGE_ERROR) {
+		/* the retry has to start from the beginning */
+		if (!fwupd_client_download_fd_reset(helper, error))
+			return NULL;
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_TIMED_OUT,
+			    "server cannot resume download: %s",
+			    errbuf);
+		return NULL;
+	}
+#endif
+	if (res == CURLE_SEND_ERROR || res == CURLE_RECV_ERROR || res == CURLE_HTTP2_STREAM ||
+	    res == CURLE_PARTIAL_FILE) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_TIMED_OUT,
@@ -6188,6 +6640,29 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 	/* check for server limit */
 	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
 	g_info("status-code was %ld", status_code);
+	if (helper->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED) {
+		glong condition_unmet = 0;
+		curl_easy_getinfo(curl, CURLINFO_CONDITION_UNMET, &condition_unmet);
+		if (status_code == 304 || condition_unmet != 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    "%s has not been modified",
+				    url);
+			return NULL;
+		}
+	}
+#ifdef HAVE_GIO_UNIX
+	if (helper->fd >= 0 && helper->fd_offset > 0 && status_code == 416) {
+		if (!fwupd_client_download_fd_reset(helper, error))
+			return NULL;
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_TIMED_OUT,
+				    "server cannot resume download from offset");
+		return NULL;
+	}
+#endif
 	if (status_code == 429) {
 		g_autofree gchar *str = g_strndup((const gchar *)buf->data, MIN(buf->len, 4000));
 		if (g_str_is_ascii(str)) {
@@ -6241,6 +6716,25 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 		return NULL;
 	}
 
+	/* save for the next conditional request */
+	if (helper->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED) {
+		curl_off_t filetime = -1;
+		g_autofree gchar *checksum = NULL;
+		curl_easy_getinfo(curl, CURLINFO_FILETIME_T, &filetime);
+		if (helper->fd < 0) {
+			checksum =
+			    g_compute_checksum_for_data(G_CHECKSUM_SHA256, buf->data, buf->len);
+		}
+		fwupd_client_validator_insert(self,
+					      url,
+					      helper->etag,
+					      filetime > 0 ? (gint64)filetime : 0,
+					      checksum);
+	}
+
+	/* the payload is in the file */
+	if (helper->fd >= 0)
+		return g_bytes_new(NULL, 0);
 	return g_bytes_new(buf->data, buf->len);
 }
 
@@ -6373,7 +6867,10 @@ fwupd_client_download_item_free(FwupdClientDownloadItem *item)
 }
 
 static GBytes *
-fwupd_client_download_http_retry(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+fwupd_client_download_http_retry(FwupdClient *self,
+				 FwupdCurlHelper *helper,
+				 const gchar *url,
+				 GError **error)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE(self);
 	gulong delay_ms = 2500;
@@ -6392,7 +6889,7 @@ fwupd_client_download_http_retry(FwupdClient *self, CURL *curl, const gchar *url
 		g_autoptr(GBytes) blob = NULL;
 		g_autoptr(GError) error_local = NULL;
 
-		blob = fwupd_client_download_http(self, curl, url, &error_local);
+		blob = fwupd_client_download_http(self, helper, url, &error_local);
 		if (blob != NULL)
 			return g_steal_pointer(&blob);
 		if (i >= priv->download_retries ||
@@ -6424,9 +6921,13 @@ fwupd_client_download_bytes_thread_cb(GTask *task,
 			return;
 		}
 		if (fwupd_client_is_url_http(url)) {
-			blob = fwupd_client_download_http_retry(self, helper->curl, url, &error);
+			blob = fwupd_client_download_http_retry(self, helper, url, &error);
 			if (blob != NULL)
 				break;
+			if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+				g_task_return_error(task, g_steal_pointer(&error));
+				return;
+			}
 		} else if (fwupd_client_is_url_ipfs(url)) {
 			blob = fwupd_client_download_ipfs(self, url, cancellable, &error);
 			if (blob != NULL)
@@ -6480,6 +6981,7 @@ fwupd_client_download_bytes2_async(FwupdClient *self,
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
+	helper->download_flags = flags;
 	g_task_set_task_data(task,
 			     g_steal_pointer(&helper),
 			     (GDestroyNotify)fwupd_client_curl_helper_free);
@@ -6552,6 +7054,162 @@ fwupd_client_download_bytes_finish(FwupdClient *self, GAsyncResult *res, GError
 	return g_task_propagate_pointer(G_TASK(res), error);
 }
 
+#ifdef HAVE_GIO_UNIX
+static void
+fwupd_client_download_stream_thread_cb(GTask *task,
+				       gpointer source_object,
+				       gpointer task_data,
+				       GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT(source_object);
+	FwupdCurlHelper *helper = g_task_get_task_data(task);
+	const gchar *checksum;
+
+	for (guint i = 0; i < helper->urls->len; i++) {
+		const gchar *url = g_ptr_array_index(helper->urls, i);
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GError) error = NULL;
+
+		/* a different server might not have the same partial data */
+		if (!fwupd_client_download_fd_reset(helper, &error)) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		g_info("downloading %s", url);
+		if (!fwupd_client_curl_helper_set_proxy(self, helper, url, &error)) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		if (fwupd_client_is_url_http(url)) {
+			blob = fwupd_client_download_http_retry(self, helper, url, &error);
+			if (blob != NULL)
+				break;
+		} else if (fwupd_client_is_url_ipfs(url)) {
+			blob = fwupd_client_download_ipfs(self, url, cancellable, &error);
+			if (blob != NULL) {
+				if (!fwupd_client_download_fd_write(helper,
+								    g_bytes_get_data(blob, NULL),
+								    g_bytes_get_size(blob),
+								    &error)) {
+					g_task_return_error(task, g_steal_pointer(&error));
+					return;
+				}
+				break;
+			}
+		} else {
+			g_set_error(&error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "not sure how to handle: %s",
+				    url);
+			/* nocheck:error-false-return */
+		}
+		if (i == helper->urls->len - 1) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		fwupd_client_set_percentage(self, 0.0);
+		g_info("failed to download %s: %s, trying next URI…", url, error->message);
+	}
+
+	/* verify checksum */
+	checksum = g_checksum_get_string(helper->checksum);
+	if (g_strcmp0(checksum, helper->checksum_expected) != 0) {
+		g_task_return_new_error(task,
+					FWUPD_ERROR,
+					FWUPD_ERROR_INVALID_FILE,
+					"checksum invalid, expected %s got %s",
+					helper->checksum_expected,
+					checksum);
+		return;
+	}
+	if (lseek(helper->fd, 0, SEEK_SET) < 0) {
+		g_task_return_new_error(task,
+					FWUPD_ERROR,
+					FWUPD_ERROR_READ,
+					"failed to seek: %s",
+					fwupd_strerror(errno));
+		return;
+	}
+	g_task_return_pointer(task,
+			      g_unix_input_stream_new(g_steal_fd(&helper->fd), TRUE),
+			      (GDestroyNotify)g_object_unref);
+}
+
+/* private */
+void
+fwupd_client_download_stream2_async(FwupdClient *self,
+				    GPtrArray *urls,
+				    FwupdClientDownloadFlags flags,
+				    const gchar *checksum,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data)
+{
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(urls != NULL);
+	g_return_if_fail(checksum != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	/* ensure networking set up */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_task_set_source_tag(task, fwupd_client_download_stream2_async);
+	helper = fwupd_client_curl_new(self, &error);
+	if (helper == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	helper->urls = fwupd_client_filter_locations(urls, flags, &error);
+	if (helper->urls == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	helper->download_flags = flags;
+	helper->checksum_expected = g_strdup(checksum);
+	helper->checksum = g_checksum_new(fwupd_checksum_guess_kind(checksum));
+
+	/* the file is deleted when the last fd is closed */
+	helper->fd = g_file_open_tmp("fwupd-XXXXXX", &fn, &error);
+	if (helper->fd < 0) {
+		fwupd_error_convert(&error);
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	if (g_unlink(fn) != 0) {
+		g_task_return_new_error(task,
+					FWUPD_ERROR,
+					FWUPD_ERROR_INVALID_FILE,
+					"failed to unlink %s",
+					fn);
+		return;
+	}
+	g_task_set_task_data(task,
+			     g_steal_pointer(&helper),
+			     (GDestroyNotify)fwupd_client_curl_helper_free);
+
+	/* keep list sane */
+	fwupd_client_download_item_prune(self);
+
+	/* download data */
+	g_task_run_in_thread(task, fwupd_client_download_stream_thread_cb);
+}
+
+/* private */
+GUnixInputStream *
+fwupd_client_download_stream2_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+#endif
+
 static void
 fwupd_client_upload_bytes_thread_cb(GTask *task,
 				    gpointer source_object,
@@ -8379,6 +9037,7 @@ fwupd_client_init(FwupdClient *self)
 	g_mutex_init(&priv->proxy_mutex);
 	g_mutex_init(&priv->idle_mutex);
 	g_mutex_init(&priv->download_items_mutex);
+	g_mutex_init(&priv->validators_mutex);
 	priv->idle_sources =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_client_context_helper_free);
 	priv->download_items =
@@ -8417,6 +9076,9 @@ fwupd_client_finalize(GObject *object)
 	g_hash_table_unref(priv->immediate_requests);
 	g_mutex_clear(&priv->idle_mutex);
 	g_mutex_clear(&priv->download_items_mutex);
+	g_mutex_clear(&priv->validators_mutex);
+	if (priv->validators != NULL)
+		g_hash_table_unref(priv->validators);
 	if (priv->idle_id != 0)
 		g_source_remove(priv->idle_id);
 	g_ptr_array_unref(priv->idle_sources);
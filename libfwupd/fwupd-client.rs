@@ -9,6 +9,10 @@ enum FwupdClientDownloadFlags {
     // Only use peer-to-peer when downloading URIs.
     // Since: 1.9.4
     OnlyP2p = 1 << 0,
+    // Only download the data if it has changed since the last download of the same URI,
+    // failing with `FWUPD_ERROR_NOTHING_TO_DO` otherwise.
+    // Since: 2.1.8
+    IfModified = 1 << 1,
 }
 
 // The options to use for uploading.
@@ -14,5 +14,7 @@ void
 fwupd_device_incorporate(FwupdDevice *self, FwupdDevice *donor) G_GNUC_NON_NULL(1, 2);
 void
 fwupd_device_remove_children(FwupdDevice *self) G_GNUC_NON_NULL(1);
+void
+fwupd_device_invalidate_variant(FwupdDevice *self) G_GNUC_NON_NULL(1);
 
 G_END_DECLS
@@ -8,6 +8,7 @@
 
 #include "fwupd-codec.h"
 #include "fwupd-device-private.h"
+#include "fwupd-enums-private.h"
 #include "fwupd-error.h"
 #include "fwupd-test.h"
 
@@ -224,11 +225,109 @@ fwupd_device_func(void)
 	g_assert_false(fwupd_device_has_flag(dev2, FWUPD_DEVICE_FLAG_LOCKED));
 }
 
+static void
+fwupd_device_variant_cache_func(void)
+{
+	g_autoptr(FwupdDevice) dev = fwupd_device_new();
+	g_autoptr(GVariant) val1 = NULL;
+	g_autoptr(GVariant) val2 = NULL;
+	g_autoptr(GVariant) val3 = NULL;
+	g_autoptr(GVariant) val4 = NULL;
+	g_autoptr(GVariant) val_trusted = NULL;
+
+	fwupd_device_set_name(dev, "ColorHug");
+	fwupd_device_set_serial(dev, "123456");
+	fwupd_device_add_instance_id(dev, "USB\\VID_1234&PID_0001");
+
+	/* the same serialized data is used again */
+	val1 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	val2 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	g_assert_true(g_variant_equal(val1, val2));
+	g_assert_true(g_variant_get_data(val1) == g_variant_get_data(val2));
+
+	/* cached separately for each set of flags */
+	val_trusted =
+	    g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_TRUSTED));
+	g_assert_false(g_variant_equal(val1, val_trusted));
+	g_assert_true(g_variant_lookup(val_trusted, FWUPD_RESULT_KEY_SERIAL, "&s", NULL));
+	g_assert_false(g_variant_lookup(val1, FWUPD_RESULT_KEY_SERIAL, "&s", NULL));
+
+	/* changed without a property notify */
+	fwupd_device_set_name(dev, "ColorHug2");
+	val3 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	g_assert_false(g_variant_equal(val1, val3));
+
+	/* changed with a property notify */
+	fwupd_device_add_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+	val4 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	g_assert_false(g_variant_equal(val3, val4));
+	g_assert_true(g_variant_lookup(val4, FWUPD_RESULT_KEY_FLAGS, "t", NULL));
+}
+
+static void
+fwupd_device_variant_array_func(void)
+{
+	FwupdDevice *dev0;
+	gdouble elapsed_built;
+	gdouble elapsed_cached;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func(g_object_unref);
+	g_autoptr(GTimer) timer = NULL;
+	g_autoptr(GVariant) val_built = NULL;
+	g_autoptr(GVariant) val_cached = NULL;
+	g_autoptr(GVariant) val_changed = NULL;
+
+	for (guint i = 0; i < 200; i++) {
+		g_autoptr(FwupdDevice) dev = fwupd_device_new();
+		g_autofree gchar *name = g_strdup_printf("Device %u", i);
+		g_autofree gchar *id = g_compute_checksum_for_string(G_CHECKSUM_SHA1, name, -1);
+		fwupd_device_set_id(dev, id);
+		fwupd_device_set_name(dev, name);
+		fwupd_device_set_vendor(dev, "Hughski");
+		fwupd_device_add_vendor_id(dev, "USB:0x273F");
+		fwupd_device_set_plugin(dev, "colorhug");
+		fwupd_device_add_protocol(dev, "com.hughski.colorhug");
+		fwupd_device_add_guid(dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+		fwupd_device_add_instance_id(dev, "USB\\VID_273F&PID_1001");
+		fwupd_device_add_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+		fwupd_device_set_version(dev, "1.2.3");
+		fwupd_device_set_version_format(dev, FWUPD_VERSION_FORMAT_TRIPLET);
+		g_ptr_array_add(devices, g_steal_pointer(&dev));
+	}
+
+	/* each device is built the first time */
+	timer = g_timer_new();
+	val_built =
+	    g_variant_ref_sink(fwupd_codec_array_to_variant(devices, FWUPD_CODEC_FLAG_NONE));
+	elapsed_built = g_timer_elapsed(timer, NULL);
+
+	/* and then the cached data is just copied into the array */
+	g_timer_reset(timer);
+	for (guint i = 0; i < 10; i++) {
+		g_clear_pointer(&val_cached, g_variant_unref);
+		val_cached = g_variant_ref_sink(
+		    fwupd_codec_array_to_variant(devices, FWUPD_CODEC_FLAG_NONE));
+	}
+	elapsed_cached = g_timer_elapsed(timer, NULL) / 10;
+	g_debug("200 devices: %.2fms built, %.2fms cached",
+		elapsed_built * 1000.f,
+		elapsed_cached * 1000.f);
+	g_assert_true(g_variant_equal(val_built, val_cached));
+
+	/* only one device has to be built again */
+	dev0 = g_ptr_array_index(devices, 0);
+	fwupd_device_set_version(dev0, "1.2.4");
+	val_changed =
+	    g_variant_ref_sink(fwupd_codec_array_to_variant(devices, FWUPD_CODEC_FLAG_NONE));
+	g_assert_false(g_variant_equal(val_cached, val_changed));
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/device", fwupd_device_func);
 	g_test_add_func("/fwupd/device/filter", fwupd_device_filter_func);
+	g_test_add_func("/fwupd/device/variant-cache", fwupd_device_variant_cache_func);
+	g_test_add_func("/fwupd/device/variant-array", fwupd_device_variant_array_func);
 	return g_test_run();
 }
@@ -29,6 +29,9 @@
 static void
 fwupd_device_finalize(GObject *object);
 
+/* all the combinations of FwupdCodecFlags */
+#define FWUPD_DEVICE_VARIANT_CACHE_SIZE 8
+
 typedef struct {
 	gchar *id;
 	gchar *parent_id;
@@ -73,6 +76,7 @@ typedef struct {
 	guint percentage;
 	GPtrArray *releases; /* (nullable) (element-type FwupdRelease) */
 	FwupdDevice *parent; /* noref */
+	GBytes *variant_cache[FWUPD_DEVICE_VARIANT_CACHE_SIZE]; /* (nullable) by FwupdCodecFlags */
 } FwupdDevicePrivate;
 
 enum {
@@ -108,6 +112,24 @@ G_DEFINE_TYPE_EXTENDED(FwupdDevice,
 
 #define FWUPD_BATTERY_THRESHOLD_DEFAULT 10 /* % */
 
+/**
+ * fwupd_device_invalidate_variant:
+ * @self: a #FwupdDevice
+ *
+ * Clears the cached serialized #GVariant of the device, which is only required when modifying the
+ * values returned by the getters directly.
+ *
+ * Since: 2.1.8
+ **/
+void
+fwupd_device_invalidate_variant(FwupdDevice *self)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	for (guint i = 0; i < G_N_ELEMENTS(priv->variant_cache); i++)
+		g_clear_pointer(&priv->variant_cache[i], g_bytes_unref);
+}
+
 static void
 fwupd_device_ensure_checksums(FwupdDevice *self)
 {
@@ -184,6 +206,7 @@ fwupd_device_add_checksum(FwupdDevice *self, const gchar *checksum)
 		return;
 	fwupd_device_ensure_checksums(self);
 	g_ptr_array_add(priv->checksums, g_strdup(checksum));
+	fwupd_device_invalidate_variant(self);
 }
 
 static void
@@ -236,6 +259,7 @@ fwupd_device_add_issue(FwupdDevice *self, const gchar *issue)
 			return;
 	}
 	g_ptr_array_add(priv->issues, g_strdup(issue));
+	fwupd_device_invalidate_variant(self);
 }
 
 static void
@@ -304,6 +328,7 @@ fwupd_device_set_summary(FwupdDevice *self, const gchar *summary)
 
 	g_free(priv->summary);
 	priv->summary = g_strdup(summary);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -345,6 +370,7 @@ fwupd_device_set_details_url(FwupdDevice *self, const gchar *details_url)
 
 	g_free(priv->details_url);
 	priv->details_url = g_strdup(details_url);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -386,6 +412,7 @@ fwupd_device_set_branch(FwupdDevice *self, const gchar *branch)
 
 	g_free(priv->branch);
 	priv->branch = g_strdup(branch);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -427,6 +454,7 @@ fwupd_device_set_serial(FwupdDevice *self, const gchar *serial)
 
 	g_free(priv->serial);
 	priv->serial = g_strdup(serial);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -556,6 +584,7 @@ fwupd_device_set_parent_id(FwupdDevice *self, const gchar *parent_id)
 
 	g_free(priv->parent_id);
 	priv->parent_id = g_strdup(parent_id);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -609,6 +638,7 @@ fwupd_device_set_composite_id(FwupdDevice *self, const gchar *composite_id)
 
 	g_free(priv->composite_id);
 	priv->composite_id = g_strdup(composite_id);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -852,6 +882,7 @@ fwupd_device_add_guid(FwupdDevice *self, const gchar *guid)
 		return;
 	fwupd_device_ensure_guids(self);
 	g_ptr_array_add(priv->guids, g_strdup(guid));
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -949,6 +980,7 @@ fwupd_device_add_instance_id(FwupdDevice *self, const gchar *instance_id)
 		return;
 	fwupd_device_ensure_instance_ids(self);
 	g_ptr_array_add(priv->instance_ids, g_strdup(instance_id));
+	fwupd_device_invalidate_variant(self);
 }
 
 static void
@@ -1025,6 +1057,7 @@ fwupd_device_add_icon(FwupdDevice *self, const gchar *icon)
 		return;
 	fwupd_device_ensure_icons(self);
 	g_ptr_array_add(priv->icons, g_strdup(icon));
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1066,6 +1099,7 @@ fwupd_device_set_name(FwupdDevice *self, const gchar *name)
 
 	g_free(priv->name);
 	priv->name = g_strdup(name);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1187,6 +1221,7 @@ fwupd_device_add_vendor_id(FwupdDevice *self, const gchar *vendor_id)
 		return;
 	fwupd_device_ensure_vendor_ids(self);
 	g_ptr_array_add(priv->vendor_ids, g_strdup(vendor_id));
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1270,6 +1305,7 @@ fwupd_device_set_version_lowest(FwupdDevice *self, const gchar *version_lowest)
 
 	g_free(priv->version_lowest);
 	priv->version_lowest = g_strdup(version_lowest);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1305,6 +1341,7 @@ fwupd_device_set_version_lowest_raw(FwupdDevice *self, guint64 version_lowest_ra
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_lowest_raw = version_lowest_raw;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1346,6 +1383,7 @@ fwupd_device_set_version_highest(FwupdDevice *self, const gchar *version_highest
 
 	g_free(priv->version_highest);
 	priv->version_highest = g_strdup(version_highest);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1381,6 +1419,7 @@ fwupd_device_set_version_highest_raw(FwupdDevice *self, guint64 version_highest_
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_highest_raw = version_highest_raw;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1422,6 +1461,7 @@ fwupd_device_set_version_bootloader(FwupdDevice *self, const gchar *version_boot
 
 	g_free(priv->version_bootloader);
 	priv->version_bootloader = g_strdup(version_bootloader);
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1457,6 +1497,7 @@ fwupd_device_set_version_bootloader_raw(FwupdDevice *self, guint64 version_bootl
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_bootloader_raw = version_bootloader_raw;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1492,6 +1533,7 @@ fwupd_device_set_flashes_left(FwupdDevice *self, guint32 flashes_left)
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->flashes_left = flashes_left;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1625,6 +1667,7 @@ fwupd_device_set_install_duration(FwupdDevice *self, guint32 duration)
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->install_duration = duration;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -1666,6 +1709,7 @@ fwupd_device_set_plugin(FwupdDevice *self, const gchar *plugin)
 
 	g_free(priv->plugin);
 	priv->plugin = g_strdup(plugin);
+	fwupd_device_invalidate_variant(self);
 }
 
 static void
@@ -1745,6 +1789,7 @@ fwupd_device_add_protocol(FwupdDevice *self, const gchar *protocol)
 		return;
 	fwupd_device_ensure_protocols(self);
 	g_ptr_array_add(priv->protocols, g_strdup(protocol));
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -2083,6 +2128,7 @@ fwupd_device_set_created(FwupdDevice *self, guint64 created)
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->created = created;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -2118,6 +2164,7 @@ fwupd_device_set_modified(FwupdDevice *self, guint64 modified)
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->modified = modified;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -2535,6 +2582,31 @@ fwupd_device_add_variant(FwupdCodec *codec, GVariantBuilder *builder, FwupdCodec
 	}
 }
 
+/* the serialized data is cached so that most devices do not have to be built again */
+static GVariant *
+fwupd_device_to_variant(FwupdCodec *codec, FwupdCodecFlags flags)
+{
+	FwupdDevice *self = FWUPD_DEVICE(codec);
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	GVariantBuilder builder;
+
+	/* the releases can be modified without the device knowing */
+	if (flags >= G_N_ELEMENTS(priv->variant_cache) ||
+	    (priv->releases != NULL && priv->releases->len > 0)) {
+		g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+		fwupd_device_add_variant(codec, &builder, flags);
+		return g_variant_new("a{sv}", &builder);
+	}
+	if (priv->variant_cache[flags] == NULL) {
+		g_autoptr(GVariant) value = NULL;
+		g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+		fwupd_device_add_variant(codec, &builder, flags);
+		value = g_variant_ref_sink(g_variant_new("a{sv}", &builder));
+		priv->variant_cache[flags] = g_variant_get_data_as_bytes(value);
+	}
+	return g_variant_new_from_bytes(G_VARIANT_TYPE_VARDICT, priv->variant_cache[flags], TRUE);
+}
+
 static void
 fwupd_device_from_key_value(FwupdDevice *self, const gchar *key, GVariant *value)
 {
@@ -2863,6 +2935,7 @@ fwupd_device_set_version_format(FwupdDevice *self, FwupdVersionFormat version_fo
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_format = version_format;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -2898,6 +2971,7 @@ fwupd_device_set_version_raw(FwupdDevice *self, guint64 version_raw)
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_raw = version_raw;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -2933,6 +3007,7 @@ fwupd_device_set_version_build_date(FwupdDevice *self, guint64 version_build_dat
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	priv->version_build_date = version_build_date;
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -3041,6 +3116,7 @@ fwupd_device_add_release(FwupdDevice *self, FwupdRelease *release)
 	g_return_if_fail(FWUPD_IS_RELEASE(release));
 	fwupd_device_ensure_releases(self);
 	g_ptr_array_add(priv->releases, g_object_ref(release));
+	fwupd_device_invalidate_variant(self);
 }
 
 /**
@@ -3930,6 +4006,12 @@ fwupd_device_set_property(GObject *object, guint prop_id, const GValue *value, G
 	}
 }
 
+static void
+fwupd_device_notify(GObject *object, GParamSpec *pspec)
+{
+	fwupd_device_invalidate_variant(FWUPD_DEVICE(object));
+}
+
 static void
 fwupd_device_class_init(FwupdDeviceClass *klass)
 {
@@ -3939,6 +4021,7 @@ fwupd_device_class_init(FwupdDeviceClass *klass)
 	object_class->finalize = fwupd_device_finalize;
 	object_class->get_property = fwupd_device_get_property;
 	object_class->set_property = fwupd_device_set_property;
+	object_class->notify = fwupd_device_notify;
 
 	/**
 	 * FwupdDevice:version:
@@ -4208,6 +4291,7 @@ fwupd_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->releases);
 	if (priv->issues != NULL)
 		g_ptr_array_unref(priv->issues);
+	fwupd_device_invalidate_variant(self);
 
 	G_OBJECT_CLASS(fwupd_device_parent_class)->finalize(object);
 }
@@ -4231,6 +4315,7 @@ fwupd_device_codec_iface_init(FwupdCodecInterface *iface)
 	iface->add_json = fwupd_device_add_json;
 	iface->from_json = fwupd_device_from_json;
 	iface->add_variant = fwupd_device_add_variant;
+	iface->to_variant = fwupd_device_to_variant;
 	iface->from_variant_iter = fwupd_device_from_variant_iter;
 }
 
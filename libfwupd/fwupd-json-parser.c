@@ -20,14 +20,20 @@
  * One item of note is that most of the JSON string methods actually return a #GRefString -- which
  * can be used to avoid lots of tiny memory allocation when parsing JSON into other objects.
  *
+ * Large documents can also be parsed using [method@FwupdJsonParser.parse_stream] which calls a
+ * function for each value rather than building a tree of nodes. The same safety limits are used.
+ *
  * See also: [struct@FwupdJsonArray] [struct@FwupdJsonObject] [struct@FwupdJsonNode]
  */
 
+typedef struct FwupdJsonParserHelper FwupdJsonParserHelper;
+
 struct _FwupdJsonParser {
 	GObject parent_instance;
 	guint max_depth;
 	guint max_items;
 	guint max_quoted;
+	FwupdJsonParserHelper *helper; /* noref, only set when parsing events */
 };
 
 G_DEFINE_TYPE(FwupdJsonParser, fwupd_json_parser, G_TYPE_OBJECT)
@@ -105,7 +111,7 @@ typedef enum {
 	FWUPD_JSON_PARSER_TOKEN_ARRAY_END = ']',
 } FwupdJsonParserToken;
 
-typedef struct {
+struct FwupdJsonParserHelper {
 	FwupdJsonLoadFlags flags;
 	GByteArray *buf;
 	gsize buf_offset; /* into @buf */
@@ -118,7 +124,10 @@ typedef struct {
 	guint newlinecnt;
 	guint whitespacecnt;
 	guint depth;
-} FwupdJsonParserHelper;
+	FwupdJsonParserEventFunc func;
+	gpointer user_data;
+	FwupdJsonParserToken current; /* container start that can be loaded as a node */
+};
 
 static FwupdJsonParserHelper *
 fwupd_json_parser_helper_new(FwupdJsonParser *self)
@@ -535,14 +544,199 @@ fwupd_json_parser_load_object(FwupdJsonParser *self, FwupdJsonParserHelper *help
 	return g_steal_pointer(&json_obj);
 }
 
-static FwupdJsonNode *
-fwupd_json_parser_load_from_stream_internal(FwupdJsonParser *self,
-					    FwupdJsonParserHelper *helper,
-					    GError **error)
+static gboolean
+fwupd_json_parser_parse_object(FwupdJsonParser *self,
+			       FwupdJsonParserHelper *helper,
+			       GRefString *key_parent,
+			       GError **error);
+static gboolean
+fwupd_json_parser_parse_array(FwupdJsonParser *self,
+			      FwupdJsonParserHelper *helper,
+			      GRefString *key_parent,
+			      GError **error);
+
+static gboolean
+fwupd_json_parser_parse_value(FwupdJsonParser *self,
+			      FwupdJsonParserHelper *helper,
+			      FwupdJsonParserToken token,
+			      GRefString *key,
+			      GRefString *str,
+			      GError **error)
 {
-	FwupdJsonParserToken token = FWUPD_JSON_PARSER_TOKEN_INVALID;
-	g_autoptr(GRefString) str = NULL;
+	if (token == FWUPD_JSON_PARSER_TOKEN_OBJECT_START ||
+	    token == FWUPD_JSON_PARSER_TOKEN_ARRAY_START) {
+		FwupdJsonParserEvent event = token == FWUPD_JSON_PARSER_TOKEN_OBJECT_START
+						 ? FWUPD_JSON_PARSER_EVENT_OBJECT_START
+						 : FWUPD_JSON_PARSER_EVENT_ARRAY_START;
+		gboolean ret;
+
+		/* the callback can load the entire value using fwupd_json_parser_load_current() */
+		helper->current = token;
+		ret = helper->func(self, event, key, NULL, helper->user_data, error);
+		token = helper->current;
+		helper->current = FWUPD_JSON_PARSER_TOKEN_INVALID;
+		if (!ret)
+			return FALSE;
+		if (token == FWUPD_JSON_PARSER_TOKEN_OBJECT_START)
+			return fwupd_json_parser_parse_object(self, helper, key, error);
+		if (token == FWUPD_JSON_PARSER_TOKEN_ARRAY_START)
+			return fwupd_json_parser_parse_array(self, helper, key, error);
+		return TRUE;
+	}
+	if (token == FWUPD_JSON_PARSER_TOKEN_STRING) {
+		return helper->func(self,
+				    FWUPD_JSON_PARSER_EVENT_STRING,
+				    key,
+				    str,
+				    helper->user_data,
+				    error);
+	}
+	if (token == FWUPD_JSON_PARSER_TOKEN_NULL) {
+		return helper->func(self,
+				    FWUPD_JSON_PARSER_EVENT_NULL,
+				    key,
+				    NULL,
+				    helper->user_data,
+				    error);
+	}
+	if (G_UNLIKELY(str == NULL)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "did not find raw value on line %u",
+			    helper->linecnt);
+		return FALSE;
+	}
+	return helper->func(self,
+			    FWUPD_JSON_PARSER_EVENT_RAW,
+			    key,
+			    str,
+			    helper->user_data,
+			    error);
+}
+
+static gboolean
+fwupd_json_parser_parse_array(FwupdJsonParser *self,
+			      FwupdJsonParserHelper *helper,
+			      GRefString *key_parent,
+			      GError **error)
+{
+	guint items = 0;
+
+	if (G_UNLIKELY(!fwupd_json_parser_helper_check_depth(self, ++helper->depth, error)))
+		return FALSE;
+	while (TRUE) {
+		g_autoptr(GRefString) str = NULL;
+		FwupdJsonParserToken token = FWUPD_JSON_PARSER_TOKEN_INVALID;
+
+		if (!fwupd_json_parser_helper_get_next_token(helper, &token, &str, error))
+			return FALSE;
+		if (token == FWUPD_JSON_PARSER_TOKEN_ARRAY_END)
+			break;
+		if (G_UNLIKELY(token == FWUPD_JSON_PARSER_TOKEN_OBJECT_END ||
+			       token == FWUPD_JSON_PARSER_TOKEN_OBJECT_DELIM ||
+			       token == FWUPD_JSON_PARSER_TOKEN_NULL)) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "object delimiter not expected in array");
+			return FALSE;
+		}
+		if (!fwupd_json_parser_parse_value(self, helper, token, NULL, str, error))
+			return FALSE;
+		if (G_UNLIKELY(self->max_items > 0 && ++items > self->max_items)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "too many items in array, limit was %u",
+				    self->max_items);
+			return FALSE;
+		}
+	}
+	helper->depth--;
+
+	return helper->func(self,
+			    FWUPD_JSON_PARSER_EVENT_ARRAY_END,
+			    key_parent,
+			    NULL,
+			    helper->user_data,
+			    error);
+}
+
+static gboolean
+fwupd_json_parser_parse_object(FwupdJsonParser *self,
+			       FwupdJsonParserHelper *helper,
+			       GRefString *key_parent,
+			       GError **error)
+{
+	guint items = 0;
+
+	if (!fwupd_json_parser_helper_check_depth(self, ++helper->depth, error))
+		return FALSE;
+	while (TRUE) {
+		FwupdJsonParserToken token1 = FWUPD_JSON_PARSER_TOKEN_INVALID;
+		FwupdJsonParserToken token2 = FWUPD_JSON_PARSER_TOKEN_INVALID;
+		FwupdJsonParserToken token3 = FWUPD_JSON_PARSER_TOKEN_INVALID;
+		g_autoptr(GRefString) key = NULL;
+		g_autoptr(GRefString) val = NULL;
+
+		/* "key" : value */
+		if (!fwupd_json_parser_helper_get_next_token(helper, &token1, &key, error))
+			return FALSE;
+		if (token1 == FWUPD_JSON_PARSER_TOKEN_OBJECT_END)
+			break;
+		if (G_UNLIKELY(token1 != FWUPD_JSON_PARSER_TOKEN_STRING)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "object key '%s' must be quoted on line %u",
+				    key,
+				    helper->linecnt);
+			return FALSE;
+		}
+		if (!fwupd_json_parser_helper_get_next_token(helper, &token2, NULL, error))
+			return FALSE;
+		if (token2 != FWUPD_JSON_PARSER_TOKEN_OBJECT_DELIM) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "did not find object delimiter on line %u",
+				    helper->linecnt);
+			return FALSE;
+		}
+		if (!fwupd_json_parser_helper_get_next_token(helper, &token3, &val, error))
+			return FALSE;
+
+		/* the same few keys are used many times */
+		if ((helper->flags & FWUPD_JSON_LOAD_FLAG_STATIC_KEYS) > 0) {
+			GRefString *key_intern = g_ref_string_new_intern(key);
+			g_ref_string_release(key);
+			key = key_intern;
+		}
+		if (!fwupd_json_parser_parse_value(self, helper, token3, key, val, error))
+			return FALSE;
+		if (G_UNLIKELY(self->max_items > 0 && ++items > self->max_items)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "too many items in object, limit was %u",
+				    self->max_items);
+			return FALSE;
+		}
+	}
+	helper->depth--;
+
+	return helper->func(self,
+			    FWUPD_JSON_PARSER_EVENT_OBJECT_END,
+			    key_parent,
+			    NULL,
+			    helper->user_data,
+			    error);
+}
 
+static void
+fwupd_json_parser_check_limits(FwupdJsonParser *self)
+{
 #ifndef SUPPORTED_BUILD
 	/* runtime warnings */
 	if (self->max_depth == G_MAXUINT16)
@@ -552,7 +746,46 @@ fwupd_json_parser_load_from_stream_internal(FwupdJsonParser *self,
 	if (self->max_quoted == G_MAXUINT16)
 		g_warning("using the default max quoted; use fwupd_json_parser_set_max_quoted()");
 #endif
+}
+
+static gboolean
+fwupd_json_parser_parse_stream_internal(FwupdJsonParser *self,
+					FwupdJsonParserHelper *helper,
+					GError **error)
+{
+	FwupdJsonParserToken token = FWUPD_JSON_PARSER_TOKEN_INVALID;
+	gboolean ret;
+	g_autoptr(GRefString) str = NULL;
+
+	fwupd_json_parser_check_limits(self);
+	if (!fwupd_json_parser_helper_get_next_token(helper, &token, &str, error))
+		return FALSE;
+	if (token != FWUPD_JSON_PARSER_TOKEN_OBJECT_START &&
+	    token != FWUPD_JSON_PARSER_TOKEN_ARRAY_START &&
+	    token != FWUPD_JSON_PARSER_TOKEN_STRING && token != FWUPD_JSON_PARSER_TOKEN_RAW) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid JSON; token was not object, array, string or raw");
+		return FALSE;
+	}
+
+	/* only valid while parsing, for fwupd_json_parser_load_current() */
+	self->helper = helper;
+	ret = fwupd_json_parser_parse_value(self, helper, token, NULL, str, error);
+	self->helper = NULL;
+	return ret;
+}
+
+static FwupdJsonNode *
+fwupd_json_parser_load_from_stream_internal(FwupdJsonParser *self,
+					    FwupdJsonParserHelper *helper,
+					    GError **error)
+{
+	FwupdJsonParserToken token = FWUPD_JSON_PARSER_TOKEN_INVALID;
+	g_autoptr(GRefString) str = NULL;
 
+	fwupd_json_parser_check_limits(self);
 	if (!fwupd_json_parser_helper_get_next_token(helper, &token, &str, error))
 		return NULL;
 	if (token == FWUPD_JSON_PARSER_TOKEN_OBJECT_START) {
@@ -679,6 +912,178 @@ fwupd_json_parser_load_from_stream(FwupdJsonParser *self,
 	return fwupd_json_parser_load_from_stream_internal(self, helper, error);
 }
 
+/**
+ * fwupd_json_parser_load_current: (skip):
+ * @self: a #FwupdJsonParser
+ * @error: (nullable): optional return location for an error
+ *
+ * Loads the object or array that has just been started as a node, which can be useful when only
+ * part of a large document needs to be kept.
+ *
+ * This can only be called from a #FwupdJsonParserEventFunc when handling the
+ * %FWUPD_JSON_PARSER_EVENT_OBJECT_START or %FWUPD_JSON_PARSER_EVENT_ARRAY_START events. No more
+ * events are emitted for the values inside the loaded node, or for the end of it.
+ *
+ * Returns: (transfer full): a #FwupdJsonNode, or %NULL for error
+ *
+ * Since: 2.1.8
+ **/
+FwupdJsonNode *
+fwupd_json_parser_load_current(FwupdJsonParser *self, GError **error)
+{
+	FwupdJsonParserHelper *helper;
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_JSON_PARSER(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	helper = self->helper;
+	if (helper == NULL || helper->current == FWUPD_JSON_PARSER_TOKEN_INVALID) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "can only load an object or array that has just been started");
+		return NULL;
+	}
+	if (helper->current == FWUPD_JSON_PARSER_TOKEN_OBJECT_START) {
+		g_autoptr(FwupdJsonObject) json_obj = NULL;
+		helper->current = FWUPD_JSON_PARSER_TOKEN_INVALID;
+		json_obj = fwupd_json_parser_load_object(self, helper, error);
+		if (json_obj == NULL)
+			return NULL;
+		return fwupd_json_node_new_object(json_obj);
+	}
+	helper->current = FWUPD_JSON_PARSER_TOKEN_INVALID;
+	json_arr = fwupd_json_parser_load_array(self, helper, error);
+	if (json_arr == NULL)
+		return NULL;
+	return fwupd_json_node_new_array(json_arr);
+}
+
+/**
+ * fwupd_json_parser_parse_stream: (skip):
+ * @self: a #FwupdJsonParser
+ * @stream: a #GInputStream
+ * @flags: a #FwupdJsonLoadFlags
+ * @func: (scope call): a #FwupdJsonParserEventFunc
+ * @user_data: user data to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses JSON from a stream, calling @func for each value rather than building a tree of nodes.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fwupd_json_parser_parse_stream(FwupdJsonParser *self,
+			       GInputStream *stream,
+			       FwupdJsonLoadFlags flags,
+			       FwupdJsonParserEventFunc func,
+			       gpointer user_data,
+			       GError **error)
+{
+	g_autoptr(FwupdJsonParserHelper) helper = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_JSON_PARSER(self), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(self->helper == NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* seek to start if possible */
+	if (G_IS_SEEKABLE(stream) && g_seekable_can_seek(G_SEEKABLE(stream))) {
+		if (!g_seekable_seek(G_SEEKABLE(stream), 0x0, G_SEEK_SET, NULL, error)) {
+			fwupd_error_convert(error);
+			return FALSE;
+		}
+	}
+	helper = fwupd_json_parser_helper_new(self);
+	helper->stream = g_object_ref(stream);
+	helper->flags = flags;
+	helper->func = func;
+	helper->user_data = user_data;
+	return fwupd_json_parser_parse_stream_internal(self, helper, error);
+}
+
+/**
+ * fwupd_json_parser_parse_bytes: (skip):
+ * @self: a #FwupdJsonParser
+ * @blob: a #GBytes
+ * @flags: a #FwupdJsonLoadFlags
+ * @func: (scope call): a #FwupdJsonParserEventFunc
+ * @user_data: user data to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses JSON from a blob, calling @func for each value rather than building a tree of nodes.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fwupd_json_parser_parse_bytes(FwupdJsonParser *self,
+			      GBytes *blob,
+			      FwupdJsonLoadFlags flags,
+			      FwupdJsonParserEventFunc func,
+			      gpointer user_data,
+			      GError **error)
+{
+	g_autoptr(FwupdJsonParserHelper) helper = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_JSON_PARSER(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(self->helper == NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	helper = fwupd_json_parser_helper_new(self);
+	helper->stream = g_memory_input_stream_new_from_bytes(blob);
+	helper->flags = flags;
+	helper->func = func;
+	helper->user_data = user_data;
+	return fwupd_json_parser_parse_stream_internal(self, helper, error);
+}
+
+/**
+ * fwupd_json_parser_parse_data: (skip):
+ * @self: a #FwupdJsonParser
+ * @text: a string
+ * @flags: a #FwupdJsonLoadFlags
+ * @func: (scope call): a #FwupdJsonParserEventFunc
+ * @user_data: user data to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses JSON from a string, calling @func for each value rather than building a tree of nodes.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fwupd_json_parser_parse_data(FwupdJsonParser *self,
+			     const gchar *text,
+			     FwupdJsonLoadFlags flags,
+			     FwupdJsonParserEventFunc func,
+			     gpointer user_data,
+			     GError **error)
+{
+	g_autoptr(FwupdJsonParserHelper) helper = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_JSON_PARSER(self), FALSE);
+	g_return_val_if_fail(text != NULL, FALSE);
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(self->helper == NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	helper = fwupd_json_parser_helper_new(self);
+	helper->stream = g_memory_input_stream_new_from_data(text, strlen(text), NULL);
+	helper->flags = flags;
+	helper->func = func;
+	helper->user_data = user_data;
+	return fwupd_json_parser_parse_stream_internal(self, helper, error);
+}
+
 static void
 fwupd_json_parser_class_init(FwupdJsonParserClass *klass)
 {
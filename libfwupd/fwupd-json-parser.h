@@ -15,6 +15,28 @@ G_BEGIN_DECLS
 #define FWUPD_TYPE_JSON_PARSER (fwupd_json_parser_get_type())
 G_DECLARE_FINAL_TYPE(FwupdJsonParser, fwupd_json_parser, FWUPD, JSON_PARSER, GObject)
 
+/**
+ * FwupdJsonParserEventFunc:
+ * @self: a #FwupdJsonParser
+ * @event: a #FwupdJsonParserEvent, e.g. %FWUPD_JSON_PARSER_EVENT_OBJECT_START
+ * @key: (nullable): the object member name, or %NULL for array elements and the root value
+ * @value: (nullable): the string or raw value
+ * @user_data: user data
+ * @error: (nullable): optional return location for an error
+ *
+ * The parser event callback.
+ *
+ * Returns: %TRUE to continue parsing
+ *
+ * Since: 2.1.8
+ */
+typedef gboolean (*FwupdJsonParserEventFunc)(FwupdJsonParser *self,
+					     FwupdJsonParserEvent event,
+					     GRefString *key,
+					     GRefString *value,
+					     gpointer user_data,
+					     GError **error);
+
 FwupdJsonParser *
 fwupd_json_parser_new(void) G_GNUC_WARN_UNUSED_RESULT;
 
@@ -41,4 +63,29 @@ fwupd_json_parser_load_from_data(FwupdJsonParser *self,
 				 FwupdJsonLoadFlags flags,
 				 GError **error) G_GNUC_NON_NULL(1, 2) G_GNUC_WARN_UNUSED_RESULT;
 
+gboolean
+fwupd_json_parser_parse_stream(FwupdJsonParser *self,
+			       GInputStream *stream,
+			       FwupdJsonLoadFlags flags,
+			       FwupdJsonParserEventFunc func,
+			       gpointer user_data,
+			       GError **error) G_GNUC_NON_NULL(1, 2, 4);
+gboolean
+fwupd_json_parser_parse_bytes(FwupdJsonParser *self,
+			      GBytes *blob,
+			      FwupdJsonLoadFlags flags,
+			      FwupdJsonParserEventFunc func,
+			      gpointer user_data,
+			      GError **error) G_GNUC_NON_NULL(1, 2, 4);
+gboolean
+fwupd_json_parser_parse_data(FwupdJsonParser *self,
+			     const gchar *text,
+			     FwupdJsonLoadFlags flags,
+			     FwupdJsonParserEventFunc func,
+			     gpointer user_data,
+			     GError **error) G_GNUC_NON_NULL(1, 2, 4);
+FwupdJsonNode *
+fwupd_json_parser_load_current(FwupdJsonParser *self, GError **error) G_GNUC_NON_NULL(1)
+    G_GNUC_WARN_UNUSED_RESULT;
+
 G_END_DECLS
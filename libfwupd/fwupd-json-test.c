@@ -354,6 +354,95 @@ fwupd_json_object_func(void)
 	g_assert_true(ret);
 }
 
+static gboolean
+fwupd_json_parser_events_cb(FwupdJsonParser *json_parser,
+			    FwupdJsonParserEvent event,
+			    GRefString *key,
+			    GRefString *value,
+			    gpointer user_data,
+			    GError **error)
+{
+	GString *str = (GString *)user_data;
+
+	g_string_append_printf(str,
+			       "%s:%s=%s;",
+			       fwupd_json_parser_event_to_string(event),
+			       key != NULL ? key : "",
+			       value != NULL ? value : "");
+
+	/* load this one as a node */
+	if (event == FWUPD_JSON_PARSER_EVENT_OBJECT_START && g_strcmp0(key, "seven") == 0) {
+		g_autoptr(FwupdJsonNode) json_node = NULL;
+		g_autoptr(GString) json_str = NULL;
+
+		json_node = fwupd_json_parser_load_current(json_parser, error);
+		if (json_node == NULL)
+			return FALSE;
+		json_str = fwupd_json_node_to_string(json_node, FWUPD_JSON_EXPORT_FLAG_NONE);
+		g_string_append_printf(str, "node=%s;", json_str->str);
+	}
+	return TRUE;
+}
+
+static void
+fwupd_json_parser_events_func(void)
+{
+	gboolean ret;
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GString) str = g_string_new(NULL);
+	const gchar *json = "{\"one\": \"two\", \"three\": [1, \"four\"], "
+			    "\"five\": {\"six\": null}, \"seven\": {\"eight\": 8}}";
+
+	/* set appropriate limits */
+	fwupd_json_parser_set_max_depth(json_parser, 10);
+	fwupd_json_parser_set_max_items(json_parser, 4);
+	fwupd_json_parser_set_max_quoted(json_parser, 10);
+
+	ret = fwupd_json_parser_parse_data(json_parser,
+					   json,
+					   FWUPD_JSON_LOAD_FLAG_STATIC_KEYS,
+					   fwupd_json_parser_events_cb,
+					   str,
+					   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(str->str,
+			==,
+			"object-start:=;string:one=two;array-start:three=;raw:=1;string:=four;"
+			"array-end:three=;object-start:five=;null:six=;object-end:five=;"
+			"object-start:seven=;node={\"eight\": 8};object-end:=;");
+
+	/* only when handling an event */
+	json_node = fwupd_json_parser_load_current(json_parser, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(json_node);
+	g_clear_error(&error);
+
+	/* same limits as loading */
+	fwupd_json_parser_set_max_items(json_parser, 3);
+	ret = fwupd_json_parser_parse_data(json_parser,
+					   json,
+					   FWUPD_JSON_LOAD_FLAG_NONE,
+					   fwupd_json_parser_events_cb,
+					   str,
+					   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+	fwupd_json_parser_set_max_items(json_parser, 4);
+	fwupd_json_parser_set_max_depth(json_parser, 1);
+	ret = fwupd_json_parser_parse_data(json_parser,
+					   json,
+					   FWUPD_JSON_LOAD_FLAG_NONE,
+					   fwupd_json_parser_events_cb,
+					   str,
+					   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
 static void
 fwupd_json_node_func(void)
 {
@@ -466,5 +555,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/json/parser/items", fwupd_json_parser_items_func);
 	g_test_add_func("/fwupd/json/parser/quoted", fwupd_json_parser_quoted_func);
 	g_test_add_func("/fwupd/json/parser/stream", fwupd_json_parser_stream_func);
+	g_test_add_func("/fwupd/json/parser/events", fwupd_json_parser_events_func);
 	return g_test_run();
 }
@@ -27,3 +27,16 @@ enum FwupdJsonLoadFlags {
     Trusted = 1 << 0,
     StaticKeys = 1 << 1,
 }
+
+// JSON parser event.
+// Since: 2.1.8
+#[derive(ToString)]
+enum FwupdJsonParserEvent {
+    ObjectStart,
+    ObjectEnd,
+    ArrayStart,
+    ArrayEnd,
+    String,
+    Raw,
+    Null,
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-backend.h"
+
+void
+fu_backend_load_json_begin(FuBackend *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_backend_load_json_device(FuBackend *self,
+			    FwupdJsonObject *json_obj,
+			    GPtrArray *events,
+			    GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_backend_load_json_end(FuBackend *self, const gchar *fwupd_version, GError **error)
+    G_GNUC_NON_NULL(1);
+void
+fu_backend_load_json_cancel(FuBackend *self) G_GNUC_NON_NULL(1);
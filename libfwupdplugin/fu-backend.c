@@ -8,6 +8,7 @@
 
 #include "config.h"
 
+#include "fu-backend-private.h"
 #include "fu-device-locker.h"
 #include "fu-device-private.h"
 
@@ -28,6 +29,9 @@ typedef struct {
 	GType device_gtype;
 	GHashTable *devices; /* device_id : * FuDevice */
 	GThread *thread_init;
+	GPtrArray *load_devices_remove;	 /* (element-type FuDevice) (nullable) */
+	GPtrArray *load_devices_changed; /* (element-type FuDevice) (nullable) */
+	GPtrArray *load_devices_added;	 /* (element-type FuDevice) (nullable) */
 } FuBackendPrivate;
 
 enum { SIGNAL_ADDED, SIGNAL_REMOVED, SIGNAL_CHANGED, SIGNAL_LAST };
@@ -358,25 +362,26 @@ fu_backend_setup(FuBackend *self, FuBackendSetupFlags flags, FuProgress *progres
 	return TRUE;
 }
 
-static gboolean
-fu_backend_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **error)
+/* private; discards anything loaded since fu_backend_load_json_begin() */
+void
+fu_backend_load_json_cancel(FuBackend *self)
 {
-	FuBackend *self = FU_BACKEND(codec);
 	FuBackendPrivate *priv = GET_PRIVATE(self);
-	g_autoptr(FwupdJsonArray) json_arr = NULL;
-	const gchar *fwupd_version;
-	g_autoptr(GPtrArray) devices_added =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(GPtrArray) devices_remove = NULL;
 
-	/* no registered specialized GType */
-	if (priv->device_gtype == FU_TYPE_DEVICE) {
-		g_debug("no registered device GType for backend %s", fu_backend_get_name(self));
-		return TRUE;
-	}
+	g_return_if_fail(FU_IS_BACKEND(self));
 
-	/* if recorded */
-	fwupd_version = fwupd_json_object_get_string(json_obj, "FwupdVersion", NULL);
+	g_clear_pointer(&priv->load_devices_remove, g_ptr_array_unref);
+	g_clear_pointer(&priv->load_devices_changed, g_ptr_array_unref);
+	g_clear_pointer(&priv->load_devices_added, g_ptr_array_unref);
+}
+
+/* private; called before fu_backend_load_json_device() for each emulated device */
+void
+fu_backend_load_json_begin(FuBackend *self)
+{
+	FuBackendPrivate *priv = GET_PRIVATE(self);
+
+	g_return_if_fail(FU_IS_BACKEND(self));
 
 	/* four steps:
 	 *
@@ -386,89 +391,137 @@ fu_backend_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **erro
 	 *    - otherwise add to devices_added
 	 * 3. emit devices in devices_remove
 	 * 4. emit devices in devices_added
+	 *
+	 * the backend devices are not modified until fu_backend_load_json_end() so that nothing
+	 * changes if the emulation data turns out to be invalid
 	 */
-	devices_remove = fu_backend_get_devices(self);
-	json_arr = fwupd_json_object_get_array(json_obj, "UsbDevices", NULL);
-	if (json_arr == NULL) {
-		/* remain compatible with all the old emulation files */
+	fu_backend_load_json_cancel(self);
+	if (priv->device_gtype == FU_TYPE_DEVICE)
+		return;
+	priv->load_devices_remove = fu_backend_get_devices(self);
+	priv->load_devices_changed = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	priv->load_devices_added = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+}
+
+/* private; @events are added to the device as well as any in @json_obj */
+gboolean
+fu_backend_load_json_device(FuBackend *self,
+			    FwupdJsonObject *json_obj,
+			    GPtrArray *events,
+			    GError **error)
+{
+	FuBackendPrivate *priv = GET_PRIVATE(self);
+	FuDevice *device_old;
+	const gchar *device_gtypestr;
+	GType device_gtype;
+	g_autofree gchar *id_display = NULL;
+	g_autoptr(FuDevice) device_tmp = NULL;
+
+	g_return_val_if_fail(FU_IS_BACKEND(self), FALSE);
+	g_return_val_if_fail(json_obj != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* no registered specialized GType */
+	if (priv->load_devices_remove == NULL)
 		return TRUE;
-	}
-	for (guint i = 0; i < fwupd_json_array_get_size(json_arr); i++) {
-		FuDevice *device_old;
-		const gchar *device_gtypestr;
-		GType device_gtype;
-		g_autofree gchar *id_display = NULL;
-		g_autoptr(FuDevice) device_tmp = NULL;
-		g_autoptr(FwupdJsonObject) object_tmp = NULL;
 
-		/* sanity check */
-		object_tmp = fwupd_json_array_get_object(json_arr, i, error);
-		if (object_tmp == NULL)
-			return FALSE;
+	/* get the GType */
+	device_gtypestr = fwupd_json_object_get_string(json_obj, "GType", NULL);
+	if (device_gtypestr == NULL)
+		device_gtypestr = "FuUsbDevice";
+	device_gtype = g_type_from_name(device_gtypestr);
+	if (device_gtype == G_TYPE_INVALID) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "unknown GType name %s",
+			    device_gtypestr);
+		return FALSE;
+	}
+	if (!g_type_is_a(device_gtype, priv->device_gtype)) {
+		g_debug("ignoring device backend GType %s", g_type_name(priv->device_gtype));
+		return TRUE;
+	}
 
-		/* get the GType */
-		device_gtypestr = fwupd_json_object_get_string(object_tmp, "GType", NULL);
-		if (device_gtypestr == NULL)
-			device_gtypestr = "FuUsbDevice";
-		device_gtype = g_type_from_name(device_gtypestr);
-		if (device_gtype == G_TYPE_INVALID) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "unknown GType name %s",
-				    device_gtypestr);
-			return FALSE;
-		}
-		if (!g_type_is_a(device_gtype, priv->device_gtype)) {
-			g_debug("ignoring device backend GType %s",
-				g_type_name(priv->device_gtype));
-			continue;
+	/* create device */
+	device_tmp = g_object_new(device_gtype, "backend", self, NULL);
+	fu_device_add_flag(device_tmp, FWUPD_DEVICE_FLAG_EMULATED);
+	if (events != NULL) {
+		for (guint i = 0; i < events->len; i++) {
+			FuDeviceEvent *event = g_ptr_array_index(events, i);
+			fu_device_add_event(device_tmp, event);
 		}
+	}
+	if (!fu_device_from_json(device_tmp, json_obj, error))
+		return FALSE;
+	if (fu_device_get_backend_id(device_tmp) == NULL) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "no backend specified %s",
+			    device_gtypestr);
+		return FALSE;
+	}
+	id_display = fu_device_get_id_display(device_tmp);
 
-		/* create device */
-		device_tmp = g_object_new(device_gtype, "backend", self, NULL);
-		fu_device_add_flag(device_tmp, FWUPD_DEVICE_FLAG_EMULATED);
-		if (fwupd_version != NULL)
-			fu_device_set_fwupd_version(device_tmp, fwupd_version);
-		if (!fu_device_from_json(device_tmp, object_tmp, error))
-			return FALSE;
-		if (fu_device_get_backend_id(device_tmp) == NULL) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "no backend specified %s",
-				    device_gtypestr);
-			return FALSE;
-		}
-		id_display = fu_device_get_id_display(device_tmp);
+	/* does a device with this platform ID [and the same created date] already exist */
+	device_old = fu_backend_lookup_by_id(self, fu_device_get_backend_id(device_tmp));
 
-		/* does a device with this platform ID [and the same created date] already exist */
-		device_old = fu_backend_lookup_by_id(self, fu_device_get_backend_id(device_tmp));
+	/* yes, and it has the same timestamp */
+	if (device_old != NULL) {
+		g_debug("created timestamp %" G_GINT64_FORMAT "->%" G_GINT64_FORMAT,
+			fu_device_get_created_usec(device_old),
+			fu_device_get_created_usec(device_tmp));
+	}
+	if (device_old != NULL &&
+	    fu_device_get_created_usec(device_old) == fu_device_get_created_usec(device_tmp)) {
+		g_debug("changed %s", id_display);
+		g_ptr_array_remove(priv->load_devices_remove, device_old);
+		g_ptr_array_add(priv->load_devices_changed, g_steal_pointer(&device_tmp));
+		return TRUE;
+	}
 
-		/* yes, and it has the same timestamp */
-		if (device_old != NULL) {
-			g_debug("created timestamp %" G_GINT64_FORMAT "->%" G_GINT64_FORMAT,
-				fu_device_get_created_usec(device_old),
-				fu_device_get_created_usec(device_tmp));
-		}
-		if (device_old != NULL && fu_device_get_created_usec(device_old) ==
-					      fu_device_get_created_usec(device_tmp)) {
-			GPtrArray *events = fu_device_get_events(device_tmp);
-
-			fu_device_clear_events(device_old);
-			for (guint j = 0; j < events->len; j++) {
-				FuDeviceEvent *event = g_ptr_array_index(events, j);
-				fu_device_add_event(device_old, event);
-			}
-			g_debug("changed %s", id_display);
-			fu_backend_device_changed(self, device_old);
-			g_ptr_array_remove(devices_remove, device_old);
+	/* new to us! */
+	g_debug("not found %s, adding", id_display);
+	g_ptr_array_add(priv->load_devices_added, g_steal_pointer(&device_tmp));
+	return TRUE;
+}
+
+/* private; called when all the emulation data has been parsed, where @fwupd_version is from
+ * the root object and so may have been found after the devices */
+gboolean
+fu_backend_load_json_end(FuBackend *self, const gchar *fwupd_version, GError **error)
+{
+	FuBackendPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GPtrArray) devices_remove = NULL;
+	g_autoptr(GPtrArray) devices_changed = NULL;
+	g_autoptr(GPtrArray) devices_added = NULL;
+
+	g_return_val_if_fail(FU_IS_BACKEND(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* no registered specialized GType */
+	if (priv->load_devices_remove == NULL)
+		return TRUE;
+	devices_remove = g_steal_pointer(&priv->load_devices_remove);
+	devices_changed = g_steal_pointer(&priv->load_devices_changed);
+	devices_added = g_steal_pointer(&priv->load_devices_added);
+
+	/* replace the events of devices we already have */
+	for (guint i = 0; i < devices_changed->len; i++) {
+		FuDevice *device_tmp = g_ptr_array_index(devices_changed, i);
+		FuDevice *device_old;
+		GPtrArray *events_tmp = fu_device_get_events(device_tmp);
+
+		device_old = fu_backend_lookup_by_id(self, fu_device_get_backend_id(device_tmp));
+		if (device_old == NULL)
 			continue;
+		fu_device_clear_events(device_old);
+		for (guint j = 0; j < events_tmp->len; j++) {
+			FuDeviceEvent *event = g_ptr_array_index(events_tmp, j);
+			fu_device_add_event(device_old, event);
 		}
-
-		/* new to us! */
-		g_debug("not found %s, adding", id_display);
-		g_ptr_array_add(devices_added, g_object_ref(device_tmp));
+		fu_backend_device_changed(self, device_old);
 	}
 
 	/* emit removes then adds */
@@ -483,6 +536,10 @@ fu_backend_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **erro
 		g_autoptr(FuDevice) device = NULL;
 		g_autoptr(GError) error_local = NULL;
 
+		/* if recorded */
+		if (fwupd_version != NULL)
+			fu_device_set_fwupd_version(donor, fwupd_version);
+
 		/* convert from FuUdevDevice to the superclass, e.g. FuHidrawDevice */
 		if (!fu_device_probe(donor, &error_local)) {
 			if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
@@ -510,6 +567,47 @@ fu_backend_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **erro
 	return TRUE;
 }
 
+static gboolean
+fu_backend_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **error)
+{
+	FuBackend *self = FU_BACKEND(codec);
+	FuBackendPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+
+	/* no registered specialized GType */
+	if (priv->device_gtype == FU_TYPE_DEVICE) {
+		g_debug("no registered device GType for backend %s", fu_backend_get_name(self));
+		return TRUE;
+	}
+
+	json_arr = fwupd_json_object_get_array(json_obj, "UsbDevices", NULL);
+	if (json_arr == NULL) {
+		/* remain compatible with all the old emulation files */
+		return TRUE;
+	}
+
+	fu_backend_load_json_begin(self);
+	for (guint i = 0; i < fwupd_json_array_get_size(json_arr); i++) {
+		g_autoptr(FwupdJsonObject) object_tmp = NULL;
+
+		/* sanity check */
+		object_tmp = fwupd_json_array_get_object(json_arr, i, error);
+		if (object_tmp == NULL) {
+			fu_backend_load_json_cancel(self);
+			return FALSE;
+		}
+		if (!fu_backend_load_json_device(self, object_tmp, NULL, error)) {
+			fu_backend_load_json_cancel(self);
+			return FALSE;
+		}
+	}
+
+	/* if recorded */
+	return fu_backend_load_json_end(self,
+					fwupd_json_object_get_string(json_obj, "FwupdVersion", NULL),
+					error);
+}
+
 static void
 fu_backend_add_json(FwupdCodec *codec, FwupdJsonObject *json_obj, FwupdCodecFlags flags)
 {
@@ -755,6 +853,7 @@ fu_backend_dispose(GObject *object)
 	FuBackend *self = FU_BACKEND(object);
 	FuBackendPrivate *priv = GET_PRIVATE(self);
 	g_hash_table_remove_all(priv->devices);
+	fu_backend_load_json_cancel(self);
 	g_clear_object(&priv->ctx);
 	G_OBJECT_CLASS(fu_backend_parent_class)->dispose(object);
 }
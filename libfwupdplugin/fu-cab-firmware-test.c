@@ -9,6 +9,7 @@
 #include <fwupdplugin.h>
 
 #include "fu-cab-firmware-private.h"
+#include "fu-cab-struct.h"
 
 static void
 fu_cab_firmware_checksum_func(void)
@@ -84,6 +85,200 @@ fu_cab_firmware_compressed_size_func(void)
 	g_assert_false(ret);
 }
 
+/* creates an archive with a single-folder payload for each folder, stealing the CFDATA */
+static GBytes *
+fu_cab_firmware_build_folders(guint folders, gsize payloadsz, GPtrArray *blobs)
+{
+	gboolean ret;
+	gsize offset_cfdata;
+	gsize offset_cffile;
+	g_autoptr(FuStructCabHeader) st_hdr = fu_struct_cab_header_new();
+	g_autoptr(GByteArray) buf_cffile = g_byte_array_new();
+	g_autoptr(GByteArray) buf_cfdata = g_byte_array_new();
+	g_autoptr(GPtrArray) folder_hdrs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_struct_cab_folder_unref);
+	g_autoptr(GError) error = NULL;
+
+	for (guint i = 0; i < folders; i++) {
+		g_autofree gchar *id = g_strdup_printf("payload%u.bin", i);
+		const guint8 *buf_tmp;
+		gsize offset_folder;
+		g_autoptr(FuCabFirmware) cab_tmp = fu_cab_firmware_new();
+		g_autoptr(FuCabImage) img = fu_cab_image_new();
+		g_autoptr(FuInputStream) stream_tmp = NULL;
+		g_autoptr(FuStructCabFolder) st_folder = NULL;
+		g_autoptr(FuStructCabFile) st_file = fu_struct_cab_file_new();
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+		g_autoptr(GBytes) blob_tmp = NULL;
+
+		/* compressible, but not trivially so */
+		fu_byte_array_set_size(buf, payloadsz, 0x0);
+		for (guint j = 0; j < buf->len; j++)
+			buf->data[j] = (guint8)((j * (i + 1)) % 251) & 0x3F;
+		g_ptr_array_add(blobs, g_byte_array_free_to_bytes(g_steal_pointer(&buf)));
+		fu_cab_firmware_set_compressed(cab_tmp, TRUE);
+		fu_firmware_set_bytes(FU_FIRMWARE(img), g_ptr_array_index(blobs, i));
+		fu_firmware_set_id(FU_FIRMWARE(img), id);
+		ret = fu_firmware_add_image(FU_FIRMWARE(cab_tmp), FU_FIRMWARE(img), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		blob_tmp = fu_firmware_write(FU_FIRMWARE(cab_tmp), &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_tmp);
+		stream_tmp = fu_memory_input_stream_new_from_bytes(blob_tmp);
+		st_folder = fu_struct_cab_folder_parse_stream(stream_tmp,
+							      FU_STRUCT_CAB_HEADER_SIZE,
+							      &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(st_folder);
+		offset_folder = fu_struct_cab_folder_get_offset(st_folder);
+		fu_struct_cab_folder_set_offset(st_folder, buf_cfdata->len);
+		buf_tmp = g_bytes_get_data(blob_tmp, NULL);
+		g_byte_array_append(buf_cfdata,
+				    buf_tmp + offset_folder,
+				    g_bytes_get_size(blob_tmp) - offset_folder);
+		g_ptr_array_add(folder_hdrs, g_steal_pointer(&st_folder));
+
+		fu_struct_cab_file_set_usize(st_file, payloadsz);
+		fu_struct_cab_file_set_index(st_file, i);
+		fu_struct_cab_file_set_date(st_file, (1 << 5) | 1); /* 1980-01-01 */
+		g_byte_array_append(buf_cffile, st_file->buf->data, st_file->buf->len);
+		g_byte_array_append(buf_cffile, (const guint8 *)id, strlen(id) + 1);
+	}
+
+	/* build a multi-folder archive */
+	offset_cffile = st_hdr->buf->len + (folders * FU_STRUCT_CAB_FOLDER_SIZE);
+	offset_cfdata = offset_cffile + buf_cffile->len;
+	fu_struct_cab_header_set_nr_folders(st_hdr, folders);
+	fu_struct_cab_header_set_nr_files(st_hdr, folders);
+	fu_struct_cab_header_set_off_cffile(st_hdr, offset_cffile);
+	fu_struct_cab_header_set_size(st_hdr, offset_cfdata + buf_cfdata->len);
+	for (guint i = 0; i < folders; i++) {
+		FuStructCabFolder *st_folder = g_ptr_array_index(folder_hdrs, i);
+		fu_struct_cab_folder_set_offset(st_folder,
+						offset_cfdata +
+						    fu_struct_cab_folder_get_offset(st_folder));
+		g_byte_array_append(st_hdr->buf, st_folder->buf->data, st_folder->buf->len);
+	}
+	g_byte_array_append(st_hdr->buf, buf_cffile->data, buf_cffile->len);
+	g_byte_array_append(st_hdr->buf, buf_cfdata->data, buf_cfdata->len);
+	return g_bytes_new(st_hdr->buf->data, st_hdr->buf->len);
+}
+
+static void
+fu_cab_firmware_folders_func(void)
+{
+	gboolean ret;
+	const guint folders = 4;
+	g_autoptr(FuCabFirmware) cab = fu_cab_firmware_new();
+	g_autoptr(GPtrArray) blobs = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(GError) error = NULL;
+
+	/* each folder is inflated on a different thread */
+	blob = fu_cab_firmware_build_folders(folders, 4 * FU_MB, blobs);
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_debug("parse=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	for (guint i = 0; i < folders; i++) {
+		g_autofree gchar *id = g_strdup_printf("payload%u.bin", i);
+		g_autoptr(FuFirmware) img = NULL;
+		g_autoptr(GBytes) blob_img = NULL;
+
+		img = fu_firmware_get_image_by_id(FU_FIRMWARE(cab), id, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(img);
+		blob_img = fu_firmware_get_bytes(img, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_img);
+		g_assert_true(g_bytes_equal(blob_img, g_ptr_array_index(blobs, i)));
+	}
+}
+
+static void
+fu_cab_firmware_lazy_func(void)
+{
+	gboolean ret;
+	gsize offset_cfdata;
+	const guint folders = 20;
+	g_autoptr(FuCabFirmware) cab = fu_cab_firmware_new();
+	g_autoptr(FuCabFirmware) cab_lazy = fu_cab_firmware_new();
+	g_autoptr(FuFirmware) img = NULL;
+	g_autoptr(FuFirmware) img_bad = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(FuStructCabFolder) st_folder = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_img = NULL;
+	g_autoptr(GPtrArray) blobs = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_bad = NULL;
+
+	/* corrupt the CFDATA checksum of the first folder */
+	blob = fu_cab_firmware_build_folders(folders, 256 * FU_KB, blobs);
+	stream = fu_memory_input_stream_new_from_bytes(blob);
+	st_folder = fu_struct_cab_folder_parse_stream(stream, FU_STRUCT_CAB_HEADER_SIZE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(st_folder);
+	offset_cfdata = fu_struct_cab_folder_get_offset(st_folder);
+	buf = g_bytes_unref_to_array(g_steal_pointer(&blob));
+	buf->data[offset_cfdata] ^= 0xFF;
+	blob = g_bytes_new(buf->data, buf->len);
+
+	/* every folder is verified when parsing */
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error_bad);
+	g_assert_error(error_bad, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+	g_debug("parse=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_clear_error(&error_bad);
+
+	/* only the CFDATA headers are read */
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab_lazy),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM |
+					  FU_FIRMWARE_PARSE_FLAG_LAZY,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_debug("parse-lazy=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* the last folder is inflated on demand */
+	img = fu_firmware_get_image_by_id(FU_FIRMWARE(cab_lazy), "payload19.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img);
+	g_assert_cmpint(fu_firmware_get_size(img), ==, 256 * FU_KB);
+	g_timer_reset(timer);
+	blob_img = fu_firmware_get_bytes(img, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_img);
+	g_debug("inflate=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_assert_true(g_bytes_equal(blob_img, g_ptr_array_index(blobs, folders - 1)));
+
+	/* the corruption is only found when the first folder is read */
+	img_bad = fu_firmware_get_image_by_id(FU_FIRMWARE(cab_lazy), "payload0.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_bad);
+	g_clear_pointer(&blob_img, g_bytes_unref);
+	blob_img = fu_firmware_get_bytes(img_bad, &error_bad);
+	g_assert_error(error_bad, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(blob_img);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -91,5 +286,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/cab-firmware/checksum", fu_cab_firmware_checksum_func);
 	g_test_add_func("/fwupd/cab-firmware/compressed-size",
 			fu_cab_firmware_compressed_size_func);
+	g_test_add_func("/fwupd/cab-firmware/folders", fu_cab_firmware_folders_func);
+	g_test_add_func("/fwupd/cab-firmware/lazy", fu_cab_firmware_lazy_func);
 	return g_test_run();
 }
@@ -18,6 +18,7 @@
 #include "fu-common.h"
 #include "fu-composite-input-stream.h"
 #include "fu-input-stream.h"
+#include "fu-lazy-input-stream.h"
 #include "fu-mem-private.h"
 #include "fu-partial-input-stream.h"
 #include "fu-path.h"
@@ -71,33 +72,87 @@ fu_cab_firmware_set_compressed(FuCabFirmware *self, gboolean compressed)
 	priv->compressed = compressed;
 }
 
+/* refcounted, as it is also used by any lazily-inflated folders after parsing */
 typedef struct {
+	grefcount refcount;
 	FuInputStream *stream;
 	FuFirmwareParseFlags parse_flags;
 	gsize rsvd_folder;
 	gsize rsvd_block;
 	gsize size_total;
-	FuCabCompression compression;
-	GPtrArray *folder_data; /* of FuCompositeInputStream */
-	z_stream zstrm;
-	guint8 *decompress_buf;
+	gsize size_max;
 	gsize decompress_bufsz;
 	gsize ndatabsz;
+	GMutex mutex; /* for @stream and @size_total */
 } FuCabFirmwareParseHelper;
 
+static FuCabFirmwareParseHelper *
+fu_cab_firmware_parse_helper_ref(FuCabFirmwareParseHelper *helper)
+{
+	g_ref_count_inc(&helper->refcount);
+	return helper;
+}
+
 static void
-fu_cab_firmware_parse_helper_free(FuCabFirmwareParseHelper *helper)
+fu_cab_firmware_parse_helper_unref(FuCabFirmwareParseHelper *helper)
 {
-	inflateEnd(&helper->zstrm);
+	if (!g_ref_count_dec(&helper->refcount))
+		return;
 	if (helper->stream != NULL)
 		g_object_unref(helper->stream);
-	if (helper->folder_data != NULL)
-		g_ptr_array_unref(helper->folder_data);
-	g_free(helper->decompress_buf);
+	g_mutex_clear(&helper->mutex);
 	g_free(helper);
 }
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareParseHelper, fu_cab_firmware_parse_helper_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareParseHelper, fu_cab_firmware_parse_helper_unref)
+
+/* each CFFOLDER has its own inflate state, and so can be decompressed on a worker thread */
+typedef struct {
+	grefcount refcount;
+	FuCabFirmwareParseHelper *helper;
+	FuCabCompression compression;
+	gsize offset; /* of the next CFDATA to parse */
+	guint16 ndatab;
+	gsize size;	     /* only set when indexed with FU_FIRMWARE_PARSE_FLAG_LAZY */
+	gsize size_inflated; /* added to @folder_data so far */
+	FuInputStream *folder_data;
+	z_stream zstrm;
+	guint8 *decompress_buf;
+	GError *error;
+} FuCabFirmwareFolderHelper;
+
+static FuCabFirmwareFolderHelper *
+fu_cab_firmware_folder_helper_new(void)
+{
+	FuCabFirmwareFolderHelper *folder_helper = g_new0(FuCabFirmwareFolderHelper, 1);
+	g_ref_count_init(&folder_helper->refcount);
+	return folder_helper;
+}
+
+static FuCabFirmwareFolderHelper *
+fu_cab_firmware_folder_helper_ref(FuCabFirmwareFolderHelper *folder_helper)
+{
+	g_ref_count_inc(&folder_helper->refcount);
+	return folder_helper;
+}
+
+static void
+fu_cab_firmware_folder_helper_unref(FuCabFirmwareFolderHelper *folder_helper)
+{
+	if (!g_ref_count_dec(&folder_helper->refcount))
+		return;
+	inflateEnd(&folder_helper->zstrm);
+	if (folder_helper->helper != NULL)
+		fu_cab_firmware_parse_helper_unref(folder_helper->helper);
+	if (folder_helper->folder_data != NULL)
+		g_object_unref(folder_helper->folder_data);
+	if (folder_helper->error != NULL)
+		g_error_free(folder_helper->error);
+	g_free(folder_helper->decompress_buf);
+	g_free(folder_helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareFolderHelper, fu_cab_firmware_folder_helper_unref)
 
 /* compute the MS cabinet checksum */
 gboolean
@@ -163,28 +218,41 @@ fu_cab_firmware_zstream_deflater_free(z_stream_deflater *zstrm)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(z_stream_deflater, fu_cab_firmware_zstream_deflater_free)
 
 static gboolean
-fu_cab_firmware_parse_data(FuCabFirmware *self,
-			   FuCabFirmwareParseHelper *helper,
-			   gsize *offset,
-			   FuInputStream *folder_data,
-			   GError **error)
+fu_cab_firmware_verify_data_checksum(guint32 checksum,
+				     guint32 checksum_actual,
+				     gsize blob_comp,
+				     gsize blob_uncomp,
+				     gsize offset,
+				     GError **error)
 {
-	gsize blob_comp;
-	gsize blob_uncomp;
-	gsize hdr_sz;
-	gsize payload_offset = *offset;
-	gsize size_max = fu_firmware_get_size_max(FU_FIRMWARE(self));
-	g_autoptr(FuStructCabData) st = NULL;
-	g_autoptr(FuInputStream) partial_stream = NULL;
+	g_autoptr(GByteArray) hdr = g_byte_array_new();
 
-	/* parse header */
-	st = fu_struct_cab_data_parse_stream(helper->stream, *offset, error);
-	if (st == NULL)
+	fu_byte_array_append_uint16(hdr, blob_comp, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint16(hdr, blob_uncomp, G_LITTLE_ENDIAN);
+	if (!fu_cab_firmware_compute_checksum(hdr->data, hdr->len, &checksum_actual, error))
+		return FALSE;
+	if (checksum_actual != checksum) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "invalid checksum at 0x%x, expected 0x%x, got 0x%x",
+			    (guint)offset,
+			    checksum,
+			    checksum_actual);
 		return FALSE;
+	}
 
-	/* sanity check */
-	blob_comp = fu_struct_cab_data_get_comp(st);
-	blob_uncomp = fu_struct_cab_data_get_uncomp(st);
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_cab_firmware_check_data(FuCabFirmwareFolderHelper *folder_helper,
+			   gsize blob_comp,
+			   gsize blob_uncomp,
+			   GError **error)
+{
+	FuCabFirmwareParseHelper *helper = folder_helper->helper;
 
 	/* validate blob sizes are reasonable */
 	if (blob_comp == 0 || blob_uncomp == 0) {
@@ -195,7 +263,7 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 		return FALSE;
 	}
 
-	if (helper->compression == FU_CAB_COMPRESSION_NONE && blob_comp != blob_uncomp) {
+	if (folder_helper->compression == FU_CAB_COMPRESSION_NONE && blob_comp != blob_uncomp) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
@@ -204,9 +272,9 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 	}
 	if (!fu_size_checked_inc(&helper->size_total, blob_uncomp, error))
 		return FALSE;
-	if (size_max > 0 && helper->size_total > size_max) {
+	if (helper->size_max > 0 && helper->size_total > helper->size_max) {
 		g_autofree gchar *sz_val = g_format_size(helper->size_total);
-		g_autofree gchar *sz_max = g_format_size(size_max);
+		g_autofree gchar *sz_max = g_format_size(helper->size_max);
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INVALID_DATA,
@@ -216,8 +284,84 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 		return FALSE;
 	}
 
+	/* success */
+	return TRUE;
+}
+
+/* only reads the CFDATA header, so the folder size is known without decompressing anything */
+static gboolean
+fu_cab_firmware_index_data(FuCabFirmwareFolderHelper *folder_helper,
+			   gsize *offset,
+			   GError **error)
+{
+	FuCabFirmwareParseHelper *helper = folder_helper->helper;
+	gsize blob_comp;
+	gsize blob_uncomp;
+	guint8 st_buf[FU_STRUCT_CAB_DATA_SIZE] = {0};
+	FuStructCabData st = {0};
+
+	/* parse header */
+	if (!fu_struct_cab_data_parse_stream_view(&st,
+						  st_buf,
+						  sizeof(st_buf),
+						  helper->stream,
+						  *offset,
+						  error))
+		return FALSE;
+
+	/* sanity check */
+	blob_comp = fu_struct_cab_data_get_comp(&st);
+	blob_uncomp = fu_struct_cab_data_get_uncomp(&st);
+	if (!fu_cab_firmware_check_data(folder_helper, blob_comp, blob_uncomp, error))
+		return FALSE;
+	if (!fu_size_checked_inc(&folder_helper->size, blob_uncomp, error))
+		return FALSE;
+
+	/* success */
+	if (!fu_size_checked_inc(offset, st.buf->len, error))
+		return FALSE;
+	if (!fu_size_checked_inc(offset, helper->rsvd_block, error))
+		return FALSE;
+	return fu_size_checked_inc(offset, blob_comp, error);
+}
+
+static gboolean
+fu_cab_firmware_parse_data(FuCabFirmwareFolderHelper *folder_helper,
+			   gsize *offset,
+			   GError **error)
+{
+	FuCabFirmwareParseHelper *helper = folder_helper->helper;
+	gsize blob_comp;
+	gsize blob_uncomp;
+	gsize hdr_sz;
+	gsize payload_offset = *offset;
+	gsize size_max = helper->size_max;
+	guint32 checksum = 0;
+	guint8 st_buf[FU_STRUCT_CAB_DATA_SIZE] = {0};
+	FuStructCabData st = {0};
+	g_autoptr(FuInputStream) partial_stream = NULL;
+	g_autoptr(GBytes) bytes_comp = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&helper->mutex);
+
+	/* parse header */
+	if (!fu_struct_cab_data_parse_stream_view(&st,
+						  st_buf,
+						  sizeof(st_buf),
+						  helper->stream,
+						  *offset,
+						  error))
+		return FALSE;
+
+	/* sanity check, unless already done when the folder was indexed */
+	blob_comp = fu_struct_cab_data_get_comp(&st);
+	blob_uncomp = fu_struct_cab_data_get_uncomp(&st);
+	if ((helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_LAZY) == 0) {
+		if (!fu_cab_firmware_check_data(folder_helper, blob_comp, blob_uncomp, error))
+			return FALSE;
+	}
+
 	/* header size calculation */
-	hdr_sz = st->buf->len;
+	hdr_sz = st.buf->len;
 	if (!fu_size_checked_inc(&hdr_sz, helper->rsvd_block, error)) {
 		g_prefix_error_literal(error, "CFDATA header size overflow: ");
 		return FALSE;
@@ -232,53 +376,52 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 		g_prefix_error_literal(error, "failed to cut cabinet checksum: ");
 		return FALSE;
 	}
-	if ((helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
-		guint32 checksum = fu_struct_cab_data_get_checksum(st);
-		if (checksum != 0) {
-			guint32 checksum_actual = 0;
-			g_autoptr(GByteArray) hdr = g_byte_array_new();
+	if ((helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0)
+		checksum = fu_struct_cab_data_get_checksum(&st);
 
+	/* the compressed data is copied so it can be verified and inflated without the lock */
+	if (folder_helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+		bytes_comp = fu_input_stream_read_bytes(helper->stream,
+							payload_offset,
+							blob_comp,
+							NULL,
+							error);
+		if (bytes_comp == NULL)
+			return FALSE;
+		g_clear_pointer(&locker, g_mutex_locker_free);
+	}
+	if (checksum != 0) {
+		guint32 checksum_actual = 0;
+		if (bytes_comp != NULL) {
+			if (!fu_cab_firmware_compute_checksum(g_bytes_get_data(bytes_comp, NULL),
+							      g_bytes_get_size(bytes_comp),
+							      &checksum_actual,
+							      error))
+				return FALSE;
+		} else {
 			if (!fu_input_stream_chunkify(partial_stream,
 						      fu_cab_firmware_compute_checksum_stream_cb,
 						      &checksum_actual,
 						      error))
 				return FALSE;
-			fu_byte_array_append_uint16(hdr, blob_comp, G_LITTLE_ENDIAN);
-			fu_byte_array_append_uint16(hdr, blob_uncomp, G_LITTLE_ENDIAN);
-			if (!fu_cab_firmware_compute_checksum(hdr->data,
-							      hdr->len,
-							      &checksum_actual,
-							      error))
-				return FALSE;
-			if (checksum_actual != checksum) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "invalid checksum at 0x%x, expected 0x%x, got 0x%x",
-					    (guint)*offset,
-					    checksum,
-					    checksum_actual);
-				return FALSE;
-			}
 		}
+		if (!fu_cab_firmware_verify_data_checksum(checksum,
+							  checksum_actual,
+							  blob_comp,
+							  blob_uncomp,
+							  *offset,
+							  error))
+			return FALSE;
 	}
 
 	/* decompress Zlib data after removing *another *header... */
-	if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+	if (folder_helper->compression == FU_CAB_COMPRESSION_MSZIP) {
 		int zret;
 		g_autofree gchar *kind = NULL;
 		g_autoptr(GByteArray) buf = g_byte_array_new();
-		g_autoptr(GBytes) bytes_comp = NULL;
 		g_autoptr(GBytes) bytes_uncomp = NULL;
 
 		/* check compressed header */
-		bytes_comp = fu_input_stream_read_bytes(helper->stream,
-							payload_offset,
-							blob_comp,
-							NULL,
-							error);
-		if (bytes_comp == NULL)
-			return FALSE;
 		kind = fu_memstrsafe(g_bytes_get_data(bytes_comp, NULL),
 				     g_bytes_get_size(bytes_comp),
 				     0x0,
@@ -294,7 +437,7 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 				    kind);
 			return FALSE;
 		}
-		if (helper->decompress_buf == NULL) {
+		if (folder_helper->decompress_buf == NULL) {
 			/* sanity check decompress buffer size */
 			if (helper->decompress_bufsz == 0 ||
 			    helper->decompress_bufsz > 32 * FU_MB) {
@@ -305,17 +448,19 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 					    (guint)helper->decompress_bufsz);
 				return FALSE;
 			}
-			helper->decompress_buf = g_malloc0(helper->decompress_bufsz);
+			folder_helper->decompress_buf = g_malloc0(helper->decompress_bufsz);
 		}
-		helper->zstrm.avail_in = g_bytes_get_size(bytes_comp) - 2;
-		helper->zstrm.next_in = (z_const Bytef *)g_bytes_get_data(bytes_comp, NULL) + 2;
+		folder_helper->zstrm.avail_in = g_bytes_get_size(bytes_comp) - 2;
+		folder_helper->zstrm.next_in =
+		    (z_const Bytef *)g_bytes_get_data(bytes_comp, NULL) + 2;
 		while (1) {
-			helper->zstrm.avail_out = helper->decompress_bufsz;
-			helper->zstrm.next_out = helper->decompress_buf;
-			zret = inflate(&helper->zstrm, Z_BLOCK);
+			folder_helper->zstrm.avail_out = helper->decompress_bufsz;
+			folder_helper->zstrm.next_out = folder_helper->decompress_buf;
+			zret = inflate(&folder_helper->zstrm, Z_BLOCK);
 			g_byte_array_append(buf,
-					    helper->decompress_buf,
-					    helper->decompress_bufsz - helper->zstrm.avail_out);
+					    folder_helper->decompress_buf,
+					    helper->decompress_bufsz -
+						folder_helper->zstrm.avail_out);
 			if (buf->len > blob_uncomp) {
 				g_set_error(error,
 					    FWUPD_ERROR,
@@ -360,7 +505,7 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 			return FALSE;
 		}
 
-		zret = inflateReset(&helper->zstrm);
+		zret = inflateReset(&folder_helper->zstrm);
 		if (zret != Z_OK) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -380,7 +525,7 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 			return FALSE;
 		}
 
-		zret = inflateSetDictionary(&helper->zstrm, buf->data, buf->len);
+		zret = inflateSetDictionary(&folder_helper->zstrm, buf->data, buf->len);
 		if (zret != Z_OK) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -390,39 +535,41 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 			return FALSE;
 		}
 		bytes_uncomp = g_byte_array_free_to_bytes(g_steal_pointer(&buf));
-		if (!fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(folder_data),
-							 bytes_uncomp,
-							 error))
+		if (!fu_composite_input_stream_add_bytes(
+			FU_COMPOSITE_INPUT_STREAM(folder_helper->folder_data),
+			bytes_uncomp,
+			error))
 			return FALSE;
 	} else {
 		if (!fu_composite_input_stream_add_partial_stream(
-			FU_COMPOSITE_INPUT_STREAM(folder_data),
+			FU_COMPOSITE_INPUT_STREAM(folder_helper->folder_data),
 			FU_PARTIAL_INPUT_STREAM(partial_stream),
 			error))
 			return FALSE;
 	}
 
 	/* success */
+	if (!fu_size_checked_inc(&folder_helper->size_inflated, blob_uncomp, error))
+		return FALSE;
 	if (!fu_size_checked_inc(offset, blob_comp, error))
 		return FALSE;
 	return fu_size_checked_inc(offset, hdr_sz, error);
 }
 
-static gboolean
+static FuCabFirmwareFolderHelper *
 fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			     FuCabFirmwareParseHelper *helper,
-			     guint idx,
 			     gsize offset,
-			     FuInputStream *folder_data,
 			     GError **error)
 {
 	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_autoptr(FuStructCabFolder) st = NULL;
+	g_autoptr(FuCabFirmwareFolderHelper) folder_helper = fu_cab_firmware_folder_helper_new();
 
 	/* parse header */
 	st = fu_struct_cab_folder_parse_stream(helper->stream, offset, error);
 	if (st == NULL)
-		return FALSE;
+		return NULL;
 
 	/* sanity check */
 	if (fu_struct_cab_folder_get_ndatab(st) == 0) {
@@ -430,31 +577,69 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
 				    "no CFDATA blocks");
-		return FALSE;
+		return NULL;
 	}
-	helper->compression = fu_struct_cab_folder_get_compression(st);
-	if (helper->compression != FU_CAB_COMPRESSION_NONE)
+	folder_helper->compression = fu_struct_cab_folder_get_compression(st);
+	if (folder_helper->compression != FU_CAB_COMPRESSION_NONE)
 		priv->compressed = TRUE;
-	if (helper->compression != FU_CAB_COMPRESSION_NONE &&
-	    helper->compression != FU_CAB_COMPRESSION_MSZIP) {
+	if (folder_helper->compression != FU_CAB_COMPRESSION_NONE &&
+	    folder_helper->compression != FU_CAB_COMPRESSION_MSZIP) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NOT_SUPPORTED,
 			    "compression %s not supported",
-			    fu_cab_compression_to_string(helper->compression));
-		return FALSE;
+			    fu_cab_compression_to_string(folder_helper->compression));
+		return NULL;
 	}
 
+	/* zlib */
+	if (folder_helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+		int zret;
+		folder_helper->zstrm.zalloc = fu_cab_firmware_zalloc;
+		folder_helper->zstrm.zfree = fu_cab_firmware_zfree;
+		zret = inflateInit2(&folder_helper->zstrm, -MAX_WBITS);
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to initialize inflate: %s",
+				    zError(zret));
+			return NULL;
+		}
+	}
+
+	/* the CFDATA is parsed later */
+	folder_helper->helper = fu_cab_firmware_parse_helper_ref(helper);
+	folder_helper->offset = fu_struct_cab_folder_get_offset(st);
+	folder_helper->ndatab = fu_struct_cab_folder_get_ndatab(st);
+	folder_helper->folder_data = fu_composite_input_stream_new();
+	return g_steal_pointer(&folder_helper);
+}
+
+typedef gboolean (*FuCabFirmwareDataFunc)(FuCabFirmwareFolderHelper *folder_helper,
+					  gsize *offset,
+					  GError **error);
+
+static gboolean
+fu_cab_firmware_parse_folder_data(FuCabFirmwareFolderHelper *folder_helper, GError **error)
+{
+	FuCabFirmwareParseHelper *helper = folder_helper->helper;
+	FuCabFirmwareDataFunc func = fu_cab_firmware_parse_data;
+
+	/* the CFDATA blocks are inflated when the folder is first read */
+	if (helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_LAZY)
+		func = fu_cab_firmware_index_data;
+
 	/* parse CDATA, either using the stream offset or the per-spec FuStructCabFolder.ndatab */
 	if (helper->ndatabsz > 0) {
-		for (gsize off = fu_struct_cab_folder_get_offset(st); off < helper->ndatabsz;) {
-			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
+		for (gsize off = folder_helper->offset; off < helper->ndatabsz;) {
+			if (!func(folder_helper, &off, error))
 				return FALSE;
 		}
 	} else {
-		gsize off = fu_struct_cab_folder_get_offset(st);
-		for (guint16 i = 0; i < fu_struct_cab_folder_get_ndatab(st); i++) {
-			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
+		gsize off = folder_helper->offset;
+		for (guint16 i = 0; i < folder_helper->ndatab; i++) {
+			if (!func(folder_helper, &off, error))
 				return FALSE;
 		}
 	}
@@ -463,9 +648,104 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 	return TRUE;
 }
 
+static gboolean
+fu_cab_firmware_folder_helper_ensure_cb(FuInputStream *stream,
+					gsize size,
+					gpointer user_data,
+					GError **error)
+{
+	FuCabFirmwareFolderHelper *folder_helper = (FuCabFirmwareFolderHelper *)user_data;
+
+	/* the inflate state is unknown if a block failed */
+	if (folder_helper->error != NULL) {
+		g_propagate_error(error, g_error_copy(folder_helper->error));
+		return FALSE;
+	}
+
+	/* MSZIP blocks can only be inflated in order, so this always starts from the last block */
+	while (folder_helper->size_inflated < size) {
+		if (!fu_cab_firmware_parse_data(folder_helper,
+						&folder_helper->offset,
+						&folder_helper->error)) {
+			g_propagate_error(error, g_error_copy(folder_helper->error));
+			return FALSE;
+		}
+	}
+	g_debug("inflated 0x%x of 0x%x bytes",
+		(guint)folder_helper->size_inflated,
+		(guint)folder_helper->size);
+	return TRUE;
+}
+
+static void
+fu_cab_firmware_parse_folder_data_thread_cb(gpointer data, gpointer user_data)
+{
+	FuCabFirmwareFolderHelper *folder_helper = (FuCabFirmwareFolderHelper *)data;
+	if (!fu_cab_firmware_parse_folder_data(folder_helper, &folder_helper->error))
+		g_debug("failed to parse folder: %s", folder_helper->error->message);
+}
+
+/*
+ * MSZIP only carries the dictionary between the CFDATA blocks of the same CFFOLDER, so large
+ * multi-folder archives can have the checksums verified and the blocks inflated on a bounded pool
+ * of worker threads. Reading the archive stream and the shared size limit are protected by a mutex.
+ */
+static gboolean
+fu_cab_firmware_parse_folders_data(FuCabFirmwareParseHelper *helper,
+				   GPtrArray *folder_helpers,
+				   GError **error)
+{
+	guint threads_max = MIN(folder_helpers->len, g_get_num_processors());
+	GThreadPool *pool;
+
+	/* nothing to gain */
+	if (threads_max <= 1 || (helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_LAZY) > 0) {
+		for (guint i = 0; i < folder_helpers->len; i++) {
+			FuCabFirmwareFolderHelper *folder_helper =
+			    g_ptr_array_index(folder_helpers, i);
+			if (!fu_cab_firmware_parse_folder_data(folder_helper, error))
+				return FALSE;
+		}
+		return TRUE;
+	}
+
+	pool = g_thread_pool_new(fu_cab_firmware_parse_folder_data_thread_cb,
+				 NULL,
+				 (gint)threads_max,
+				 FALSE,
+				 error);
+	if (pool == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	for (guint i = 0; i < folder_helpers->len; i++) {
+		FuCabFirmwareFolderHelper *folder_helper = g_ptr_array_index(folder_helpers, i);
+		if (!g_thread_pool_push(pool, folder_helper, error)) {
+			g_thread_pool_free(pool, TRUE, TRUE);
+			fwupd_error_convert(error);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+	g_debug("parsed %u folders using %u threads", folder_helpers->len, threads_max);
+
+	/* report the first folder that failed */
+	for (guint i = 0; i < folder_helpers->len; i++) {
+		FuCabFirmwareFolderHelper *folder_helper = g_ptr_array_index(folder_helpers, i);
+		if (folder_helper->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&folder_helper->error));
+			return FALSE;
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_cab_firmware_parse_file(FuCabFirmware *self,
 			   FuCabFirmwareParseHelper *helper,
+			   GPtrArray *folders_data,
 			   gsize *offset,
 			   FuFirmwareParseFlags flags,
 			   GError **error)
@@ -474,23 +754,28 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 	guint16 date;
 	guint16 index;
 	guint16 time;
+	guint8 st_buf[FU_STRUCT_CAB_FILE_SIZE] = {0};
+	FuStructCabFile st = {0};
 	g_autoptr(FuCabImage) img = fu_cab_image_new();
-	g_autoptr(FuStructCabFile) st = NULL;
 	g_autoptr(GDateTime) created = NULL;
 	g_autoptr(FuInputStream) stream = NULL;
 	g_autoptr(GString) filename = g_string_new(NULL);
 	g_autoptr(GTimeZone) tz_utc = g_time_zone_new_utc();
 
 	/* parse header */
-	st = fu_struct_cab_file_parse_stream(helper->stream, *offset, error);
-	if (st == NULL)
+	if (!fu_struct_cab_file_parse_stream_view(&st,
+						  st_buf,
+						  sizeof(st_buf),
+						  helper->stream,
+						  *offset,
+						  error))
 		return FALSE;
-	fu_firmware_set_offset(FU_FIRMWARE(img), fu_struct_cab_file_get_uoffset(st));
-	fu_firmware_set_size(FU_FIRMWARE(img), fu_struct_cab_file_get_usize(st));
+	fu_firmware_set_offset(FU_FIRMWARE(img), fu_struct_cab_file_get_uoffset(&st));
+	fu_firmware_set_size(FU_FIRMWARE(img), fu_struct_cab_file_get_usize(&st));
 
 	/* sanity check */
-	index = fu_struct_cab_file_get_index(st);
-	if (index >= helper->folder_data->len) {
+	index = fu_struct_cab_file_get_index(&st);
+	if (index >= folders_data->len) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NOT_SUPPORTED,
@@ -498,7 +783,7 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 			    index);
 		return FALSE;
 	}
-	folder_data = g_ptr_array_index(helper->folder_data, index);
+	folder_data = g_ptr_array_index(folders_data, index);
 
 	/* parse filename */
 	if (!fu_size_checked_inc(offset, FU_STRUCT_CAB_FILE_SIZE, error))
@@ -542,8 +827,8 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 		fu_firmware_set_id(FU_FIRMWARE(img), filename->str);
 	}
 	stream = fu_partial_input_stream_new(folder_data,
-					     fu_struct_cab_file_get_uoffset(st),
-					     fu_struct_cab_file_get_usize(st),
+					     fu_struct_cab_file_get_uoffset(&st),
+					     fu_struct_cab_file_get_usize(&st),
 					     error);
 	if (stream == NULL) {
 		g_prefix_error_literal(error, "failed to cut cabinet image: ");
@@ -555,8 +840,8 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 		return FALSE;
 
 	/* set created date time */
-	date = fu_struct_cab_file_get_date(st);
-	time = fu_struct_cab_file_get_time(st);
+	date = fu_struct_cab_file_get_date(&st);
+	time = fu_struct_cab_file_get_time(&st);
 	created = g_date_time_new(tz_utc,
 				  1980 + ((date & 0xFE00) >> 9),
 				  (date & 0x01E0) >> 5,
@@ -577,29 +862,18 @@ fu_cab_firmware_validate(FuFirmware *firmware, FuInputStream *stream, gsize offs
 }
 
 static FuCabFirmwareParseHelper *
-fu_cab_firmware_parse_helper_new(FuInputStream *stream, FuFirmwareParseFlags flags, GError **error)
+fu_cab_firmware_parse_helper_new(FuCabFirmware *self,
+				 FuInputStream *stream,
+				 FuFirmwareParseFlags flags)
 {
-	int zret;
-	g_autoptr(FuCabFirmwareParseHelper) helper = g_new0(FuCabFirmwareParseHelper, 1);
-
-	/* zlib */
-	helper->zstrm.zalloc = fu_cab_firmware_zalloc;
-	helper->zstrm.zfree = fu_cab_firmware_zfree;
-	zret = inflateInit2(&helper->zstrm, -MAX_WBITS);
-	if (zret != Z_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "failed to initialize inflate: %s",
-			    zError(zret));
-		return NULL;
-	}
-
+	FuCabFirmwareParseHelper *helper = g_new0(FuCabFirmwareParseHelper, 1);
+	g_ref_count_init(&helper->refcount);
+	g_mutex_init(&helper->mutex);
 	helper->stream = g_object_ref(stream);
 	helper->parse_flags = flags;
-	helper->folder_data = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	helper->size_max = fu_firmware_get_size_max(FU_FIRMWARE(self));
 	helper->decompress_bufsz = FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ;
-	return g_steal_pointer(&helper);
+	return helper;
 }
 
 static gboolean
@@ -614,6 +888,10 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 	gsize streamsz = 0;
 	g_autoptr(FuStructCabHeader) st = NULL;
 	g_autoptr(FuCabFirmwareParseHelper) helper = NULL;
+	g_autoptr(GPtrArray) folder_helpers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_cab_firmware_folder_helper_unref);
+	g_autoptr(GPtrArray) folders_data =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 
 	/* get size */
 	if (!fu_input_stream_size(stream, &streamsz, error))
@@ -677,9 +955,7 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 	}
 
 	/* create helper */
-	helper = fu_cab_firmware_parse_helper_new(stream, flags, error);
-	if (helper == NULL)
-		return FALSE;
+	helper = fu_cab_firmware_parse_helper_new(self, stream, flags);
 
 	/* if the only folder is >= 2GB then FuStructCabFolder.ndatab will overflow */
 	if (streamsz >= 0x8000 * 0xFFFF && fu_struct_cab_header_get_nr_folders(st) == 1)
@@ -729,9 +1005,34 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 
 	/* parse CFFOLDER */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_folders(st); i++) {
-		g_autoptr(FuInputStream) folder_data = fu_composite_input_stream_new();
-		if (!fu_cab_firmware_parse_folder(self, helper, i, offset, folder_data, error))
+		g_autoptr(FuCabFirmwareFolderHelper) folder_helper = NULL;
+		folder_helper = fu_cab_firmware_parse_folder(self, helper, offset, error);
+		if (folder_helper == NULL)
 			return FALSE;
+		g_ptr_array_add(folder_helpers, g_steal_pointer(&folder_helper));
+		if (!fu_size_checked_inc(&offset, FU_STRUCT_CAB_FOLDER_SIZE, error))
+			return FALSE;
+		if (!fu_size_checked_inc(&offset, helper->rsvd_folder, error))
+			return FALSE;
+	}
+
+	/* parse CFDATA for each CFFOLDER */
+	if (!fu_cab_firmware_parse_folders_data(helper, folder_helpers, error))
+		return FALSE;
+	for (guint i = 0; i < folder_helpers->len; i++) {
+		FuCabFirmwareFolderHelper *folder_helper = g_ptr_array_index(folder_helpers, i);
+		g_autoptr(FuInputStream) folder_data = NULL;
+
+		if (flags & FU_FIRMWARE_PARSE_FLAG_LAZY) {
+			folder_data = fu_lazy_input_stream_new(
+			    folder_helper->folder_data,
+			    folder_helper->size,
+			    fu_cab_firmware_folder_helper_ensure_cb,
+			    fu_cab_firmware_folder_helper_ref(folder_helper),
+			    (GDestroyNotify)fu_cab_firmware_folder_helper_unref);
+		} else {
+			folder_data = g_object_ref(folder_helper->folder_data);
+		}
 		if (!fu_input_stream_size(folder_data, &streamsz, error))
 			return FALSE;
 		if (streamsz == 0) {
@@ -741,16 +1042,17 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 					    "no folder data");
 			return FALSE;
 		}
-		g_ptr_array_add(helper->folder_data, g_steal_pointer(&folder_data));
-		if (!fu_size_checked_inc(&offset, FU_STRUCT_CAB_FOLDER_SIZE, error))
-			return FALSE;
-		if (!fu_size_checked_inc(&offset, helper->rsvd_folder, error))
-			return FALSE;
+		g_ptr_array_add(folders_data, g_steal_pointer(&folder_data));
 	}
 
 	/* parse CFFILEs */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_files(st); i++) {
-		if (!fu_cab_firmware_parse_file(self, helper, &off_cffile, flags, error))
+		if (!fu_cab_firmware_parse_file(self,
+						helper,
+						folders_data,
+						&off_cffile,
+						flags,
+						error))
 			return FALSE;
 	}
 
@@ -1,7 +1,7 @@
 // Copyright 2023 Richard Hughes <richard@hughsie.com>
 // SPDX-License-Identifier: LGPL-2.1-or-later
 
-#[derive(ParseStream, New)]
+#[derive(ParseStreamView, New)]
 #[repr(C, packed)]
 struct FuStructCabData {
     checksum: u32le,
@@ -29,7 +29,7 @@ enum FuCabFileAttribute {
     NameUtf8 = 0x80,
 }
 
-#[derive(ParseStream, New)]
+#[derive(ParseStreamView, New)]
 #[repr(C, packed)]
 struct FuStructCabFile {
     usize: u32le, // uncompressed
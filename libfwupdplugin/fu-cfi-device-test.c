@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+#include "fu-device-private.h"
+#include "fu-self-test-cfi-device.h"
+
+static FuSelfTestCfiDevice *
+fu_cfi_device_test_new(FuContext *ctx, GBytes *blob)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FuSelfTestCfiDevice) self = fu_self_test_cfi_device_new(ctx, blob);
+
+	fu_cfi_device_set_page_size(FU_CFI_DEVICE(self), 0x100);
+	fu_cfi_device_set_sector_size(FU_CFI_DEVICE(self), 0x1000);
+	fu_cfi_device_set_block_size(FU_CFI_DEVICE(self), 0x8000);
+	ret = fu_device_set_quirk_kv(FU_DEVICE(self),
+				     "CfiDeviceCmdBlockErase",
+				     "0xD8",
+				     FU_CONTEXT_QUIRK_SOURCE_DB,
+				     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return g_steal_pointer(&self);
+}
+
+static void
+fu_cfi_device_write_func(FuSelfTestCfiDevice *self, GBytes *blob)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new_from_bytes(blob);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob_new = NULL;
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_device_write_firmware(FU_DEVICE(self),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_progress_get_percentage(progress), ==, 100);
+	blob_new = fu_self_test_cfi_device_get_contents(self);
+	ret = fu_bytes_compare(blob_new, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_cfi_device_differential_func(void)
+{
+	gsize bufsz = 0x10000;
+	g_autofree guint8 *buf_old = g_malloc0(bufsz);
+	g_autofree guint8 *buf_new = g_malloc0(bufsz);
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuSelfTestCfiDevice) device_full = NULL;
+	g_autoptr(FuSelfTestCfiDevice) device_diff = NULL;
+	g_autoptr(GBytes) blob_old = NULL;
+	g_autoptr(GBytes) blob_new = NULL;
+
+	/* the new image needs one sector erasing, only clears bits in another and then erases an
+	 * entire block */
+	for (gsize i = 0; i < bufsz; i++)
+		buf_old[i] = (guint8)(i * 13 + (i >> 8));
+	for (gsize i = 0; i < bufsz; i++)
+		buf_new[i] = i >= 0x8000 ? 0xFF : buf_old[i];
+	buf_new[0x3010] = buf_old[0x3010] ^ 0xFF;
+	buf_new[0x5020] = buf_old[0x5020] & 0x0F;
+	blob_old = g_bytes_new(buf_old, bufsz);
+	blob_new = g_bytes_new(buf_new, bufsz);
+
+	/* erase everything, then write and verify every page */
+	device_full = fu_cfi_device_test_new(ctx, blob_old);
+	fu_cfi_device_write_func(device_full, blob_new);
+	g_debug("full: erase=%u, page-prog=%u, read=0x%x",
+		fu_self_test_cfi_device_get_erase_cnt(device_full),
+		fu_self_test_cfi_device_get_page_prog_cnt(device_full),
+		(guint)fu_self_test_cfi_device_get_read_size(device_full));
+	g_assert_cmpint(fu_self_test_cfi_device_get_erase_cnt(device_full), ==, 1);
+	g_assert_cmpint(fu_self_test_cfi_device_get_page_prog_cnt(device_full), ==, 0x100);
+
+	/* only the sectors that changed */
+	device_diff = fu_cfi_device_test_new(ctx, blob_old);
+	fu_device_add_private_flag(FU_DEVICE(device_diff), FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE);
+	fu_cfi_device_write_func(device_diff, blob_new);
+	g_debug("differential: erase=%u, page-prog=%u, read=0x%x",
+		fu_self_test_cfi_device_get_erase_cnt(device_diff),
+		fu_self_test_cfi_device_get_page_prog_cnt(device_diff),
+		(guint)fu_self_test_cfi_device_get_read_size(device_diff));
+	g_assert_cmpint(fu_self_test_cfi_device_get_erase_cnt(device_diff), ==, 2);
+	g_assert_cmpint(fu_self_test_cfi_device_get_page_prog_cnt(device_diff), ==, 0x11);
+	g_assert_cmpint(fu_self_test_cfi_device_get_read_size(device_diff), ==, 0x1A000);
+
+	/* nothing to do */
+	fu_cfi_device_write_func(device_diff, blob_new);
+	g_assert_cmpint(fu_self_test_cfi_device_get_erase_cnt(device_diff), ==, 2);
+	g_assert_cmpint(fu_self_test_cfi_device_get_page_prog_cnt(device_diff), ==, 0x11);
+}
+
+int
+main(int argc, char **argv)
+{
+	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/cfi-device/differential", fu_cfi_device_differential_func);
+	return g_test_run();
+}
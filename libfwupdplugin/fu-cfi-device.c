@@ -30,6 +30,9 @@
  * * `SectorSize`: 0x1000
  * * `BlockSize`: 0x10000
  *
+ * If the `differential-write` flag is set then only the sectors that differ from the current
+ * contents are erased, written and verified, rather than erasing the entire chip.
+ *
  * See also: [class@FuDevice]
  */
 
@@ -51,6 +54,12 @@ enum { PROP_0, PROP_FLASH_ID, PROP_LAST };
 #define FU_CFI_DEVICE_SECTOR_SIZE_DEFAULT 0x1000
 #define FU_CFI_DEVICE_BLOCK_SIZE_DEFAULT  0x10000
 
+typedef enum {
+	FU_CFI_DEVICE_SECTOR_STATE_UNCHANGED,
+	FU_CFI_DEVICE_SECTOR_STATE_PROGRAM, /* only clears bits, so no erase required */
+	FU_CFI_DEVICE_SECTOR_STATE_ERASE,
+} FuCfiDeviceSectorState;
+
 /**
  * fu_cfi_device_get_size:
  * @self: a #FuCfiDevice
@@ -725,6 +734,35 @@ fu_cfi_device_chip_erase(FuCfiDevice *self, GError **error)
 	return fu_cfi_device_wait_for_status(self, 0b1, 0b0, 100, 500, error);
 }
 
+static gboolean
+fu_cfi_device_erase_address(FuCfiDevice *self, FuCfiDeviceCmd cmd, guint32 addr, GError **error)
+{
+	guint8 buf[4] = {0x0}; /* cmd, then 24 bit starting address */
+	g_autoptr(FuDeviceLocker) cslocker = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	if (!fu_cfi_device_get_cmd(self, cmd, &buf[0], error))
+		return FALSE;
+	if (!fu_cfi_device_write_enable(self, error))
+		return FALSE;
+
+	/* enable chip */
+	cslocker = fu_cfi_device_chip_select_locker_new(self, error);
+	if (cslocker == NULL)
+		return FALSE;
+
+	/* erase */
+	fu_memwrite_uint24(buf + 0x1, addr, G_BIG_ENDIAN);
+	g_debug("erasing %s at 0x%x", fu_cfi_device_cmd_to_string(cmd), addr);
+	if (!fu_cfi_device_send_command(self, buf, sizeof(buf), NULL, 0, progress, error))
+		return FALSE;
+	if (!fu_device_locker_close(cslocker, error))
+		return FALSE;
+
+	/* poll Read Status register BUSY */
+	return fu_cfi_device_wait_for_status(self, 0b1, 0b0, 100, 100, error);
+}
+
 static gboolean
 fu_cfi_device_write_page(FuCfiDevice *self, FuChunk *page, FuProgress *progress, GError **error)
 {
@@ -803,7 +841,11 @@ fu_cfi_device_read_block(FuCfiDevice *self, FuChunk *block, FuProgress *progress
 }
 
 static GBytes *
-fu_cfi_device_read_firmware(FuCfiDevice *self, gsize bufsz, FuProgress *progress, GError **error)
+fu_cfi_device_read_region(FuCfiDevice *self,
+			  guint32 addr,
+			  gsize bufsz,
+			  FuProgress *progress,
+			  GError **error)
 {
 	g_autoptr(GByteArray) buf = g_byte_array_new();
 	g_autoptr(GPtrArray) pages = NULL;
@@ -812,7 +854,7 @@ fu_cfi_device_read_firmware(FuCfiDevice *self, gsize bufsz, FuProgress *progress
 	fu_byte_array_set_size(buf, bufsz, 0x0);
 	pages = fu_chunk_array_mutable_new(buf->data,
 					   buf->len,
-					   0x0,
+					   addr,
 					   0x0,
 					   fu_cfi_device_get_block_size(self),
 					   error);
@@ -831,6 +873,12 @@ fu_cfi_device_read_firmware(FuCfiDevice *self, gsize bufsz, FuProgress *progress
 	return g_bytes_new(buf->data, buf->len);
 }
 
+static GBytes *
+fu_cfi_device_read_firmware(FuCfiDevice *self, gsize bufsz, FuProgress *progress, GError **error)
+{
+	return fu_cfi_device_read_region(self, 0x0, bufsz, progress, error);
+}
+
 static GBytes *
 fu_cfi_device_dump_firmware(FuDevice *device, FuProgress *progress, GError **error)
 {
@@ -854,6 +902,282 @@ fu_cfi_device_dump_firmware(FuDevice *device, FuProgress *progress, GError **err
 	return fu_cfi_device_read_firmware(self, bufsz, progress, error);
 }
 
+static FuCfiDeviceSectorState
+fu_cfi_device_get_sector_state(const guint8 *buf_old, const guint8 *buf_new, gsize bufsz)
+{
+	if (memcmp(buf_old, buf_new, bufsz) == 0)
+		return FU_CFI_DEVICE_SECTOR_STATE_UNCHANGED;
+	for (gsize i = 0; i < bufsz; i++) {
+		if ((buf_old[i] & buf_new[i]) != buf_new[i])
+			return FU_CFI_DEVICE_SECTOR_STATE_ERASE;
+	}
+	return FU_CFI_DEVICE_SECTOR_STATE_PROGRAM;
+}
+
+static gboolean
+fu_cfi_device_erase_sectors(FuCfiDevice *self,
+			    FuCfiDeviceSectorState *states,
+			    guint states_sz,
+			    gsize bufsz,
+			    FuProgress *progress,
+			    GError **error)
+{
+	FuCfiDevicePrivate *priv = GET_PRIVATE(self);
+	guint sectors_per_block = priv->block_size / priv->sector_size;
+	gboolean has_block_erase;
+
+	/* optional */
+	has_block_erase = fu_cfi_device_get_cmd(self, FU_CFI_DEVICE_CMD_BLOCK_ERASE, NULL, NULL);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, states_sz);
+	for (guint i = 0; i < states_sz; i++) {
+		guint32 addr = i * priv->sector_size;
+
+		if (states[i] != FU_CFI_DEVICE_SECTOR_STATE_ERASE) {
+			fu_progress_step_done(progress);
+			continue;
+		}
+
+		/* use one block erase if every sector in the image block needs erasing */
+		if (has_block_erase && sectors_per_block > 1 && addr % priv->block_size == 0 &&
+		    addr + priv->block_size <= bufsz) {
+			gboolean erase_block = TRUE;
+			for (guint j = i; j < i + sectors_per_block; j++) {
+				if (states[j] != FU_CFI_DEVICE_SECTOR_STATE_ERASE) {
+					erase_block = FALSE;
+					break;
+				}
+			}
+			if (erase_block) {
+				if (!fu_cfi_device_erase_address(self,
+								 FU_CFI_DEVICE_CMD_BLOCK_ERASE,
+								 addr,
+								 error))
+					return FALSE;
+				for (guint j = 0; j < sectors_per_block; j++)
+					fu_progress_step_done(progress);
+				i += sectors_per_block - 1;
+				continue;
+			}
+		}
+		if (!fu_cfi_device_erase_address(self, FU_CFI_DEVICE_CMD_SECTOR_ERASE, addr, error))
+			return FALSE;
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_cfi_device_write_changed_pages(FuCfiDevice *self,
+				  FuCfiDeviceSectorState *states,
+				  GBytes *fw_old,
+				  FuChunkArray *pages,
+				  FuProgress *progress,
+				  GError **error)
+{
+	FuCfiDevicePrivate *priv = GET_PRIVATE(self);
+	guint cnt = 0;
+	const guint8 *buf_old = g_bytes_get_data(fw_old, NULL);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, fu_chunk_array_length(pages));
+	for (guint i = 0; i < fu_chunk_array_length(pages); i++) {
+		FuCfiDeviceSectorState state;
+		g_autoptr(FuChunk) page = NULL;
+		g_autoptr(GBytes) blob = NULL;
+
+		/* prepare chunk */
+		page = fu_chunk_array_index(pages, i, error);
+		if (page == NULL)
+			return FALSE;
+		state = states[fu_chunk_get_address(page) / priv->sector_size];
+		if (state == FU_CFI_DEVICE_SECTOR_STATE_UNCHANGED) {
+			fu_progress_step_done(progress);
+			continue;
+		}
+
+		/* already the erased value, or already identical */
+		blob = fu_chunk_get_bytes(page);
+		if (state == FU_CFI_DEVICE_SECTOR_STATE_ERASE && fu_bytes_is_empty(blob)) {
+			fu_progress_step_done(progress);
+			continue;
+		}
+		if (state == FU_CFI_DEVICE_SECTOR_STATE_PROGRAM &&
+		    memcmp(buf_old + fu_chunk_get_address(page),
+			   fu_chunk_get_data(page),
+			   fu_chunk_get_data_sz(page)) == 0) {
+			fu_progress_step_done(progress);
+			continue;
+		}
+		if (!fu_cfi_device_write_page(self, page, fu_progress_get_child(progress), error))
+			return FALSE;
+		fu_progress_step_done(progress);
+		cnt++;
+	}
+	g_debug("wrote %u of %u pages", cnt, fu_chunk_array_length(pages));
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_cfi_device_verify_changed_sectors(FuCfiDevice *self,
+				     FuCfiDeviceSectorState *states,
+				     guint states_sz,
+				     GBytes *fw,
+				     FuProgress *progress,
+				     GError **error)
+{
+	FuCfiDevicePrivate *priv = GET_PRIVATE(self);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, states_sz);
+	for (guint i = 0; i < states_sz; i++) {
+		guint j;
+		gsize addr = (gsize)i * priv->sector_size;
+		gsize runsz;
+		g_autoptr(GBytes) fw_run = NULL;
+		g_autoptr(GBytes) fw_verify = NULL;
+
+		if (states[i] == FU_CFI_DEVICE_SECTOR_STATE_UNCHANGED) {
+			fu_progress_step_done(progress);
+			continue;
+		}
+
+		/* read consecutive changed sectors at once */
+		for (j = i + 1; j < states_sz; j++) {
+			if (states[j] == FU_CFI_DEVICE_SECTOR_STATE_UNCHANGED)
+				break;
+		}
+		runsz = MIN((gsize)j * priv->sector_size, g_bytes_get_size(fw)) - addr;
+		fw_run = fu_bytes_new_offset(fw, addr, runsz, error);
+		if (fw_run == NULL)
+			return FALSE;
+		fw_verify = fu_cfi_device_read_region(self,
+						      addr,
+						      runsz,
+						      fu_progress_get_child(progress),
+						      error);
+		if (fw_verify == NULL)
+			return FALSE;
+		if (!fu_bytes_compare(fw_verify, fw_run, error)) {
+			g_prefix_error(error, "verify failed at 0x%x: ", (guint)addr);
+			return FALSE;
+		}
+		for (guint k = i; k < j; k++)
+			fu_progress_step_done(progress);
+		i = j - 1;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_cfi_device_write_firmware_differential(FuCfiDevice *self,
+					  GBytes *fw,
+					  FuProgress *progress,
+					  GError **error)
+{
+	FuCfiDevicePrivate *priv = GET_PRIVATE(self);
+	gsize bufsz = g_bytes_get_size(fw);
+	guint states_sz;
+	const guint8 *buf = g_bytes_get_data(fw, NULL);
+	const guint8 *buf_old;
+	g_autofree FuCfiDeviceSectorState *states = NULL;
+	g_autoptr(FuChunkArray) pages = NULL;
+	g_autoptr(GBytes) fw_old = NULL;
+
+	/* sanity check */
+	if (priv->page_size == 0 || priv->sector_size == 0 ||
+	    priv->sector_size % priv->page_size != 0 || priv->block_size % priv->sector_size != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "invalid page size 0x%x, sector size 0x%x and block size 0x%x",
+			    priv->page_size,
+			    priv->sector_size,
+			    priv->block_size);
+		return FALSE;
+	}
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_READ, 25, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_ERASE, 10, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 60, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_VERIFY, 5, NULL);
+
+	/* compare each sector with the current contents */
+	fw_old = fu_cfi_device_read_firmware(self, bufsz, fu_progress_get_child(progress), error);
+	if (fw_old == NULL) {
+		g_prefix_error_literal(error, "failed to read existing contents: ");
+		return FALSE;
+	}
+	buf_old = g_bytes_get_data(fw_old, NULL);
+	states_sz = (bufsz + priv->sector_size - 1) / priv->sector_size;
+	states = g_new0(FuCfiDeviceSectorState, states_sz);
+	for (guint i = 0; i < states_sz; i++) {
+		gsize offset = (gsize)i * priv->sector_size;
+		states[i] = fu_cfi_device_get_sector_state(buf_old + offset,
+							   buf + offset,
+							   MIN(priv->sector_size, bufsz - offset));
+	}
+	fu_progress_step_done(progress);
+
+	/* erase */
+	if (!fu_cfi_device_erase_sectors(self,
+					 states,
+					 states_sz,
+					 bufsz,
+					 fu_progress_get_child(progress),
+					 error)) {
+		g_prefix_error_literal(error, "failed to erase: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* write each changed page */
+	pages = fu_chunk_array_new_from_bytes(fw,
+					      FU_CHUNK_ADDR_OFFSET_NONE,
+					      FU_CHUNK_PAGESZ_NONE,
+					      priv->page_size,
+					      error);
+	if (pages == NULL)
+		return FALSE;
+	if (!fu_cfi_device_write_changed_pages(self,
+					       states,
+					       fw_old,
+					       pages,
+					       fu_progress_get_child(progress),
+					       error)) {
+		g_prefix_error_literal(error, "failed to write pages: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* verify each changed sector */
+	if (!fu_cfi_device_verify_changed_sectors(self,
+						  states,
+						  states_sz,
+						  fw,
+						  fu_progress_get_child(progress),
+						  error)) {
+		g_prefix_error_literal(error, "failed to verify blocks: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* success! */
+	return TRUE;
+}
+
 static gboolean
 fu_cfi_device_write_firmware(FuDevice *device,
 			     FuFirmware *firmware,
@@ -872,17 +1196,21 @@ fu_cfi_device_write_firmware(FuDevice *device,
 	if (locker == NULL)
 		return FALSE;
 
+	/* get default image */
+	fw = fu_firmware_get_bytes(firmware, error);
+	if (fw == NULL)
+		return FALSE;
+
+	/* only erase and write what changed */
+	if (fu_device_has_private_flag(device, FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE))
+		return fu_cfi_device_write_firmware_differential(self, fw, progress, error);
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_ERASE, 10, NULL);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 85, NULL);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_VERIFY, 5, NULL);
 
-	/* get default image */
-	fw = fu_firmware_get_bytes(firmware, error);
-	if (fw == NULL)
-		return FALSE;
-
 	/* erase */
 	if (!fu_cfi_device_write_enable(self, error)) {
 		g_prefix_error_literal(error, "failed to enable writes: ");
@@ -992,6 +1320,7 @@ fu_cfi_device_class_init(FuCfiDeviceClass *klass)
 	device_class->write_firmware = fu_cfi_device_write_firmware;
 	device_class->dump_firmware = fu_cfi_device_dump_firmware;
 	device_class->set_progress = fu_cfi_device_set_progress;
+	fu_device_register_private_flag(device_class, FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE);
 
 	/**
 	 * FuCfiDevice:flash-id:
@@ -25,6 +25,13 @@ struct _FuCfiDeviceClass {
 	gboolean (*read_jedec)(FuCfiDevice *self, GError **error);
 };
 
+/**
+ * FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE:
+ *
+ * Only erase, write and verify the sectors that differ from the existing flash contents.
+ */
+#define FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE "differential-write"
+
 FuCfiDevice *
 fu_cfi_device_new(FuDevice *proxy, const gchar *flash_id) G_GNUC_NON_NULL(1);
 const gchar *
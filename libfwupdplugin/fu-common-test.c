@@ -192,6 +192,135 @@ fu_common_crc_func(void)
 	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32Q, buf, sizeof(buf)), ==, 0xE955C875);
 }
 
+/* bit-by-bit CRC-32/JAMCRC, which is CRC-32 without the final inversion */
+static guint32
+fu_common_crc32_jamcrc_bitwise(const guint8 *buf, gsize bufsz)
+{
+	guint32 crc = 0xFFFFFFFF;
+	for (gsize i = 0; i < bufsz; i++) {
+		crc ^= buf[i];
+		for (guint bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ ((crc & 0x1) ? 0xEDB88320 : 0x0);
+	}
+	return crc;
+}
+
+static void
+fu_common_crc_kinds_func(void)
+{
+	gboolean ret;
+	const guint8 buf[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	guint32 crc32 = 0xFFFFFFFF;
+	guint32 jamcrc;
+	const gsize splits[] = {0x1, 0x3F, 0x41, 0x3FFF, 0x40001, 0xFFFFF};
+	const FuCrcKind kinds_zlib[] = {FU_CRC_KIND_B32_JAMCRC, FU_CRC_KIND_B32_STANDARD};
+	gsize bigbufsz = 0x100003;
+	g_autofree guint8 *bigbuf = g_malloc0(bigbufsz);
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+	struct {
+		FuCrcKind kind;
+		guint32 check;
+	} map[] = {
+	    /* from https://reveng.sourceforge.io/crc-catalogue/ */
+	    {FU_CRC_KIND_B32_STANDARD, 0xCBF43926},
+	    {FU_CRC_KIND_B32_BZIP2, 0xFC891918},
+	    {FU_CRC_KIND_B32_JAMCRC, 0x340BC6D9},
+	    {FU_CRC_KIND_B32_MPEG2, 0x0376E6E7},
+	    {FU_CRC_KIND_B32_POSIX, 0x765E7680},
+	    {FU_CRC_KIND_B32_SATA, 0xCF72AFE8},
+	    {FU_CRC_KIND_B32_XFER, 0xBD0BE338},
+	    {FU_CRC_KIND_B32C, 0xE3069283},
+	    {FU_CRC_KIND_B32D, 0x87315576},
+	    {FU_CRC_KIND_B32Q, 0x3010BF7F},
+	    {FU_CRC_KIND_B16_XMODEM, 0x31C3},
+	    {FU_CRC_KIND_B16_KERMIT, 0x2189},
+	    {FU_CRC_KIND_B16_USB, 0xB4C8},
+	    {FU_CRC_KIND_B16_UMTS, 0xFEE8},
+	    {FU_CRC_KIND_B16_TMS37157, 0x26B1},
+	    {FU_CRC_KIND_B16_BNR, 0xAEE7},
+	    {FU_CRC_KIND_B8_WCDMA, 0x25},
+	    {FU_CRC_KIND_B8_TECH3250, 0x97},
+	    {FU_CRC_KIND_B8_STANDARD, 0xF4},
+	    {FU_CRC_KIND_B8_SAE_J1850, 0x4B},
+	    {FU_CRC_KIND_B8_ROHC, 0xD0},
+	    {FU_CRC_KIND_B8_OPENSAFETY, 0x3E},
+	    {FU_CRC_KIND_B8_NRSC5, 0xF7},
+	    {FU_CRC_KIND_B8_MIFARE_MAD, 0x99},
+	    {FU_CRC_KIND_B8_MAXIM_DOW, 0xA1},
+	    {FU_CRC_KIND_B8_LTE, 0xEA},
+	    {FU_CRC_KIND_B8_I_CODE, 0x7E},
+	    {FU_CRC_KIND_B8_ITU, 0xA1},
+	    {FU_CRC_KIND_B8_HITAG, 0xB4},
+	    {FU_CRC_KIND_B8_GSM_B, 0x94},
+	    {FU_CRC_KIND_B8_GSM_A, 0x37},
+	    {FU_CRC_KIND_B8_DVB_S2, 0xBC},
+	    {FU_CRC_KIND_B8_DARC, 0x15},
+	    {FU_CRC_KIND_B8_CDMA2000, 0xDA},
+	    {FU_CRC_KIND_B8_BLUETOOTH, 0x26},
+	    {FU_CRC_KIND_B8_AUTOSAR, 0xDF},
+	};
+
+	/* check value for every kind */
+	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
+		guint32 crc = 0;
+		if (fu_crc_size(map[i].kind) == 32)
+			crc = fu_crc32(map[i].kind, buf, sizeof(buf));
+		else if (fu_crc_size(map[i].kind) == 16)
+			crc = fu_crc16(map[i].kind, buf, sizeof(buf));
+		else
+			crc = fu_crc8(map[i].kind, buf, sizeof(buf));
+		g_assert_cmpint(crc, ==, map[i].check);
+	}
+
+	/* chained over chunks of the stream */
+	for (gsize i = 0; i < bigbufsz; i++)
+		bigbuf[i] = (guint8)(i * 7);
+	stream = fu_memory_input_stream_new_from_data(bigbuf, bigbufsz, NULL);
+	ret = fu_input_stream_compute_crc32(stream, FU_CRC_KIND_B32_MPEG2, &crc32, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(crc32, ==, fu_crc32(FU_CRC_KIND_B32_MPEG2, bigbuf, bigbufsz));
+
+	/* the reflected 0x04C11DB7 kinds use zlib for large chunks and the tables for small ones,
+	 * so chain both at odd offsets and compare against the bit-by-bit value */
+	jamcrc = fu_common_crc32_jamcrc_bitwise(bigbuf, bigbufsz);
+	for (guint j = 0; j < G_N_ELEMENTS(kinds_zlib); j++) {
+		FuCrcKind kind = kinds_zlib[j];
+		guint32 crc_expected = kind == FU_CRC_KIND_B32_JAMCRC ? jamcrc : ~jamcrc;
+		guint32 crc = 0xFFFFFFFF;
+
+		/* only the sliced tables */
+		for (gsize i = 0; i < bigbufsz; i += 0x3F)
+			crc = fu_crc32_step(kind, bigbuf + i, MIN(0x3F, bigbufsz - i), crc);
+		g_assert_cmpint(fu_crc32_done(kind, crc), ==, crc_expected);
+
+		/* zlib for at least one of the chunks */
+		for (guint i = 0; i < G_N_ELEMENTS(splits); i++) {
+			crc = 0xFFFFFFFF;
+			crc = fu_crc32_step(kind, bigbuf, splits[i], crc);
+			crc = fu_crc32_step(kind, bigbuf + splits[i], bigbufsz - splits[i], crc);
+			g_assert_cmpint(fu_crc32_done(kind, crc), ==, crc_expected);
+		}
+	}
+	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32_JAMCRC, bigbuf, bigbufsz), ==, jamcrc);
+	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32_STANDARD, bigbuf, bigbufsz), ==, ~jamcrc);
+
+	/* throughput */
+	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
+		g_autoptr(GTimer) timer = g_timer_new();
+		if (fu_crc_size(map[i].kind) == 32)
+			(void)fu_crc32(map[i].kind, bigbuf, bigbufsz);
+		else if (fu_crc_size(map[i].kind) == 16)
+			(void)fu_crc16(map[i].kind, bigbuf, bigbufsz);
+		else
+			(void)fu_crc8(map[i].kind, bigbuf, bigbufsz);
+		g_debug("%s: %.0f MB/s",
+			fu_crc_kind_to_string(map[i].kind),
+			(bigbufsz / (1024.f * 1024.f)) / g_timer_elapsed(timer, NULL));
+	}
+}
+
 static void
 fu_common_guid_func(void)
 {
@@ -306,6 +435,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/common/align-up", fu_common_align_up_func);
 	g_test_add_func("/fwupd/common/bitwise", fu_common_bitwise_func);
 	g_test_add_func("/fwupd/common/crc", fu_common_crc_func);
+	g_test_add_func("/fwupd/common/crc/kinds", fu_common_crc_kinds_func);
 	g_test_add_func("/fwupd/common/guid", fu_common_guid_func);
 	g_test_add_func("/fwupd/common/olson-timezone-id", fu_common_olson_timezone_id_func);
 	g_test_add_func("/fwupd/common/random", fu_common_random_func);
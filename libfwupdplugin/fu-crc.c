@@ -14,6 +14,9 @@
 #include "fu-crc-private.h"
 #include "fu-mem-private.h"
 
+/* converting the register is not free, so only use zlib for larger buffers */
+#define FU_CRC_ZLIB_MIN_SIZE 64
+
 static const struct {
 	FuCrcKind kind;
 	guint bitwidth;
@@ -85,6 +88,76 @@ fu_crc_reflect(guint32 data, guint bitwidth)
 	return val;
 }
 
+/* the register is kept left-aligned in 32 bits so all the bit widths can share the tables */
+static const guint32 *
+fu_crc_get_table(FuCrcKind kind)
+{
+	static gsize tables[FU_CRC_KIND_LAST] = {0};
+
+	if (g_once_init_enter(&tables[kind])) {
+		guint32 poly = crc_map[kind].poly << (32 - crc_map[kind].bitwidth);
+		guint32 *table = g_new(guint32, 8 * 256);
+
+		for (guint i = 0; i < 256; i++) {
+			guint32 crc = (guint32)i << 24;
+			for (guint8 bit = 0; bit < 8; bit++) {
+				if (FU_BIT_IS_SET(crc, 31)) {
+					crc = (crc << 1) ^ poly;
+				} else {
+					crc = (crc << 1);
+				}
+			}
+			table[i] = crc;
+		}
+
+		/* each slice is the previous one followed by an extra zero byte */
+		for (guint j = 1; j < 8; j++) {
+			for (guint i = 0; i < 256; i++) {
+				guint32 crc = table[((j - 1) * 256) + i];
+				table[(j * 256) + i] = (crc << 8) ^ table[crc >> 24];
+			}
+		}
+		g_once_init_leave(&tables[kind], (gsize)table);
+	}
+	return (const guint32 *)tables[kind];
+}
+
+/* a lookup table to optionally reflect each input byte */
+static const guint8 *
+fu_crc_get_input_table(FuCrcKind kind)
+{
+	static gsize tables[2] = {0};
+	guint idx = crc_map[kind].reflected ? 1 : 0;
+
+	if (g_once_init_enter(&tables[idx])) {
+		guint8 *table = g_new(guint8, 256);
+		for (guint i = 0; i < 256; i++)
+			table[i] = idx == 1 ? fu_crc_reflect8(i) : i;
+		g_once_init_leave(&tables[idx], (gsize)table);
+	}
+	return (const guint8 *)tables[idx];
+}
+
+/* slice-by-8, processing 8 bytes of input for every iteration */
+static guint32
+fu_crc_step_sliced(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	const guint32 *t = fu_crc_get_table(kind);
+	const guint8 *in = fu_crc_get_input_table(kind);
+
+	for (; bufsz >= 8; buf += 8, bufsz -= 8) {
+		crc ^= ((guint32)in[buf[0]] << 24) | ((guint32)in[buf[1]] << 16) | /* nocheck:endian */
+		       ((guint32)in[buf[2]] << 8) | (guint32)in[buf[3]];
+		crc = t[(7 * 256) + (crc >> 24)] ^ t[(6 * 256) + (guint8)(crc >> 16)] ^
+		      t[(5 * 256) + (guint8)(crc >> 8)] ^ t[(4 * 256) + (guint8)crc] ^
+		      t[(3 * 256) + in[buf[4]]] ^ t[(2 * 256) + in[buf[5]]] ^
+		      t[(1 * 256) + in[buf[6]]] ^ t[in[buf[7]]];
+	}
+	for (gsize i = 0; i < bufsz; i++)
+		crc = (crc << 8) ^ t[(crc >> 24) ^ in[buf[i]]];
+	return crc;
+}
+
 /**
  * fu_crc_size:
  * @kind: a #FuCrcKind
@@ -120,22 +193,9 @@ fu_crc_size(FuCrcKind kind)
 guint8
 fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 8, 0x0);
-
-	for (gsize i = 0; i < bufsz; ++i) {
-		crc ^= crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
-	}
-	return crc;
+	return fu_crc_step_sliced(kind, buf, bufsz, (guint32)crc << 24) >> 24;
 }
 
 /**
@@ -256,23 +316,9 @@ fu_crc8_bytes(FuCrcKind kind, GBytes *blob)
 guint16
 fu_crc16_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint16 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 16, 0x0);
-
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint16 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
-	}
-	return crc;
+	return fu_crc_step_sliced(kind, buf, bufsz, (guint32)crc << 16) >> 16;
 }
 
 /**
@@ -393,23 +439,18 @@ fu_crc16_bytes(FuCrcKind kind, GBytes *blob)
 guint32
 fu_crc32_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 32, 0x0);
 
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint32 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
+	/* the system zlib is at least as fast as the tables, and builds such as zlib-ng also use
+	 * carry-less multiplication -- but the register is reflected and inverted compared to ours */
+	if (crc_map[kind].reflected && crc_map[kind].poly == 0x04C11DB7 &&
+	    bufsz >= FU_CRC_ZLIB_MIN_SIZE) {
+		crc = fu_crc_reflect(crc, 32) ^ G_MAXUINT32;
+		crc = crc32_z(crc, buf, bufsz);
+		return fu_crc_reflect(crc ^ G_MAXUINT32, 32);
 	}
-	return crc;
+	return fu_crc_step_sliced(kind, buf, bufsz, crc);
 }
 
 /**
@@ -12,3 +12,9 @@ const gchar *
 fu_device_event_get_id(FuDeviceEvent *self) G_GNUC_NON_NULL(1);
 gchar *
 fu_device_event_build_id(const gchar *id) G_GNUC_NON_NULL(1);
+gboolean
+fu_device_event_add_json_value(FuDeviceEvent *self,
+			       GRefString *key,
+			       FwupdJsonParserEvent event,
+			       GRefString *value,
+			       GError **error) G_GNUC_NON_NULL(1, 2);
@@ -99,6 +99,66 @@ fu_device_event_func(void)
 	g_assert_false(ret);
 }
 
+static gboolean
+fu_device_event_json_value_cb(FwupdJsonParser *json_parser,
+			      FwupdJsonParserEvent event,
+			      GRefString *key,
+			      GRefString *value,
+			      gpointer user_data,
+			      GError **error)
+{
+	FuDeviceEvent *device_event = FU_DEVICE_EVENT(user_data);
+
+	/* the root object */
+	if (key == NULL)
+		return TRUE;
+	return fu_device_event_add_json_value(device_event, key, event, value, error);
+}
+
+static void
+fu_device_event_json_value_func(void)
+{
+	gboolean ret;
+	const gchar *str;
+	g_autoptr(FuDeviceEvent) event1 = fu_device_event_new(NULL);
+	g_autoptr(FuDeviceEvent) event2 = fu_device_event_new(NULL);
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GError) error = NULL;
+
+	/* set appropriate limits */
+	fwupd_json_parser_set_max_depth(json_parser, 10);
+	fwupd_json_parser_set_max_items(json_parser, 10);
+	fwupd_json_parser_set_max_quoted(json_parser, 100);
+
+	/* loaded without any JSON nodes */
+	ret = fwupd_json_parser_parse_data(
+	    json_parser,
+	    "{\"Id\": \"#f9f98a90\", \"Name\": \"Richard\", \"Age\": 123, \"Other\": null}",
+	    FWUPD_JSON_LOAD_FLAG_STATIC_KEYS,
+	    fu_device_event_json_value_cb,
+	    event1,
+	    &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(fu_device_event_get_id(event1), ==, "#f9f98a90");
+	g_assert_cmpint(fu_device_event_get_i64(event1, "Age", NULL), ==, 123);
+	g_assert_cmpstr(fu_device_event_get_str(event1, "Name", NULL), ==, "Richard");
+	str = fu_device_event_get_str(event1, "Other", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(str);
+	g_clear_error(&error);
+
+	/* not an integer */
+	ret = fwupd_json_parser_parse_data(json_parser,
+					   "{\"Age\": abc}",
+					   FWUPD_JSON_LOAD_FLAG_NONE,
+					   fu_device_event_json_value_cb,
+					   event2,
+					   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
 static void
 fu_device_event_uncompressed_func(void)
 {
@@ -151,13 +211,60 @@ fu_device_event_strict_order_func(void)
 	g_assert_null(event_tmp);
 }
 
+static void
+fu_device_event_resume_func(void)
+{
+	FuDeviceEvent *event_tmp;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(FuDeviceEvent) event1 = fu_device_event_new("foo:bar:baz");
+	g_autoptr(FuDeviceEvent) event2 = fu_device_event_new("aaa:bbb:ccc");
+	g_autoptr(FuDeviceEvent) event3 = fu_device_event_new("foo:bar:baz");
+	g_autoptr(FuDeviceEvent) event4 = fu_device_event_new("ddd:eee:fff");
+	g_autoptr(GError) error = NULL;
+
+	fu_device_add_event(device, event1);
+	fu_device_add_event(device, event2);
+	fu_device_add_event(device, event3);
+
+	/* repeated IDs are returned in order */
+	event_tmp = fu_device_load_event(device, "foo:bar:baz", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event1);
+	event_tmp = fu_device_load_event(device, "foo:bar:baz", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event3);
+
+	/* added after the first lookup */
+	fu_device_add_event(device, event4);
+	event_tmp = fu_device_load_event(device, "ddd:eee:fff", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event4);
+
+	/* does not go backwards until we run out of events */
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event2);
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(event_tmp);
+	g_clear_error(&error);
+
+	/* cleared */
+	fu_device_clear_events(device);
+	event_tmp = fu_device_load_event(device, "foo:bar:baz", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(event_tmp);
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/device-event", fu_device_event_func);
 	g_test_add_func("/fwupd/device-event/uncompressed", fu_device_event_uncompressed_func);
+	g_test_add_func("/fwupd/device-event/json-value", fu_device_event_json_value_func);
 	g_test_add_func("/fwupd/device-event/donor", fu_device_event_donor_func);
 	g_test_add_func("/fwupd/device-event/strict-order", fu_device_event_strict_order_func);
+	g_test_add_func("/fwupd/device-event/resume", fu_device_event_resume_func);
 	return g_test_run();
 }
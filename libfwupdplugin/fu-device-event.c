@@ -533,55 +533,95 @@ fu_device_event_set_id_from_json(FuDeviceEvent *self, const gchar *id)
 	}
 }
 
+/* private; also used when loading emulation data without building the JSON nodes */
+gboolean
+fu_device_event_add_json_value(FuDeviceEvent *self,
+			       GRefString *key,
+			       FwupdJsonParserEvent event,
+			       GRefString *value,
+			       GError **error)
+{
+	g_return_val_if_fail(FU_IS_DEVICE_EVENT(self), FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (event == FWUPD_JSON_PARSER_EVENT_STRING) {
+		if (g_strcmp0(key, "Id") == 0) {
+			if (value != NULL)
+				fu_device_event_set_id_from_json(self, value);
+		} else if (value != NULL) {
+			g_ptr_array_add(self->values,
+					fu_device_event_blob_new_internal(
+					    G_TYPE_STRING,
+					    key,
+					    g_ref_string_acquire(value),
+					    (GDestroyNotify)g_ref_string_release));
+		} else {
+			g_ptr_array_add(
+			    self->values,
+			    fu_device_event_blob_new_internal(G_TYPE_STRING, key, NULL, NULL));
+		}
+	} else if (event == FWUPD_JSON_PARSER_EVENT_RAW) {
+		gint64 value_int = 0;
+
+		if (value == NULL) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "no raw value for key %s",
+				    key);
+			return FALSE;
+		}
+		if (!fu_strtoll(value,
+				&value_int,
+				G_MININT64,
+				G_MAXINT64,
+				FU_INTEGER_BASE_AUTO,
+				error))
+			return FALSE;
+		g_ptr_array_add(self->values,
+				fu_device_event_blob_new_internal(G_TYPE_INT,
+								  key,
+								  g_memdup2(&value_int,
+									    sizeof(value_int)),
+								  g_free));
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_device_event_from_json(FwupdCodec *codec, FwupdJsonObject *json_obj, GError **error)
 {
 	FuDeviceEvent *self = FU_DEVICE_EVENT(codec);
 	for (guint i = 0; i < fwupd_json_object_get_size(json_obj); i++) {
 		GRefString *key = fwupd_json_object_get_key_for_index(json_obj, i, NULL);
+		FwupdJsonNodeKind kind;
 		g_autoptr(FwupdJsonNode) json_node = NULL;
 
 		json_node = fwupd_json_object_get_node_for_index(json_obj, i, error);
 		if (json_node == NULL)
 			return FALSE;
-		if (fwupd_json_node_get_kind(json_node) == FWUPD_JSON_NODE_KIND_STRING) {
+		kind = fwupd_json_node_get_kind(json_node);
+		if (kind == FWUPD_JSON_NODE_KIND_STRING) {
 			GRefString *str = fwupd_json_node_get_string(json_node, NULL);
-			if (g_strcmp0(key, "Id") == 0) {
-				fu_device_event_set_id_from_json(self, str);
-			} else if (str != NULL) {
-				g_ptr_array_add(self->values,
-						fu_device_event_blob_new_internal(
-						    G_TYPE_STRING,
-						    key,
-						    g_ref_string_acquire(str),
-						    (GDestroyNotify)g_ref_string_release));
-			} else {
-				g_ptr_array_add(self->values,
-						fu_device_event_blob_new_internal(G_TYPE_STRING,
-										  key,
-										  NULL,
-										  NULL));
-			}
-		} else if (fwupd_json_node_get_kind(json_node) == FWUPD_JSON_NODE_KIND_RAW) {
-			GRefString *str;
-			gint64 value = 0;
-
-			str = fwupd_json_node_get_raw(json_node, error);
+			if (!fu_device_event_add_json_value(self,
+							    key,
+							    FWUPD_JSON_PARSER_EVENT_STRING,
+							    str,
+							    error))
+				return FALSE;
+		} else if (kind == FWUPD_JSON_NODE_KIND_RAW) {
+			GRefString *str = fwupd_json_node_get_raw(json_node, error);
 			if (str == NULL)
 				return FALSE;
-			if (!fu_strtoll(str,
-					&value,
-					G_MININT64,
-					G_MAXINT64,
-					FU_INTEGER_BASE_AUTO,
-					error))
+			if (!fu_device_event_add_json_value(self,
+							    key,
+							    FWUPD_JSON_PARSER_EVENT_RAW,
+							    str,
+							    error))
 				return FALSE;
-			g_ptr_array_add(
-			    self->values,
-			    fu_device_event_blob_new_internal(G_TYPE_INT,
-							      key,
-							      g_memdup2(&value, sizeof(value)),
-							      g_free));
 		}
 	}
 
@@ -65,6 +65,8 @@ GPtrArray *
 fu_device_get_possible_plugins(FuDevice *self) G_GNUC_NON_NULL(1);
 guint
 fu_device_get_request_cnt(FuDevice *self, FwupdRequestKind request_kind) G_GNUC_NON_NULL(1);
+guint
+fu_device_get_rescan_cnt(FuDevice *self) G_GNUC_NON_NULL(1);
 void
 fu_device_set_progress(FuDevice *self, FuProgress *progress) G_GNUC_NON_NULL(1);
 gboolean
@@ -75,10 +75,12 @@ typedef struct {
 	GPtrArray *parent_physical_ids; /* (nullable) */
 	GPtrArray *parent_backend_ids;	/* (nullable) */
 	GPtrArray *events;		/* (nullable) (element-type FuDeviceEvent) */
+	GHashTable *events_index;	/* (nullable) event ID : GArray of guint */
 	guint event_idx;
 	guint remove_delay;    /* ms */
 	guint acquiesce_delay; /* ms */
 	guint request_cnts[FWUPD_REQUEST_KIND_LAST];
+	guint rescan_cnt;
 	gint order;
 	guint priority;
 	guint poll_id;
@@ -476,6 +478,25 @@ fu_device_get_request_cnt(FuDevice *self, FwupdRequestKind request_kind)
 	return priv->request_cnts[request_kind];
 }
 
+/**
+ * fu_device_get_rescan_cnt:
+ * @self: a #FuDevice
+ *
+ * Gets the number of times the device has been rescanned, which is when the GUIDs and instance
+ * IDs are removed and added again.
+ *
+ * Returns: integer
+ *
+ * Since: 2.1.8
+ **/
+guint
+fu_device_get_rescan_cnt(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), G_MAXUINT);
+	return priv->rescan_cnt;
+}
+
 /**
  * fu_device_get_possible_plugins:
  * @self: a #FuDevice
@@ -6366,6 +6387,8 @@ fu_device_rescan(FuDevice *self, GError **error)
 		g_ptr_array_set_size(priv->instance_ids, 0);
 	g_ptr_array_set_size(fu_device_get_instance_ids(self), 0);
 	g_ptr_array_set_size(fu_device_get_guids(self), 0);
+	fwupd_device_invalidate_variant(FWUPD_DEVICE(self));
+	priv->rescan_cnt++;
 
 	/* subclassed */
 	if (device_class->rescan != NULL) {
@@ -8033,6 +8056,66 @@ fu_device_ensure_events(FuDevice *self)
 	priv->events = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 }
 
+static void
+fu_device_add_event_to_index(FuDevice *self, FuDeviceEvent *event, guint idx)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	const gchar *id = fu_device_event_get_id(event);
+	GArray *idxs;
+
+	/* can never match */
+	if (id == NULL)
+		return;
+	idxs = g_hash_table_lookup(priv->events_index, id);
+	if (idxs == NULL) {
+		idxs = g_array_new(FALSE, FALSE, sizeof(guint));
+		g_hash_table_insert(priv->events_index, (gpointer)id, idxs);
+	}
+	g_array_append_val(idxs, idx);
+}
+
+/* the event IDs are owned by the events, so this has to be cleared when they are removed */
+static void
+fu_device_ensure_events_index(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->events_index != NULL)
+		return;
+	priv->events_index =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_array_unref);
+	for (guint i = 0; i < priv->events->len; i++) {
+		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
+		fu_device_add_event_to_index(self, event, i);
+	}
+}
+
+/* returns the index of the first event with the ID at or after @idx_start */
+static gboolean
+fu_device_events_index_lookup(FuDevice *self, const gchar *id, guint idx_start, guint *idx)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	GArray *idxs;
+	guint lo = 0;
+	guint hi;
+
+	fu_device_ensure_events_index(self);
+	idxs = g_hash_table_lookup(priv->events_index, id);
+	if (idxs == NULL)
+		return FALSE;
+	hi = idxs->len;
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		if (g_array_index(idxs, guint, mid) < idx_start)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo >= idxs->len)
+		return FALSE;
+	*idx = g_array_index(idxs, guint, lo);
+	return TRUE;
+}
+
 /**
  * fu_device_add_event:
  * @self: a #FuDevice
@@ -8059,10 +8142,14 @@ fu_device_add_event(FuDevice *self, FuDeviceEvent *event)
 	fu_device_ensure_events(self);
 
 	/* fuzzing */
-	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
+	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_IS_FAKE)) {
+		g_clear_pointer(&priv->events_index, g_hash_table_unref);
 		g_ptr_array_set_size(priv->events, 0);
+	}
 
 	g_ptr_array_add(priv->events, g_object_ref(event));
+	if (priv->events_index != NULL)
+		fu_device_add_event_to_index(self, event, priv->events->len - 1);
 }
 
 /**
@@ -8112,6 +8199,7 @@ FuDeviceEvent *
 fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
+	guint idx = 0;
 	g_autofree gchar *id_hash = NULL;
 
 	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
@@ -8179,13 +8267,10 @@ fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 	}
 
 	/* look for the next event in the sequence */
-	for (guint i = priv->event_idx; i < priv->events->len; i++) {
-		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
-		if (g_strcmp0(fu_device_event_get_id(event), id_hash) == 0) {
-			priv->event_idx = i + 1;
-			g_debug("found event with ID %s [%s]", id, id_hash);
-			return event;
-		}
+	if (fu_device_events_index_lookup(self, id_hash, priv->event_idx, &idx)) {
+		priv->event_idx = idx + 1;
+		g_debug("found event with ID %s [%s]", id, id_hash);
+		return g_ptr_array_index(priv->events, idx);
 	}
 
 	/* nothing found */
@@ -8250,6 +8335,7 @@ fu_device_clear_events(FuDevice *self)
 
 	if (priv->events == NULL)
 		return;
+	g_clear_pointer(&priv->events_index, g_hash_table_unref);
 	g_ptr_array_set_size(priv->events, 0);
 	priv->event_idx = 0;
 }
@@ -8786,6 +8872,8 @@ fu_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->parent_backend_ids);
 	if (priv->events != NULL)
 		g_ptr_array_unref(priv->events);
+	if (priv->events_index != NULL)
+		g_hash_table_unref(priv->events_index);
 	if (priv->retry_recs != NULL)
 		g_ptr_array_unref(priv->retry_recs);
 	if (priv->instance_ids != NULL)
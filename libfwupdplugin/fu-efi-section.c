@@ -16,8 +16,7 @@
 #include "fu-efi-struct.h"
 #include "fu-efi-volume.h"
 #include "fu-input-stream.h"
-#include "fu-lzma-common.h"
-#include "fu-memory-input-stream.h"
+#include "fu-lzma-input-stream.h"
 #include "fu-partial-input-stream.h"
 #include "fu-string.h"
 
@@ -79,20 +78,14 @@ fu_efi_section_parse_lzma_sections(FuEfiSection *self,
 				   FuFirmwareParseFlags flags,
 				   GError **error)
 {
-	g_autoptr(GBytes) blob = NULL;
-	g_autoptr(GBytes) blob_uncomp = NULL;
 	g_autoptr(FuInputStream) stream_uncomp = NULL;
 
-	/* parse all sections */
-	blob = fu_input_stream_read_bytes(stream, 0, G_MAXSIZE, NULL, error);
-	if (blob == NULL)
-		return FALSE;
-	blob_uncomp = fu_lzma_decompress_bytes(blob, 128 * FU_MB, error);
-	if (blob_uncomp == NULL) {
+	/* parse all sections, decompressing as required */
+	stream_uncomp = fu_lzma_input_stream_new(stream, 128 * FU_MB, error);
+	if (stream_uncomp == NULL) {
 		g_prefix_error_literal(error, "failed to decompress: ");
 		return FALSE;
 	}
-	stream_uncomp = fu_memory_input_stream_new_from_bytes(blob_uncomp);
 	if (!fu_efi_parse_sections(FU_FIRMWARE(self), stream_uncomp, 0, flags, error)) {
 		g_prefix_error_literal(error, "failed to parse sections: ");
 		return FALSE;
@@ -259,27 +252,37 @@ fu_efi_section_parse(FuFirmware *firmware,
 	gsize streamsz = 0;
 	gsize stlen = 0;
 	guint32 size;
-	g_autoptr(FuStructEfiSection) st = NULL;
+	guint8 st_buf[FU_STRUCT_EFI_SECTION_SIZE] = {0};
+	FuStructEfiSection st = {0};
 	g_autoptr(FuInputStream) partial_stream = NULL;
 
-	/* parse */
-	st = fu_struct_efi_section_parse_stream(stream, offset, error);
-	if (st == NULL)
+	/* parse, without allocating as there is a section for every EFI file */
+	if (!fu_struct_efi_section_parse_stream_view(&st,
+						     st_buf,
+						     sizeof(st_buf),
+						     stream,
+						     offset,
+						     error))
 		return FALSE;
 
 	/* use extended size */
-	if (fu_struct_efi_section_get_size(st) == 0xFFFFFF) {
-		g_autoptr(FuStructEfiSection2) st2 = NULL;
-		st2 = fu_struct_efi_section2_parse_stream(stream, offset, error);
-		if (st2 == NULL)
+	if (fu_struct_efi_section_get_size(&st) == 0xFFFFFF) {
+		guint8 st2_buf[FU_STRUCT_EFI_SECTION2_SIZE] = {0};
+		FuStructEfiSection2 st2 = {0};
+		if (!fu_struct_efi_section2_parse_stream_view(&st2,
+							      st2_buf,
+							      sizeof(st2_buf),
+							      stream,
+							      offset,
+							      error))
 			return FALSE;
-		priv->type = fu_struct_efi_section2_get_type(st2);
-		size = fu_struct_efi_section2_get_extended_size(st2);
-		stlen = st2->buf->len;
+		priv->type = fu_struct_efi_section2_get_type(&st2);
+		size = fu_struct_efi_section2_get_extended_size(&st2);
+		stlen = st2.buf->len;
 	} else {
-		priv->type = fu_struct_efi_section_get_type(st);
-		size = fu_struct_efi_section_get_size(st);
-		stlen = st->buf->len;
+		priv->type = fu_struct_efi_section_get_type(&st);
+		size = fu_struct_efi_section_get_size(&st);
+		stlen = st.buf->len;
 	}
 	if (size < stlen) {
 		g_set_error(error,
@@ -306,32 +309,38 @@ fu_efi_section_parse(FuFirmware *firmware,
 	/* name */
 	if (priv->type == FU_EFI_SECTION_TYPE_GUID_DEFINED) {
 		gsize offset_delta;
+		guint8 st_def_buf[FU_STRUCT_EFI_SECTION_GUID_DEFINED_SIZE] = {0};
+		FuStructEfiSectionGuidDefined st_def = {0};
 		g_autofree gchar *guid_str = NULL;
-		g_autoptr(FuStructEfiSectionGuidDefined) st_def = NULL;
-		st_def = fu_struct_efi_section_guid_defined_parse_stream(stream, stlen, error);
-		if (st_def == NULL)
+		if (!fu_struct_efi_section_guid_defined_parse_stream_view(&st_def,
+									  st_def_buf,
+									  sizeof(st_def_buf),
+									  stream,
+									  stlen,
+									  error))
 			return FALSE;
-		guid_str = fwupd_guid_to_string(fu_struct_efi_section_guid_defined_get_name(st_def),
-						FWUPD_GUID_FLAG_MIXED_ENDIAN);
+		guid_str =
+		    fwupd_guid_to_string(fu_struct_efi_section_guid_defined_get_name(&st_def),
+					 FWUPD_GUID_FLAG_MIXED_ENDIAN);
 		fu_firmware_set_id(firmware, guid_str);
-		if (fu_struct_efi_section_guid_defined_get_offset(st_def) < st_def->buf->len) {
+		if (fu_struct_efi_section_guid_defined_get_offset(&st_def) < st_def.buf->len) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INTERNAL,
 				    "invalid section size, got 0x%x",
-				    (guint)fu_struct_efi_section_guid_defined_get_offset(st_def));
+				    (guint)fu_struct_efi_section_guid_defined_get_offset(&st_def));
 			return FALSE;
 		}
-		if (fu_struct_efi_section_guid_defined_get_offset(st_def) > size) {
+		if (fu_struct_efi_section_guid_defined_get_offset(&st_def) > size) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INTERNAL,
 				    "invalid section offset 0x%x, greater than size 0x%x",
-				    (guint)fu_struct_efi_section_guid_defined_get_offset(st_def),
+				    (guint)fu_struct_efi_section_guid_defined_get_offset(&st_def),
 				    (guint)size);
 			return FALSE;
 		}
-		offset_delta = fu_struct_efi_section_guid_defined_get_offset(st_def) - stlen;
+		offset_delta = fu_struct_efi_section_guid_defined_get_offset(&st_def) - stlen;
 		if (!fu_size_checked_inc(&offset, offset_delta, error)) {
 			g_prefix_error_literal(error, "section offset overflow: ");
 			return FALSE;
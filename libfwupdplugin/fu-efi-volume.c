@@ -245,23 +245,27 @@ fu_efi_volume_parse(FuFirmware *firmware,
 					 error))
 			return FALSE;
 		do {
-			g_autoptr(FuStructEfiVolumeExtEntry) st_ext_entry = NULL;
-			st_ext_entry =
-			    fu_struct_efi_volume_ext_entry_parse_stream(stream, offset_ext, error);
-			if (st_ext_entry == NULL)
+			guint8 st_buf[FU_STRUCT_EFI_VOLUME_EXT_ENTRY_SIZE] = {0};
+			FuStructEfiVolumeExtEntry st_ext_entry = {0};
+			if (!fu_struct_efi_volume_ext_entry_parse_stream_view(&st_ext_entry,
+									      st_buf,
+									      sizeof(st_buf),
+									      stream,
+									      offset_ext,
+									      error))
 				return FALSE;
-			if (fu_struct_efi_volume_ext_entry_get_size(st_ext_entry) == 0x0) {
+			if (fu_struct_efi_volume_ext_entry_get_size(&st_ext_entry) == 0x0) {
 				g_set_error_literal(error,
 						    FWUPD_ERROR,
 						    FWUPD_ERROR_INVALID_DATA,
 						    "EFI_VOLUME_EXT_ENTRY invalid size");
 				return FALSE;
 			}
-			if (fu_struct_efi_volume_ext_entry_get_size(st_ext_entry) == 0xFFFF)
+			if (fu_struct_efi_volume_ext_entry_get_size(&st_ext_entry) == 0xFFFF)
 				break;
 			if (!fu_size_checked_inc(
 				&offset_ext,
-				fu_struct_efi_volume_ext_entry_get_size(st_ext_entry),
+				fu_struct_efi_volume_ext_entry_get_size(&st_ext_entry),
 				error))
 				return FALSE;
 		} while (offset_ext < fv_length);
@@ -323,13 +327,18 @@ fu_efi_volume_parse(FuFirmware *firmware,
 	while (offset < streamsz) {
 		guint32 num_blocks;
 		guint32 length;
-		g_autoptr(FuStructEfiVolumeBlockMap) st_blk = NULL;
-		st_blk = fu_struct_efi_volume_block_map_parse_stream(stream, offset, error);
-		if (st_blk == NULL)
+		guint8 st_buf[FU_STRUCT_EFI_VOLUME_BLOCK_MAP_SIZE] = {0};
+		FuStructEfiVolumeBlockMap st_blk = {0};
+		if (!fu_struct_efi_volume_block_map_parse_stream_view(&st_blk,
+								      st_buf,
+								      sizeof(st_buf),
+								      stream,
+								      offset,
+								      error))
 			return FALSE;
-		num_blocks = fu_struct_efi_volume_block_map_get_num_blocks(st_blk);
-		length = fu_struct_efi_volume_block_map_get_length(st_blk);
-		if (!fu_size_checked_inc(&offset, st_blk->buf->len, error)) {
+		num_blocks = fu_struct_efi_volume_block_map_get_num_blocks(&st_blk);
+		length = fu_struct_efi_volume_block_map_get_length(&st_blk);
+		if (!fu_size_checked_inc(&offset, st_blk.buf->len, error)) {
 			g_prefix_error_literal(error, "block map entry offset overflow: ");
 			return FALSE;
 		}
@@ -152,14 +152,14 @@ enum FuEfiSectionType {
     InsydeSectionPostcode = 0x20,   // Insyde H2O
 }
 
-#[derive(New, ParseStream)]
+#[derive(New, ParseStreamView)]
 #[repr(C, packed)]
 struct FuStructEfiSection {
     size: u24le,
     type: FuEfiSectionType,
 }
 
-#[derive(ParseStream, Default)]
+#[derive(ParseStreamView, Default)]
 #[repr(C, packed)]
 struct FuStructEfiSection2 {
     size: u24le == 0xFFFFFF,
@@ -173,7 +173,7 @@ struct FuStructEfiSectionFreeformSubtypeGuid {
     guid: Guid,
 }
 
-#[derive(New, ParseStream)]
+#[derive(New, ParseStreamView)]
 #[repr(C, packed)]
 struct FuStructEfiSectionGuidDefined {
     name: Guid,
@@ -211,14 +211,14 @@ enum FuEfiVolumeExtEntryType {
     Size = 0x03,
 }
 
-#[derive(ParseStream)]
+#[derive(ParseStreamView)]
 #[repr(C, packed)]
 struct FuStructEfiVolumeExtEntry {
     size: u16le,
     type: FuEfiVolumeExtEntryType,
 }
 
-#[derive(New, ParseStream)]
+#[derive(New, ParseStreamView)]
 #[repr(C, packed)]
 struct FuStructEfiVolumeBlockMap {
     num_blocks: u32le,
@@ -9,6 +9,13 @@
 #include "fu-firmware.h"
 
 #define FU_FIRMWARE_SIZE_MAX_DEFAULT ((100 * FU_MB) + 1)
+#define FU_FIRMWARE_MAGIC_PREFIX_SIZE (4 * FU_KB)
 
 const GType *
 fu_firmware_get_image_gtypes(FuFirmware *self, guint *n_gtypes) G_GNUC_NON_NULL(1);
+GBytes *
+fu_firmware_read_magic_prefix(FuInputStream *stream, gsize offset, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+gboolean
+fu_firmware_gtype_matches_magic(GType gtype, GBytes *prefix, FuFirmwareParseFlags flags)
+    G_GNUC_NON_NULL(2);
@@ -11,6 +11,7 @@
 #include "fwupd-test.h"
 
 #include "fu-context-private.h"
+#include "fu-firmware-private.h"
 #include "fu-ifwi-struct.h"
 
 static void
@@ -421,6 +422,110 @@ fu_firmware_new_from_gtypes_func(void)
 	g_assert_null(firmware3);
 }
 
+static GPtrArray *
+fu_firmware_magic_detect(FuInputStream *stream, GArray *gtypes, GBytes *prefix)
+{
+	FuFirmwareParseFlags flags = FU_FIRMWARE_PARSE_FLAG_NO_SEARCH;
+	g_autoptr(GPtrArray) names = g_ptr_array_new();
+
+	for (guint i = 0; i < gtypes->len; i++) {
+		GType gtype = g_array_index(gtypes, GType, i);
+		g_autoptr(FuFirmware) firmware = NULL;
+
+		if (prefix != NULL && !fu_firmware_gtype_matches_magic(gtype, prefix, flags))
+			continue;
+		firmware = g_object_new(gtype, NULL);
+		if (fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
+			continue;
+		if (!fu_firmware_parse_stream(firmware, stream, 0x0, flags, NULL))
+			continue;
+		g_ptr_array_add(names, (gpointer)g_type_name(gtype));
+	}
+	return g_steal_pointer(&names);
+}
+
+static void
+fu_firmware_magic_func(void)
+{
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuFirmware) firmware2 = NULL;
+	g_autoptr(FuFirmware) firmware3 = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(GArray) gtypes = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) prefix = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) names_magic = NULL;
+	g_autoptr(GPtrArray) names_trial = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "uswid.builder.xml", NULL);
+	firmware = fu_firmware_new_from_filename(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(firmware);
+	blob = fu_firmware_write(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	stream = fu_memory_input_stream_new_from_bytes(blob);
+	prefix = fu_firmware_read_magic_prefix(stream, 0x0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(prefix);
+
+	/* only anchored magic can be used to reject a GType */
+	g_assert_true(fu_firmware_gtype_matches_magic(FU_TYPE_USWID_FIRMWARE,
+						      prefix,
+						      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH));
+	g_assert_false(fu_firmware_gtype_matches_magic(FU_TYPE_FMAP_FIRMWARE,
+						       prefix,
+						       FU_FIRMWARE_PARSE_FLAG_NO_SEARCH));
+	g_assert_true(fu_firmware_gtype_matches_magic(FU_TYPE_FMAP_FIRMWARE,
+						      prefix,
+						      FU_FIRMWARE_PARSE_FLAG_NONE));
+	g_assert_true(fu_firmware_gtype_matches_magic(FU_TYPE_SREC_FIRMWARE,
+						      prefix,
+						      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH));
+
+	/* the same types are detected, with and without checking the magic first */
+	fu_context_add_firmware_gtypes(ctx);
+	gtypes = fu_context_get_firmware_gtypes(ctx);
+	g_timer_reset(timer);
+	names_trial = fu_firmware_magic_detect(stream, gtypes, NULL);
+	g_debug("trial=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_timer_reset(timer);
+	names_magic = fu_firmware_magic_detect(stream, gtypes, prefix);
+	g_debug("magic=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_assert_cmpint(names_magic->len, ==, names_trial->len);
+	for (guint i = 0; i < names_trial->len; i++) {
+		const gchar *name = g_ptr_array_index(names_trial, i);
+		g_assert_true(
+		    g_ptr_array_find_with_equal_func(names_magic, name, g_str_equal, NULL));
+	}
+	g_assert_true(
+	    g_ptr_array_find_with_equal_func(names_magic, "FuUswidFirmware", g_str_equal, NULL));
+
+	/* types that cannot match are skipped */
+	firmware2 = fu_firmware_new_from_gtypes(stream,
+						0x0,
+						FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+						&error,
+						FU_TYPE_FMAP_FIRMWARE,
+						FU_TYPE_USWID_FIRMWARE,
+						G_TYPE_INVALID);
+	g_assert_no_error(error);
+	g_assert_nonnull(firmware2);
+	g_assert_cmpstr(G_OBJECT_TYPE_NAME(firmware2), ==, "FuUswidFirmware");
+	firmware3 = fu_firmware_new_from_gtypes(stream,
+						0x0,
+						FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+						&error,
+						FU_TYPE_FMAP_FIRMWARE,
+						G_TYPE_INVALID);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null(firmware3);
+}
+
 static void
 fu_firmware_csv_func(void)
 {
@@ -1257,6 +1362,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/firmware/dfuse", fu_firmware_dfuse_func);
 	g_test_add_func("/fwupd/firmware/fmap", fu_firmware_fmap_func);
 	g_test_add_func("/fwupd/firmware/gtypes", fu_firmware_new_from_gtypes_func);
+	g_test_add_func("/fwupd/firmware/magic", fu_firmware_magic_func);
 	g_test_add_func("/fwupd/firmware/sorted", fu_firmware_sorted_func);
 	return g_test_run();
 }
@@ -94,6 +94,17 @@ fu_firmware_patch_free(FuFirmwarePatch *ptch)
 	g_free(ptch);
 }
 
+/* the magic declared by a firmware GType, built once from a prototype instance */
+typedef struct {
+	GPtrArray *magic; /* nullable, element-type FuFirmwarePatch */
+	gboolean anchored;
+} FuFirmwareMagicInfo;
+
+/* nocheck:static */
+static GMutex fu_firmware_magic_mutex;
+
+G_DEFINE_QUARK(fu-firmware-magic-info, fu_firmware_magic_info)
+
 /**
  * fu_firmware_add_flag:
  * @self: a #FuFirmware
@@ -2840,6 +2851,107 @@ fu_firmware_new_from_bytes(GBytes *fw)
 	return self;
 }
 
+/* the info is never freed as GTypes are never unregistered */
+static FuFirmwareMagicInfo *
+fu_firmware_get_magic_info(GType gtype)
+{
+	FuFirmwareMagicInfo *info;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&fu_firmware_magic_mutex);
+
+	info = g_type_get_qdata(gtype, fu_firmware_magic_info_quark());
+	if (info == NULL) {
+		g_autoptr(FuFirmware) firmware = g_object_new(gtype, NULL);
+		FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(firmware);
+		FuFirmwarePrivate *priv = GET_PRIVATE(firmware);
+
+		info = g_new0(FuFirmwareMagicInfo, 1);
+		if (priv->magic != NULL)
+			info->magic = g_ptr_array_ref(priv->magic);
+
+		/* with no validate vfunc the magic is only used for searching */
+		info->anchored = klass->validate != NULL &&
+				 !fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_ALWAYS_SEARCH);
+		g_type_set_qdata(gtype, fu_firmware_magic_info_quark(), info);
+	}
+	return info;
+}
+
+/**
+ * fu_firmware_read_magic_prefix:
+ * @stream: a #FuInputStream
+ * @offset: start offset, useful for ignoring a bootloader
+ * @error: (nullable): optional return location for an error
+ *
+ * Reads the start of the stream once so that many firmware GTypes can be checked using
+ * fu_firmware_gtype_matches_magic() without constructing each object.
+ *
+ * Returns: (transfer full): the prefix, which may be smaller than the magic of some GTypes
+ *
+ * Since: 2.1.8
+ **/
+GBytes *
+fu_firmware_read_magic_prefix(FuInputStream *stream, gsize offset, GError **error)
+{
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return fu_input_stream_read_bytes(stream,
+					  offset,
+					  FU_FIRMWARE_MAGIC_PREFIX_SIZE,
+					  NULL,
+					  error);
+}
+
+/**
+ * fu_firmware_gtype_matches_magic:
+ * @gtype: a #GType, e.g. `FU_TYPE_USWID_FIRMWARE`
+ * @prefix: a #GBytes from fu_firmware_read_magic_prefix()
+ * @flags: parse flags, e.g. %FU_FIRMWARE_PARSE_FLAG_NO_SEARCH
+ *
+ * Checks if the firmware could be parsed by @gtype using the magic declared with
+ * fu_firmware_add_magic(), without constructing the object or parsing the stream.
+ *
+ * Only GTypes with magic that has to be at the start offset can be rejected; if the firmware
+ * would be searched, the GType has no magic, or the prefix is too short then this returns %TRUE
+ * and the caller has to try parsing the stream.
+ *
+ * Returns: %FALSE if the GType cannot possibly parse the firmware
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fu_firmware_gtype_matches_magic(GType gtype, GBytes *prefix, FuFirmwareParseFlags flags)
+{
+	FuFirmwareMagicInfo *info;
+	gsize bufsz = 0;
+	const guint8 *buf;
+
+	g_return_val_if_fail(g_type_is_a(gtype, FU_TYPE_FIRMWARE), FALSE);
+	g_return_val_if_fail(prefix != NULL, FALSE);
+
+	/* the magic could be anywhere */
+	if ((flags & FU_FIRMWARE_PARSE_FLAG_NO_SEARCH) == 0)
+		return TRUE;
+	info = fu_firmware_get_magic_info(gtype);
+	if (info->magic == NULL || !info->anchored)
+		return TRUE;
+
+	/* any of the magic values */
+	buf = g_bytes_get_data(prefix, &bufsz);
+	for (guint i = 0; i < info->magic->len; i++) {
+		FuFirmwarePatch *patch = g_ptr_array_index(info->magic, i);
+		gsize blobsz = 0;
+		const guint8 *blob = g_bytes_get_data(patch->blob, &blobsz);
+
+		if (patch->offset + blobsz > bufsz)
+			return TRUE;
+		if (fu_memcmp_safe(buf, bufsz, patch->offset, blob, blobsz, 0x0, blobsz, NULL))
+			return TRUE;
+	}
+
+	/* no match */
+	return FALSE;
+}
+
 /**
  * fu_firmware_new_from_gtypes:
  * @stream: a #FuInputStream
@@ -2850,6 +2962,9 @@ fu_firmware_new_from_bytes(GBytes *fw)
  *
  * Tries to parse the firmware with each #GType in order.
  *
+ * If %FU_FIRMWARE_PARSE_FLAG_NO_SEARCH is set then any #GType with magic that does not match
+ * is skipped without being constructed.
+ *
  * Returns: (transfer full) (nullable): a #FuFirmware, or %NULL
  *
  * Since: 1.5.6
@@ -2863,6 +2978,7 @@ fu_firmware_new_from_gtypes(FuInputStream *stream,
 {
 	va_list args;
 	g_autoptr(GArray) gtypes = g_array_new(FALSE, FALSE, sizeof(GType));
+	g_autoptr(GBytes) prefix = NULL;
 	g_autoptr(GError) error_all = NULL;
 
 	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
@@ -2887,11 +3003,27 @@ fu_firmware_new_from_gtypes(FuInputStream *stream,
 		return NULL;
 	}
 
+	/* check the magic of each GType before constructing it */
+	if (flags & FU_FIRMWARE_PARSE_FLAG_NO_SEARCH) {
+		g_autoptr(GError) error_local = NULL;
+		prefix = fu_firmware_read_magic_prefix(stream, offset, &error_local);
+		if (prefix == NULL)
+			g_debug("not checking magic: %s", error_local->message);
+	}
+
 	/* try each GType in turn */
 	for (guint i = 0; i < gtypes->len; i++) {
 		GType gtype = g_array_index(gtypes, GType, i);
-		g_autoptr(FuFirmware) firmware = g_object_new(gtype, NULL);
+		g_autoptr(FuFirmware) firmware = NULL;
 		g_autoptr(GError) error_local = NULL;
+
+		if (prefix != NULL && !fu_firmware_gtype_matches_magic(gtype, prefix, flags)) {
+			g_debug("@0x%x ignoring %s as magic does not match",
+				(guint)offset,
+				g_type_name(gtype));
+			continue;
+		}
+		firmware = g_object_new(gtype, NULL);
 		if (!fu_firmware_parse_stream(firmware, stream, offset, flags, &error_local)) {
 			g_debug("@0x%x %s", (guint)offset, error_local->message);
 			if (error_all == NULL) {
@@ -2906,6 +3038,13 @@ fu_firmware_new_from_gtypes(FuInputStream *stream,
 	}
 
 	/* failed */
+	if (error_all == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "failed to find magic bytes");
+		return NULL;
+	}
 	g_propagate_error(error, g_steal_pointer(&error_all));
 	return NULL;
 }
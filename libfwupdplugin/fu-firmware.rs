@@ -18,6 +18,7 @@ enum FuFirmwareParseFlags {
     OnlyTrustPqSignatures = 1 << 12,
     OnlyPartitionLayout = 1 << 13,
     OnlyBasename = 1 << 14,
+    Lazy = 1 << 15, // decompress image data when it is first read
 }
 
 enum FuFirmwareBuilderFlags {
@@ -188,12 +188,116 @@ fu_input_stream_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_input_stream_mapped_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob3 = NULL;
+	g_autoptr(GBytes) blob4 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(FuInputStream) stream_partial = NULL;
+
+	fn = g_test_build_filename(G_TEST_DIST, "tests", "dfu.builder.xml", NULL);
+	g_assert_nonnull(fn);
+	stream = fu_input_stream_from_path(fn, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	g_assert_true(FU_IS_MAPPED_FILE_INPUT_STREAM(stream));
+
+	/* both reference the mapping */
+	blob1 = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob1);
+	g_assert_cmpint(g_bytes_get_size(blob1), ==, 216);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 216);
+	blob2 = fu_input_stream_read_bytes(stream, 0x10, 0x20, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_cmpint(g_bytes_get_size(blob2), ==, 0x20);
+	g_assert_true((const guint8 *)g_bytes_get_data(blob2, NULL) ==
+		      (const guint8 *)g_bytes_get_data(blob1, NULL) + 0x10);
+
+	/* also from a slice */
+	stream_partial = fu_partial_input_stream_new(stream, 0x8, 0x10, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_partial);
+	blob3 = fu_input_stream_read_bytes(stream_partial, 0x8, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob3);
+	g_assert_cmpint(g_bytes_get_size(blob3), ==, 0x8);
+	g_assert_true(g_bytes_get_data(blob3, NULL) == g_bytes_get_data(blob2, NULL));
+
+	/* seeking past the end is allowed, but there is nothing to read */
+	ret = g_seekable_seek(G_SEEKABLE(stream), 0x1000, G_SEEK_SET, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob4 = fu_input_stream_read_bytes(stream, 216, 0x20, NULL, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null(blob4);
+}
+
+static void
+fu_input_stream_checksums_func(void)
+{
+	GChecksumType checksum_types[] = {
+	    G_CHECKSUM_SHA1,
+	    G_CHECKSUM_SHA256,
+	    G_CHECKSUM_SHA384,
+	};
+	gsize bufsz = 32 * 1024 * 1024;
+	g_autofree guint8 *buf = g_malloc(bufsz);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7 + (i >> 12));
+
+	/* small enough to be serial, and large enough to use threads */
+	for (gsize sz = 0x10; sz <= bufsz; sz = MIN(sz * 0x100, bufsz)) {
+		g_autoptr(GError) error = NULL;
+		g_autoptr(GPtrArray) checksums = NULL;
+		g_autoptr(FuInputStream) stream = NULL;
+
+		stream = fu_memory_input_stream_new_from_data(buf, sz, NULL);
+		g_timer_reset(timer);
+		checksums = fu_input_stream_compute_checksums(stream,
+							      checksum_types,
+							      G_N_ELEMENTS(checksum_types),
+							      &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(checksums);
+		g_debug("size=0x%x, one-pass=%.3fms",
+			(guint)sz,
+			g_timer_elapsed(timer, NULL) * 1000.f);
+		g_assert_cmpint(checksums->len, ==, G_N_ELEMENTS(checksum_types));
+
+		/* same as hashing the stream once for each type */
+		g_timer_reset(timer);
+		for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
+			g_autofree gchar *checksum =
+			    fu_input_stream_compute_checksum(stream, checksum_types[i], &error);
+			g_assert_no_error(error);
+			g_assert_cmpstr(g_ptr_array_index(checksums, i), ==, checksum);
+		}
+		g_debug("size=0x%x, multi-pass=%.3fms",
+			(guint)sz,
+			g_timer_elapsed(timer, NULL) * 1000.f);
+		if (sz == bufsz)
+			break;
+	}
+}
+
 int
 main(int argc, char **argv)
 {
 	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/input-stream", fu_input_stream_func);
+	g_test_add_func("/fwupd/input-stream/mapped", fu_input_stream_mapped_func);
+	g_test_add_func("/fwupd/input-stream/checksums", fu_input_stream_checksums_func);
 	g_test_add_func("/fwupd/input-stream/sum-overflow", fu_input_stream_sum_overflow_func);
 	g_test_add_func("/fwupd/input-stream/chunkify", fu_input_stream_chunkify_func);
 	g_test_add_func("/fwupd/input-stream/find", fu_input_stream_find_func);
@@ -12,9 +12,14 @@
 #include "fu-crc-private.h"
 #include "fu-file-input-stream.h"
 #include "fu-input-stream.h"
+#include "fu-mapped-file-input-stream.h"
 #include "fu-mem-private.h"
 #include "fu-sum.h"
 
+/* hashing is much slower than reading, so only use threads when each chunk is large */
+#define FU_INPUT_STREAM_CHECKSUMS_THREADED_SIZE (4 * 1024 * 1024)
+#define FU_INPUT_STREAM_CHECKSUMS_CHUNK_SIZE	(1024 * 1024)
+
 static void
 fu_input_stream_seekable_iface_init(GSeekableIface *iface);
 
@@ -228,6 +233,9 @@ fu_input_stream_read_all(FuInputStream *stream,
  *
  * Opens the file as n input stream.
  *
+ * Regular files are mapped into memory where possible, so that fu_input_stream_read_bytes()
+ * does not have to copy the data.
+ *
  * Returns: (transfer full): a #FuInputStream, or %NULL on error
  *
  * Since: 2.0.0
@@ -235,12 +243,20 @@ fu_input_stream_read_all(FuInputStream *stream,
 FuInputStream *
 fu_input_stream_from_path(const gchar *path, GError **error)
 {
+	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GFile) file = NULL;
 	g_autoptr(FuFileInputStream) stream = NULL;
+	g_autoptr(FuInputStream) stream_mapped = NULL;
 
 	g_return_val_if_fail(path != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	/* try as a mapped file, falling back to reading it instead */
+	stream_mapped = fu_mapped_file_input_stream_new(path, &error_local);
+	if (stream_mapped != NULL)
+		return g_steal_pointer(&stream_mapped);
+	g_debug("failed to map %s, so reading: %s", path, error_local->message);
+
 	file = g_file_new_for_path(path);
 	stream = fu_file_input_stream_from_file(file, NULL, error);
 	if (stream == NULL) {
@@ -550,6 +566,9 @@ fu_input_stream_read_byte_array(FuInputStream *stream,
  *
  * Read a #GBytes from a stream in a safe way.
  *
+ * If the stream is backed by memory, for instance a mapped file, then the returned buffer
+ * references that memory rather than being a copy.
+ *
  * NOTE: The returned buffer may be smaller than @count!
  *
  * Returns: (transfer full): buffer
@@ -563,10 +582,39 @@ fu_input_stream_read_bytes(FuInputStream *stream,
 			   FuProgress *progress,
 			   GError **error)
 {
+	FuInputStreamClass *klass;
 	g_autoptr(GByteArray) buf = NULL;
+
 	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(progress == NULL || FU_IS_PROGRESS(progress), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* reference the existing data rather than copying it */
+	klass = FU_INPUT_STREAM_GET_CLASS(stream);
+	if (klass->read_bytes != NULL) {
+		g_autoptr(GBytes) blob = NULL;
+		if (count == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOT_SUPPORTED,
+					    "read size must be non-zero");
+			return NULL;
+		}
+		blob = klass->read_bytes(stream, offset, count, error);
+		if (blob == NULL)
+			return NULL;
+		if (g_bytes_get_size(blob) == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "no data could be read");
+			return NULL;
+		}
+		if (progress != NULL)
+			fu_progress_set_percentage_full(progress, g_bytes_get_size(blob), count);
+		return g_steal_pointer(&blob);
+	}
+
 	buf = fu_input_stream_read_byte_array(stream, offset, count, progress, error);
 	if (buf == NULL)
 		return NULL;
@@ -681,6 +729,174 @@ fu_input_stream_compute_checksum(FuInputStream *stream, GChecksumType checksum_t
 	return g_strdup(g_checksum_get_string(csum));
 }
 
+static gboolean
+fu_input_stream_compute_checksums_cb(const guint8 *buf,
+				     gsize bufsz,
+				     gpointer user_data,
+				     GError **error)
+{
+	GPtrArray *csums = (GPtrArray *)user_data;
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index(csums, i);
+		g_checksum_update(csum, buf, bufsz);
+	}
+	return TRUE;
+}
+
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	GBytes *blob; /* the chunk being hashed */
+	guint pending;
+} FuInputStreamChecksumsHelper;
+
+static void
+fu_input_stream_compute_checksums_thread_cb(gpointer data, gpointer user_data)
+{
+	GChecksum *csum = (GChecksum *)data;
+	FuInputStreamChecksumsHelper *helper = (FuInputStreamChecksumsHelper *)user_data;
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(helper->blob, &bufsz);
+
+	g_checksum_update(csum, buf, bufsz);
+	g_mutex_lock(&helper->mutex);
+	helper->pending--;
+	g_cond_signal(&helper->cond);
+	g_mutex_unlock(&helper->mutex);
+}
+
+static void
+fu_input_stream_compute_checksums_wait(FuInputStreamChecksumsHelper *helper)
+{
+	g_mutex_lock(&helper->mutex);
+	while (helper->pending > 0)
+		g_cond_wait(&helper->cond, &helper->mutex);
+	g_mutex_unlock(&helper->mutex);
+}
+
+/*
+ * Each digest is only ever updated by one pool thread at a time, and the next chunk is read while
+ * the current chunk is being hashed, so the stream is still only read once.
+ */
+static gboolean
+fu_input_stream_compute_checksums_threaded(FuInputStream *stream,
+					   gsize streamsz,
+					   GPtrArray *csums,
+					   GError **error)
+{
+	gsize offset = 0;
+	gboolean ret = TRUE;
+	GThreadPool *pool;
+	FuInputStreamChecksumsHelper helper = {0};
+	g_autoptr(GBytes) blob = NULL;
+
+	pool = g_thread_pool_new(fu_input_stream_compute_checksums_thread_cb,
+				 &helper,
+				 (gint)MIN(csums->len, g_get_num_processors()),
+				 FALSE,
+				 error);
+	if (pool == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	g_mutex_init(&helper.mutex);
+	g_cond_init(&helper.cond);
+
+	blob = fu_input_stream_read_bytes(stream,
+					  offset,
+					  FU_INPUT_STREAM_CHECKSUMS_CHUNK_SIZE,
+					  NULL,
+					  error);
+	if (blob == NULL)
+		ret = FALSE;
+	while (ret && offset < streamsz) {
+		g_autoptr(GBytes) blob_next = NULL;
+
+		/* hash this chunk with every digest */
+		helper.blob = blob;
+		helper.pending = csums->len;
+		for (guint i = 0; i < csums->len; i++) {
+			if (!g_thread_pool_push(pool, g_ptr_array_index(csums, i), NULL))
+				fu_input_stream_compute_checksums_thread_cb(
+				    g_ptr_array_index(csums, i),
+				    &helper);
+		}
+
+		/* read the next chunk at the same time */
+		offset += g_bytes_get_size(blob);
+		if (offset < streamsz) {
+			blob_next = fu_input_stream_read_bytes(stream,
+							       offset,
+							       FU_INPUT_STREAM_CHECKSUMS_CHUNK_SIZE,
+							       NULL,
+							       error);
+			if (blob_next == NULL)
+				ret = FALSE;
+		}
+		fu_input_stream_compute_checksums_wait(&helper);
+		g_bytes_unref(blob);
+		blob = g_steal_pointer(&blob_next);
+	}
+
+	g_thread_pool_free(pool, FALSE, TRUE);
+	g_cond_clear(&helper.cond);
+	g_mutex_clear(&helper.mutex);
+	return ret;
+}
+
+/**
+ * fu_input_stream_compute_checksums:
+ * @stream: a #FuInputStream
+ * @checksum_types: (array length=checksum_typesz): #GChecksumType values
+ * @checksum_typesz: number of items in @checksum_types
+ * @error: (nullable): optional return location for an error
+ *
+ * Generates multiple checksums of the entire stream, only reading the stream once.
+ *
+ * For large streams each digest is computed on a worker thread.
+ *
+ * Returns: (transfer container) (element-type utf8): the hexadecimal representation of each
+ * checksum in the same order as @checksum_types, or %NULL on error
+ *
+ * Since: 2.1.8
+ **/
+GPtrArray *
+fu_input_stream_compute_checksums(FuInputStream *stream,
+				  const GChecksumType *checksum_types,
+				  guint checksum_typesz,
+				  GError **error)
+{
+	gsize streamsz = 0;
+	g_autoptr(GPtrArray) csums = NULL;
+	g_autoptr(GPtrArray) strs = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(checksum_types != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	csums = g_ptr_array_new_with_free_func((GDestroyNotify)g_checksum_free);
+	for (guint i = 0; i < checksum_typesz; i++)
+		g_ptr_array_add(csums, g_checksum_new(checksum_types[i]));
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return NULL;
+	if (csums->len > 1 && g_get_num_processors() > 1 && streamsz != G_MAXSIZE &&
+	    streamsz >= FU_INPUT_STREAM_CHECKSUMS_THREADED_SIZE) {
+		if (!fu_input_stream_compute_checksums_threaded(stream, streamsz, csums, error))
+			return NULL;
+	} else {
+		if (!fu_input_stream_chunkify(stream,
+					      fu_input_stream_compute_checksums_cb,
+					      csums,
+					      error))
+			return NULL;
+	}
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index(csums, i);
+		g_ptr_array_add(strs, g_strdup(g_checksum_get_string(csum)));
+	}
+	return g_steal_pointer(&strs);
+}
+
 static gboolean
 fu_input_stream_compute_sum8_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
 {
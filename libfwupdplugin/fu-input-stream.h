@@ -29,6 +29,7 @@ struct _FuInputStreamClass {
 			 GSeekType type,
 			 GCancellable *cancellable,
 			 GError **error);
+	GBytes *(*read_bytes)(FuInputStream *stream, gsize offset, gsize count, GError **error);
 };
 
 FuInputStream *
@@ -119,6 +120,11 @@ gchar *
 fu_input_stream_compute_checksum(FuInputStream *stream,
 				 GChecksumType checksum_type,
 				 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_input_stream_compute_checksums(FuInputStream *stream,
+				  const GChecksumType *checksum_types,
+				  guint checksum_typesz,
+				  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gssize
 fu_input_stream_read(FuInputStream *stream,
 		     void *buffer,
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuLazyInputStream"
+
+#include "config.h"
+
+#include "fwupd-codec.h"
+
+#include "fu-input-stream.h"
+#include "fu-lazy-input-stream.h"
+
+/**
+ * FuLazyInputStream:
+ *
+ * An input stream of a known size where the data is only produced when it is first read.
+ *
+ * This is useful for archives, where the stream for each image can be created when parsing the
+ * file table and the payload is only decompressed if something actually reads it. The callback
+ * is called with the offset of the end of each read, and may populate the backing stream with
+ * more data than was requested.
+ *
+ * NOTE: like #FuCompositeInputStream, this stream is not thread safe.
+ */
+struct _FuLazyInputStream {
+	FuInputStream parent_instance;
+	FuInputStream *stream; /* backing */
+	gsize size;
+	gsize size_ready;
+	goffset pos;
+	FuLazyInputStreamFunc func;
+	gpointer user_data;
+	GDestroyNotify user_data_free;
+};
+
+static void
+fu_lazy_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuLazyInputStream,
+			fu_lazy_input_stream,
+			FU_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+					      fu_lazy_input_stream_codec_iface_init))
+
+static void
+fu_lazy_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuLazyInputStream *self = FU_LAZY_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "Size", self->size);
+	fwupd_codec_string_append_hex(str, idt, "SizeReady", self->size_ready);
+}
+
+static void
+fu_lazy_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_lazy_input_stream_add_string;
+}
+
+static gboolean
+fu_lazy_input_stream_ensure_size(FuLazyInputStream *self, gsize size, GError **error)
+{
+	if (size <= self->size_ready)
+		return TRUE;
+	if (!self->func(self->stream, size, self->user_data, error))
+		return FALSE;
+	self->size_ready = size;
+	return TRUE;
+}
+
+static gssize
+fu_lazy_input_stream_read_fn(FuInputStream *stream,
+			     void *buffer,
+			     gsize count,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	FuLazyInputStream *self = FU_LAZY_INPUT_STREAM(stream);
+	gssize rc;
+
+	if ((gsize)self->pos >= self->size)
+		return 0;
+	count = MIN(count, self->size - (gsize)self->pos);
+	if (!fu_lazy_input_stream_ensure_size(self, (gsize)self->pos + count, error))
+		return -1;
+	if (!g_seekable_seek(G_SEEKABLE(self->stream), self->pos, G_SEEK_SET, cancellable, error))
+		return -1;
+	rc = fu_input_stream_read(self->stream, buffer, count, cancellable, error);
+	if (rc < 0)
+		return rc;
+	self->pos += rc;
+	return rc;
+}
+
+static goffset
+fu_lazy_input_stream_tell(FuInputStream *stream)
+{
+	FuLazyInputStream *self = FU_LAZY_INPUT_STREAM(stream);
+	return self->pos;
+}
+
+static gboolean
+fu_lazy_input_stream_can_seek(FuInputStream *stream)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_lazy_input_stream_seek(FuInputStream *stream,
+			  goffset offset,
+			  GSeekType type,
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	FuLazyInputStream *self = FU_LAZY_INPUT_STREAM(stream);
+	goffset new_pos;
+
+	/* this does not populate the backing stream */
+	switch (type) {
+	case G_SEEK_SET:
+		new_pos = offset;
+		break;
+	case G_SEEK_CUR:
+		new_pos = self->pos + offset;
+		break;
+	case G_SEEK_END:
+		new_pos = (goffset)self->size + offset;
+		break;
+	default:
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "unsupported seek type");
+		return FALSE;
+	}
+	if (new_pos < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot seek to negative offset %" G_GINT64_FORMAT,
+			    (gint64)new_pos);
+		return FALSE;
+	}
+	self->pos = new_pos;
+	return TRUE;
+}
+
+static void
+fu_lazy_input_stream_finalize(GObject *object)
+{
+	FuLazyInputStream *self = FU_LAZY_INPUT_STREAM(object);
+	if (self->user_data_free != NULL)
+		self->user_data_free(self->user_data);
+	g_object_unref(self->stream);
+	G_OBJECT_CLASS(fu_lazy_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_lazy_input_stream_class_init(FuLazyInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	FuInputStreamClass *istream_class = FU_INPUT_STREAM_CLASS(klass);
+	object_class->finalize = fu_lazy_input_stream_finalize;
+	istream_class->read_fn = fu_lazy_input_stream_read_fn;
+	istream_class->tell = fu_lazy_input_stream_tell;
+	istream_class->can_seek = fu_lazy_input_stream_can_seek;
+	istream_class->seek = fu_lazy_input_stream_seek;
+}
+
+static void
+fu_lazy_input_stream_init(FuLazyInputStream *self)
+{
+}
+
+/**
+ * fu_lazy_input_stream_new:
+ * @stream: the backing #FuInputStream, which may be empty
+ * @size: the final size of @stream in bytes
+ * @func: (scope notified): the function used to populate @stream
+ * @user_data: (closure func): user data for @func
+ * @user_data_free: (nullable): function to free @user_data
+ *
+ * Creates a stream of @size bytes where @func is only called when data is first read, and is
+ * passed the number of bytes at the start of @stream that have to be readable afterwards.
+ *
+ * Seeking and getting the size of the returned stream does not call @func.
+ *
+ * Returns: (transfer full): a #FuInputStream
+ *
+ * Since: 2.1.8
+ **/
+FuInputStream *
+fu_lazy_input_stream_new(FuInputStream *stream,
+			 gsize size,
+			 FuLazyInputStreamFunc func,
+			 gpointer user_data,
+			 GDestroyNotify user_data_free)
+{
+	g_autoptr(FuLazyInputStream) self = g_object_new(FU_TYPE_LAZY_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(func != NULL, NULL);
+
+	self->stream = g_object_ref(stream);
+	self->size = size;
+	self->func = func;
+	self->user_data = user_data;
+	self->user_data_free = user_data_free;
+	return FU_INPUT_STREAM(g_steal_pointer(&self));
+}
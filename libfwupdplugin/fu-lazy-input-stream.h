@@ -0,0 +1,30 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-input-stream.h"
+
+#define FU_TYPE_LAZY_INPUT_STREAM (fu_lazy_input_stream_get_type())
+G_DECLARE_FINAL_TYPE(FuLazyInputStream, fu_lazy_input_stream, FU, LAZY_INPUT_STREAM, FuInputStream)
+
+/**
+ * FuLazyInputStreamFunc:
+ *
+ * Callback used by [ctor@LazyInputStream.new] to make the first @size bytes of @stream readable.
+ **/
+typedef gboolean (*FuLazyInputStreamFunc)(FuInputStream *stream,
+					  gsize size,
+					  gpointer user_data,
+					  GError **error);
+
+FuInputStream *
+fu_lazy_input_stream_new(FuInputStream *stream,
+			 gsize size,
+			 FuLazyInputStreamFunc func,
+			 gpointer user_data,
+			 GDestroyNotify user_data_free) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 3);
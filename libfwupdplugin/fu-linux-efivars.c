@@ -255,18 +255,20 @@ fu_linux_efivars_get_data(FuEfivars *efivars,
 	FuEfiVariableAttrs attr_tmp;
 	guint64 sz;
 	g_autofree gchar *fn = NULL;
-	g_autoptr(FuInputStream) istr = NULL;
+	g_autoptr(FuFileInputStream) istr = NULL;
+	g_autoptr(GFile) file = NULL;
 
 	/* open file as stream */
 	fn = fu_linux_efivars_get_filename(efivars, guid, name, error);
 	if (fn == NULL)
 		return FALSE;
-	istr = fu_input_stream_from_path(fn, error);
+	file = g_file_new_for_path(fn);
+	istr = fu_file_input_stream_from_file(file, NULL, error);
 	if (istr == NULL) {
 		fwupd_error_convert(error);
 		return FALSE;
 	}
-	sz = fu_file_input_stream_get_file_size(FU_FILE_INPUT_STREAM(istr), NULL, error);
+	sz = fu_file_input_stream_get_file_size(istr, NULL, error);
 	if (sz == 0 && error != NULL && *error != NULL) {
 		g_prefix_error_literal(error, "failed to get file size: ");
 		fwupd_error_convert(error);
@@ -283,7 +285,11 @@ fu_linux_efivars_get_data(FuEfivars *efivars,
 	}
 
 	/* read out the attributes */
-	attr_sz = fu_input_stream_read(istr, &attr_tmp, sizeof(attr_tmp), NULL, error);
+	attr_sz = fu_input_stream_read(FU_INPUT_STREAM(istr),
+				       &attr_tmp,
+				       sizeof(attr_tmp),
+				       NULL,
+				       error);
 	if (attr_sz == -1) {
 		g_prefix_error_literal(error, "failed to read attr: ");
 		fwupd_error_convert(error);
@@ -305,7 +311,12 @@ fu_linux_efivars_get_data(FuEfivars *efivars,
 		*data_sz = data_sz_tmp;
 	if (data != NULL) {
 		g_autofree guint8 *data_tmp = g_malloc0(data_sz_tmp);
-		if (!fu_input_stream_read_all(istr, data_tmp, data_sz_tmp, NULL, NULL, error)) {
+		if (!fu_input_stream_read_all(FU_INPUT_STREAM(istr),
+					      data_tmp,
+					      data_sz_tmp,
+					      NULL,
+					      NULL,
+					      error)) {
 			g_prefix_error_literal(error, "failed to read data: ");
 			return FALSE;
 		}
@@ -0,0 +1,431 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuLzmaInputStream"
+
+#include "config.h"
+
+#include <lzma.h>
+
+#include "fwupd-codec.h"
+
+#include "fu-lzma-input-stream.h"
+#include "fu-mem.h"
+
+/**
+ * FuLzmaInputStream:
+ *
+ * An input stream that decompresses a LZMA or XZ source #FuInputStream on demand.
+ *
+ * The decompressed data is only produced when it is read, and each decoded window is kept in
+ * memory so that parsing and then checksumming the same image does not decode it twice.
+ * If the uncompressed data is larger than 64MiB then only the most recently decoded windows are
+ * kept, and seeking backwards before those restarts the decoder from the beginning.
+ *
+ * The uncompressed size is taken from the header of `.lzma` files, and for `.xz` files, or
+ * when the header does not specify it, the whole stream is decoded once when created.
+ *
+ * NOTE: like #FuLazyInputStream, this stream is not thread safe.
+ */
+
+#define FU_LZMA_INPUT_STREAM_WINDOW_SIZE 0x40000
+#define FU_LZMA_INPUT_STREAM_WINDOWS_MAX 256 /* 64MiB */
+#define FU_LZMA_INPUT_STREAM_INBUF_SIZE	 0x10000
+
+typedef struct {
+	gsize offset;
+	gsize len;
+	guint8 *buf; /* of FU_LZMA_INPUT_STREAM_WINDOW_SIZE */
+} FuLzmaInputStreamWindow;
+
+struct _FuLzmaInputStream {
+	FuInputStream parent_instance;
+	FuInputStream *source; /* compressed */
+	gsize source_size;
+	gsize source_pos;
+	guint64 memlimit;
+	lzma_stream strm;
+	guint8 *inbuf;
+	gsize decoded; /* offset of the next window to be decoded */
+	gboolean eof;
+	GPtrArray *windows; /* of FuLzmaInputStreamWindow */
+	guint windows_idx; /* the next window to be replaced once full */
+	guint restarts;
+	gsize size;
+	goffset pos;
+};
+
+static void
+fu_lzma_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuLzmaInputStream,
+			fu_lzma_input_stream,
+			FU_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+					      fu_lzma_input_stream_codec_iface_init))
+
+static void
+fu_lzma_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuLzmaInputStream *self = FU_LZMA_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "Size", self->size);
+	fwupd_codec_string_append_hex(str, idt, "Decoded", self->decoded);
+	fwupd_codec_string_append_int(str, idt, "Windows", self->windows->len);
+	fwupd_codec_string_append_int(str, idt, "Restarts", self->restarts);
+}
+
+static void
+fu_lzma_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_lzma_input_stream_add_string;
+}
+
+static void
+fu_lzma_input_stream_window_free(FuLzmaInputStreamWindow *window)
+{
+	g_free(window->buf);
+	g_free(window);
+}
+
+/* the cached windows are still valid as the decoded data is always the same */
+static gboolean
+fu_lzma_input_stream_restart(FuLzmaInputStream *self, GError **error)
+{
+	lzma_ret rc;
+
+	lzma_end(&self->strm);
+	self->strm = (lzma_stream)LZMA_STREAM_INIT;
+	self->source_pos = 0;
+	self->decoded = 0;
+	self->eof = FALSE;
+	rc = lzma_auto_decoder(&self->strm, self->memlimit, LZMA_TELL_UNSUPPORTED_CHECK);
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to set up LZMA decoder rc=%u",
+			    rc);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static FuLzmaInputStreamWindow *
+fu_lzma_input_stream_decode_window(FuLzmaInputStream *self, GError **error)
+{
+	FuLzmaInputStreamWindow *window;
+
+	/* keep everything until the cache is full, and then replace the oldest window */
+	if (self->windows->len < FU_LZMA_INPUT_STREAM_WINDOWS_MAX) {
+		window = g_new0(FuLzmaInputStreamWindow, 1);
+		window->buf = g_malloc(FU_LZMA_INPUT_STREAM_WINDOW_SIZE);
+		g_ptr_array_add(self->windows, window);
+	} else {
+		window = g_ptr_array_index(self->windows, self->windows_idx);
+		self->windows_idx = (self->windows_idx + 1) % FU_LZMA_INPUT_STREAM_WINDOWS_MAX;
+	}
+	window->offset = self->decoded;
+	window->len = 0;
+	self->strm.next_out = window->buf;
+	self->strm.avail_out = FU_LZMA_INPUT_STREAM_WINDOW_SIZE;
+	while (self->strm.avail_out > 0) {
+		lzma_ret rc;
+
+		/* refill from the source */
+		if (self->strm.avail_in == 0 && self->source_pos < self->source_size) {
+			gsize count = MIN(FU_LZMA_INPUT_STREAM_INBUF_SIZE,
+					  self->source_size - self->source_pos);
+			if (!fu_input_stream_read_safe(self->source,
+						       self->inbuf,
+						       FU_LZMA_INPUT_STREAM_INBUF_SIZE,
+						       0x0,
+						       self->source_pos,
+						       count,
+						       error))
+				return NULL;
+			self->strm.next_in = self->inbuf;
+			self->strm.avail_in = count;
+			self->source_pos += count;
+		}
+		rc = lzma_code(&self->strm,
+			       self->source_pos < self->source_size ? LZMA_RUN : LZMA_FINISH);
+		if (rc == LZMA_STREAM_END) {
+			self->eof = TRUE;
+			break;
+		}
+		if (rc != LZMA_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to decode LZMA data rc=%u",
+				    rc);
+			return NULL;
+		}
+	}
+
+	/* success */
+	window->len = FU_LZMA_INPUT_STREAM_WINDOW_SIZE - self->strm.avail_out;
+	self->decoded += window->len;
+	return window;
+}
+
+static FuLzmaInputStreamWindow *
+fu_lzma_input_stream_find_window(FuLzmaInputStream *self, gsize offset)
+{
+	for (guint i = 0; i < self->windows->len; i++) {
+		FuLzmaInputStreamWindow *window = g_ptr_array_index(self->windows, i);
+		if (offset >= window->offset && offset < window->offset + window->len)
+			return window;
+	}
+	return NULL;
+}
+
+/* decode up to the window with the data, going back to the start if required */
+static FuLzmaInputStreamWindow *
+fu_lzma_input_stream_get_window(FuLzmaInputStream *self,
+				gsize offset,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuLzmaInputStreamWindow *window = fu_lzma_input_stream_find_window(self, offset);
+
+	if (window != NULL)
+		return window;
+	if (offset < self->decoded) {
+		g_debug("restarting decoder to read @0x%x", (guint)offset);
+		if (!fu_lzma_input_stream_restart(self, error))
+			return NULL;
+		self->restarts++;
+	}
+	while (TRUE) {
+		if (self->eof) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "LZMA data ended at 0x%x but expected 0x%x",
+				    (guint)self->decoded,
+				    (guint)self->size);
+			return NULL;
+		}
+		if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+			fwupd_error_convert(error);
+			return NULL;
+		}
+		window = fu_lzma_input_stream_decode_window(self, error);
+		if (window == NULL)
+			return NULL;
+		if (offset < window->offset + window->len)
+			return window;
+	}
+}
+
+static gssize
+fu_lzma_input_stream_read_fn(FuInputStream *stream,
+			     void *buffer,
+			     gsize count,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	FuLzmaInputStream *self = FU_LZMA_INPUT_STREAM(stream);
+	gsize done = 0;
+
+	/* the data may span multiple windows */
+	while (done < count && (gsize)self->pos < self->size) {
+		gsize offset = (gsize)self->pos;
+		gsize chunksz;
+		FuLzmaInputStreamWindow *window;
+
+		window = fu_lzma_input_stream_get_window(self, offset, cancellable, error);
+		if (window == NULL)
+			return -1;
+		chunksz = MIN(count - done, window->offset + window->len - offset);
+		chunksz = MIN(chunksz, self->size - offset);
+		if (!fu_memcpy_safe(buffer,
+				    count,
+				    done,
+				    window->buf,
+				    window->len,
+				    offset - window->offset,
+				    chunksz,
+				    error))
+			return -1;
+		done += chunksz;
+		self->pos += chunksz;
+	}
+	return (gssize)done;
+}
+
+static goffset
+fu_lzma_input_stream_tell(FuInputStream *stream)
+{
+	FuLzmaInputStream *self = FU_LZMA_INPUT_STREAM(stream);
+	return self->pos;
+}
+
+static gboolean
+fu_lzma_input_stream_can_seek(FuInputStream *stream)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_lzma_input_stream_seek(FuInputStream *stream,
+			  goffset offset,
+			  GSeekType type,
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	FuLzmaInputStream *self = FU_LZMA_INPUT_STREAM(stream);
+	goffset new_pos;
+
+	/* this does not decode anything until the next read */
+	switch (type) {
+	case G_SEEK_SET:
+		new_pos = offset;
+		break;
+	case G_SEEK_CUR:
+		new_pos = self->pos + offset;
+		break;
+	case G_SEEK_END:
+		new_pos = (goffset)self->size + offset;
+		break;
+	default:
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "unsupported seek type");
+		return FALSE;
+	}
+	if (new_pos < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot seek to negative offset %" G_GINT64_FORMAT,
+			    (gint64)new_pos);
+		return FALSE;
+	}
+	self->pos = new_pos;
+	return TRUE;
+}
+
+/* the .lzma header has the uncompressed size, which may be unknown */
+static gboolean
+fu_lzma_input_stream_ensure_size(FuLzmaInputStream *self, GError **error)
+{
+	const guint8 xz_magic[] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+	guint8 buf[13] = {0x0};
+	guint64 size = G_MAXUINT64;
+
+	if (self->source_size >= sizeof(buf)) {
+		if (!fu_input_stream_read_safe(self->source,
+					       buf,
+					       sizeof(buf),
+					       0x0,
+					       0x0,
+					       sizeof(buf),
+					       error))
+			return FALSE;
+		if (!fu_memcmp_safe(buf,
+				    sizeof(buf),
+				    0x0,
+				    xz_magic,
+				    sizeof(xz_magic),
+				    0x0,
+				    sizeof(xz_magic),
+				    NULL))
+			size = fu_memread_uint64(buf + 5, G_LITTLE_ENDIAN);
+	}
+	if (size != G_MAXUINT64) {
+		if (size > G_MAXSIZE) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "uncompressed size 0x%" G_GINT64_MODIFIER "x is too large",
+				    size);
+			return FALSE;
+		}
+		self->size = (gsize)size;
+		return TRUE;
+	}
+
+	/* decode everything once, which also fills the cache */
+	while (!self->eof) {
+		if (fu_lzma_input_stream_decode_window(self, error) == NULL)
+			return FALSE;
+	}
+	self->size = self->decoded;
+	return TRUE;
+}
+
+static void
+fu_lzma_input_stream_finalize(GObject *object)
+{
+	FuLzmaInputStream *self = FU_LZMA_INPUT_STREAM(object);
+	lzma_end(&self->strm);
+	g_ptr_array_unref(self->windows);
+	g_free(self->inbuf);
+	if (self->source != NULL)
+		g_object_unref(self->source);
+	G_OBJECT_CLASS(fu_lzma_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_lzma_input_stream_class_init(FuLzmaInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	FuInputStreamClass *istream_class = FU_INPUT_STREAM_CLASS(klass);
+	object_class->finalize = fu_lzma_input_stream_finalize;
+	istream_class->read_fn = fu_lzma_input_stream_read_fn;
+	istream_class->tell = fu_lzma_input_stream_tell;
+	istream_class->can_seek = fu_lzma_input_stream_can_seek;
+	istream_class->seek = fu_lzma_input_stream_seek;
+}
+
+static void
+fu_lzma_input_stream_init(FuLzmaInputStream *self)
+{
+	self->strm = (lzma_stream)LZMA_STREAM_INIT;
+	self->inbuf = g_malloc(FU_LZMA_INPUT_STREAM_INBUF_SIZE);
+	self->windows =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_lzma_input_stream_window_free);
+}
+
+/**
+ * fu_lzma_input_stream_new:
+ * @source: a #FuInputStream with LZMA or XZ compressed data
+ * @memlimit: decompression memory limit, in bytes
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates a new stream that decompresses data from @source as it is read, which means the
+ * uncompressed data does not all have to be in memory at the same time.
+ *
+ * Returns: (transfer full): a #FuInputStream, or %NULL on error
+ *
+ * Since: 2.1.8
+ **/
+FuInputStream *
+fu_lzma_input_stream_new(FuInputStream *source, guint64 memlimit, GError **error)
+{
+	g_autoptr(FuLzmaInputStream) self = g_object_new(FU_TYPE_LZMA_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(source), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	self->source = g_object_ref(source);
+	self->memlimit = memlimit;
+	if (!fu_input_stream_size(source, &self->source_size, error))
+		return NULL;
+	if (!fu_lzma_input_stream_restart(self, error))
+		return NULL;
+	if (!fu_lzma_input_stream_ensure_size(self, error))
+		return NULL;
+
+	/* fail early if the data cannot be decoded at all */
+	if (self->decoded == 0 && fu_lzma_input_stream_decode_window(self, error) == NULL)
+		return NULL;
+	return FU_INPUT_STREAM(g_steal_pointer(&self));
+}
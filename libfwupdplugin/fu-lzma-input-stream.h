@@ -0,0 +1,16 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-input-stream.h"
+
+#define FU_TYPE_LZMA_INPUT_STREAM (fu_lzma_input_stream_get_type())
+G_DECLARE_FINAL_TYPE(FuLzmaInputStream, fu_lzma_input_stream, FU, LZMA_INPUT_STREAM, FuInputStream)
+
+FuInputStream *
+fu_lzma_input_stream_new(FuInputStream *source, guint64 memlimit, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
@@ -7,6 +7,7 @@
 #include "config.h"
 
 #include <fwupdplugin.h>
+#include <lzma.h>
 
 static void
 fu_lzma_func(void)
@@ -40,10 +41,125 @@ fu_lzma_func(void)
 	g_assert_true(ret);
 }
 
+/* the legacy .lzma format used in EFI sections, which has the uncompressed size in the header */
+static GBytes *
+fu_lzma_compress_bytes_alone(GBytes *blob)
+{
+	lzma_options_lzma opts = {0};
+	lzma_stream strm = LZMA_STREAM_INIT;
+	gsize bufsz = g_bytes_get_size(blob) + 0x10000;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	lzma_ret rc;
+
+	g_assert_false(lzma_lzma_preset(&opts, 6));
+	rc = lzma_alone_encoder(&strm, &opts);
+	g_assert_cmpint(rc, ==, LZMA_OK);
+	strm.next_in = g_bytes_get_data(blob, NULL);
+	strm.avail_in = g_bytes_get_size(blob);
+	strm.next_out = buf;
+	strm.avail_out = bufsz;
+	rc = lzma_code(&strm, LZMA_FINISH);
+	g_assert_cmpint(rc, ==, LZMA_STREAM_END);
+	bufsz -= strm.avail_out;
+	lzma_end(&strm);
+
+	/* the encoder does not know the size, so the header says it is unknown */
+	fu_memwrite_uint64(buf + 5, g_bytes_get_size(blob), G_LITTLE_ENDIAN);
+	return g_bytes_new(buf, bufsz);
+}
+
+static void
+fu_lzma_input_stream_func(gconstpointer user_data)
+{
+	gboolean alone = GPOINTER_TO_INT(user_data);
+	gboolean ret;
+	gsize streamsz = 0;
+	guint8 buf[0x100] = {0x0};
+	g_autoptr(GByteArray) buf_in = g_byte_array_new();
+	g_autoptr(GBytes) blob_in = NULL;
+	g_autoptr(GBytes) blob_out = NULL;
+	g_autoptr(GBytes) blob_orig = NULL;
+	g_autoptr(FuInputStream) stream_comp = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* larger than one window, with data that depends on the offset */
+	for (guint32 i = 0; i < 0x180000; i += sizeof(i))
+		fu_byte_array_append_uint32(buf_in, i, G_LITTLE_ENDIAN);
+	blob_in = g_bytes_new(buf_in->data, buf_in->len);
+	if (alone) {
+		blob_out = fu_lzma_compress_bytes_alone(blob_in);
+	} else {
+		blob_out = fu_lzma_compress_bytes(blob_in, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_out);
+	}
+	stream_comp = fu_memory_input_stream_new_from_bytes(blob_out);
+	stream = fu_lzma_input_stream_new(stream_comp, 128 * FU_MB, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	ret = fu_input_stream_size(stream, &streamsz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(streamsz, ==, buf_in->len);
+
+	/* near the end, then back to the start which is still cached */
+	ret = fu_input_stream_read_safe(stream, buf, sizeof(buf), 0x0, 0x170000, 0x8, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_memread_uint32(buf, G_LITTLE_ENDIAN), ==, 0x170000);
+	g_assert_cmpint(fu_memread_uint32(buf + 4, G_LITTLE_ENDIAN), ==, 0x170004);
+	ret = fu_input_stream_read_safe(stream, buf, sizeof(buf), 0x0, 0x10, 0x4, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_memread_uint32(buf, G_LITTLE_ENDIAN), ==, 0x10);
+
+	/* across a window boundary */
+	ret = fu_input_stream_read_safe(stream, buf, sizeof(buf), 0x0, 0x3fffc, 0x8, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_memread_uint32(buf, G_LITTLE_ENDIAN), ==, 0x3fffc);
+	g_assert_cmpint(fu_memread_uint32(buf + 4, G_LITTLE_ENDIAN), ==, 0x40000);
+
+	/* past the end */
+	ret = fu_input_stream_read_safe(stream, buf, sizeof(buf), 0x0, 0x17fffc, 0x8, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* everything */
+	blob_orig = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_orig);
+	ret = fu_bytes_compare(blob_in, blob_orig, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_lzma_input_stream_invalid_func(void)
+{
+	g_autoptr(GBytes) blob = g_bytes_new_static("hello world, this is not LZMA", 29);
+	g_autoptr(FuInputStream) stream_comp = fu_memory_input_stream_new_from_bytes(blob);
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+
+	stream = fu_lzma_input_stream_new(stream_comp, 128 * FU_MB, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(stream);
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/lzma", fu_lzma_func);
+	g_test_add_data_func("/fwupd/lzma/input-stream{xz}",
+			     GINT_TO_POINTER(FALSE),
+			     fu_lzma_input_stream_func);
+	g_test_add_data_func("/fwupd/lzma/input-stream{lzma}",
+			     GINT_TO_POINTER(TRUE),
+			     fu_lzma_input_stream_func);
+	g_test_add_func("/fwupd/lzma/input-stream{invalid}", fu_lzma_input_stream_invalid_func);
 	return g_test_run();
 }
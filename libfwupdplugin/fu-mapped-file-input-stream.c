@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMappedFileInputStream"
+
+#include "config.h"
+
+#include "fu-mapped-file-input-stream.h"
+#include "fu-mem.h"
+
+/**
+ * FuMappedFileInputStream:
+ *
+ * An input stream for a local file that has been mapped into memory.
+ *
+ * Reading a #GBytes from this stream does not copy the data, and instead references the
+ * mapping. The seek semantics match #FuFileInputStream, so seeking past the end of the file is
+ * allowed and any reads from there return zero bytes.
+ *
+ * NOTE: the file must not be truncated while the stream, or any #GBytes read from it, is alive.
+ */
+struct _FuMappedFileInputStream {
+	FuInputStream parent_instance;
+	GBytes *bytes;
+	goffset pos;
+};
+
+G_DEFINE_TYPE(FuMappedFileInputStream, fu_mapped_file_input_stream, FU_TYPE_INPUT_STREAM)
+
+static gssize
+fu_mapped_file_input_stream_read_fn(FuInputStream *stream,
+				    void *buffer,
+				    gsize count,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	FuMappedFileInputStream *self = FU_MAPPED_FILE_INPUT_STREAM(stream);
+	gsize data_sz = 0;
+	const guint8 *data = g_bytes_get_data(self->bytes, &data_sz);
+
+	if ((gsize)self->pos >= data_sz)
+		return 0;
+	count = MIN(count, data_sz - (gsize)self->pos);
+	if (!fu_memcpy_safe(buffer, count, 0x0, data, data_sz, self->pos, count, error))
+		return -1;
+	self->pos += count;
+	return (gssize)count;
+}
+
+static GBytes *
+fu_mapped_file_input_stream_read_bytes(FuInputStream *stream,
+				       gsize offset,
+				       gsize count,
+				       GError **error)
+{
+	FuMappedFileInputStream *self = FU_MAPPED_FILE_INPUT_STREAM(stream);
+	gsize data_sz = g_bytes_get_size(self->bytes);
+
+	/* like read(), this is not an error */
+	self->pos = (goffset)offset;
+	if (offset >= data_sz)
+		return g_bytes_new(NULL, 0);
+	count = MIN(count, data_sz - offset);
+	self->pos += count;
+	return g_bytes_new_from_bytes(self->bytes, offset, count);
+}
+
+static goffset
+fu_mapped_file_input_stream_tell(FuInputStream *stream)
+{
+	FuMappedFileInputStream *self = FU_MAPPED_FILE_INPUT_STREAM(stream);
+	return self->pos;
+}
+
+static gboolean
+fu_mapped_file_input_stream_can_seek(FuInputStream *stream)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_mapped_file_input_stream_seek(FuInputStream *stream,
+				 goffset offset,
+				 GSeekType type,
+				 GCancellable *cancellable,
+				 GError **error)
+{
+	FuMappedFileInputStream *self = FU_MAPPED_FILE_INPUT_STREAM(stream);
+	goffset new_pos;
+
+	switch (type) {
+	case G_SEEK_SET:
+		new_pos = offset;
+		break;
+	case G_SEEK_CUR:
+		new_pos = self->pos + offset;
+		break;
+	case G_SEEK_END:
+		new_pos = (goffset)g_bytes_get_size(self->bytes) + offset;
+		break;
+	default:
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "unsupported seek type");
+		return FALSE;
+	}
+	if (new_pos < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot seek to negative offset %" G_GINT64_FORMAT,
+			    (gint64)new_pos);
+		return FALSE;
+	}
+	self->pos = new_pos;
+	return TRUE;
+}
+
+static void
+fu_mapped_file_input_stream_finalize(GObject *object)
+{
+	FuMappedFileInputStream *self = FU_MAPPED_FILE_INPUT_STREAM(object);
+	g_clear_pointer(&self->bytes, g_bytes_unref);
+	G_OBJECT_CLASS(fu_mapped_file_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_mapped_file_input_stream_class_init(FuMappedFileInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	FuInputStreamClass *istream_class = FU_INPUT_STREAM_CLASS(klass);
+	object_class->finalize = fu_mapped_file_input_stream_finalize;
+	istream_class->read_fn = fu_mapped_file_input_stream_read_fn;
+	istream_class->read_bytes = fu_mapped_file_input_stream_read_bytes;
+	istream_class->tell = fu_mapped_file_input_stream_tell;
+	istream_class->can_seek = fu_mapped_file_input_stream_can_seek;
+	istream_class->seek = fu_mapped_file_input_stream_seek;
+}
+
+static void
+fu_mapped_file_input_stream_init(FuMappedFileInputStream *self)
+{
+}
+
+/**
+ * fu_mapped_file_input_stream_new:
+ * @path: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Maps a local file into memory, which fails if the file is empty or the filesystem does not
+ * support mapping, e.g. for sysfs attributes.
+ *
+ * Returns: (transfer full): a #FuInputStream, or %NULL on error
+ *
+ * Since: 2.1.8
+ **/
+FuInputStream *
+fu_mapped_file_input_stream_new(const gchar *path, GError **error)
+{
+	g_autoptr(FuMappedFileInputStream) self = NULL;
+	g_autoptr(GMappedFile) mapped_file = NULL;
+
+	g_return_val_if_fail(path != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	mapped_file = g_mapped_file_new(path, FALSE, error);
+	if (mapped_file == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	if (g_mapped_file_get_length(mapped_file) == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot map zero-sized file %s",
+			    path);
+		return NULL;
+	}
+	self = g_object_new(FU_TYPE_MAPPED_FILE_INPUT_STREAM, NULL);
+	self->bytes = g_mapped_file_get_bytes(mapped_file);
+	return FU_INPUT_STREAM(g_steal_pointer(&self));
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-input-stream.h"
+
+#define FU_TYPE_MAPPED_FILE_INPUT_STREAM (fu_mapped_file_input_stream_get_type())
+G_DECLARE_FINAL_TYPE(FuMappedFileInputStream,
+		     fu_mapped_file_input_stream,
+		     FU,
+		     MAPPED_FILE_INPUT_STREAM,
+		     FuInputStream)
+
+FuInputStream *
+fu_mapped_file_input_stream_new(const gchar *path, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
@@ -109,6 +109,22 @@ fu_memory_input_stream_seek(FuInputStream *stream,
 	return TRUE;
 }
 
+static GBytes *
+fu_memory_input_stream_read_bytes(FuInputStream *stream,
+				  gsize offset,
+				  gsize count,
+				  GError **error)
+{
+	FuMemoryInputStream *self = FU_MEMORY_INPUT_STREAM(stream);
+	gsize data_sz = g_bytes_get_size(self->bytes);
+
+	if (!fu_memory_input_stream_seek(stream, (goffset)offset, G_SEEK_SET, NULL, error))
+		return NULL;
+	count = MIN(count, data_sz - self->pos);
+	self->pos += count;
+	return g_bytes_new_from_bytes(self->bytes, offset, count);
+}
+
 static void
 fu_memory_input_stream_finalize(GObject *object)
 {
@@ -124,6 +140,7 @@ fu_memory_input_stream_class_init(FuMemoryInputStreamClass *klass)
 	FuInputStreamClass *istream_class = FU_INPUT_STREAM_CLASS(klass);
 	object_class->finalize = fu_memory_input_stream_finalize;
 	istream_class->read_fn = fu_memory_input_stream_read_fn;
+	istream_class->read_bytes = fu_memory_input_stream_read_bytes;
 	istream_class->tell = fu_memory_input_stream_tell;
 	istream_class->can_seek = fu_memory_input_stream_can_seek;
 	istream_class->seek = fu_memory_input_stream_seek;
@@ -106,7 +106,7 @@ fu_partial_input_stream_func(void)
 	g_autoptr(FuInputStream) stream_file = NULL;
 	g_autoptr(FuInputStream) stream = NULL;
 
-	/* check the behavior of FuFileInputStream */
+	/* check the behavior of a local file */
 	fn = g_test_build_filename(G_TEST_DIST, "tests", "dfu.builder.xml", NULL);
 	g_assert_nonnull(fn);
 	stream_file = fu_input_stream_from_path(fn, &error);
@@ -225,6 +225,30 @@ fu_partial_input_stream_read_fn(FuInputStream *stream,
 	return fu_input_stream_read(self->base_stream, buffer, count, cancellable, error);
 }
 
+static GBytes *
+fu_partial_input_stream_read_bytes(FuInputStream *stream,
+				   gsize offset,
+				   gsize count,
+				   GError **error)
+{
+	FuPartialInputStream *self = FU_PARTIAL_INPUT_STREAM(stream);
+	if (offset > self->size) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "base stream is outside seekable range");
+		return NULL;
+	}
+	count = MIN(count, self->size - offset);
+	if (count == 0)
+		return g_bytes_new(NULL, 0);
+	return fu_input_stream_read_bytes(self->base_stream,
+					  self->offset + offset,
+					  count,
+					  NULL,
+					  error);
+}
+
 static void
 fu_partial_input_stream_finalize(GObject *object)
 {
@@ -240,6 +264,7 @@ fu_partial_input_stream_class_init(FuPartialInputStreamClass *klass)
 	GObjectClass *object_class = G_OBJECT_CLASS(klass);
 	FuInputStreamClass *istream_class = FU_INPUT_STREAM_CLASS(klass);
 	istream_class->read_fn = fu_partial_input_stream_read_fn;
+	istream_class->read_bytes = fu_partial_input_stream_read_bytes;
 	istream_class->tell = fu_partial_input_stream_tell;
 	istream_class->can_seek = fu_partial_input_stream_can_seek;
 	istream_class->seek = fu_partial_input_stream_seek;
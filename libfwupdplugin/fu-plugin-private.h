@@ -160,6 +160,8 @@ fu_plugin_runner_reboot_cleanup(FuPlugin *self,
 void
 fu_plugin_runner_add_security_attrs(FuPlugin *self, FuSecurityAttrs *attrs) G_GNUC_NON_NULL(1, 2);
 gboolean
+fu_plugin_has_add_security_attrs(FuPlugin *self) G_GNUC_NON_NULL(1);
+gboolean
 fu_plugin_runner_modify_config(FuPlugin *self, const gchar *key, const gchar *value, GError **error)
     G_GNUC_NON_NULL(1, 2, 3);
 gint
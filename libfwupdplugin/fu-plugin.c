@@ -1655,6 +1655,24 @@ fu_plugin_runner_add_security_attrs(FuPlugin *self, FuSecurityAttrs *attrs)
 	vfuncs->add_security_attrs(self, attrs);
 }
 
+/**
+ * fu_plugin_has_add_security_attrs:
+ * @self: a #FuPlugin
+ *
+ * Gets if the plugin implements the `add_security_attrs()` routine.
+ *
+ * Returns: %TRUE if fu_plugin_runner_add_security_attrs() might add attributes
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fu_plugin_has_add_security_attrs(FuPlugin *self)
+{
+	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), FALSE);
+	return vfuncs->add_security_attrs != NULL;
+}
+
 /**
  * fu_plugin_add_device_gtype:
  * @self: a #FuPlugin
@@ -10,3 +10,5 @@
 
 gdouble
 fu_progress_get_global_fraction(FuProgress *self) G_GNUC_NON_NULL(1);
+void
+fu_progress_set_step_duration(FuProgress *self, guint idx, gdouble duration) G_GNUC_NON_NULL(1);
@@ -333,6 +333,27 @@ fu_progress_child_finished(void)
 	fu_progress_step_done(progress);
 }
 
+static void
+fu_progress_step_duration_func(void)
+{
+	FuProgress *child;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	fu_progress_set_profile(progress, TRUE);
+	fu_progress_set_steps(progress, 2);
+
+	/* not done yet, so ignored */
+	fu_progress_set_step_duration(progress, 0, 1.5f);
+	child = fu_progress_get_child(progress);
+	g_assert_cmpfloat_with_epsilon(fu_progress_get_duration(child), 0.f, 0.001);
+
+	/* work was done elsewhere */
+	fu_progress_step_done(progress);
+	fu_progress_set_step_duration(progress, 0, 1.5f);
+	g_assert_cmpfloat_with_epsilon(fu_progress_get_duration(child), 1.5f, 0.001);
+	fu_progress_step_done(progress);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -348,5 +369,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/progress/no-equal", fu_progress_non_equal_steps_func);
 	g_test_add_func("/fwupd/progress/finish", fu_progress_finish_func);
 	g_test_add_func("/fwupd/progress/global-fraction", fu_progress_global_fraction_func);
+	g_test_add_func("/fwupd/progress/step-duration", fu_progress_step_duration_func);
 	return g_test_run();
 }
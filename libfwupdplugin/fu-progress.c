@@ -958,6 +958,34 @@ fu_progress_step_done(FuProgress *self)
 		fu_progress_show_profile(self);
 }
 
+/**
+ * fu_progress_set_step_duration:
+ * @self: A #FuProgress
+ * @idx: the step index, which must already be done
+ * @duration: the duration in seconds
+ *
+ * Overrides the profiled duration of a completed step, which is useful when the work for the step
+ * was actually done on a worker thread and the parent timer only measured the time to collect the
+ * result.
+ *
+ * Since: 2.1.8
+ **/
+void
+fu_progress_set_step_duration(FuProgress *self, guint idx, gdouble duration)
+{
+	FuProgress *child;
+
+	g_return_if_fail(FU_IS_PROGRESS(self));
+
+	/* only use the timer if profiling */
+	if (!self->profile)
+		return;
+	if (idx >= self->step_now || idx >= self->children->len)
+		return;
+	child = g_ptr_array_index(self->children, idx);
+	fu_progress_set_duration(child, duration);
+}
+
 /**
  * fu_progress_sleep:
  * @self: a #FuProgress
@@ -143,6 +143,67 @@ fu_quirks_performance_func(void)
 	g_debug("lookup=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
 }
 
+static void
+fu_quirks_performance_index_func(void)
+{
+	gboolean ret;
+	const gchar *tmp;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *guid = fwupd_guid_hash_string("USB\\VID_8086");
+	g_autofree gchar *testdatadir = NULL;
+	g_autofree gchar *testdatadir_quirks = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuQuirks) quirks1 = fu_quirks_new(ctx);
+	g_autoptr(FuQuirks) quirks2 = fu_quirks_new(ctx);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(GError) error = NULL;
+	const gchar *keys[] = {"Name", "Children", "Flags", NULL};
+
+	tmpdir = fu_temporary_directory_new("quirks-index", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+
+	/* set up test harness */
+	testdatadir = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	testdatadir_quirks = g_test_build_filename(G_TEST_DIST, "tests", "quirks.d", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_VENDOR_IDS, testdatadir);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_QUIRKS, testdatadir_quirks);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+
+	/* generate the index */
+	ret = fu_quirks_load(quirks1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_debug("generate=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	fn = fu_temporary_directory_build(tmpdir, "quirks.idx", NULL);
+	g_assert_true(g_file_test(fn, G_FILE_TEST_EXISTS));
+
+	/* reuse the index like another process would */
+	g_timer_reset(timer);
+	ret = fu_quirks_load(quirks2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_debug("load=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* from both the quirk files and the vendor IDs */
+	tmp = fu_quirks_lookup_by_id(quirks2, guid, FWUPD_RESULT_KEY_VENDOR);
+	g_assert_cmpstr(tmp, ==, "Intel Corp.");
+	tmp = fu_quirks_lookup_by_id(quirks2, guid, "NotGoingToExist");
+	g_assert_cmpstr(tmp, ==, NULL);
+
+	/* lookup */
+	g_timer_reset(timer);
+	for (guint j = 0; j < 1000; j++) {
+		const gchar *group = "bb9ec3e2-77b3-53bc-a1f1-b05916715627";
+		for (guint i = 0; keys[i] != NULL; i++) {
+			tmp = fu_quirks_lookup_by_id(quirks2, group, keys[i]);
+			g_assert_cmpstr(tmp, !=, NULL);
+		}
+	}
+	g_debug("lookup=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -151,5 +212,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/quirks/append", fu_quirks_append_func);
 	g_test_add_func("/fwupd/quirks/vendor-ids", fu_quirks_vendor_ids_func);
 	g_test_add_func("/fwupd/quirks/performance", fu_quirks_performance_func);
+	g_test_add_func("/fwupd/quirks/performance{index}", fu_quirks_performance_index_func);
 	return g_test_run();
 }
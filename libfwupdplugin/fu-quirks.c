@@ -19,11 +19,15 @@
 #include "fwupd-enums-private.h"
 #include "fwupd-error.h"
 
+#include "fu-byte-array.h"
+#include "fu-bytes.h"
 #include "fu-context-private.h"
 #include "fu-input-stream.h"
+#include "fu-mem.h"
 #include "fu-memory-input-stream.h"
 #include "fu-path-store.h"
 #include "fu-path.h"
+#include "fu-quirks-struct.h"
 #include "fu-quirks.h"
 #include "fu-string.h"
 
@@ -53,6 +57,10 @@
  *
  * You can add quirk files in `/usr/share/fwupd/quirks.d` or `/var/lib/fwupd/quirks.d/`.
  *
+ * The quirk files and the vendor ID database are also compiled into a small hashed index in the
+ * cache directory, which is mapped into memory by both the daemon and `fwupdtool` so that the
+ * lookups do not need an XPath query or SQL statement.
+ *
  * Here is an example as seen in the CSR plugin:
  *
  * |[
@@ -82,8 +90,17 @@ struct _FuQuirks {
 	XbQuery *query_vs;
 	gboolean verbose;
 	gboolean loaded;
+	GMappedFile *index_mmap;
+	const guint8 *index_buf; /* (nullable), points into @index_mmap */
+	guint32 index_buckets;
+	guint32 index_entries;
+	gsize index_entries_offset;
+	gsize index_strtab_offset;
+	guint32 index_strtab_size;
+	GRecMutex mutex; /* devices can be probed from worker threads */
 #ifdef HAVE_SQLITE
 	sqlite3 *db;
+	gchar *db_mtimes;
 #endif
 };
 
@@ -356,6 +373,461 @@ fu_quirks_strcasecmp_cb(gconstpointer a, gconstpointer b)
 	return g_ascii_strcasecmp(entry1, entry2);
 }
 
+/* FNV-1a, as the hash has to be stable between processes and versions */
+static guint32
+fu_quirks_index_hash(const gchar *str)
+{
+	guint32 hash = 2166136261u;
+	for (gsize i = 0; str[i] != '\0'; i++) {
+		hash ^= (guint8)str[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static gchar *
+fu_quirks_index_build_source_key(FuQuirks *self)
+{
+	g_autoptr(GString) str = g_string_new(xb_silo_get_guid(self->silo));
+#ifdef HAVE_SQLITE
+	if (self->db_mtimes != NULL)
+		g_string_append_printf(str, ";%s", self->db_mtimes);
+#endif
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
+static void
+fu_quirks_index_clear(FuQuirks *self)
+{
+	self->index_buf = NULL;
+	self->index_buckets = 0;
+	self->index_entries = 0;
+	g_clear_pointer(&self->index_mmap, g_mapped_file_unref);
+}
+
+static guint32
+fu_quirks_index_get_bucket(FuQuirks *self, guint32 idx)
+{
+	return fu_memread_uint32(self->index_buf + FU_STRUCT_QUIRKS_INDEX_HDR_SIZE + (idx * 4),
+				 G_LITTLE_ENDIAN);
+}
+
+static guint32
+fu_quirks_index_get_entry(FuQuirks *self, guint32 idx, gsize offset)
+{
+	return fu_memread_uint32(self->index_buf + self->index_entries_offset +
+				     (idx * FU_STRUCT_QUIRKS_INDEX_ENTRY_SIZE) + offset,
+				 G_LITTLE_ENDIAN);
+}
+
+static const gchar *
+fu_quirks_index_get_str(FuQuirks *self, guint32 offset)
+{
+	if (offset >= self->index_strtab_size)
+		return NULL;
+	return (const gchar *)self->index_buf + self->index_strtab_offset + offset;
+}
+
+static const gchar *
+fu_quirks_index_get_entry_str(FuQuirks *self, guint32 idx, gsize offset)
+{
+	return fu_quirks_index_get_str(self, fu_quirks_index_get_entry(self, idx, offset));
+}
+
+static gboolean
+fu_quirks_index_load(FuQuirks *self, const gchar *filename, const gchar *source_key, GError **error)
+{
+	const guint8 *buf;
+	gsize bufsz;
+	gsize offset;
+	guint32 bucket_last = 0;
+	g_autoptr(FuStructQuirksIndexHdr) st_hdr = NULL;
+	g_autoptr(GMappedFile) mmap = NULL;
+
+	mmap = g_mapped_file_new(filename, FALSE, error);
+	if (mmap == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	buf = (const guint8 *)g_mapped_file_get_contents(mmap);
+	bufsz = g_mapped_file_get_length(mmap);
+	st_hdr = fu_struct_quirks_index_hdr_parse(buf, bufsz, 0x0, error);
+	if (st_hdr == NULL)
+		return FALSE;
+
+	/* check the sections all fit in the file */
+	self->index_buckets = fu_struct_quirks_index_hdr_get_buckets(st_hdr);
+	self->index_entries = fu_struct_quirks_index_hdr_get_entries(st_hdr);
+	self->index_strtab_size = fu_struct_quirks_index_hdr_get_strtab_size(st_hdr);
+	offset = FU_STRUCT_QUIRKS_INDEX_HDR_SIZE + (((gsize)self->index_buckets + 1) * 4);
+	self->index_entries_offset = offset;
+	offset += (gsize)self->index_entries * FU_STRUCT_QUIRKS_INDEX_ENTRY_SIZE;
+	self->index_strtab_offset = offset;
+	offset += self->index_strtab_size;
+	if (self->index_buckets == 0 || self->index_strtab_size == 0 || offset != bufsz ||
+	    buf[bufsz - 1] != '\0') {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "index size invalid, got 0x%x bytes",
+			    (guint)bufsz);
+		fu_quirks_index_clear(self);
+		return FALSE;
+	}
+	self->index_buf = buf;
+
+	/* each bucket has to point inside the entries */
+	for (guint32 i = 0; i <= self->index_buckets; i++) {
+		guint32 bucket = fu_quirks_index_get_bucket(self, i);
+		if (bucket < bucket_last || bucket > self->index_entries) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "bucket 0x%x invalid",
+				    i);
+			fu_quirks_index_clear(self);
+			return FALSE;
+		}
+		bucket_last = bucket;
+	}
+	if (bucket_last != self->index_entries) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "buckets do not cover all entries");
+		fu_quirks_index_clear(self);
+		return FALSE;
+	}
+
+	/* generated from different sources */
+	if (g_strcmp0(fu_quirks_index_get_str(self,
+					      fu_struct_quirks_index_hdr_get_source_key(st_hdr)),
+		      source_key) != 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "index out of date");
+		fu_quirks_index_clear(self);
+		return FALSE;
+	}
+
+	/* success */
+	self->index_mmap = g_steal_pointer(&mmap);
+	return TRUE;
+}
+
+typedef struct {
+	guint32 hash;
+	guint32 guid;
+	guint32 key;
+	guint32 value;
+	FuContextQuirkSource source;
+} FuQuirksIndexItem;
+
+typedef struct {
+	GArray *items;	   /* of FuQuirksIndexItem */
+	GByteArray *strtab;
+	GHashTable *strtab_offsets; /* str:offset */
+} FuQuirksIndexHelper;
+
+static guint32
+fu_quirks_index_helper_add_str(FuQuirksIndexHelper *helper, const gchar *str)
+{
+	gpointer offset_ptr = NULL;
+	guint32 offset;
+
+	if (g_hash_table_lookup_extended(helper->strtab_offsets, str, NULL, &offset_ptr))
+		return GPOINTER_TO_UINT(offset_ptr);
+	offset = helper->strtab->len;
+	g_byte_array_append(helper->strtab, (const guint8 *)str, strlen(str) + 1);
+	g_hash_table_insert(helper->strtab_offsets, g_strdup(str), GUINT_TO_POINTER(offset));
+	return offset;
+}
+
+static void
+fu_quirks_index_helper_add_item(FuQuirksIndexHelper *helper,
+				const gchar *guid,
+				const gchar *key,
+				const gchar *value,
+				FuContextQuirkSource source)
+{
+	FuQuirksIndexItem item = {
+	    .hash = fu_quirks_index_hash(guid),
+	    .guid = fu_quirks_index_helper_add_str(helper, guid),
+	    .key = fu_quirks_index_helper_add_str(helper, key),
+	    .value = value != NULL ? fu_quirks_index_helper_add_str(helper, value) : G_MAXUINT32,
+	    .source = source,
+	};
+	g_array_append_val(helper->items, item);
+}
+
+static gboolean
+fu_quirks_index_helper_add_silo(FuQuirksIndexHelper *helper, FuQuirks *self, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	devices = xb_silo_query(self->silo, "quirk/device", 0, &error_local);
+	if (devices == NULL) {
+		if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+			return TRUE;
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	for (guint i = 0; i < devices->len; i++) {
+		XbNode *n = g_ptr_array_index(devices, i);
+		const gchar *guid = xb_node_get_attr(n, "id");
+		g_autoptr(GPtrArray) values = xb_node_get_children(n);
+
+		if (guid == NULL)
+			continue;
+		for (guint j = 0; j < values->len; j++) {
+			XbNode *c = g_ptr_array_index(values, j);
+			const gchar *key = xb_node_get_attr(c, "key");
+			if (key == NULL)
+				continue;
+			fu_quirks_index_helper_add_item(helper,
+							guid,
+							key,
+							xb_node_get_text(c),
+							FU_CONTEXT_QUIRK_SOURCE_FILE);
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
+#ifdef HAVE_SQLITE
+static gboolean
+fu_quirks_index_helper_add_db(FuQuirksIndexHelper *helper, FuQuirks *self, GError **error)
+{
+	g_autoptr(sqlite3_stmt) stmt = NULL;
+
+	if (self->db == NULL)
+		return TRUE;
+	if (sqlite3_prepare_v2(self->db,
+			       "SELECT guid, key, value FROM quirks",
+			       -1,
+			       &stmt,
+			       NULL) != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed to prepare SQL: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		const gchar *guid = (const gchar *)sqlite3_column_text(stmt, 0);
+		const gchar *key = (const gchar *)sqlite3_column_text(stmt, 1);
+		const gchar *value = (const gchar *)sqlite3_column_text(stmt, 2);
+		if (guid == NULL || key == NULL)
+			continue;
+		fu_quirks_index_helper_add_item(helper,
+						guid,
+						key,
+						value,
+						FU_CONTEXT_QUIRK_SOURCE_DB);
+	}
+
+	/* success */
+	return TRUE;
+}
+#endif
+
+static GBytes *
+fu_quirks_index_build(FuQuirks *self, const gchar *source_key, GError **error)
+{
+	guint32 buckets = 1;
+	guint32 source_key_offset;
+	g_autofree guint32 *bucket_offsets = NULL;
+	g_autofree guint32 *bucket_fill = NULL;
+	g_autofree guint32 *order = NULL;
+	g_autoptr(FuStructQuirksIndexHdr) st_hdr = fu_struct_quirks_index_hdr_new();
+	g_autoptr(GArray) items = g_array_new(FALSE, FALSE, sizeof(FuQuirksIndexItem));
+	g_autoptr(GByteArray) strtab = g_byte_array_new();
+	g_autoptr(GHashTable) strtab_offsets =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	FuQuirksIndexHelper helper = {
+	    .items = items,
+	    .strtab = strtab,
+	    .strtab_offsets = strtab_offsets,
+	};
+
+	/* the database entries take priority over the quirk files */
+	source_key_offset = fu_quirks_index_helper_add_str(&helper, source_key);
+#ifdef HAVE_SQLITE
+	if (!fu_quirks_index_helper_add_db(&helper, self, error))
+		return NULL;
+#endif
+	if (!fu_quirks_index_helper_add_silo(&helper, self, error))
+		return NULL;
+
+	/* a power of two means the bucket can be found using a mask */
+	while (buckets < items->len && buckets < G_MAXUINT32 / 2)
+		buckets <<= 1;
+
+	/* counting sort into buckets, which keeps the insertion order in each bucket */
+	bucket_offsets = g_new0(guint32, (gsize)buckets + 1);
+	bucket_fill = g_new0(guint32, buckets);
+	order = g_new0(guint32, MAX(items->len, 1));
+	for (guint i = 0; i < items->len; i++) {
+		FuQuirksIndexItem *item = &g_array_index(items, FuQuirksIndexItem, i);
+		bucket_offsets[(item->hash & (buckets - 1)) + 1]++;
+	}
+	for (guint32 i = 0; i < buckets; i++)
+		bucket_offsets[i + 1] += bucket_offsets[i];
+	for (guint i = 0; i < items->len; i++) {
+		FuQuirksIndexItem *item = &g_array_index(items, FuQuirksIndexItem, i);
+		guint32 bucket = item->hash & (buckets - 1);
+		order[bucket_offsets[bucket] + bucket_fill[bucket]++] = i;
+	}
+
+	/* header */
+	fu_struct_quirks_index_hdr_set_source_key(st_hdr, source_key_offset);
+	fu_struct_quirks_index_hdr_set_buckets(st_hdr, buckets);
+	fu_struct_quirks_index_hdr_set_entries(st_hdr, items->len);
+	fu_struct_quirks_index_hdr_set_strtab_size(st_hdr, strtab->len);
+
+	/* buckets */
+	for (guint32 i = 0; i <= buckets; i++)
+		fu_byte_array_append_uint32(st_hdr->buf, bucket_offsets[i], G_LITTLE_ENDIAN);
+
+	/* entries */
+	for (guint i = 0; i < items->len; i++) {
+		FuQuirksIndexItem *item = &g_array_index(items, FuQuirksIndexItem, order[i]);
+		g_autoptr(FuStructQuirksIndexEntry) st_ent = fu_struct_quirks_index_entry_new();
+		fu_struct_quirks_index_entry_set_hash(st_ent, item->hash);
+		fu_struct_quirks_index_entry_set_guid(st_ent, item->guid);
+		fu_struct_quirks_index_entry_set_key(st_ent, item->key);
+		fu_struct_quirks_index_entry_set_value(st_ent, item->value);
+		fu_struct_quirks_index_entry_set_source(st_ent, item->source);
+		g_byte_array_append(st_hdr->buf, st_ent->buf->data, st_ent->buf->len);
+	}
+
+	/* strings */
+	g_byte_array_append(st_hdr->buf, strtab->data, strtab->len);
+	g_debug("quirk index has %u entries in %u buckets", items->len, buckets);
+	return g_bytes_new(st_hdr->buf->data, st_hdr->buf->len);
+}
+
+static gboolean
+fu_quirks_index_ensure(FuQuirks *self, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *source_key = fu_quirks_index_build_source_key(self);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	filename = fu_context_build_filename(self->ctx,
+					     error,
+					     FU_PATH_KIND_CACHEDIR_PKG,
+					     "quirks.idx",
+					     NULL);
+	if (filename == NULL)
+		return FALSE;
+
+	/* try to use the index created by either the daemon or fwupdtool */
+	if (fu_quirks_index_load(self, filename, source_key, &error_local))
+		return TRUE;
+	g_debug("ignoring %s: %s", filename, error_local->message);
+	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_READONLY_FS)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "cannot regenerate index on read-only filesystem");
+		return FALSE;
+	}
+
+	/* this is written atomically, so existing mappings remain valid */
+	blob = fu_quirks_index_build(self, source_key, error);
+	if (blob == NULL)
+		return FALSE;
+	if (!fu_bytes_set_contents(filename, blob, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return fu_quirks_index_load(self, filename, source_key, error);
+}
+
+static const gchar *
+fu_quirks_index_lookup(FuQuirks *self, const gchar *guid, const gchar *key)
+{
+	guint32 hash = fu_quirks_index_hash(guid);
+	guint32 bucket = hash & (self->index_buckets - 1);
+	guint32 idx_end = fu_quirks_index_get_bucket(self, bucket + 1);
+
+	for (guint32 i = fu_quirks_index_get_bucket(self, bucket); i < idx_end; i++) {
+		const gchar *guid_tmp;
+		const gchar *key_tmp;
+
+		if (fu_quirks_index_get_entry(self, i, FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_HASH) !=
+		    hash)
+			continue;
+		key_tmp =
+		    fu_quirks_index_get_entry_str(self, i, FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_KEY);
+		if (g_strcmp0(key_tmp, key) != 0)
+			continue;
+		guid_tmp = fu_quirks_index_get_entry_str(self,
+							 i,
+							 FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_GUID);
+		if (g_strcmp0(guid_tmp, guid) != 0)
+			continue;
+		return fu_quirks_index_get_entry_str(self,
+						     i,
+						     FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_VALUE);
+	}
+	return NULL;
+}
+
+static gboolean
+fu_quirks_index_lookup_iter(FuQuirks *self,
+			    const gchar *guid,
+			    const gchar *key,
+			    FuQuirksIter iter_cb,
+			    gpointer user_data)
+{
+	gboolean found = FALSE;
+	guint32 hash = fu_quirks_index_hash(guid);
+	guint32 bucket = hash & (self->index_buckets - 1);
+	guint32 idx_end = fu_quirks_index_get_bucket(self, bucket + 1);
+
+	for (guint32 i = fu_quirks_index_get_bucket(self, bucket); i < idx_end; i++) {
+		const gchar *guid_tmp;
+		const gchar *key_tmp;
+		const gchar *value;
+		FuContextQuirkSource source;
+
+		if (fu_quirks_index_get_entry(self, i, FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_HASH) !=
+		    hash)
+			continue;
+		guid_tmp = fu_quirks_index_get_entry_str(self,
+							 i,
+							 FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_GUID);
+		if (g_strcmp0(guid_tmp, guid) != 0)
+			continue;
+		key_tmp =
+		    fu_quirks_index_get_entry_str(self, i, FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_KEY);
+		if (key != NULL && g_strcmp0(key_tmp, key) != 0)
+			continue;
+		value = fu_quirks_index_get_entry_str(self,
+						      i,
+						      FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_VALUE);
+		source =
+		    fu_quirks_index_get_entry(self, i, FU_STRUCT_QUIRKS_INDEX_ENTRY_OFFSET_SOURCE);
+		if (self->verbose)
+			g_debug("%s → %s", guid, value);
+		iter_cb(self, key_tmp, value, source, user_data);
+
+		/* the silo query returns FALSE when there are no quirk file results */
+		if (source == FU_CONTEXT_QUIRK_SOURCE_FILE)
+			found = TRUE;
+	}
+	return found;
+}
+
 static gboolean
 fu_quirks_check_silo(FuQuirks *self, GError **error)
 {
@@ -369,6 +841,7 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	/* everything is okay */
 	if (self->silo != NULL && xb_silo_is_valid(self->silo))
 		return TRUE;
+	fu_quirks_index_clear(self);
 
 	/* system datadir */
 	builder = xb_builder_new();
@@ -421,6 +894,14 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 		g_info("invalid key names: %s", str);
 	}
 
+	/* the prepared queries are not required if the shared index can be used */
+	if (!fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE)) {
+		g_autoptr(GError) error_local = NULL;
+		if (fu_quirks_index_ensure(self, &error_local))
+			return TRUE;
+		g_info("failed to use quirk index: %s", error_local->message);
+	}
+
 	/* check if there is any quirk data to load, as older libxmlb versions will not be able to
 	 * create the prepared query with an unknown text ID */
 	n_any = xb_silo_query_first(self->silo, "quirk", NULL);
@@ -459,29 +940,26 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	return TRUE;
 }
 
-/**
- * fu_quirks_lookup_by_id:
- * @self: a #FuQuirks
- * @guid: GUID to lookup
- * @key: an ID to match the entry, e.g. `Name`
- *
- * Looks up an entry in the hardware database using a string value.
- *
- * Returns: (transfer none): values from the database, or %NULL if not found
- *
- * Since: 1.0.1
- **/
-const gchar *
-fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
+static const gchar *
+fu_quirks_lookup_by_id_unlocked(FuQuirks *self, const gchar *guid, const gchar *key)
 {
 	g_autoptr(GError) error = NULL;
 	g_autoptr(XbNode) n = NULL;
 	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
-	g_return_val_if_fail(FU_IS_QUIRKS(self), NULL);
-	g_return_val_if_fail(self->loaded, NULL);
-	g_return_val_if_fail(guid != NULL, NULL);
-	g_return_val_if_fail(key != NULL, NULL);
+	/* ensure up to date */
+	if (!fu_quirks_check_silo(self, &error)) {
+		g_warning("failed to build silo: %s", error->message);
+		return NULL;
+	}
+
+	/* this is generated from both the quirk files and usb.ids */
+	if (self->index_buf != NULL) {
+		const gchar *value = fu_quirks_index_lookup(self, guid, key);
+		if (self->verbose && value != NULL)
+			g_debug("%s:%s → %s", guid, key, value);
+		return value;
+	}
 
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
@@ -506,12 +984,6 @@ fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 	}
 #endif
 
-	/* ensure up to date */
-	if (!fu_quirks_check_silo(self, &error)) {
-		g_warning("failed to build silo: %s", error->message);
-		return NULL;
-	}
-
 	/* no quirk data */
 	if (self->query_kv == NULL)
 		return NULL;
@@ -535,34 +1007,51 @@ fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 }
 
 /**
- * fu_quirks_lookup_by_id_iter:
+ * fu_quirks_lookup_by_id:
  * @self: a #FuQuirks
  * @guid: GUID to lookup
- * @key: (nullable): an ID to match the entry, e.g. `Name`, or %NULL for all keys
- * @iter_cb: (scope call) (closure user_data): a function to call for each result
- * @user_data: user data passed to @iter_cb
+ * @key: an ID to match the entry, e.g. `Name`
  *
- * Looks up all entries in the hardware database using a GUID value.
+ * Looks up an entry in the hardware database using a string value.
  *
- * Returns: %TRUE if the ID was found, and @iter was called
+ * Returns: (transfer none): values from the database, or %NULL if not found
  *
- * Since: 1.3.3
+ * Since: 1.0.1
  **/
-gboolean
-fu_quirks_lookup_by_id_iter(FuQuirks *self,
-			    const gchar *guid,
-			    const gchar *key,
-			    FuQuirksIter iter_cb,
-			    gpointer user_data)
+const gchar *
+fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
+{
+	g_autoptr(GRecMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_QUIRKS(self), NULL);
+	g_return_val_if_fail(self->loaded, NULL);
+	g_return_val_if_fail(guid != NULL, NULL);
+	g_return_val_if_fail(key != NULL, NULL);
+
+	locker = g_rec_mutex_locker_new(&self->mutex);
+	return fu_quirks_lookup_by_id_unlocked(self, guid, key);
+}
+
+static gboolean
+fu_quirks_lookup_by_id_iter_unlocked(FuQuirks *self,
+				     const gchar *guid,
+				     const gchar *key,
+				     FuQuirksIter iter_cb,
+				     gpointer user_data)
 {
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) results = NULL;
 	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
-	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
-	g_return_val_if_fail(self->loaded, FALSE);
-	g_return_val_if_fail(guid != NULL, FALSE);
-	g_return_val_if_fail(iter_cb != NULL, FALSE);
+	/* ensure up to date */
+	if (!fu_quirks_check_silo(self, &error)) {
+		g_warning("failed to build silo: %s", error->message);
+		return FALSE;
+	}
+
+	/* this is generated from both the quirk files and usb.ids */
+	if (self->index_buf != NULL)
+		return fu_quirks_index_lookup_iter(self, guid, key, iter_cb, user_data);
 
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
@@ -599,12 +1088,6 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 	}
 #endif
 
-	/* ensure up to date */
-	if (!fu_quirks_check_silo(self, &error)) {
-		g_warning("failed to build silo: %s", error->message);
-		return FALSE;
-	}
-
 	/* no quirk data */
 	if (self->query_vs == NULL)
 		return FALSE;
@@ -640,6 +1123,39 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 	return TRUE;
 }
 
+/**
+ * fu_quirks_lookup_by_id_iter:
+ * @self: a #FuQuirks
+ * @guid: GUID to lookup
+ * @key: (nullable): an ID to match the entry, e.g. `Name`, or %NULL for all keys
+ * @iter_cb: (scope call) (closure user_data): a function to call for each result
+ * @user_data: user data passed to @iter_cb
+ *
+ * Looks up all entries in the hardware database using a GUID value.
+ *
+ * Returns: %TRUE if the ID was found, and @iter was called
+ *
+ * Since: 1.3.3
+ **/
+gboolean
+fu_quirks_lookup_by_id_iter(FuQuirks *self,
+			    const gchar *guid,
+			    const gchar *key,
+			    FuQuirksIter iter_cb,
+			    gpointer user_data)
+{
+	g_autoptr(GRecMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
+	g_return_val_if_fail(self->loaded, FALSE);
+	g_return_val_if_fail(guid != NULL, FALSE);
+	g_return_val_if_fail(iter_cb != NULL, FALSE);
+
+	/* @iter_cb may look up other quirks from the same thread */
+	locker = g_rec_mutex_locker_new(&self->mutex);
+	return fu_quirks_lookup_by_id_iter_unlocked(self, guid, key, iter_cb, user_data);
+}
+
 #ifdef HAVE_SQLITE
 
 typedef struct {
@@ -906,6 +1422,10 @@ fu_quirks_db_load(FuQuirks *self, GError **error)
 		g_string_append_printf(fn_mtimes, ",%s:%" G_GUINT64_FORMAT, item->fn, mtime);
 	}
 
+	/* used for the quirk index too */
+	g_free(self->db_mtimes);
+	self->db_mtimes = g_strdup(fn_mtimes->str);
+
 	/* check if the mtimes match */
 	if (sqlite3_prepare_v2(self->db,
 			       "SELECT value FROM quirks WHERE guid = ?1 and key = ?2",
@@ -1111,6 +1631,7 @@ fu_quirks_init(FuQuirks *self)
 {
 	self->possible_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	self->invalid_keys = g_ptr_array_new_with_free_func(g_free);
+	g_rec_mutex_init(&self->mutex);
 
 	/* built in */
 	fu_quirks_add_possible_key(self, FU_QUIRKS_BRANCH);
@@ -1168,12 +1689,16 @@ fu_quirks_finalize(GObject *obj)
 		g_object_unref(self->query_vs);
 	if (self->silo != NULL)
 		g_object_unref(self->silo);
+	if (self->index_mmap != NULL)
+		g_mapped_file_unref(self->index_mmap);
 #ifdef HAVE_SQLITE
 	if (self->db != NULL)
 		sqlite3_close(self->db);
+	g_free(self->db_mtimes);
 #endif
 	g_hash_table_unref(self->possible_keys);
 	g_ptr_array_unref(self->invalid_keys);
+	g_rec_mutex_clear(&self->mutex);
 	G_OBJECT_CLASS(fu_quirks_parent_class)->finalize(obj);
 }
 
@@ -0,0 +1,23 @@
+// Copyright 2026 Richard Hughes <richard@hughsie.com>
+// SPDX-License-Identifier: LGPL-2.1-or-later
+
+#[derive(New, Validate, Parse, Default)]
+#[repr(C, packed)]
+struct FuStructQuirksIndexHdr {
+    magic: [char; 4] == "FQIX",
+    version: u32le == 0x1,
+    source_key: u32le, // string offset
+    buckets: u32le,
+    entries: u32le,
+    strtab_size: u32le,
+}
+
+#[derive(New, Default)]
+#[repr(C, packed)]
+struct FuStructQuirksIndexEntry {
+    hash: u32le,
+    guid: u32le, // string offset
+    key: u32le, // string offset
+    value: u32le, // string offset
+    source: u32le,
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-device-private.h"
+#include "fu-mem-private.h"
+#include "fu-mem.h"
+#include "fu-self-test-cfi-device.h"
+
+/* a SPI flash chip in memory, where programming can only clear bits */
+struct _FuSelfTestCfiDevice {
+	FuCfiDevice parent_instance;
+	GByteArray *contents;
+	gboolean write_enabled;
+	guint erase_cnt;
+	guint page_prog_cnt;
+	gsize read_size;
+};
+
+G_DEFINE_TYPE(FuSelfTestCfiDevice, fu_self_test_cfi_device, FU_TYPE_CFI_DEVICE)
+
+static gboolean
+fu_self_test_cfi_device_erase(FuSelfTestCfiDevice *self, gsize addr, gsize size, GError **error)
+{
+	if (!self->write_enabled) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_WRITE, "WEL not set");
+		return FALSE;
+	}
+	addr -= addr % size;
+	for (gsize i = addr; i < MIN(addr + size, self->contents->len); i++)
+		self->contents->data[i] = 0xFF;
+	self->write_enabled = FALSE;
+	self->erase_cnt++;
+	return TRUE;
+}
+
+static gboolean
+fu_self_test_cfi_device_chip_select(FuCfiDevice *device, gboolean value, GError **error)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_self_test_cfi_device_send_command(FuCfiDevice *device,
+				     const guint8 *wbuf,
+				     gsize wbufsz,
+				     guint8 *rbuf,
+				     gsize rbufsz,
+				     FuProgress *progress,
+				     GError **error)
+{
+	FuSelfTestCfiDevice *self = FU_SELF_TEST_CFI_DEVICE(device);
+	gsize addr = 0;
+
+	if (wbufsz >= 4)
+		addr = fu_memread_uint24(wbuf + 1, G_BIG_ENDIAN);
+	switch (wbuf[0]) {
+	case 0x06: /* write enable */
+		self->write_enabled = TRUE;
+		return TRUE;
+	case 0x05: /* read status, never busy */
+		if (rbufsz >= 2)
+			rbuf[1] = self->write_enabled ? 0b10 : 0b0;
+		return TRUE;
+	case 0x60: /* chip erase */
+		return fu_self_test_cfi_device_erase(self, 0x0, self->contents->len, error);
+	case 0x20: /* sector erase */
+		return fu_self_test_cfi_device_erase(self,
+						     addr,
+						     fu_cfi_device_get_sector_size(device),
+						     error);
+	case 0xD8: /* block erase */
+		return fu_self_test_cfi_device_erase(self,
+						     addr,
+						     fu_cfi_device_get_block_size(device),
+						     error);
+	case 0x02: /* page program */
+		if (!self->write_enabled) {
+			g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_WRITE, "WEL not set");
+			return FALSE;
+		}
+		if (!fu_memchk_write(self->contents->len, addr, wbufsz - 4, error))
+			return FALSE;
+		for (gsize i = 4; i < wbufsz; i++)
+			self->contents->data[addr + i - 4] &= wbuf[i];
+		self->write_enabled = FALSE;
+		self->page_prog_cnt++;
+		return TRUE;
+	case 0x03: /* read data */
+		self->read_size += rbufsz;
+		return fu_memcpy_safe(rbuf,
+				      rbufsz,
+				      0x0,
+				      self->contents->data,
+				      self->contents->len,
+				      addr,
+				      rbufsz,
+				      error);
+	default:
+		break;
+	}
+	g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "unknown cmd 0x%02x", wbuf[0]);
+	return FALSE;
+}
+
+/**
+ * fu_self_test_cfi_device_get_contents:
+ * @self: a #FuSelfTestCfiDevice
+ *
+ * Gets the current contents of the emulated flash.
+ *
+ * Returns: (transfer full): data
+ **/
+GBytes *
+fu_self_test_cfi_device_get_contents(FuSelfTestCfiDevice *self)
+{
+	return g_bytes_new(self->contents->data, self->contents->len);
+}
+
+/**
+ * fu_self_test_cfi_device_get_erase_cnt:
+ * @self: a #FuSelfTestCfiDevice
+ *
+ * Gets the number of chip, block or sector erase commands.
+ *
+ * Returns: integer
+ **/
+guint
+fu_self_test_cfi_device_get_erase_cnt(FuSelfTestCfiDevice *self)
+{
+	return self->erase_cnt;
+}
+
+/**
+ * fu_self_test_cfi_device_get_page_prog_cnt:
+ * @self: a #FuSelfTestCfiDevice
+ *
+ * Gets the number of page program commands.
+ *
+ * Returns: integer
+ **/
+guint
+fu_self_test_cfi_device_get_page_prog_cnt(FuSelfTestCfiDevice *self)
+{
+	return self->page_prog_cnt;
+}
+
+/**
+ * fu_self_test_cfi_device_get_read_size:
+ * @self: a #FuSelfTestCfiDevice
+ *
+ * Gets the total number of bytes read from the flash.
+ *
+ * Returns: integer
+ **/
+gsize
+fu_self_test_cfi_device_get_read_size(FuSelfTestCfiDevice *self)
+{
+	return self->read_size;
+}
+
+static void
+fu_self_test_cfi_device_init(FuSelfTestCfiDevice *self)
+{
+	self->contents = g_byte_array_new();
+	fu_device_set_physical_id(FU_DEVICE(self), "SPI");
+	fu_device_remove_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_USE_PROXY_FOR_OPEN);
+}
+
+static void
+fu_self_test_cfi_device_finalize(GObject *object)
+{
+	FuSelfTestCfiDevice *self = FU_SELF_TEST_CFI_DEVICE(object);
+	g_byte_array_unref(self->contents);
+	G_OBJECT_CLASS(fu_self_test_cfi_device_parent_class)->finalize(object);
+}
+
+static void
+fu_self_test_cfi_device_class_init(FuSelfTestCfiDeviceClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	FuCfiDeviceClass *cfi_class = FU_CFI_DEVICE_CLASS(klass);
+	object_class->finalize = fu_self_test_cfi_device_finalize;
+	cfi_class->chip_select = fu_self_test_cfi_device_chip_select;
+	cfi_class->send_command = fu_self_test_cfi_device_send_command;
+}
+
+/**
+ * fu_self_test_cfi_device_new:
+ * @ctx: a #FuContext
+ * @blob: the initial flash contents
+ *
+ * Creates a new emulated SPI flash chip.
+ *
+ * Returns: (transfer full): a #FuSelfTestCfiDevice
+ **/
+FuSelfTestCfiDevice *
+fu_self_test_cfi_device_new(FuContext *ctx, GBytes *blob)
+{
+	FuSelfTestCfiDevice *self =
+	    g_object_new(FU_TYPE_SELF_TEST_CFI_DEVICE, "context", ctx, NULL);
+	g_byte_array_append(self->contents, g_bytes_get_data(blob, NULL), g_bytes_get_size(blob));
+	return self;
+}
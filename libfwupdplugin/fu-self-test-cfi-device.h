@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-cfi-device.h"
+
+#define FU_TYPE_SELF_TEST_CFI_DEVICE (fu_self_test_cfi_device_get_type())
+G_DECLARE_FINAL_TYPE(FuSelfTestCfiDevice,
+		     fu_self_test_cfi_device,
+		     FU,
+		     SELF_TEST_CFI_DEVICE,
+		     FuCfiDevice)
+
+FuSelfTestCfiDevice *
+fu_self_test_cfi_device_new(FuContext *ctx, GBytes *blob) G_GNUC_NON_NULL(1, 2);
+GBytes *
+fu_self_test_cfi_device_get_contents(FuSelfTestCfiDevice *self) G_GNUC_NON_NULL(1);
+guint
+fu_self_test_cfi_device_get_erase_cnt(FuSelfTestCfiDevice *self) G_GNUC_NON_NULL(1);
+guint
+fu_self_test_cfi_device_get_page_prog_cnt(FuSelfTestCfiDevice *self) G_GNUC_NON_NULL(1);
+gsize
+fu_self_test_cfi_device_get_read_size(FuSelfTestCfiDevice *self) G_GNUC_NON_NULL(1);
@@ -156,6 +156,167 @@ fu_plugin_struct_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_plugin_struct_view_func(void)
+{
+	gboolean ret;
+	guint8 buf[FU_STRUCT_SELF_TEST_SIZE + 2] = {0};
+	FuStructSelfTest st2 = {0};
+	g_autoptr(FuStructSelfTest) st = fu_struct_self_test_new();
+	g_autoptr(FuStructSelfTest) st3 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* parse in-place, at an offset */
+	fu_struct_self_test_set_revision(st, 0xFF);
+	fu_struct_self_test_set_length(st, 0xDEAD);
+	ret = fu_memcpy_safe(buf,
+			     sizeof(buf),
+			     0x2,
+			     st->buf->data,
+			     st->buf->len,
+			     0x0,
+			     st->buf->len,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_struct_self_test_parse_view(&st2, buf, sizeof(buf), 0x2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(st2.buf->data == buf + 2);
+	g_assert_cmpint(st2.buf->len, ==, FU_STRUCT_SELF_TEST_SIZE);
+	g_assert_cmpint(fu_struct_self_test_get_revision(&st2), ==, 0xFF);
+	g_assert_cmpint(fu_struct_self_test_get_length(&st2), ==, 0xDEAD);
+
+	/* the view is not a copy */
+	buf[2 + FU_STRUCT_SELF_TEST_OFFSET_REVISION] = 0x12;
+	g_assert_cmpint(fu_struct_self_test_get_revision(&st2), ==, 0x12);
+
+	/* the copying parser gives the same result */
+	st3 = fu_struct_self_test_parse(buf, sizeof(buf), 0x2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(st3);
+	g_assert_cmpmem(st3->buf->data, st3->buf->len, st2.buf->data, st2.buf->len);
+
+	/* compare the two parsers */
+	for (guint i = 0; i < 100000; i++) {
+		g_autoptr(FuStructSelfTest) st4 =
+		    fu_struct_self_test_parse(buf, sizeof(buf), 0x2, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(st4);
+	}
+	g_debug("parse: %.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_timer_reset(timer);
+	for (guint i = 0; i < 100000; i++) {
+		FuStructSelfTest st4 = {0};
+		ret = fu_struct_self_test_parse_view(&st4, buf, sizeof(buf), 0x2, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	g_debug("parse-view: %.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* too small */
+	ret = fu_struct_self_test_parse_view(&st2, buf, sizeof(buf), 0x3, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* parse failing signature */
+	buf[2] = 0xFF;
+	ret = fu_struct_self_test_parse_view(&st2, buf, sizeof(buf), 0x2, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
+static void
+fu_plugin_struct_view_throughput(const gchar *name, FuFirmware *firmware, guint images_cnt)
+{
+	gboolean ret;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	blob = fu_firmware_write(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	for (guint i = 0; i < 10; i++) {
+		g_autoptr(FuFirmware) firmware_tmp = g_object_new(G_OBJECT_TYPE(firmware), NULL);
+		g_autoptr(GPtrArray) images = NULL;
+
+		ret = fu_firmware_parse_bytes(firmware_tmp,
+					      blob,
+					      0x0,
+					      FU_FIRMWARE_PARSE_FLAG_NONE,
+					      &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		images = fu_firmware_get_images(firmware_tmp);
+		g_assert_cmpint(images->len, ==, images_cnt);
+	}
+	g_debug("%s: 10x 0x%x bytes in %.3fms, %.1fMB/s",
+		name,
+		(guint)g_bytes_get_size(blob),
+		g_timer_elapsed(timer, NULL) * 1000.f,
+		(10.f * g_bytes_get_size(blob) / FU_MB) / g_timer_elapsed(timer, NULL));
+}
+
+static void
+fu_plugin_struct_view_cab_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) cab = fu_cab_firmware_new();
+	g_autoptr(GError) error = NULL;
+
+	/* 4MB split into 32kB CFDATA blocks */
+	for (guint i = 0; i < 64; i++) {
+		g_autofree gchar *id = g_strdup_printf("file%02u.bin", i);
+		g_autofree guint8 *buf = g_malloc(64 * FU_KB);
+		g_autoptr(FuFirmware) img = FU_FIRMWARE(fu_cab_image_new());
+		g_autoptr(GBytes) blob = NULL;
+
+		memset(buf, i, 64 * FU_KB);
+		blob = g_bytes_new_take(g_steal_pointer(&buf), 64 * FU_KB);
+		fu_firmware_set_bytes(img, blob);
+		fu_firmware_set_id(img, id);
+		ret = fu_firmware_add_image(cab, img, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	fu_plugin_struct_view_throughput("cab", cab, 64);
+}
+
+static void
+fu_plugin_struct_view_efi_volume_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) volume = fu_efi_volume_new();
+	g_autoptr(FuFirmware) filesystem = fu_efi_filesystem_new();
+	g_autoptr(GError) error = NULL;
+
+	/* 4MB of raw files in a FFS2 volume, each a multiple of 8 bytes */
+	fu_firmware_set_id(volume, "8c8ce578-8a3d-4f1c-9935-896185c32dd3");
+	for (guint i = 0; i < 1000; i++) {
+		g_autofree gchar *id = NULL;
+		g_autofree gchar *str = g_strdup_printf("%u", i);
+		g_autofree guint8 *buf = g_malloc(4 * FU_KB);
+		g_autoptr(FuFirmware) img = fu_efi_file_new();
+		g_autoptr(GBytes) blob = NULL;
+
+		memset(buf, i & 0x7F, 4 * FU_KB);
+		blob = g_bytes_new_take(g_steal_pointer(&buf), 4 * FU_KB);
+		id = fwupd_guid_hash_string(str);
+		fu_firmware_set_bytes(img, blob);
+		fu_firmware_set_id(img, id);
+		ret = fu_firmware_add_image(filesystem, img, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	ret = fu_firmware_add_image(volume, filesystem, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_plugin_struct_view_throughput("efi-volume", volume, 1);
+}
+
 static void
 fu_plugin_struct_wrapped_func(void)
 {
@@ -239,6 +400,9 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/struct", fu_plugin_struct_func);
 	g_test_add_func("/fwupd/struct/bits", fu_plugin_struct_bits_func);
+	g_test_add_func("/fwupd/struct/view", fu_plugin_struct_view_func);
+	g_test_add_func("/fwupd/struct/view{cab}", fu_plugin_struct_view_cab_func);
+	g_test_add_func("/fwupd/struct/view{efi-volume}", fu_plugin_struct_view_efi_volume_func);
 	g_test_add_func("/fwupd/struct/list", fu_plugin_struct_list_func);
 	g_test_add_func("/fwupd/struct/wrapped", fu_plugin_struct_wrapped_func);
 	return g_test_run();
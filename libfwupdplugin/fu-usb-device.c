@@ -1778,6 +1778,284 @@ fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 	return TRUE;
 }
 
+typedef struct {
+	struct libusb_transfer *transfer;
+	FuChunk *chk;
+	gint completed; /* set from the libusb event handler */
+} FuUsbDeviceTransferHelper;
+
+static void
+fu_usb_device_transfer_helper_free(FuUsbDeviceTransferHelper *helper)
+{
+	/* only ever freed once the transfer has completed, or if it was never submitted */
+	libusb_free_transfer(helper->transfer);
+	if (helper->chk != NULL)
+		g_object_unref(helper->chk);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuUsbDeviceTransferHelper, fu_usb_device_transfer_helper_free)
+
+static void LIBUSB_CALL
+fu_usb_device_transfer_helper_cb(struct libusb_transfer *transfer)
+{
+	FuUsbDeviceTransferHelper *helper = (FuUsbDeviceTransferHelper *)transfer->user_data;
+	helper->completed = 1;
+}
+
+#define FU_USB_DEVICE_TRANSFER_HELPER_WAIT_FAILURES_MAX 5
+
+/* if this fails then the transfer is still owned by libusb and @helper must not be freed */
+static gboolean
+fu_usb_device_transfer_helper_wait(FuUsbDevice *self,
+				   FuUsbDeviceTransferHelper *helper,
+				   GError **error)
+{
+	FuContext *ctx = fu_device_get_context(FU_DEVICE(self));
+	libusb_context *usb_ctx = fu_context_get_data(ctx, "libusb_context");
+	guint failures = 0;
+	struct timeval tv = {
+	    .tv_usec = 0,
+	    .tv_sec = 1,
+	};
+
+	/* this is safe even if the FuUsbBackend thread is also handling events */
+	while (!helper->completed) {
+		gint rc = libusb_handle_events_timeout_completed(usb_ctx, &tv, &helper->completed);
+		if (rc == LIBUSB_SUCCESS || rc == LIBUSB_ERROR_INTERRUPTED)
+			continue;
+
+		/* give libusb a chance to complete the transfer as cancelled */
+		if (failures++ == 0)
+			libusb_cancel_transfer(helper->transfer);
+		if (failures >= FU_USB_DEVICE_TRANSFER_HELPER_WAIT_FAILURES_MAX) {
+			fu_usb_device_libusb_error_to_gerror(rc, error);
+			g_prefix_error_literal(error, "failed to handle events: ");
+			return FALSE;
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_usb_device_transfer_helper_check(FuUsbDeviceTransferHelper *helper, GError **error)
+{
+	struct libusb_transfer *transfer = helper->transfer;
+
+	if (!fu_usb_device_libusb_status_to_gerror(transfer->status, error))
+		return FALSE;
+	if ((gsize)transfer->actual_length != fu_chunk_get_data_sz(helper->chk)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "only wrote 0x%x of 0x%x bytes",
+			    (guint)transfer->actual_length,
+			    (guint)fu_chunk_get_data_sz(helper->chk));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_usb_device_bulk_transfer_chunks_sync(FuUsbDevice *self,
+					guint8 endpoint,
+					FuChunkArray *chunks,
+					guint timeout,
+					FuProgress *progress,
+					GError **error)
+{
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+		gsize actual_length = 0;
+		g_autofree guint8 *buf = NULL;
+		g_autoptr(FuChunk) chk = NULL;
+
+		/* make mutable */
+		chk = fu_chunk_array_index(chunks, i, error);
+		if (chk == NULL)
+			return FALSE;
+		buf = fu_memdup_safe(fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk), error);
+		if (buf == NULL)
+			return FALSE;
+		if (!fu_usb_device_bulk_transfer(self,
+						 endpoint,
+						 buf,
+						 fu_chunk_get_data_sz(chk),
+						 &actual_length,
+						 timeout,
+						 NULL,
+						 error)) {
+			g_prefix_error(error, "failed to write chunk 0x%x: ", i);
+			return FALSE;
+		}
+		if (actual_length != fu_chunk_get_data_sz(chk)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "failed to write chunk 0x%x: only wrote 0x%x of 0x%x bytes",
+				    i,
+				    (guint)actual_length,
+				    (guint)fu_chunk_get_data_sz(chk));
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/**
+ * fu_usb_device_bulk_transfer_chunks:
+ * @self: a #FuUsbDevice
+ * @endpoint: the address of a valid OUT endpoint to communicate with
+ * @chunks: a #FuChunkArray
+ * @transfers_max: the maximum number of transfers in flight at once, e.g. 8
+ * @timeout: timeout (in milliseconds) for each transfer -- use 0 for unlimited
+ * @progress: a #FuProgress
+ * @error: a #GError, or %NULL
+ *
+ * Writes each chunk to the device using a USB bulk transfer, keeping up to @transfers_max
+ * transfers queued so that the device does not have to wait for the host between chunks.
+ *
+ * The chunks are always completed in order, and all the remaining transfers are cancelled if any
+ * chunk fails or is only partially written. The @progress is incremented as each chunk completes.
+ *
+ * When emulating or recording the device each chunk is sent using fu_usb_device_bulk_transfer(),
+ * so the events are identical to writing each chunk in turn.
+ *
+ * Return value: %TRUE on success
+ *
+ * Since: 2.1.8
+ **/
+gboolean
+fu_usb_device_bulk_transfer_chunks(FuUsbDevice *self,
+				   guint8 endpoint,
+				   FuChunkArray *chunks,
+				   guint transfers_max,
+				   guint timeout,
+				   FuProgress *progress,
+				   GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	guint idx_submit = 0;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GQueue) helpers = g_queue_new();
+
+	g_return_val_if_fail(FU_IS_USB_DEVICE(self), FALSE);
+	g_return_val_if_fail(FU_IS_CHUNK_ARRAY(chunks), FALSE);
+	g_return_val_if_fail(FU_IS_PROGRESS(progress), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* sanity check */
+	if ((endpoint & LIBUSB_ENDPOINT_IN) > 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "endpoint 0x%02x is not an OUT endpoint",
+			    endpoint);
+		return FALSE;
+	}
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
+
+	/* events have to be loaded or saved in order */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) ||
+	    fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE) ||
+	    fu_context_has_flag(fu_device_get_context(FU_DEVICE(self)),
+				FU_CONTEXT_FLAG_SAVE_EVENTS) ||
+	    transfers_max <= 1) {
+		return fu_usb_device_bulk_transfer_chunks_sync(self,
+							       endpoint,
+							       chunks,
+							       timeout,
+							       progress,
+							       error);
+	}
+
+	/* sanity check */
+	if (priv->handle == NULL)
+		return fu_usb_device_not_open_error(self, error);
+
+	while (idx_submit < fu_chunk_array_length(chunks) || !g_queue_is_empty(helpers)) {
+		g_autoptr(FuUsbDeviceTransferHelper) helper = NULL;
+		g_autoptr(GError) error_wait = NULL;
+
+		/* keep the queue full */
+		while (error_local == NULL && idx_submit < fu_chunk_array_length(chunks) &&
+		       g_queue_get_length(helpers) < transfers_max) {
+			gint rc;
+			g_autoptr(FuUsbDeviceTransferHelper) helper_new =
+			    g_new0(FuUsbDeviceTransferHelper, 1);
+
+			helper_new->transfer = libusb_alloc_transfer(0);
+			helper_new->chk = fu_chunk_array_index(chunks, idx_submit, &error_local);
+			if (helper_new->chk == NULL)
+				break;
+			libusb_fill_bulk_transfer(helper_new->transfer,
+						  priv->handle,
+						  endpoint,
+						  (guint8 *)fu_chunk_get_data(helper_new->chk),
+						  (gint)fu_chunk_get_data_sz(helper_new->chk),
+						  fu_usb_device_transfer_helper_cb,
+						  helper_new,
+						  timeout);
+			rc = libusb_submit_transfer(helper_new->transfer);
+			if (!fu_usb_device_libusb_error_to_gerror(rc, &error_local)) {
+				g_prefix_error(&error_local,
+					       "failed to submit chunk 0x%x: ",
+					       idx_submit);
+				break;
+			}
+			g_queue_push_tail(helpers, g_steal_pointer(&helper_new));
+			idx_submit++;
+		}
+		if (g_queue_is_empty(helpers))
+			break;
+
+		/* the remaining transfers complete as cancelled */
+		if (error_local != NULL) {
+			for (GList *l = helpers->head; l != NULL; l = l->next) {
+				FuUsbDeviceTransferHelper *helper_tmp = l->data;
+				libusb_cancel_transfer(helper_tmp->transfer);
+			}
+		}
+
+		/* wait for the oldest transfer */
+		helper = g_queue_pop_head(helpers);
+		if (!fu_usb_device_transfer_helper_wait(self, helper, &error_wait)) {
+			/* libusb may still write to the transfer, so it cannot be freed */
+			g_warning("leaking transfer for chunk 0x%x: %s",
+				  fu_chunk_get_idx(helper->chk),
+				  error_wait->message);
+			g_steal_pointer(&helper);
+			if (error_local == NULL)
+				error_local = g_steal_pointer(&error_wait);
+			g_clear_error(&error_wait);
+			continue;
+		}
+		if (error_local != NULL)
+			continue;
+		if (!fu_usb_device_transfer_helper_check(helper, &error_local)) {
+			g_prefix_error(&error_local,
+				       "failed to write chunk 0x%x: ",
+				       fu_chunk_get_idx(helper->chk));
+			continue;
+		}
+		fu_progress_step_done(progress);
+	}
+	if (error_local != NULL) {
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_usb_device_reset:
  * @self: a #FuUsbDevice
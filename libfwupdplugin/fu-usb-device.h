@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "fu-chunk-array.h"
 #include "fu-udev-device.h"
 #include "fu-usb-interface.h"
 #include "fu-usb-struct.h"
@@ -96,6 +97,15 @@ fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 				 GCancellable *cancellable,
 				 GError **error) G_GNUC_NON_NULL(1);
 gboolean
+fu_usb_device_bulk_transfer_chunks(FuUsbDevice *self,
+				   guint8 endpoint,
+				   FuChunkArray *chunks,
+				   guint transfers_max,
+				   guint timeout,
+				   FuProgress *progress,
+				   GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 3, 6);
+gboolean
 fu_usb_device_claim_interface(FuUsbDevice *self,
 			      guint8 iface,
 			      FuUsbDeviceClaimFlags flags,
@@ -98,8 +98,11 @@
 #include <libfwupdplugin/fu-kenv.h>
 #include <libfwupdplugin/fu-kernel-search-path.h>
 #include <libfwupdplugin/fu-kernel.h>
+#include <libfwupdplugin/fu-lazy-input-stream.h>
 #include <libfwupdplugin/fu-linear-firmware.h>
 #include <libfwupdplugin/fu-lzma-common.h>
+#include <libfwupdplugin/fu-lzma-input-stream.h>
+#include <libfwupdplugin/fu-mapped-file-input-stream.h>
 #include <libfwupdplugin/fu-mei-device.h>
 #include <libfwupdplugin/fu-mem.h>
 #include <libfwupdplugin/fu-memory-input-stream.h>
@@ -264,6 +264,8 @@ class StructObj:
             "Parse": Export.NONE,
             "ParseBytes": Export.NONE,
             "ParseStream": Export.NONE,
+            "ParseView": Export.NONE,
+            "ParseStreamView": Export.NONE,
             "ParseInternal": Export.NONE,
             "New": Export.NONE,
             "NewInternal": Export.NONE,
@@ -336,7 +338,11 @@ class StructObj:
                     item.add_private_export("Getters")
         elif derive == "Parse":
             self.add_private_export("NewInternal")
+            self.add_private_export("ParseView")
+        elif derive == "ParseView":
             self.add_private_export("ParseInternal")
+        elif derive == "ParseStreamView":
+            self.add_private_export("ParseView")
         elif derive == "ParseStream":
             self.add_private_export("NewInternal")
             self.add_private_export("ParseInternal")
@@ -370,7 +376,13 @@ class StructObj:
             self._exports[derive] = Export.PUBLIC
 
         # for convenience
-        if derive in ["Parse", "ParseBytes", "ParseStream"]:
+        if derive in [
+            "Parse",
+            "ParseBytes",
+            "ParseStream",
+            "ParseView",
+            "ParseStreamView",
+        ]:
             self.add_public_export("Getters")
             for item in self.items:
                 if item.struct_obj:
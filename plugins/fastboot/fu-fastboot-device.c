@@ -16,6 +16,7 @@
 #define FASTBOOT_EP_IN			   0x81
 #define FASTBOOT_EP_OUT			   0x01
 #define FASTBOOT_CMD_BUFSZ		   64 /* bytes */
+#define FASTBOOT_TRANSFERS_MAX		   8
 
 struct _FuFastbootDevice {
 	FuUsbDevice parent_instance;
@@ -280,21 +281,35 @@ fu_fastboot_device_download(FuFastbootDevice *self,
 					       error);
 	if (chunks == NULL)
 		return FALSE;
-	fu_progress_set_id(progress, G_STRLOC);
-	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autoptr(FuChunk) chk = NULL;
-
-		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
-			return FALSE;
-		if (!fu_fastboot_device_write(self,
-					      fu_chunk_get_data(chk),
-					      fu_chunk_get_data_sz(chk),
-					      error))
+	if (self->operation_delay == 0) {
+		/* nothing to wait for between chunks, so keep several in flight */
+		if (!fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(self),
+							FASTBOOT_EP_OUT,
+							chunks,
+							FASTBOOT_TRANSFERS_MAX,
+							FASTBOOT_TRANSACTION_TIMEOUT,
+							progress,
+							error)) {
+			g_prefix_error_literal(error, "failed to do bulk transfer: ");
 			return FALSE;
-		fu_progress_step_done(progress);
+		}
+	} else {
+		fu_progress_set_id(progress, G_STRLOC);
+		fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
+		for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+			g_autoptr(FuChunk) chk = NULL;
+
+			/* prepare chunk */
+			chk = fu_chunk_array_index(chunks, i, error);
+			if (chk == NULL)
+				return FALSE;
+			if (!fu_fastboot_device_write(self,
+						      fu_chunk_get_data(chk),
+						      fu_chunk_get_data_sz(chk),
+						      error))
+				return FALSE;
+			fu_progress_step_done(progress);
+		}
 	}
 	if (!fu_fastboot_device_read(self,
 				     NULL,
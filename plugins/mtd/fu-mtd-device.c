@@ -997,6 +997,321 @@ fu_mtd_device_dump_firmware(FuDevice *device, FuProgress *progress, GError **err
 	return g_bytes_new_take(g_steal_pointer(&buf), bufsz);
 }
 
+static gboolean
+fu_mtd_device_get_bad_block(FuMtdDevice *self, guint64 addr, gboolean *bad, GError **error)
+{
+#ifdef HAVE_MTD_USER_H
+	gint rc = 0;
+	gint64 offs = addr;
+	g_autoptr(FuIoctl) ioctl = fu_udev_device_ioctl_new(FU_UDEV_DEVICE(self));
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_ioctl_execute(ioctl,
+			      MEMGETBADBLOCK,
+			      (guint8 *)&offs,
+			      sizeof(offs),
+			      &rc,
+			      FU_MTD_DEVICE_IOCTL_TIMEOUT,
+			      FU_IOCTL_FLAG_NONE,
+			      &error_local)) {
+		/* no bad block table, e.g. NOR flash */
+		if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+			*bad = FALSE;
+			return TRUE;
+		}
+		g_propagate_prefixed_error(error,
+					   g_steal_pointer(&error_local),
+					   "failed to get bad block status @0x%x: ",
+					   (guint)addr);
+		return FALSE;
+	}
+	*bad = rc > 0;
+	return TRUE;
+#else
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "Not supported as mtd-user.h is unavailable");
+	return FALSE;
+#endif
+}
+
+static gboolean
+fu_mtd_device_erase_region(FuMtdDevice *self, guint64 addr, guint64 length, GError **error)
+{
+#ifdef HAVE_MTD_USER_H
+	struct erase_info_user erase = {0x0};
+	g_autoptr(FuIoctl) ioctl = fu_udev_device_ioctl_new(FU_UDEV_DEVICE(self));
+
+	erase.start = addr;
+	erase.length = length;
+	if (!fu_ioctl_execute(ioctl,
+			      MEMERASE,
+			      (guint8 *)&erase,
+			      sizeof(erase),
+			      NULL,
+			      FU_MTD_DEVICE_IOCTL_TIMEOUT,
+			      FU_IOCTL_FLAG_NONE,
+			      error)) {
+		g_prefix_error(error,
+			       "failed to erase @0x%x, length 0x%x: ",
+			       (guint)erase.start,
+			       (guint)erase.length);
+		return FALSE;
+	}
+	return TRUE;
+#else
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "Not supported as mtd-user.h is unavailable");
+	return FALSE;
+#endif
+}
+
+/* returns the runs of consecutive erase blocks that differ from the image, as chunks */
+static GPtrArray *
+fu_mtd_device_get_changed_runs(FuMtdDevice *self,
+			       FuInputStream *stream,
+			       gsize offset,
+			       FuProgress *progress,
+			       GError **error)
+{
+	FuMtdDevicePrivate *priv = GET_PRIVATE(self);
+	gsize run_offset = 0;
+	gsize run_size = 0;
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(GPtrArray) runs = g_ptr_array_new_with_free_func(g_object_unref);
+
+	chunks = fu_chunk_array_new_from_stream(stream,
+						offset,
+						FU_CHUNK_PAGESZ_NONE,
+						priv->erasesize,
+						error);
+	if (chunks == NULL)
+		return NULL;
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
+
+	/* compare each erase block, plus one extra iteration to close the last run */
+	for (guint i = 0; i <= fu_chunk_array_length(chunks); i++) {
+		gboolean changed = FALSE;
+
+		if (i < fu_chunk_array_length(chunks)) {
+			gboolean bad = FALSE;
+			g_autofree guint8 *buf = NULL;
+			g_autoptr(FuChunk) chk = NULL;
+			g_autoptr(GBytes) blob1 = NULL;
+			g_autoptr(GBytes) blob2 = NULL;
+
+			chk = fu_chunk_array_index(chunks, i, error);
+			if (chk == NULL)
+				return NULL;
+			buf = g_malloc0(fu_chunk_get_data_sz(chk));
+			if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
+						  fu_chunk_get_address(chk),
+						  buf,
+						  fu_chunk_get_data_sz(chk),
+						  error)) {
+				g_prefix_error(error,
+					       "failed to read @0x%x: ",
+					       (guint)fu_chunk_get_address(chk));
+				return NULL;
+			}
+			blob1 = fu_chunk_get_bytes(chk);
+			blob2 = g_bytes_new_static(buf, fu_chunk_get_data_sz(chk));
+			changed = !fu_bytes_compare(blob1, blob2, NULL);
+
+			/* MTD does not remap, so the image cannot be written around a bad block */
+			if (changed) {
+				if (!fu_mtd_device_get_bad_block(self,
+								 fu_chunk_get_address(chk),
+								 &bad,
+								 error))
+					return NULL;
+				if (bad) {
+					g_set_error(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_WRITE,
+						    "erase block @0x%x is marked bad",
+						    (guint)fu_chunk_get_address(chk));
+					return NULL;
+				}
+				if (run_size == 0)
+					run_offset = i * priv->erasesize;
+				run_size += fu_chunk_get_data_sz(chk);
+			}
+			fu_progress_step_done(progress);
+		}
+
+		/* close the run */
+		if (!changed && run_size > 0) {
+			g_autoptr(FuChunk) run = NULL;
+			g_autoptr(GBytes) blob = NULL;
+
+			blob = fu_input_stream_read_bytes(stream,
+							  run_offset,
+							  run_size,
+							  NULL,
+							  error);
+			if (blob == NULL)
+				return NULL;
+			run = fu_chunk_bytes_new(blob);
+			fu_chunk_set_address(run, offset + run_offset);
+			g_ptr_array_add(runs, g_steal_pointer(&run));
+			run_size = 0;
+		}
+	}
+
+	/* success */
+	return g_steal_pointer(&runs);
+}
+
+static gboolean
+fu_mtd_device_erase_runs(FuMtdDevice *self, GPtrArray *runs, FuProgress *progress, GError **error)
+{
+	FuMtdDevicePrivate *priv = GET_PRIVATE(self);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, runs->len);
+
+	/* erase all the blocks of each run at once */
+	for (guint i = 0; i < runs->len; i++) {
+		FuChunk *run = g_ptr_array_index(runs, i);
+		guint64 length = fu_chunk_get_data_sz(run);
+
+		/* the image may end part-way through the last erase block */
+		if (length % priv->erasesize != 0)
+			length += priv->erasesize - (length % priv->erasesize);
+		if (!fu_mtd_device_erase_region(self, fu_chunk_get_address(run), length, error))
+			return FALSE;
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_mtd_device_write_runs(FuMtdDevice *self, GPtrArray *runs, FuProgress *progress, GError **error)
+{
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, runs->len);
+
+	/* write each run */
+	for (guint i = 0; i < runs->len; i++) {
+		FuChunk *run = g_ptr_array_index(runs, i);
+		if (!fu_udev_device_pwrite(FU_UDEV_DEVICE(self),
+					   fu_chunk_get_address(run),
+					   fu_chunk_get_data(run),
+					   fu_chunk_get_data_sz(run),
+					   error)) {
+			g_prefix_error(error,
+				       "failed to write @0x%x: ",
+				       (guint)fu_chunk_get_address(run));
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_mtd_device_verify_runs(FuMtdDevice *self, GPtrArray *runs, FuProgress *progress, GError **error)
+{
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, runs->len);
+
+	/* verify each run */
+	for (guint i = 0; i < runs->len; i++) {
+		FuChunk *run = g_ptr_array_index(runs, i);
+		g_autofree guint8 *buf = g_malloc0(fu_chunk_get_data_sz(run));
+		g_autoptr(GBytes) blob1 = NULL;
+		g_autoptr(GBytes) blob2 = NULL;
+
+		if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
+					  fu_chunk_get_address(run),
+					  buf,
+					  fu_chunk_get_data_sz(run),
+					  error)) {
+			g_prefix_error(error,
+				       "failed to read @0x%x: ",
+				       (guint)fu_chunk_get_address(run));
+			return FALSE;
+		}
+		blob1 = fu_chunk_get_bytes(run);
+		blob2 = g_bytes_new_static(buf, fu_chunk_get_data_sz(run));
+		if (!fu_bytes_compare(blob1, blob2, error)) {
+			g_prefix_error(error,
+				       "failed to verify @0x%x: ",
+				       (guint)fu_chunk_get_address(run));
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_mtd_device_write_stream_differential(FuMtdDevice *self,
+					FuInputStream *stream,
+					gsize offset,
+					FuProgress *progress,
+					GError **error)
+{
+	g_autoptr(GPtrArray) runs = NULL;
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_GUESSED);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_READ, 40, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_ERASE, 15, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 35, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_VERIFY, 10, NULL);
+
+	/* find what needs changing */
+	runs = fu_mtd_device_get_changed_runs(self,
+					      stream,
+					      offset,
+					      fu_progress_get_child(progress),
+					      error);
+	if (runs == NULL)
+		return FALSE;
+	fu_progress_step_done(progress);
+	if (runs->len == 0) {
+		g_debug("no erase blocks changed, skipping write");
+		fu_progress_finished(progress);
+		return TRUE;
+	}
+
+	/* erase */
+	if (!fu_mtd_device_erase_runs(self, runs, fu_progress_get_child(progress), error))
+		return FALSE;
+	fu_progress_step_done(progress);
+
+	/* write */
+	if (!fu_mtd_device_write_runs(self, runs, fu_progress_get_child(progress), error))
+		return FALSE;
+	fu_progress_step_done(progress);
+
+	/* verify */
+	if (!fu_mtd_device_verify_runs(self, runs, fu_progress_get_child(progress), error))
+		return FALSE;
+	fu_progress_step_done(progress);
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_mtd_device_write_stream(FuMtdDevice *self,
 			   FuInputStream *stream,
@@ -1010,6 +1325,14 @@ fu_mtd_device_write_stream(FuMtdDevice *self,
 	if (priv->erasesize == 0)
 		return fu_mtd_device_write_verify(self, stream, offset, progress, error);
 
+	/* only erase and write the blocks that are different */
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE))
+		return fu_mtd_device_write_stream_differential(self,
+							       stream,
+							       offset,
+							       progress,
+							       error);
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_GUESSED);
@@ -1297,5 +1620,6 @@ fu_mtd_device_class_init(FuMtdDeviceClass *klass)
 	device_class->write_firmware = fu_mtd_device_write_firmware;
 	device_class->set_quirk_kv = fu_mtd_device_set_quirk_kv;
 	fu_device_register_private_flag(device_class, FU_MTD_DEVICE_FLAG_SMBIOS_VERSION_FALLBACK);
+	fu_device_register_private_flag(device_class, FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE);
 	device_class->add_security_attrs = fu_mtd_device_add_security_attrs;
 }
@@ -28,7 +28,8 @@ typedef struct {
 	FuContext *ctx;
 } FuTest;
 
-#define FU_TEST_MTD_DEVICE_SIZE 0x100000
+#define FU_TEST_MTD_DEVICE_SIZE	     0x100000
+#define FU_TEST_MTD_DEVICE_ERASESIZE 0x1000
 
 static void
 fu_test_free(FuTest *self)
@@ -73,26 +74,41 @@ fu_test_mtd_find_mtdram(FuContext *ctx, GError **error)
 
 #ifdef HAVE_MTD_USER_H
 static void
-fu_test_mtd_device_add_memislocked_event(FuMtdDevice *device, gboolean locked)
+fu_test_mtd_device_add_ioctl_event(FuMtdDevice *device,
+				   gulong request,
+				   const guint8 *buf,
+				   gsize bufsz,
+				   gint64 rc)
 {
-	struct erase_info_user erase = {0x0};
 	g_autofree gchar *data = NULL;
 	g_autofree gchar *event_id = NULL;
 	g_autoptr(FuDeviceEvent) event = NULL;
 
-	erase.start = 0x0;
-	erase.length = FU_TEST_MTD_DEVICE_SIZE;
-	data = fu_base64_encode((const guint8 *)&erase, sizeof(erase));
+	data = fu_base64_encode(buf, bufsz);
 	event_id = g_strdup_printf("Ioctl:Request=0x%04x,Data=%s,Length=0x%x",
-				   (guint)MEMISLOCKED,
+				   (guint)request,
 				   data,
-				   (guint)sizeof(erase));
+				   (guint)bufsz);
 	event = fu_device_event_new(event_id);
-	fu_device_event_set_data(event, "DataOut", (const guint8 *)&erase, sizeof(erase));
-	fu_device_event_set_i64(event, "Rc", locked ? 1 : 0);
+	fu_device_event_set_data(event, "DataOut", buf, bufsz);
+	fu_device_event_set_i64(event, "Rc", rc);
 	fu_device_add_event(FU_DEVICE(device), event);
 }
 
+static void
+fu_test_mtd_device_add_memislocked_event(FuMtdDevice *device, gboolean locked)
+{
+	struct erase_info_user erase = {0x0};
+
+	erase.start = 0x0;
+	erase.length = FU_TEST_MTD_DEVICE_SIZE;
+	fu_test_mtd_device_add_ioctl_event(device,
+					   MEMISLOCKED,
+					   (const guint8 *)&erase,
+					   sizeof(erase),
+					   locked ? 1 : 0);
+}
+
 static void
 fu_test_mtd_device_write_sysfs_attr(const gchar *sysfs_path, const gchar *attr, const gchar *value)
 {
@@ -103,8 +119,78 @@ fu_test_mtd_device_write_sysfs_attr(const gchar *sysfs_path, const gchar *attr,
 	g_assert_no_error(error);
 }
 
+static void
+fu_test_mtd_device_add_pread_event(FuMtdDevice *device,
+				   guint64 addr,
+				   const guint8 *buf,
+				   gsize bufsz)
+{
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+
+	event_id = g_strdup_printf("Pread:Port=0x%x,Length=0x%x", (guint)addr, (guint)bufsz);
+	event = fu_device_event_new(event_id);
+	fu_device_event_set_data(event, "Data", buf, bufsz);
+	fu_device_add_event(FU_DEVICE(device), event);
+}
+
+static void
+fu_test_mtd_device_add_pwrite_event(FuMtdDevice *device,
+				    guint64 addr,
+				    const guint8 *buf,
+				    gsize bufsz)
+{
+	g_autofree gchar *data = fu_base64_encode(buf, bufsz);
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+
+	event_id = g_strdup_printf("Pwrite:Port=0x%x,Data=%s,Length=0x%x",
+				   (guint)addr,
+				   data,
+				   (guint)bufsz);
+	event = fu_device_event_new(event_id);
+	fu_device_add_event(FU_DEVICE(device), event);
+}
+
+static void
+fu_test_mtd_device_add_badblock_event(FuMtdDevice *device, guint64 addr, gboolean bad)
+{
+	gint64 offs = addr;
+	fu_test_mtd_device_add_ioctl_event(device,
+					   MEMGETBADBLOCK,
+					   (const guint8 *)&offs,
+					   sizeof(offs),
+					   bad ? 1 : 0);
+}
+
+static void
+fu_test_mtd_device_add_erase_event(FuMtdDevice *device, guint64 addr, guint64 length)
+{
+	struct erase_info_user erase = {0x0};
+
+	erase.start = addr;
+	erase.length = length;
+	fu_test_mtd_device_add_ioctl_event(device,
+					   MEMERASE,
+					   (const guint8 *)&erase,
+					   sizeof(erase),
+					   0);
+}
+
+/* reading back the current flash contents, one erase block at a time */
+static void
+fu_test_mtd_device_add_pread_events(FuMtdDevice *device, GByteArray *flash)
+{
+	for (gsize i = 0; i < flash->len; i += FU_TEST_MTD_DEVICE_ERASESIZE) {
+		fu_test_mtd_device_add_pread_event(device,
+						   i,
+						   flash->data + i,
+						   FU_TEST_MTD_DEVICE_ERASESIZE);
+	}
+}
+
 static FuMtdDevice *
-fu_test_mtd_device_new_for_security_attrs(FuTest *self, gboolean add_event, gboolean locked)
+fu_test_mtd_device_new_emulated(FuTest *self)
 {
 	gboolean ret;
 	g_autofree gchar *sysfs_path = NULL;
@@ -112,7 +198,7 @@ fu_test_mtd_device_new_for_security_attrs(FuTest *self, gboolean add_event, gboo
 	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
 	g_autoptr(GError) error = NULL;
 
-	tmpdir = fu_temporary_directory_new("mtd-security-attrs", &error);
+	tmpdir = fu_temporary_directory_new("mtd-emulated", &error);
 	g_assert_no_error(error);
 	g_assert_nonnull(tmpdir);
 	sysfs_path =
@@ -134,10 +220,17 @@ fu_test_mtd_device_new_for_security_attrs(FuTest *self, gboolean add_event, gboo
 	g_assert_true(ret);
 
 	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
-	if (add_event)
-		fu_test_mtd_device_add_memislocked_event(FU_MTD_DEVICE(device), locked);
 	return FU_MTD_DEVICE(g_steal_pointer(&device));
 }
+
+static FuMtdDevice *
+fu_test_mtd_device_new_for_security_attrs(FuTest *self, gboolean add_event, gboolean locked)
+{
+	g_autoptr(FuMtdDevice) device = fu_test_mtd_device_new_emulated(self);
+	if (add_event)
+		fu_test_mtd_device_add_memislocked_event(device, locked);
+	return g_steal_pointer(&device);
+}
 #endif
 
 static FuFirmware *
@@ -393,6 +486,112 @@ fu_test_mtd_device_security_attrs_missing_func(gconstpointer user_data)
 #endif
 }
 
+static void
+fu_test_mtd_device_differential_func(gconstpointer user_data)
+{
+#ifndef HAVE_MTD_USER_H
+	g_test_skip("no mtd-user.h support");
+#else
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuMtdDevice) device = fu_test_mtd_device_new_emulated(self);
+	g_autoptr(FuProgress) progress = fu_progress_new(NULL);
+	g_autoptr(GByteArray) flash = g_byte_array_new();
+	g_autoptr(GByteArray) image = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fu_device_set_fwupd_version(FU_DEVICE(device), PACKAGE_VERSION);
+	fu_device_add_private_flag(FU_DEVICE(device),
+				   FU_DEVICE_PRIVATE_FLAG_STRICT_EMULATION_ORDER);
+	fu_device_add_private_flag(FU_DEVICE(device), FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE);
+
+	/* change two adjacent erase blocks and one other */
+	fu_byte_array_set_size(flash, FU_TEST_MTD_DEVICE_SIZE, 0xFF);
+	fu_byte_array_set_size(image, FU_TEST_MTD_DEVICE_SIZE, 0xFF);
+	for (gsize i = 0x2000; i < 0x4000; i++)
+		image->data[i] = (guint8)i;
+	image->data[0x6010] = 0x12;
+	blob = g_bytes_new(image->data, image->len);
+	firmware = fu_firmware_new_from_bytes(blob);
+
+	/* only the changed blocks are erased and written, the adjacent ones together */
+	fu_test_mtd_device_add_pread_events(device, flash);
+	fu_test_mtd_device_add_badblock_event(device, 0x2000, FALSE);
+	fu_test_mtd_device_add_badblock_event(device, 0x3000, FALSE);
+	fu_test_mtd_device_add_badblock_event(device, 0x6000, FALSE);
+	fu_test_mtd_device_add_erase_event(device, 0x2000, 0x2000);
+	fu_test_mtd_device_add_erase_event(device, 0x6000, 0x1000);
+	fu_test_mtd_device_add_pwrite_event(device, 0x2000, image->data + 0x2000, 0x2000);
+	fu_test_mtd_device_add_pwrite_event(device, 0x6000, image->data + 0x6000, 0x1000);
+	fu_test_mtd_device_add_pread_event(device, 0x2000, image->data + 0x2000, 0x2000);
+	fu_test_mtd_device_add_pread_event(device, 0x6000, image->data + 0x6000, 0x1000);
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* writing the same image again only reads */
+	fu_device_clear_events(FU_DEVICE(device));
+	fu_test_mtd_device_add_pread_events(device, image);
+	fu_progress_reset(progress);
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+#endif
+}
+
+static void
+fu_test_mtd_device_differential_bad_block_func(gconstpointer user_data)
+{
+#ifndef HAVE_MTD_USER_H
+	g_test_skip("no mtd-user.h support");
+#else
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuMtdDevice) device = fu_test_mtd_device_new_emulated(self);
+	g_autoptr(FuProgress) progress = fu_progress_new(NULL);
+	g_autoptr(GByteArray) flash = g_byte_array_new();
+	g_autoptr(GByteArray) image = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fu_device_add_private_flag(FU_DEVICE(device),
+				   FU_DEVICE_PRIVATE_FLAG_STRICT_EMULATION_ORDER);
+	fu_device_add_private_flag(FU_DEVICE(device), FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE);
+	fu_byte_array_set_size(flash, FU_TEST_MTD_DEVICE_SIZE, 0xFF);
+	fu_byte_array_set_size(image, FU_TEST_MTD_DEVICE_SIZE, 0xFF);
+	image->data[0x2000] = 0x00;
+	blob = g_bytes_new(image->data, image->len);
+	firmware = fu_firmware_new_from_bytes(blob);
+
+	/* nothing gets erased as the changed block is bad */
+	for (gsize i = 0; i <= 0x2000; i += FU_TEST_MTD_DEVICE_ERASESIZE) {
+		fu_test_mtd_device_add_pread_event(device,
+						   i,
+						   flash->data + i,
+						   FU_TEST_MTD_DEVICE_ERASESIZE);
+	}
+	fu_test_mtd_device_add_badblock_event(device, 0x2000, TRUE);
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_WRITE);
+	g_assert_false(ret);
+#endif
+}
+
 static void
 fu_test_mtd_device_quirk_metadata_offset_func(gconstpointer user_data)
 {
@@ -763,6 +962,12 @@ main(int argc, char **argv)
 	g_test_add_data_func("/mtd/device/security-attrs/missing",
 			     self,
 			     fu_test_mtd_device_security_attrs_missing_func);
+	g_test_add_data_func("/mtd/device/differential",
+			     self,
+			     fu_test_mtd_device_differential_func);
+	g_test_add_data_func("/mtd/device/differential/bad-block",
+			     self,
+			     fu_test_mtd_device_differential_bad_block_func);
 	g_test_add_data_func("/mtd/device/quirk/metadata-offset",
 			     self,
 			     fu_test_mtd_device_quirk_metadata_offset_func);
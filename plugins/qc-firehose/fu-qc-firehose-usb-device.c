@@ -17,6 +17,7 @@
 #define FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP "no-zlp"
 
 #define FU_QC_FIREHOSE_USB_DEVICE_RAW_BUFFER_SIZE (4 * FU_KB)
+#define FU_QC_FIREHOSE_USB_DEVICE_TRANSFERS_MAX	  32
 
 struct _FuQcFirehoseUsbDevice {
 	FuUsbDevice parent_instance;
@@ -98,9 +99,9 @@ fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
 				guint timeout_ms,
 				GError **error)
 {
-	gsize actual_len = 0;
-	g_autoptr(GPtrArray) chunks = NULL;
-	g_autoptr(GByteArray) bufmut = g_byte_array_sized_new(sz);
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob = NULL;
 
 	/* sanity check */
 	if (self->maxpktsize_out == 0) {
@@ -111,45 +112,27 @@ fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
 		return FALSE;
 	}
 
-	/* copy const data to mutable GByteArray */
-	g_byte_array_append(bufmut, buf, sz);
-	chunks = fu_chunk_array_mutable_new(bufmut->data,
-					    bufmut->len,
-					    0,
-					    0,
-					    self->maxpktsize_out,
-					    error);
+	/* queue all the packets at once, as the buffer is only used in this function */
+	fu_dump_raw(G_LOG_DOMAIN, "tx packet", buf, sz);
+	blob = g_bytes_new_static(buf, sz);
+	chunks = fu_chunk_array_new_from_bytes(blob,
+					       FU_CHUNK_ADDR_OFFSET_NONE,
+					       FU_CHUNK_PAGESZ_NONE,
+					       self->maxpktsize_out,
+					       error);
 	if (chunks == NULL)
 		return FALSE;
-	if (chunks->len > 1)
-		g_debug("split into %u chunks", chunks->len);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index(chunks, i);
-
-		fu_dump_raw(G_LOG_DOMAIN,
-			    "tx packet",
-			    fu_chunk_get_data(chk),
-			    fu_chunk_get_data_sz(chk));
-		if (!fu_usb_device_bulk_transfer(FU_USB_DEVICE(self),
-						 self->ep_out,
-						 fu_chunk_get_data_out(chk),
-						 fu_chunk_get_data_sz(chk),
-						 &actual_len,
-						 timeout_ms,
-						 NULL,
-						 error)) {
-			g_prefix_error_literal(error, "failed to do bulk transfer (write data): ");
-			return FALSE;
-		}
-		if (actual_len != fu_chunk_get_data_sz(chk)) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "only wrote 0x%x of 0x%x bytes",
-				    (guint)actual_len,
-				    (guint)fu_chunk_get_data_sz(chk));
-			return FALSE;
-		}
+	if (fu_chunk_array_length(chunks) > 1)
+		g_debug("split into %u chunks", fu_chunk_array_length(chunks));
+	if (!fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(self),
+						self->ep_out,
+						chunks,
+						FU_QC_FIREHOSE_USB_DEVICE_TRANSFERS_MAX,
+						timeout_ms,
+						progress,
+						error)) {
+		g_prefix_error_literal(error, "failed to do bulk transfer (write data): ");
+		return FALSE;
 	}
 
 	/* sent zlp packet if needed */
@@ -43,6 +43,7 @@ static void
 fu_wch_ch347_cfi_device_init(FuWchCh347CfiDevice *self)
 {
 	fu_device_add_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_NO_VERSION_EXPECTED);
+	fu_device_add_private_flag(FU_DEVICE(self), FU_CFI_DEVICE_FLAG_DIFFERENTIAL_WRITE);
 	fu_device_add_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_CAN_EMULATION_TAG);
 	fu_device_set_proxy_gtype(FU_DEVICE(self), FU_TYPE_WCH_CH347_DEVICE);
 }
@@ -111,8 +111,11 @@ fu_cabinet_verify_payload_target(FuCabinet *self,
 				 FuJcatVerifyFlags jcat_flags,
 				 GError **error)
 {
-	g_autofree gchar *checksum_sha256 = NULL;
-	g_autofree gchar *checksum_sha512 = NULL;
+	GChecksumType checksum_types[] = {
+	    G_CHECKSUM_SHA256,
+	    G_CHECKSUM_SHA512,
+	};
+	g_autoptr(GPtrArray) checksums = NULL;
 	g_autoptr(GPtrArray) results = NULL;
 	g_autoptr(FuInputStream) stream = NULL;
 	g_autoptr(FwupdJcatBlob) blob_target_sha256 = NULL;
@@ -125,21 +128,25 @@ fu_cabinet_verify_payload_target(FuCabinet *self,
 	if (item == NULL)
 		return FALSE;
 
-	/* add SHA-256 */
+	/* compute both in one pass */
 	stream = fu_firmware_get_stream(img_blob, error);
 	if (stream == NULL)
 		return FALSE;
-	checksum_sha256 = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-	if (checksum_sha256 == NULL)
+	checksums = fu_input_stream_compute_checksums(stream,
+						      checksum_types,
+						      G_N_ELEMENTS(checksum_types),
+						      error);
+	if (checksums == NULL)
 		return FALSE;
-	blob_target_sha256 = fwupd_jcat_blob_new_utf8(FWUPD_JCAT_BLOB_KIND_SHA256, checksum_sha256);
+
+	/* add SHA-256 */
+	blob_target_sha256 = fwupd_jcat_blob_new_utf8(FWUPD_JCAT_BLOB_KIND_SHA256,
+						      g_ptr_array_index(checksums, 0));
 	fwupd_jcat_item_add_blob(item_target, blob_target_sha256);
 
 	/* add SHA-512 */
-	checksum_sha512 = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA512, error);
-	if (checksum_sha512 == NULL)
-		return FALSE;
-	blob_target_sha512 = fwupd_jcat_blob_new_utf8(FWUPD_JCAT_BLOB_KIND_SHA512, checksum_sha512);
+	blob_target_sha512 = fwupd_jcat_blob_new_utf8(FWUPD_JCAT_BLOB_KIND_SHA512,
+						      g_ptr_array_index(checksums, 1));
 	fwupd_jcat_item_add_blob(item_target, blob_target_sha512);
 
 	results = fu_jcat_context_verify_target(self->jcat_context,
@@ -979,6 +986,7 @@ fu_cabinet_parse(FuFirmware *firmware,
 		 GError **error)
 {
 	FuCabinet *self = FU_CABINET(firmware);
+	FuFirmwareParseFlags parse_flags = flags | FU_FIRMWARE_PARSE_FLAG_ONLY_BASENAME;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(XbQuery) query = NULL;
@@ -989,6 +997,12 @@ fu_cabinet_parse(FuFirmware *firmware,
 
 	/* decompress and calculate container hashes */
 	if (stream != NULL) {
+		GChecksumType checksum_types[] = {
+		    G_CHECKSUM_SHA1,
+		    G_CHECKSUM_SHA256,
+		};
+		g_autoptr(GPtrArray) checksums = NULL;
+
 		if ((flags & FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM) == 0 &&
 		    (flags & FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB) == 0) {
 			g_set_error_literal(
@@ -999,20 +1013,21 @@ fu_cabinet_parse(FuFirmware *firmware,
 			    "FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB for accurate checksums");
 			return FALSE;
 		}
+
+		/* only decompress the payloads that are used, unless caching every blob */
+		if ((flags & FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB) == 0)
+			parse_flags |= FU_FIRMWARE_PARSE_FLAG_LAZY;
 		if (!FU_FIRMWARE_CLASS(fu_cabinet_parent_class)
-			 ->parse(firmware,
-				 stream,
-				 flags | FU_FIRMWARE_PARSE_FLAG_ONLY_BASENAME,
-				 error))
-			return FALSE;
-		self->container_checksum =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA1, error);
-		if (self->container_checksum == NULL)
+			 ->parse(firmware, stream, parse_flags, error))
 			return FALSE;
-		self->container_checksum_alt =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-		if (self->container_checksum_alt == NULL)
+		checksums = fu_input_stream_compute_checksums(stream,
+							      checksum_types,
+							      G_N_ELEMENTS(checksum_types),
+							      error);
+		if (checksums == NULL)
 			return FALSE;
+		self->container_checksum = g_strdup(g_ptr_array_index(checksums, 0));
+		self->container_checksum_alt = g_strdup(g_ptr_array_index(checksums, 1));
 	}
 
 	/* build xmlb silo */
@@ -1462,6 +1462,30 @@ fu_dbus_daemon_method_get_upgrades(FuDbusDaemon *self,
 	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
 }
 
+static void
+fu_dbus_daemon_method_get_upgrades_all(FuDbusDaemon *self,
+				       GVariant *parameters,
+				       FuEngineRequest *request,
+				       GDBusMethodInvocation *invocation)
+{
+	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	GVariant *val;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	devices = fu_engine_get_upgrades_all(engine, request, &error);
+	if (devices == NULL) {
+		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
+		return;
+	}
+	val = fu_dbus_daemon_device_array_to_variant(self, request, devices, &error);
+	if (val == NULL) {
+		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
+		return;
+	}
+	g_dbus_method_invocation_return_value(invocation, val);
+}
+
 static void
 fu_dbus_daemon_return_get_remotes(FuDbusDaemon *self,
 				  GDBusMethodInvocation *invocation,
@@ -2147,6 +2171,10 @@ fu_dbus_daemon_method_modify_remote(FuDbusDaemon *self,
 	    "Password",
 	    NULL,
 	};
+	const gchar *keys_refresh[] = {
+	    "MetadataNotModified",
+	    NULL,
+	};
 
 	/* check the id exists */
 	g_variant_get(parameters, "(&s&s&s)", &remote_id, &key, &value);
@@ -2156,6 +2184,8 @@ fu_dbus_daemon_method_modify_remote(FuDbusDaemon *self,
 		action_id = "org.freedesktop.fwupd.enable-remote";
 	} else if (g_strv_contains(keys_modify, key)) {
 		action_id = "org.freedesktop.fwupd.modify-remote";
+	} else if (g_strv_contains(keys_refresh, key)) {
+		action_id = "org.freedesktop.fwupd.refresh-remote";
 	} else {
 		g_dbus_method_invocation_return_error(invocation,
 						      FWUPD_ERROR,
@@ -2746,6 +2776,7 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 	    {"SelfSign", fu_dbus_daemon_method_self_sign},
 	    {"GetDowngrades", fu_dbus_daemon_method_get_downgrades},
 	    {"GetUpgrades", fu_dbus_daemon_method_get_upgrades},
+	    {"GetUpgradesAll", fu_dbus_daemon_method_get_upgrades_all},
 	    {"GetRemotes", fu_dbus_daemon_method_get_remotes},
 	    {"GetHistory", fu_dbus_daemon_method_get_history},
 	    {"GetHostSecurityAttrs", fu_dbus_daemon_method_get_host_security_attrs},
@@ -672,6 +672,141 @@ fu_device_list_func(void)
 	g_assert_cmpstr(fu_device_get_id(device), ==, "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882");
 }
 
+static void
+fu_device_list_index_func(void)
+{
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+	g_autoptr(FuDevice) device1 = fu_device_new(ctx);
+	g_autoptr(FuDevice) device2 = fu_device_new(ctx);
+	g_autoptr(FuDevice) device_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *guid_foobar = fwupd_guid_hash_string("foobar");
+	gboolean ret;
+
+	fu_device_set_id(device1, "device1");
+	fu_device_add_instance_id(device1, "foobar");
+	fu_device_list_add(device_list, device1);
+	fu_device_set_id(device2, "device2");
+	fu_device_add_instance_id(device2, "foobar");
+	fu_device_list_add(device_list, device2);
+
+	/* the first added device always wins */
+	device_tmp = fu_device_list_get_by_guid(device_list, "foobar", &error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device1);
+	g_clear_object(&device_tmp);
+
+	/* GUID added after the device was added to the list */
+	fwupd_device_add_guid(FWUPD_DEVICE(device2), "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	device_tmp = fu_device_list_get_by_guid(device_list,
+						"2082b5e0-7a64-478a-b1b2-e3404fab6dad",
+						&error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device2);
+	g_clear_object(&device_tmp);
+
+	/* device ID changed after the device was added to the list */
+	fu_device_set_id(device2, "device3");
+	device_tmp = fu_device_list_get_by_id(device_list, fu_device_get_id(device2), &error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device2);
+	g_clear_object(&device_tmp);
+	device_tmp = fu_device_list_get_by_id(device_list,
+					      "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882",
+					      &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device_tmp);
+	g_clear_error(&error);
+
+	/* GUIDs replaced with the same number of different ones when rescanned */
+	ret = fu_device_rescan(device2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fwupd_device_add_guid(FWUPD_DEVICE(device2), "a3ed4e31-26a2-4bc6-b6e5-9d1a8d6d2a6b");
+	fwupd_device_add_guid(FWUPD_DEVICE(device2), guid_foobar);
+	g_assert_cmpint(fu_device_get_guids(device2)->len, ==, 2);
+	device_tmp = fu_device_list_get_by_guid(device_list,
+						"2082b5e0-7a64-478a-b1b2-e3404fab6dad",
+						&error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device_tmp);
+	g_clear_error(&error);
+	device_tmp = fu_device_list_get_by_guid(device_list,
+						"a3ed4e31-26a2-4bc6-b6e5-9d1a8d6d2a6b",
+						&error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device2);
+	g_clear_object(&device_tmp);
+	device_tmp = fu_device_list_get_by_guid(device_list, "foobar", &error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device1);
+	g_clear_object(&device_tmp);
+
+	/* removed devices are no longer found */
+	fu_device_list_remove(device_list, device1);
+
+	device_tmp = fu_device_list_get_by_guid(device_list, "foobar", &error);
+	g_assert_no_error(error);
+	g_assert_true(device_tmp == device2);
+	g_clear_object(&device_tmp);
+	fu_device_list_remove_all(device_list);
+	device_tmp = fu_device_list_get_by_guid(device_list, "foobar", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device_tmp);
+}
+
+static void
+fu_device_list_lookup_func(void)
+{
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	guint sizes[] = {10, 100, 1000};
+
+	for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+		g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+		g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func(g_object_unref);
+		g_autoptr(GTimer) timer = g_timer_new();
+
+		/* add */
+		for (guint j = 0; j < sizes[i]; j++) {
+			g_autoptr(FuDevice) device = fu_device_new(ctx);
+			g_autofree gchar *id = g_strdup_printf("device%u", j);
+			g_autofree gchar *instance_id = NULL;
+			g_autofree gchar *physical_id = NULL;
+
+			instance_id = g_strdup_printf("USB\\VID_273F&PID_%04X", j);
+			physical_id = g_strdup_printf("usb:%02x:%02x", j / 256, j % 256);
+			fu_device_set_id(device, id);
+			fu_device_set_physical_id(device, physical_id);
+			fu_device_add_instance_id(device, instance_id);
+			fu_device_list_add(device_list, device);
+			g_ptr_array_add(devices, g_steal_pointer(&device));
+		}
+		g_debug("add %u=%.3fms", sizes[i], g_timer_elapsed(timer, NULL) * 1000.f);
+
+		/* lookup each device by GUID and by ID */
+		g_timer_reset(timer);
+		for (guint j = 0; j < devices->len; j++) {
+			FuDevice *device = g_ptr_array_index(devices, j);
+			GPtrArray *guids = fu_device_get_guids(device);
+			g_autoptr(FuDevice) device1 = NULL;
+			g_autoptr(FuDevice) device2 = NULL;
+			g_autoptr(GError) error = NULL;
+
+			device1 = fu_device_list_get_by_guid(device_list,
+							     g_ptr_array_index(guids, 0),
+							     &error);
+			g_assert_no_error(error);
+			g_assert_true(device1 == device);
+			device2 =
+			    fu_device_list_get_by_id(device_list, fu_device_get_id(device), &error);
+			g_assert_no_error(error);
+			g_assert_true(device2 == device);
+		}
+		g_debug("lookup %u=%.3fms", sizes[i], g_timer_elapsed(timer, NULL) * 1000.f);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -680,6 +815,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device-list/unconnected-no-delay",
 			fu_device_list_unconnected_no_delay_func);
 	g_test_add_func("/fwupd/device-list/equivalent-id", fu_device_list_equivalent_id_func);
+	g_test_add_func("/fwupd/device-list/index", fu_device_list_index_func);
+	g_test_add_func("/fwupd/device-list/lookup", fu_device_list_lookup_func);
 	g_test_add_func("/fwupd/device-list/delay", fu_device_list_delay_func);
 	g_test_add_func("/fwupd/device-list/explicit-order", fu_device_list_explicit_order_func);
 	g_test_add_func("/fwupd/device-list/explicit-order-post",
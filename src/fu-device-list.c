@@ -29,10 +29,23 @@
 static void
 fu_device_list_finalize(GObject *obj);
 
+typedef enum {
+	FU_DEVICE_LIST_INDEX_GUID,
+	FU_DEVICE_LIST_INDEX_GUID_OLD,
+	FU_DEVICE_LIST_INDEX_ID,
+	FU_DEVICE_LIST_INDEX_ID_OLD,
+	FU_DEVICE_LIST_INDEX_CONNECTION,
+	FU_DEVICE_LIST_INDEX_CONNECTION_OLD,
+	FU_DEVICE_LIST_INDEX_LAST,
+} FuDeviceListIndex;
+
 struct _FuDeviceList {
 	GObject parent_instance;
 	GPtrArray *devices; /* of FuDeviceItem */
 	GRWLock devices_mutex;
+	GHashTable *index[FU_DEVICE_LIST_INDEX_LAST]; /* key : GPtrArray of FuDeviceItem */
+	guint64 index_seq;
+	gint index_dirty; /* atomic */
 };
 
 enum { SIGNAL_ADDED, SIGNAL_REMOVED, SIGNAL_CHANGED, SIGNAL_LAST };
@@ -51,8 +64,18 @@ typedef struct {
 	FuDevice *device_old;
 	FuDeviceList *self; /* no ref */
 	guint remove_id;
+	guint64 index_seq;
+	GPtrArray *index_entries; /* of FuDeviceListIndexEntry */
+	guint index_guids_cnt[2];
+	guint index_rescan_cnt[2];
+	gint index_dirty; /* atomic */
 } FuDeviceItem;
 
+typedef struct {
+	FuDeviceListIndex kind;
+	gchar *key;
+} FuDeviceListIndexEntry;
+
 static void
 fu_device_list_codec_iface_init(FwupdCodecInterface *iface);
 
@@ -261,6 +284,234 @@ fu_device_list_get_active(FuDeviceList *self)
 	return devices;
 }
 
+static void
+fu_device_list_index_entry_free(FuDeviceListIndexEntry *entry)
+{
+	g_free(entry->key);
+	g_free(entry);
+}
+
+static gchar *
+fu_device_list_index_connection_key(const gchar *physical_id, const gchar *logical_id)
+{
+	if (physical_id == NULL)
+		return NULL;
+	if (logical_id == NULL)
+		return g_strdup(physical_id);
+	return g_strdup_printf("%s\n%s", physical_id, logical_id);
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_insert(FuDeviceList *self,
+			    FuDeviceItem *item,
+			    FuDeviceListIndex kind,
+			    const gchar *key)
+{
+	GPtrArray *items = g_hash_table_lookup(self->index[kind], key);
+	FuDeviceListIndexEntry *entry;
+	guint idx;
+
+	if (items == NULL) {
+		items = g_ptr_array_new();
+		g_hash_table_insert(self->index[kind], g_strdup(key), items);
+	} else if (g_ptr_array_find(items, item, NULL)) {
+		return;
+	}
+
+	/* keep the same order as the devices array so the first match is unchanged */
+	for (idx = items->len; idx > 0; idx--) {
+		FuDeviceItem *item_tmp = g_ptr_array_index(items, idx - 1);
+		if (item_tmp->index_seq < item->index_seq)
+			break;
+	}
+	g_ptr_array_insert(items, idx, item);
+
+	/* so we can remove it again without knowing the old device properties */
+	entry = g_new0(FuDeviceListIndexEntry, 1);
+	entry->kind = kind;
+	entry->key = g_strdup(key);
+	g_ptr_array_add(item->index_entries, entry);
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_remove_item(FuDeviceList *self, FuDeviceItem *item)
+{
+	for (guint i = 0; i < item->index_entries->len; i++) {
+		FuDeviceListIndexEntry *entry = g_ptr_array_index(item->index_entries, i);
+		GPtrArray *items = g_hash_table_lookup(self->index[entry->kind], entry->key);
+		if (items == NULL)
+			continue;
+		g_ptr_array_remove(items, item);
+		if (items->len == 0)
+			g_hash_table_remove(self->index[entry->kind], entry->key);
+	}
+	g_ptr_array_set_size(item->index_entries, 0);
+	item->index_guids_cnt[0] = 0;
+	item->index_guids_cnt[1] = 0;
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_remove_kind(FuDeviceList *self, FuDeviceItem *item, FuDeviceListIndex kind)
+{
+	for (guint i = item->index_entries->len; i > 0; i--) {
+		FuDeviceListIndexEntry *entry = g_ptr_array_index(item->index_entries, i - 1);
+		GPtrArray *items;
+
+		if (entry->kind != kind)
+			continue;
+		items = g_hash_table_lookup(self->index[entry->kind], entry->key);
+		if (items != NULL) {
+			g_ptr_array_remove(items, item);
+			if (items->len == 0)
+				g_hash_table_remove(self->index[entry->kind], entry->key);
+		}
+		g_ptr_array_remove_index(item->index_entries, i - 1);
+	}
+}
+
+/* GUIDs are only removed from a device when it is rescanned, otherwise only the new ones have to
+ * be added */
+static void
+fu_device_list_index_add_guids(FuDeviceList *self, FuDeviceItem *item)
+{
+	FuDevice *devices[] = {item->device, item->device_old};
+	FuDeviceListIndex kinds[] = {FU_DEVICE_LIST_INDEX_GUID, FU_DEVICE_LIST_INDEX_GUID_OLD};
+
+	for (guint i = 0; i < G_N_ELEMENTS(devices); i++) {
+		GPtrArray *guids;
+		guint rescan_cnt;
+
+		if (devices[i] == NULL)
+			continue;
+		rescan_cnt = fu_device_get_rescan_cnt(devices[i]);
+		if (item->index_rescan_cnt[i] != rescan_cnt) {
+			fu_device_list_index_remove_kind(self, item, kinds[i]);
+			item->index_guids_cnt[i] = 0;
+			item->index_rescan_cnt[i] = rescan_cnt;
+		}
+		guids = fu_device_get_guids(devices[i]);
+		for (guint j = item->index_guids_cnt[i]; j < guids->len; j++) {
+			const gchar *guid = g_ptr_array_index(guids, j);
+			fu_device_list_index_insert(self, item, kinds[i], guid);
+		}
+		item->index_guids_cnt[i] = guids->len;
+	}
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_add_item(FuDeviceList *self, FuDeviceItem *item)
+{
+	FuDevice *devices[] = {item->device, item->device_old};
+	FuDeviceListIndex kinds_id[] = {FU_DEVICE_LIST_INDEX_ID, FU_DEVICE_LIST_INDEX_ID_OLD};
+	FuDeviceListIndex kinds_connection[] = {FU_DEVICE_LIST_INDEX_CONNECTION,
+						FU_DEVICE_LIST_INDEX_CONNECTION_OLD};
+
+	fu_device_list_index_remove_item(self, item);
+	g_atomic_int_set(&item->index_dirty, FALSE);
+	for (guint i = 0; i < G_N_ELEMENTS(devices); i++) {
+		const gchar *ids[3] = {NULL};
+		g_autofree gchar *key = NULL;
+
+		if (devices[i] == NULL)
+			continue;
+		ids[0] = fu_device_get_id(devices[i]);
+		ids[1] = fu_device_get_equivalent_id(devices[i]);
+		for (guint j = 0; j < G_N_ELEMENTS(ids); j++) {
+			if (ids[j] != NULL)
+				fu_device_list_index_insert(self, item, kinds_id[i], ids[j]);
+		}
+		key = fu_device_list_index_connection_key(fu_device_get_physical_id(devices[i]),
+							  fu_device_get_logical_id(devices[i]));
+		if (key != NULL)
+			fu_device_list_index_insert(self, item, kinds_connection[i], key);
+	}
+	fu_device_list_index_add_guids(self, item);
+}
+
+/* the device or one of the indexed properties has changed, so rebuild on next use */
+static void
+fu_device_list_index_invalidate_item(FuDeviceItem *item)
+{
+	g_atomic_int_set(&item->index_dirty, TRUE);
+	g_atomic_int_set(&item->self->index_dirty, TRUE);
+}
+
+static void
+fu_device_list_index_ensure(FuDeviceList *self, gboolean with_guids)
+{
+	g_autoptr(GRWLockWriterLocker) locker = g_rw_lock_writer_locker_new(&self->devices_mutex);
+	gboolean dirty = g_atomic_int_compare_and_exchange(&self->index_dirty, TRUE, FALSE);
+
+	g_return_if_fail(locker != NULL);
+
+	/* nothing to do */
+	if (!dirty && !with_guids)
+		return;
+	for (guint i = 0; i < self->devices->len; i++) {
+		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
+		if (g_atomic_int_get(&item->index_dirty)) {
+			fu_device_list_index_add_item(self, item);
+			continue;
+		}
+		if (with_guids)
+			fu_device_list_index_add_guids(self, item);
+	}
+}
+
+/* returns the first active match, and only then the first old match */
+static FuDeviceItem *
+fu_device_list_index_lookup(FuDeviceList *self,
+			    FuDeviceListIndex kind,
+			    FuDeviceListIndex kind_old,
+			    const gchar *key)
+{
+	FuDeviceListIndex kinds[] = {kind, kind_old};
+	for (guint i = 0; i < G_N_ELEMENTS(kinds); i++) {
+		GPtrArray *items = g_hash_table_lookup(self->index[kinds[i]], key);
+		if (items != NULL && items->len > 0)
+			return g_ptr_array_index(items, 0);
+	}
+	return NULL;
+}
+
+static void
+fu_device_list_item_notify_cb(FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceItem *item = (FuDeviceItem *)user_data;
+	fu_device_list_index_invalidate_item(item);
+}
+
+static void
+fu_device_list_item_watch(FuDeviceItem *item, gboolean enabled)
+{
+	FuDevice *devices[] = {item->device, item->device_old};
+	const gchar *signal_names[] = {"notify::id",
+				       "notify::equivalent-id",
+				       "notify::physical-id",
+				       "notify::logical-id"};
+
+	for (guint i = 0; i < G_N_ELEMENTS(devices); i++) {
+		if (devices[i] == NULL)
+			continue;
+		if (!enabled) {
+			g_signal_handlers_disconnect_by_func(devices[i],
+							     fu_device_list_item_notify_cb,
+							     item);
+			continue;
+		}
+		for (guint j = 0; j < G_N_ELEMENTS(signal_names); j++) {
+			g_signal_connect(FU_DEVICE(devices[i]),
+					 signal_names[j],
+					 G_CALLBACK(fu_device_list_item_notify_cb),
+					 item);
+		}
+	}
+}
+
 static FuDeviceItem *
 fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 {
@@ -282,21 +533,22 @@ fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 static FuDeviceItem *
 fu_device_list_find_by_guid(FuDeviceList *self, const gchar *guid)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (fu_device_has_guid(item->device, guid))
-			return item;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == NULL)
-			continue;
-		if (fu_device_has_guid(item->device_old, guid))
-			return item;
+	g_autofree gchar *guid_tmp = NULL;
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
+	/* make valid */
+	if (!fwupd_guid_is_valid(guid)) {
+		guid_tmp = fwupd_guid_hash_string(guid);
+		guid = guid_tmp;
 	}
-	return NULL;
+
+	fu_device_list_index_ensure(self, TRUE);
+	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
+	g_return_val_if_fail(locker != NULL, NULL);
+	return fu_device_list_index_lookup(self,
+					   FU_DEVICE_LIST_INDEX_GUID,
+					   FU_DEVICE_LIST_INDEX_GUID_OLD,
+					   guid);
 }
 
 static FuDeviceItem *
@@ -304,28 +556,19 @@ fu_device_list_find_by_connection(FuDeviceList *self,
 				  const gchar *physical_id,
 				  const gchar *logical_id)
 {
+	g_autofree gchar *key = NULL;
 	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
 	if (physical_id == NULL)
 		return NULL;
+	key = fu_device_list_index_connection_key(physical_id, logical_id);
+	fu_device_list_index_ensure(self, FALSE);
 	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
 	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device_old;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
-	}
-	return NULL;
+	return fu_device_list_index_lookup(self,
+					   FU_DEVICE_LIST_INDEX_CONNECTION,
+					   FU_DEVICE_LIST_INDEX_CONNECTION_OLD,
+					   key);
 }
 
 static gint
@@ -358,6 +601,32 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 			    device_id);
 		return NULL;
 	}
+
+	/* all device IDs have the same length, so a full ID can only ever match exactly */
+	if (fwupd_device_id_is_valid(device_id)) {
+		FuDeviceListIndex kinds[] = {FU_DEVICE_LIST_INDEX_ID, FU_DEVICE_LIST_INDEX_ID_OLD};
+		fu_device_list_index_ensure(self, FALSE);
+		g_rw_lock_reader_lock(&self->devices_mutex);
+		for (guint i = 0; i < G_N_ELEMENTS(kinds) && items->len == 0; i++) {
+			GPtrArray *items_tmp;
+			items_tmp = g_hash_table_lookup(self->index[kinds[i]], device_id);
+			if (items_tmp != NULL)
+				g_ptr_array_extend(items, items_tmp, NULL, NULL);
+		}
+		g_rw_lock_reader_unlock(&self->devices_mutex);
+		if (items->len > 0) {
+			g_ptr_array_sort(items, fu_device_list_item_sort_by_priority_cb);
+			return g_steal_pointer(&items);
+		}
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "device ID %s was not found",
+			    device_id);
+		return NULL;
+	}
+
+	/* abbreviated hashes have to be compared against every device */
 	g_rw_lock_reader_lock(&self->devices_mutex);
 	for (guint i = 0; i < self->devices->len; i++) {
 		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
@@ -690,7 +959,10 @@ fu_device_list_item_set_device_old(FuDeviceItem *item, FuDevice *device)
 {
 	fu_device_set_parent(device, NULL);
 	fu_device_remove_children(device);
+	fu_device_list_item_watch(item, FALSE);
 	g_set_object(&item->device_old, device);
+	fu_device_list_item_watch(item, TRUE);
+	fu_device_list_index_invalidate_item(item);
 }
 
 /* this should never be required, and yet here we are */
@@ -703,7 +975,10 @@ fu_device_list_item_set_device(FuDeviceItem *item, FuDevice *device)
 	if (device != NULL) {
 		g_object_weak_ref(G_OBJECT(device), fu_device_list_item_finalized_cb, item);
 	}
+	fu_device_list_item_watch(item, FALSE);
 	g_set_object(&item->device, device);
+	fu_device_list_item_watch(item, TRUE);
+	fu_device_list_index_invalidate_item(item);
 }
 
 static void
@@ -867,7 +1142,9 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 					      device,
 					      FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR |
 						  FU_DEVICE_INCORPORATE_FLAG_UPDATE_STATE);
+			fu_device_list_item_watch(item, FALSE);
 			g_set_object(&item->device_old, item->device);
+			fu_device_list_item_watch(item, TRUE);
 			fu_device_list_item_set_device(item, device);
 			fu_device_list_clear_wait_for_replug(self, item);
 			fu_device_list_emit_device_changed(self, device);
@@ -937,9 +1214,13 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	/* add helper */
 	item = g_new0(FuDeviceItem, 1);
 	item->self = self; /* no ref */
+	item->index_entries =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_index_entry_free);
 	fu_device_list_item_set_device(item, device);
 	g_rw_lock_writer_lock(&self->devices_mutex);
+	item->index_seq = self->index_seq++;
 	g_ptr_array_add(self->devices, item);
+	fu_device_list_index_add_item(self, item);
 	g_rw_lock_writer_unlock(&self->devices_mutex);
 	fu_device_list_emit_device_added(self, device);
 }
@@ -1110,9 +1391,11 @@ fu_device_list_item_free(FuDeviceItem *item)
 {
 	if (item->remove_id != 0)
 		g_source_remove(item->remove_id);
-	if (item->device_old != NULL)
-		g_object_unref(item->device_old);
+	fu_device_list_index_remove_item(item->self, item);
+	fu_device_list_item_watch(item, FALSE);
+	g_clear_object(&item->device_old);
 	fu_device_list_item_set_device(item, NULL);
+	g_ptr_array_unref(item->index_entries);
 	g_free(item);
 }
 
@@ -1202,6 +1485,12 @@ fu_device_list_init(FuDeviceList *self)
 {
 	self->devices = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_item_free);
 	g_rw_lock_init(&self->devices_mutex);
+	for (guint i = 0; i < FU_DEVICE_LIST_INDEX_LAST; i++) {
+		self->index[i] = g_hash_table_new_full(g_str_hash,
+						       g_str_equal,
+						       g_free,
+						       (GDestroyNotify)g_ptr_array_unref);
+	}
 }
 
 static void
@@ -1211,6 +1500,8 @@ fu_device_list_finalize(GObject *obj)
 
 	g_rw_lock_clear(&self->devices_mutex);
 	g_ptr_array_unref(self->devices);
+	for (guint i = 0; i < FU_DEVICE_LIST_INDEX_LAST; i++)
+		g_hash_table_unref(self->index[i]);
 
 	G_OBJECT_CLASS(fu_device_list_parent_class)->finalize(obj);
 }
@@ -8,8 +8,9 @@
 
 #include "config.h"
 
-#include "fu-backend.h"
+#include "fu-backend-private.h"
 #include "fu-context-private.h"
+#include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-engine-emulator.h"
 #include "fu-input-stream.h"
@@ -100,39 +101,240 @@ fu_engine_emulator_save(FuEngineEmulator *self, GOutputStream *stream, GError **
 	return TRUE;
 }
 
+/*
+ * The emulation data can be tens of MB, so the devices are created as they are parsed rather than
+ * loading all the JSON nodes first. Only the device properties are loaded as nodes, and the events
+ * are added directly to each FuDeviceEvent.
+ *
+ * Nothing is changed in the backends until all of the data has been parsed successfully, and
+ * `FwupdVersion` may appear before or after `UsbDevices` as it is only used at that point.
+ *
+ * The depth is the number of objects or arrays containing the current value, where:
+ *
+ * 1. root members, e.g. `FwupdVersion` and `UsbDevices`
+ * 2. devices in `UsbDevices`
+ * 3. device properties, e.g. `GType`, `Created` and `Events`
+ * 4. events in `Events`
+ * 5. event values, e.g. `Id`, `Data` and `Rc`
+ */
+typedef struct {
+	GPtrArray *backends; /* noref */
+	guint depth;
+	gchar *fwupd_version;
+	gboolean got_devices;
+	FwupdJsonObject *json_device; /* nullable */
+	GPtrArray *events;	      /* (element-type FuDeviceEvent) (nullable) */
+	gboolean got_events;	      /* ignore the legacy `UsbEvents` */
+	FuDeviceEvent *event;	      /* nullable */
+} FuEngineEmulatorLoadHelper;
+
+static void
+fu_engine_emulator_load_helper_free(FuEngineEmulatorLoadHelper *helper)
+{
+	if (helper->json_device != NULL)
+		fwupd_json_object_unref(helper->json_device);
+	if (helper->events != NULL)
+		g_ptr_array_unref(helper->events);
+	if (helper->event != NULL)
+		g_object_unref(helper->event);
+	g_free(helper->fwupd_version);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineEmulatorLoadHelper, fu_engine_emulator_load_helper_free)
+
+static gboolean
+fu_engine_emulator_load_json_skip(FwupdJsonParser *json_parser, GError **error)
+{
+	g_autoptr(FwupdJsonNode) json_node = fwupd_json_parser_load_current(json_parser, error);
+	return json_node != NULL;
+}
+
+static gboolean
+fu_engine_emulator_load_json_end(FuEngineEmulatorLoadHelper *helper,
+				 FwupdJsonParserEvent event,
+				 GError **error)
+{
+	helper->depth--;
+
+	/* end of event */
+	if (helper->depth == 4 && event == FWUPD_JSON_PARSER_EVENT_OBJECT_END) {
+		g_ptr_array_add(helper->events, g_steal_pointer(&helper->event));
+		return TRUE;
+	}
+
+	/* end of device */
+	if (helper->depth == 2 && event == FWUPD_JSON_PARSER_EVENT_OBJECT_END) {
+		for (guint i = 0; i < helper->backends->len; i++) {
+			FuBackend *backend = g_ptr_array_index(helper->backends, i);
+			if (!fu_backend_load_json_device(backend,
+							 helper->json_device,
+							 helper->events,
+							 error))
+				return FALSE;
+		}
+		g_clear_pointer(&helper->json_device, fwupd_json_object_unref);
+		g_clear_pointer(&helper->events, g_ptr_array_unref);
+		return TRUE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_engine_emulator_load_json_cb(FwupdJsonParser *json_parser,
+				FwupdJsonParserEvent event,
+				GRefString *key,
+				GRefString *value,
+				gpointer user_data,
+				GError **error)
+{
+	FuEngineEmulatorLoadHelper *helper = (FuEngineEmulatorLoadHelper *)user_data;
+	gboolean is_start = event == FWUPD_JSON_PARSER_EVENT_OBJECT_START ||
+			    event == FWUPD_JSON_PARSER_EVENT_ARRAY_START;
+
+	if (event == FWUPD_JSON_PARSER_EVENT_OBJECT_END ||
+	    event == FWUPD_JSON_PARSER_EVENT_ARRAY_END)
+		return fu_engine_emulator_load_json_end(helper, event, error);
+
+	/* root */
+	if (helper->depth == 0) {
+		if (event != FWUPD_JSON_PARSER_EVENT_OBJECT_START) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "emulation data is not an object");
+			return FALSE;
+		}
+		helper->depth++;
+		return TRUE;
+	}
+
+	/* root members */
+	if (helper->depth == 1) {
+		if (event == FWUPD_JSON_PARSER_EVENT_STRING &&
+		    g_strcmp0(key, "FwupdVersion") == 0) {
+			g_free(helper->fwupd_version);
+			helper->fwupd_version = g_strdup(value);
+			return TRUE;
+		}
+		if (event == FWUPD_JSON_PARSER_EVENT_ARRAY_START &&
+		    g_strcmp0(key, "UsbDevices") == 0) {
+			for (guint i = 0; i < helper->backends->len; i++) {
+				FuBackend *backend = g_ptr_array_index(helper->backends, i);
+				fu_backend_load_json_begin(backend);
+			}
+			helper->got_devices = TRUE;
+			helper->depth++;
+			return TRUE;
+		}
+		if (is_start)
+			return fu_engine_emulator_load_json_skip(json_parser, error);
+		return TRUE;
+	}
+
+	/* devices */
+	if (helper->depth == 2) {
+		if (event != FWUPD_JSON_PARSER_EVENT_OBJECT_START) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "emulated device is not an object");
+			return FALSE;
+		}
+		helper->json_device = fwupd_json_object_new();
+		helper->events = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+		helper->got_events = FALSE;
+		helper->depth++;
+		return TRUE;
+	}
+
+	/* device properties */
+	if (helper->depth == 3) {
+		if (event == FWUPD_JSON_PARSER_EVENT_ARRAY_START &&
+		    g_strcmp0(key, "Events") == 0) {
+			g_ptr_array_set_size(helper->events, 0);
+			helper->got_events = TRUE;
+			helper->depth++;
+			return TRUE;
+		}
+		if (event == FWUPD_JSON_PARSER_EVENT_ARRAY_START &&
+		    g_strcmp0(key, "UsbEvents") == 0 && !helper->got_events) {
+			helper->depth++;
+			return TRUE;
+		}
+		if (g_strcmp0(key, "UsbEvents") == 0 && is_start)
+			return fu_engine_emulator_load_json_skip(json_parser, error);
+		if (is_start) {
+			g_autoptr(FwupdJsonNode) json_node = NULL;
+			json_node = fwupd_json_parser_load_current(json_parser, error);
+			if (json_node == NULL)
+				return FALSE;
+			fwupd_json_object_add_node(helper->json_device, key, json_node);
+			return TRUE;
+		}
+		if (event == FWUPD_JSON_PARSER_EVENT_STRING)
+			fwupd_json_object_add_string(helper->json_device, key, value);
+		else if (event == FWUPD_JSON_PARSER_EVENT_RAW)
+			fwupd_json_object_add_raw(helper->json_device, key, value);
+		return TRUE;
+	}
+
+	/* events */
+	if (helper->depth == 4) {
+		if (event != FWUPD_JSON_PARSER_EVENT_OBJECT_START) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "emulated device event is not an object");
+			return FALSE;
+		}
+		helper->event = fu_device_event_new(NULL);
+		helper->depth++;
+		return TRUE;
+	}
+
+	/* event values */
+	if (is_start)
+		return fu_engine_emulator_load_json_skip(json_parser, error);
+	return fu_device_event_add_json_value(helper->event, key, event, value, error);
+}
+
 static gboolean
 fu_engine_emulator_load_json_blob(FuEngineEmulator *self, GBytes *json_blob, GError **error)
 {
-	GPtrArray *backends = fu_context_get_backends(fu_engine_get_context(self->engine));
-	g_autoptr(FwupdJsonNode) json_node = NULL;
-	g_autoptr(FwupdJsonObject) json_obj = NULL;
 	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(FuEngineEmulatorLoadHelper) helper = g_new0(FuEngineEmulatorLoadHelper, 1);
 
 	/* set appropriate limits */
 	fwupd_json_parser_set_max_depth(json_parser, 50);
 	fwupd_json_parser_set_max_items(json_parser, 5000000); /* yes, this big! */
 	fwupd_json_parser_set_max_quoted(json_parser, 1000000);
 
-	/* parse */
-	json_node = fwupd_json_parser_load_from_bytes(json_parser,
-						      json_blob,
-						      FWUPD_JSON_LOAD_FLAG_TRUSTED |
-							  FWUPD_JSON_LOAD_FLAG_STATIC_KEYS,
-						      error);
-	if (json_node == NULL)
-		return FALSE;
-	json_obj = fwupd_json_node_get_object(json_node, error);
-	if (json_obj == NULL)
+	/* parse, loading into all backends */
+	helper->backends = fu_context_get_backends(fu_engine_get_context(self->engine));
+	if (!fwupd_json_parser_parse_bytes(json_parser,
+					   json_blob,
+					   FWUPD_JSON_LOAD_FLAG_TRUSTED | FWUPD_JSON_LOAD_FLAG_STATIC_KEYS,
+					   fu_engine_emulator_load_json_cb,
+					   helper,
+					   error)) {
+		for (guint i = 0; i < helper->backends->len; i++) {
+			FuBackend *backend = g_ptr_array_index(helper->backends, i);
+			fu_backend_load_json_cancel(backend);
+		}
 		return FALSE;
+	}
 
-	/* load into all backends */
-	for (guint i = 0; i < backends->len; i++) {
-		FuBackend *backend = g_ptr_array_index(backends, i);
-		if (!fwupd_codec_from_json(FWUPD_CODEC(backend), json_obj, error))
+	/* remain compatible with all the old emulation files */
+	if (!helper->got_devices)
+		return TRUE;
+	for (guint i = 0; i < helper->backends->len; i++) {
+		FuBackend *backend = g_ptr_array_index(helper->backends, i);
+		if (!fu_backend_load_json_end(backend, helper->fwupd_version, error))
 			return FALSE;
 	}
-
-	/* success */
 	return TRUE;
 }
 
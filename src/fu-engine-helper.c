@@ -229,35 +229,21 @@ fu_engine_update_motd(FuEngine *self, GError **error)
 	return g_file_set_contents(target, str->str, str->len, error);
 }
 
-gboolean
-fu_engine_update_devices_file(FuEngine *self, GError **error)
+/* the snapshot used for the devices.json file */
+FwupdJsonObject *
+fu_engine_devices_to_json(FuEngine *self)
 {
 	FuContext *ctx = fu_engine_get_context(self);
 	FwupdCodecFlags flags = FWUPD_CODEC_FLAG_NONE;
 	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
-	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
-	g_autoptr(GString) data = NULL;
-	g_autofree gchar *target = NULL;
 
-	target = fu_context_build_filename(ctx,
-					   &error_local,
-					   FU_PATH_KIND_CACHEDIR_PKG,
-					   "devices.json",
-					   NULL);
-	if (target == NULL) {
-		g_debug("ignoring update devices file: %s", error_local->message);
-		return TRUE;
-	}
 	if (fu_context_get_config_bool(ctx, "ShowDevicePrivate"))
 		flags |= FWUPD_CODEC_FLAG_TRUSTED;
-
 	devices = fu_engine_get_devices(self, NULL);
 	if (devices != NULL)
 		fwupd_codec_array_to_json(devices, "Devices", json_obj, flags);
-
-	data = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_INDENT);
-	return g_file_set_contents(target, data->str, -1, error);
+	return g_steal_pointer(&json_obj);
 }
 
 static void
@@ -10,8 +10,8 @@
 
 gboolean
 fu_engine_update_motd(FuEngine *self, GError **error) G_GNUC_NON_NULL(1);
-gboolean
-fu_engine_update_devices_file(FuEngine *self, GError **error) G_GNUC_NON_NULL(1);
+FwupdJsonObject *
+fu_engine_devices_to_json(FuEngine *self) G_GNUC_NON_NULL(1);
 
 GHashTable *
 fu_engine_integrity_new(FuContext *ctx, GError **error);
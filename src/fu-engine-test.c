@@ -167,6 +167,272 @@ fu_engine_generate_md_func(void)
 	g_assert_cmpstr(tmp, ==, NULL);
 }
 
+static void
+fu_engine_generate_md_cached_func(void)
+{
+	const gchar *tmp;
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *fn_archive = NULL;
+	g_autofree gchar *fn_stale = NULL;
+	g_autofree gchar *fn_xmlb = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) data = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("self-tests", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_engine_save_remote_directory(tmpdir);
+
+	/* put cab file somewhere we can parse it */
+	filename = g_test_build_filename(G_TEST_BUILT,
+					 "..",
+					 "libfwupdplugin",
+					 "tests",
+					 "colorhug",
+					 "colorhug-als-3.0.2.cab",
+					 NULL);
+	data = fu_bytes_get_contents(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data);
+	fn_archive = fu_temporary_directory_build(tmpdir, "foo.cab", NULL);
+	ret = fu_bytes_set_contents(fn_archive, data, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* a remote that has since been removed */
+	fn_stale = fu_temporary_directory_build(tmpdir, "metadata.d", "removed.xmlb", NULL);
+	ret = fu_path_mkdir_parent(fn_stale, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents(fn_stale, "xmlb", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* build the per-remote silo, then load the merged silo from the cache */
+	for (guint i = 0; i < 2; i++) {
+		g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+		g_autoptr(FuDevice) device = fu_device_new(ctx);
+		g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+		g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+		g_autoptr(XbNode) component = NULL;
+
+		fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_METADATA, tmpdir);
+		fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+		fu_context_set_tmpdir(ctx, FU_PATH_KIND_DATADIR_PKG, tmpdir);
+		ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_REMOTES, progress, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		fu_device_add_instance_id(device, "12345678-1234-1234-1234-123456789012");
+		fu_device_set_version_format(device, FWUPD_VERSION_FORMAT_TRIPLET);
+		fu_device_set_version(device, "1.2.3");
+		component = fu_engine_get_component_by_guids(engine, device);
+		g_assert_nonnull(component);
+		tmp = xb_node_query_text(component,
+					 "../custom/value[@key='fwupd::RemoteId']",
+					 NULL);
+		g_assert_cmpstr(tmp, ==, "directory");
+	}
+
+	/* the remote was compiled on its own, and the stale silo was deleted */
+	fn_xmlb = fu_temporary_directory_build(tmpdir, "metadata.d", "directory.xmlb", NULL);
+	g_assert_true(g_file_test(fn_xmlb, G_FILE_TEST_EXISTS));
+	g_assert_false(g_file_test(fn_stale, G_FILE_TEST_EXISTS));
+}
+
+static void
+fu_engine_generate_md_readonly_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn_metadata_d = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("self-tests", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_engine_save_remote_directory(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_METADATA, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_DATADIR_PKG, tmpdir);
+
+	/* there is no merged silo, so the parts are compiled in memory only */
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_REMOTES | FU_ENGINE_LOAD_FLAG_READONLY,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fn_metadata_d = fu_temporary_directory_build(tmpdir, "metadata.d", NULL);
+	g_assert_false(g_file_test(fn_metadata_d, G_FILE_TEST_EXISTS));
+}
+
+static void
+fu_engine_emulation_load_count_cb(FuBackend *backend, FuDevice *device, gpointer user_data)
+{
+	guint *cnt = (guint *)user_data;
+	(*cnt)++;
+}
+
+static FuInputStream *
+fu_engine_emulation_load_archive(const gchar *json)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) archive = fu_zip_firmware_new();
+	g_autoptr(FuFirmware) img = fu_zip_file_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) json_blob = g_bytes_new_static(json, strlen(json));
+	g_autoptr(GError) error = NULL;
+
+	fu_zip_file_set_compression(FU_ZIP_FILE(img), FU_ZIP_COMPRESSION_DEFLATE);
+	fu_firmware_set_id(img, "setup.json");
+	fu_firmware_set_bytes(img, json_blob);
+	ret = fu_firmware_add_image(archive, img, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fu_firmware_write(archive, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	return fu_memory_input_stream_new_from_bytes(blob);
+}
+
+static void
+fu_engine_emulation_load_func(void)
+{
+	gboolean ret;
+	guint added_cnt = 0;
+	guint changed_cnt = 0;
+	guint removed_cnt = 0;
+	FuDevice *device;
+	g_autoptr(FuBackend) backend = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuInputStream) stream1 = NULL;
+	g_autoptr(FuInputStream) stream2 = NULL;
+	g_autoptr(FuInputStream) stream3 = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *json1 =
+	    "{\n"
+	    "  \"Unknown\": {\"Foo\": [1, {\"Bar\": [true, null]}], \"Baz\": \"hello\"},\n"
+	    "  \"UsbDevices\": [\n"
+	    "    {\n"
+	    "      \"Created\": \"2023-02-01T16:35:03Z\",\n"
+	    "      \"GType\": \"FuUdevDevice\",\n"
+	    "      \"BackendId\": \"foo:bar:1\",\n"
+	    "      \"Unknown\": {\"Foo\": [{\"Bar\": 1}]},\n"
+	    "      \"UsbEvents\": [\n"
+	    "        {\"Id\": \"Ioctl:Request=0x0001\", \"Data\": \"AA==\"},\n"
+	    "        {\"Id\": \"Ioctl:Request=0x0002\", \"Data\": \"AA==\"}\n"
+	    "      ],\n"
+	    "      \"Events\": [\n"
+	    "        {\"Id\": \"Ioctl:Request=0x007b\", \"Data\": \"Aw==\", \"Unknown\": [1]}\n"
+	    "      ]\n"
+	    "    },\n"
+	    "    {\n"
+	    "      \"Created\": \"2023-02-01T16:35:04Z\",\n"
+	    "      \"GType\": \"FuUdevDevice\",\n"
+	    "      \"BackendId\": \"foo:bar:2\",\n"
+	    "      \"UsbEvents\": [\n"
+	    "        {\"Id\": \"Ioctl:Request=0x0001\", \"Data\": \"AA==\"},\n"
+	    "        {\"Id\": \"Ioctl:Request=0x0002\", \"Data\": \"AA==\"}\n"
+	    "      ]\n"
+	    "    }\n"
+	    "  ],\n"
+	    "  \"FwupdVersion\": \"" PACKAGE_VERSION "\"\n"
+	    "}";
+	const gchar *json2 = "{\n"
+			     "  \"UsbDevices\": [\n"
+			     "    {\n"
+			     "      \"Created\": \"2023-02-01T16:35:03Z\",\n"
+			     "      \"GType\": \"FuUdevDevice\",\n"
+			     "      \"BackendId\": \"foo:bar:1\"\n"
+			     "    }\n"
+			     "  ],\n"
+			     "  \"FwupdVersion\": [\n";
+	const gchar *json3 = "{\n"
+			     "  \"UsbDevices\": [\n"
+			     "    {\n"
+			     "      \"Created\": \"2023-02-01T16:35:03Z\",\n"
+			     "      \"GType\": \"FuUdevDevice\",\n"
+			     "      \"BackendId\": \"foo:bar:1\",\n"
+			     "      \"Events\": []\n"
+			     "    }\n"
+			     "  ]\n"
+			     "}";
+
+	/* watch events */
+	backend = g_object_new(FU_TYPE_BACKEND,
+			       "context",
+			       ctx,
+			       "name",
+			       "udev",
+			       "device-gtype",
+			       FU_TYPE_UDEV_DEVICE,
+			       NULL);
+	g_signal_connect(backend,
+			 "device-added",
+			 G_CALLBACK(fu_engine_emulation_load_count_cb),
+			 &added_cnt);
+	g_signal_connect(backend,
+			 "device-removed",
+			 G_CALLBACK(fu_engine_emulation_load_count_cb),
+			 &removed_cnt);
+	g_signal_connect(backend,
+			 "device-changed",
+			 G_CALLBACK(fu_engine_emulation_load_count_cb),
+			 &changed_cnt);
+	fu_context_add_backend(ctx, backend);
+
+	/* the version is after the devices, and Events is preferred to UsbEvents */
+	stream1 = fu_engine_emulation_load_archive(json1);
+	ret = fu_engine_emulation_load(engine, stream1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(added_cnt, ==, 2);
+	g_assert_cmpint(changed_cnt, ==, 0);
+	g_assert_cmpint(removed_cnt, ==, 0);
+	device = fu_backend_lookup_by_id(backend, "foo:bar:1");
+	g_assert_nonnull(device);
+	g_assert_true(fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED));
+	g_assert_true(fu_device_check_fwupd_version(device, PACKAGE_VERSION));
+	g_assert_cmpint(fu_device_get_events(device)->len, ==, 1);
+	device = fu_backend_lookup_by_id(backend, "foo:bar:2");
+	g_assert_nonnull(device);
+	g_assert_true(fu_device_check_fwupd_version(device, PACKAGE_VERSION));
+	g_assert_cmpint(fu_device_get_events(device)->len, ==, 2);
+
+	/* the existing devices are unloaded, but nothing is added from invalid data */
+	stream2 = fu_engine_emulation_load_archive(json2);
+	ret = fu_engine_emulation_load(engine, stream2, &error);
+	g_assert_nonnull(error);
+	g_assert_false(ret);
+	g_clear_error(&error);
+	g_assert_cmpint(added_cnt, ==, 2);
+	g_assert_cmpint(changed_cnt, ==, 0);
+	g_assert_cmpint(removed_cnt, ==, 2);
+	g_assert_null(fu_backend_lookup_by_id(backend, "foo:bar:1"));
+
+	/* a different archive replaces all the devices */
+	stream3 = fu_engine_emulation_load_archive(json3);
+	ret = fu_engine_emulation_load(engine, stream3, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(added_cnt, ==, 3);
+	g_assert_cmpint(changed_cnt, ==, 0);
+	g_assert_cmpint(removed_cnt, ==, 2);
+	device = fu_backend_lookup_by_id(backend, "foo:bar:1");
+	g_assert_nonnull(device);
+	g_assert_false(fu_device_check_fwupd_version(device, PACKAGE_VERSION));
+	g_assert_cmpint(fu_device_get_events(device)->len, ==, 0);
+	g_assert_null(fu_backend_lookup_by_id(backend, "foo:bar:2"));
+}
+
 static void
 fu_engine_test_plugin_mutable_enumeration(void)
 {
@@ -1112,6 +1378,7 @@ fu_engine_version_highest_func(void)
 static void
 fu_engine_downgrade_func(void)
 {
+	FwupdDevice *device_up;
 	FwupdRelease *rel;
 	gboolean ret;
 	g_autofree gchar *fn_broken = NULL;
@@ -1126,6 +1393,7 @@ fu_engine_downgrade_func(void)
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 	g_autoptr(GPtrArray) devices_pre = NULL;
+	g_autoptr(GPtrArray) devices_up = NULL;
 	g_autoptr(GPtrArray) releases_dg = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 	g_autoptr(GPtrArray) releases_up = NULL;
@@ -1306,6 +1574,18 @@ fu_engine_downgrade_func(void)
 	rel = FWUPD_RELEASE(g_ptr_array_index(releases_dg, 0));
 	g_assert_cmpstr(fwupd_release_get_version(rel), ==, "1.2.2");
 
+	/* upgrades for all devices, using the releases already checked */
+	devices_up = fu_engine_get_upgrades_all(engine, request, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices_up);
+	g_assert_cmpint(devices_up->len, ==, 1);
+	device_up = g_ptr_array_index(devices_up, 0);
+	g_assert_cmpstr(fwupd_device_get_id(device_up), ==, fu_device_get_id(device));
+	g_assert_cmpint(fwupd_device_get_releases(device_up)->len, ==, 2);
+	g_assert_true(g_ptr_array_index(fwupd_device_get_releases(device_up), 0) ==
+		      g_ptr_array_index(releases_up, 0));
+	g_assert_cmpint(fwupd_device_get_releases(FWUPD_DEVICE(device))->len, ==, 0);
+
 	/* enforce that updates have to be explicit */
 	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_ONLY_EXPLICIT_UPDATES);
 	releases_up2 = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
@@ -3501,6 +3781,105 @@ fu_engine_modify_bios_settings_func(void)
 	g_clear_error(&error);
 }
 
+#define FU_TYPE_ENGINE_TEST_HSI_PLUGIN (fu_engine_test_hsi_plugin_get_type())
+G_DECLARE_FINAL_TYPE(FuEngineTestHsiPlugin,
+		     fu_engine_test_hsi_plugin,
+		     FU,
+		     ENGINE_TEST_HSI_PLUGIN,
+		     FuPlugin)
+
+struct _FuEngineTestHsiPlugin {
+	FuPlugin parent_instance;
+	guint add_security_attrs_cnt;
+};
+
+G_DEFINE_TYPE(FuEngineTestHsiPlugin, fu_engine_test_hsi_plugin, FU_TYPE_PLUGIN)
+
+static void
+fu_engine_test_hsi_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs)
+{
+	FuEngineTestHsiPlugin *self = FU_ENGINE_TEST_HSI_PLUGIN(plugin);
+	g_autoptr(FwupdSecurityAttr) attr = NULL;
+
+	attr = fu_plugin_security_attr_new(plugin, FWUPD_SECURITY_ATTR_ID_ENCRYPTED_RAM);
+	fwupd_security_attr_set_result(attr, FWUPD_SECURITY_ATTR_RESULT_ENCRYPTED);
+	fwupd_security_attr_add_flag(attr, FWUPD_SECURITY_ATTR_FLAG_SUCCESS);
+	fu_security_attrs_append(attrs, attr);
+	self->add_security_attrs_cnt++;
+}
+
+static void
+fu_engine_test_hsi_plugin_init(FuEngineTestHsiPlugin *self)
+{
+}
+
+static void
+fu_engine_test_hsi_plugin_class_init(FuEngineTestHsiPluginClass *klass)
+{
+	FuPluginClass *plugin_class = FU_PLUGIN_CLASS(klass);
+	plugin_class->add_security_attrs = fu_engine_test_hsi_plugin_add_security_attrs;
+}
+
+static void
+fu_engine_security_attrs_invalidate_func(void)
+{
+	gboolean ret;
+	FuEngineTestHsiPlugin *plugin_hsi;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device_hsi = fu_device_new(ctx);
+	g_autoptr(FuDevice) device_usb = fu_device_new(ctx);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuPlugin) plugin1 = NULL;
+	g_autoptr(FuPlugin) plugin2 = fu_plugin_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuSecurityAttrs) attrs = NULL;
+	g_autoptr(GError) error = NULL;
+
+#ifndef HAVE_HSI
+	g_test_skip("no HSI support");
+	return;
+#endif
+
+	/* one plugin adds security attributes, the other does not */
+	plugin1 = fu_plugin_new_from_gtype(FU_TYPE_ENGINE_TEST_HSI_PLUGIN, ctx);
+	plugin_hsi = FU_ENGINE_TEST_HSI_PLUGIN(plugin1);
+	fu_engine_add_plugin(engine, plugin1);
+	fu_plugin_set_name(plugin2, "usb");
+	fu_engine_add_plugin(engine, plugin2);
+	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_NO_CACHE, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	fu_device_set_id(device_hsi, "3d3ad2e4d4f8b2fa20be0d4eb39df6b2bbcd5e5d");
+	fu_plugin_add_device(plugin1, device_hsi);
+	fu_device_set_id(device_usb, "1ec7a6d4e0cd0c95a5b0ee5ab8ba80ce3b0f8b56");
+	fu_plugin_add_device(plugin2, device_usb);
+
+	/* first call asks every plugin */
+	attrs = fu_engine_get_host_security_attrs(engine);
+	g_assert_nonnull(attrs);
+	g_assert_cmpint(plugin_hsi->add_security_attrs_cnt, ==, 1);
+
+	/* changes to a device from the other plugin do not invalidate anything */
+	for (guint i = 0; i < 100; i++) {
+		g_autoptr(FuSecurityAttrs) attrs_tmp = NULL;
+		if (i % 2 == 0)
+			fu_device_add_flag(device_usb, FWUPD_DEVICE_FLAG_NEEDS_REBOOT);
+		else
+			fu_device_remove_flag(device_usb, FWUPD_DEVICE_FLAG_NEEDS_REBOOT);
+		attrs_tmp = fu_engine_get_host_security_attrs(engine);
+		g_assert_nonnull(attrs_tmp);
+	}
+	g_assert_cmpint(plugin_hsi->add_security_attrs_cnt, ==, 1);
+
+	/* changes to a device from the plugin ask only that plugin again */
+	fu_device_add_flag(device_hsi, FWUPD_DEVICE_FLAG_NEEDS_REBOOT);
+	g_clear_object(&attrs);
+	attrs = fu_engine_get_host_security_attrs(engine);
+	g_assert_nonnull(attrs);
+	g_assert_cmpint(plugin_hsi->add_security_attrs_cnt, ==, 2);
+}
+
 static void
 fu_engine_report_metadata_func(void)
 {
@@ -3600,11 +3979,16 @@ main(int argc, char **argv)
 			fu_plugin_engine_get_results_appstream_id_func);
 	g_test_add_func("/fwupd/engine/release-dedupe", fu_engine_release_dedupe_func);
 	g_test_add_func("/fwupd/engine/generate-md", fu_engine_generate_md_func);
+	g_test_add_func("/fwupd/engine/generate-md{cached}", fu_engine_generate_md_cached_func);
+	g_test_add_func("/fwupd/engine/generate-md{readonly}", fu_engine_generate_md_readonly_func);
+	g_test_add_func("/fwupd/engine/emulation-load", fu_engine_emulation_load_func);
 	g_test_add_func("/fwupd/engine/better-than", fu_engine_device_better_than_func);
 	g_test_add_func("/fwupd/engine/plugin/mutable", fu_engine_test_plugin_mutable_enumeration);
 	g_test_add_func("/fwupd/engine/plugin/composite", fu_engine_plugin_composite_func);
 	g_test_add_func("/fwupd/engine/plugin/composite-multistep",
 			fu_engine_plugin_composite_multistep_func);
 	g_test_add_func("/fwupd/engine/write-bios-attrs", fu_engine_modify_bios_settings_func);
+	g_test_add_func("/fwupd/engine/security-attrs-invalidate",
+			fu_engine_security_attrs_invalidate_func);
 	return g_test_run();
 }
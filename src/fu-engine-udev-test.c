@@ -89,6 +89,62 @@ fu_test_engine_udev_hidraw(void)
 	g_assert_cmpstr(fu_udev_device_get_driver(udev_device3), ==, "usb");
 }
 
+static void
+fu_test_engine_udev_coldplug_threads(void)
+{
+	gboolean ret;
+	g_autofree gchar *testdatadir_quirks = NULL;
+	g_autofree gchar *testdatadir_sysfs = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuDevice) device1 = NULL;
+	g_autoptr(FuDevice) device2 = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+#ifndef HAVE_HIDRAW_H
+	g_test_skip("linux/hidraw.h not available");
+	return;
+#endif
+
+	/* set up test harness */
+	testdatadir_quirks = g_test_build_filename(G_TEST_DIST, "tests", "quirks.d", NULL);
+	testdatadir_sysfs = g_test_build_filename(G_TEST_DIST, "tests", "sys", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_QUIRKS, testdatadir_quirks);
+	fu_context_set_path(ctx, FU_PATH_KIND_SYSFSDIR, testdatadir_sysfs);
+	fu_config_set_default(fu_context_get_config(ctx), "fwupd", "ColdplugThreads", "4");
+
+	/* non-linux */
+	if (!fu_context_has_backend(ctx, "udev")) {
+		g_test_skip("no Udev backend");
+		return;
+	}
+
+	/* probe on worker threads */
+	fu_progress_set_profile(progress, TRUE);
+	fu_engine_add_plugin_filter(engine, "pixart_rf");
+	fu_engine_add_plugin_filter(engine, "hughski_colorhug");
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_COLDPLUG | FU_ENGINE_LOAD_FLAG_BUILTIN_PLUGINS |
+				 FU_ENGINE_LOAD_FLAG_READONLY | FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* hidraw -> pixart_rf */
+	device1 = fu_engine_get_device(engine, "ab6b164573f0782ee23e38740d0e0934ee352090", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device1);
+	g_assert_cmpstr(fu_device_get_plugin(device1), ==, "pixart_rf");
+
+	/* USB -> colorhug */
+	device2 = fu_engine_get_device(engine, "d787669ee4a103fe0b361fe31c10ea037c72f27c", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device2);
+	g_assert_cmpstr(fu_device_get_plugin(device2), ==, "hughski_colorhug");
+}
+
 static void
 fu_test_engine_udev_usb(void)
 {
@@ -322,5 +378,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/engine/udev/serio", fu_test_engine_udev_serio);
 	g_test_add_func("/fwupd/engine/udev/nvme", fu_test_engine_udev_nvme);
 	g_test_add_func("/fwupd/engine/udev/v4l", fu_test_engine_udev_v4l);
+	g_test_add_func("/fwupd/engine/udev/coldplug-threads",
+			fu_test_engine_udev_coldplug_threads);
 	return g_test_run();
 }
@@ -32,6 +32,7 @@
 
 #include <fwupdplugin.h>
 
+#include "fwupd-device-private.h"
 #include "fwupd-enums-private.h"
 #include "fwupd-jcat-file.h"
 #include "fwupd-remote-private.h"
@@ -59,7 +60,9 @@
 #include "fu-remote-list.h"
 #include "fu-remote.h"
 #include "fu-security-attr-common.h"
+#include "fu-security-attrs-cache.h"
 #include "fu-security-attrs-private.h"
+#include "fu-snapshot-writer.h"
 #include "fu-udev-device-private.h"
 #include "fu-uefi-backend.h"
 #include "fu-usb-backend.h"
@@ -82,6 +85,8 @@
 
 #define FU_ENGINE_UPDATE_MOTD_DELAY 5 /* s */
 
+#define FU_ENGINE_COLDPLUG_THREADS_MAX 32
+
 #define FU_ENGINE_MAX_METADATA_SIZE  (32 * FU_MB)
 #define FU_ENGINE_MAX_SIGNATURE_SIZE (1 * FU_MB)
 
@@ -110,6 +115,8 @@ struct _FuEngine {
 	XbQuery *query_container_checksum2; /* artifact checksum -> release */
 	XbQuery *query_tag_by_guid_version;
 	GPtrArray *search_queries; /* (element-type XbQuery) */
+	GHashTable *components_by_guid; /* (element-type utf8 GPtrArray) of XbNode */
+	GHashTable *releases_by_device; /* (element-type utf8 GPtrArray) of FuRelease */
 	FuPluginList *plugin_list;
 	GPtrArray *plugin_filter;
 	FuContext *ctx;
@@ -119,11 +126,13 @@ struct _FuEngine {
 	gchar *host_machine_id;
 	FuJcatContext *jcat_context;
 	FuSecurityAttrs *host_security_attrs;
+	FuSecurityAttrsCache *host_security_attrs_cache;
 	GPtrArray *local_monitors; /* (element-type GFileMonitor) */
 	GMainLoop *acquiesce_loop;
 	guint acquiesce_id;
 	guint acquiesce_delay;
 	guint update_motd_id;
+	FuSnapshotWriter *devices_file; /* nullable */
 	FuEngineEmulatorPhase emulator_phase;
 	guint emulator_write_cnt;
 	guint emulator_composite_cnt;
@@ -194,6 +203,32 @@ fu_engine_update_motd_timeout_cb(gpointer user_data)
 	return G_SOURCE_REMOVE;
 }
 
+static FwupdJsonObject *
+fu_engine_devices_file_snapshot_cb(gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE(user_data);
+	return fu_engine_devices_to_json(self);
+}
+
+static FuSnapshotWriter *
+fu_engine_ensure_devices_file(FuEngine *self, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+
+	if (self->devices_file != NULL)
+		return self->devices_file;
+	filename = fu_context_build_filename(self->ctx,
+					     error,
+					     FU_PATH_KIND_CACHEDIR_PKG,
+					     "devices.json",
+					     NULL);
+	if (filename == NULL)
+		return NULL;
+	self->devices_file =
+	    fu_snapshot_writer_new(filename, fu_engine_devices_file_snapshot_cb, self);
+	return self->devices_file;
+}
+
 static void
 fu_engine_update_motd_reset(FuEngine *self)
 {
@@ -208,6 +243,7 @@ fu_engine_update_motd_reset(FuEngine *self)
 static void
 fu_engine_emit_changed(FuEngine *self)
 {
+	FuSnapshotWriter *devices_file;
 	g_autoptr(GError) error = NULL;
 
 	/* do nothing */
@@ -221,20 +257,71 @@ fu_engine_emit_changed(FuEngine *self)
 	if (fu_context_get_config_bool(self->ctx, "UpdateMotd"))
 		fu_engine_update_motd_reset(self);
 
-	/* update the list of devices */
-	if (!fu_engine_update_devices_file(self, &error))
-		g_info("failed to update list of devices: %s", error->message);
+	/* update the list of devices, coalescing any other changes soon after */
+	devices_file = fu_engine_ensure_devices_file(self, &error);
+	if (devices_file == NULL) {
+		g_debug("ignoring update devices file: %s", error->message);
+		return;
+	}
+	fu_snapshot_writer_queue(devices_file);
+}
+
+/* any device, metadata or config change can change the result of the requirement checks */
+static void
+fu_engine_invalidate_releases(FuEngine *self)
+{
+	g_hash_table_remove_all(self->releases_by_device);
+}
+
+static void
+fu_engine_invalidate_security_attrs(FuEngine *self)
+{
+	fu_security_attrs_cache_invalidate_all(self->host_security_attrs_cache);
+	fu_security_attrs_remove_all(self->host_security_attrs);
+}
+
+/* only the device, its plugin and the sources asked after them are asked again -- unless the
+ * device was not asked last time, in which case we do not know where it goes */
+static void
+fu_engine_invalidate_security_attrs_for_device(FuEngine *self, FuDevice *device)
+{
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(device);
+	FuPlugin *plugin = NULL;
+	gboolean invalidated = FALSE;
+
+	if (device_class->add_security_attrs != NULL) {
+		g_autofree gchar *source = g_strdup_printf("device:%s", fu_device_get_id(device));
+		if (!fu_security_attrs_cache_invalidate(self->host_security_attrs_cache, source))
+			fu_security_attrs_cache_invalidate_all(self->host_security_attrs_cache);
+		invalidated = TRUE;
+	}
+	if (fu_device_get_plugin(device) != NULL) {
+		plugin = fu_plugin_list_find_by_name(self->plugin_list,
+						     fu_device_get_plugin(device),
+						     NULL);
+	}
+	if (plugin != NULL && fu_plugin_has_add_security_attrs(plugin)) {
+		g_autofree gchar *source = g_strdup_printf("plugin:%s", fu_plugin_get_name(plugin));
+		if (!fu_security_attrs_cache_invalidate(self->host_security_attrs_cache, source))
+			fu_security_attrs_cache_invalidate_all(self->host_security_attrs_cache);
+		invalidated = TRUE;
+	}
+	if (invalidated)
+		fu_security_attrs_remove_all(self->host_security_attrs);
 }
 
 static void
 fu_engine_emit_device_changed_safe(FuEngine *self, FuDevice *device)
 {
+	/* requirements can depend on other devices */
+	fu_engine_invalidate_releases(self);
+
 	/* do nothing */
 	if ((self->load_flags & FU_ENGINE_LOAD_FLAG_READY) == 0)
 		return;
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs_for_device(self, device);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
 }
 
@@ -416,6 +503,9 @@ fu_engine_config_reload(FuEngine *self)
 	g_auto(GStrv) uids = NULL;
 	g_autofree gchar *domains = NULL;
 
+	/* the requirement checks use the config */
+	fu_engine_invalidate_releases(self);
+
 	/* required on Linux kernel < 6.4, or when `RT->QueryVariableInfo` is not supported */
 	if (fu_context_get_config_bool(self->ctx, "IgnoreEfivarsFreeSpace"))
 		fu_context_add_flag(self->ctx, FU_CONTEXT_FLAG_IGNORE_EFIVARS_FREE_SPACE);
@@ -674,6 +764,7 @@ fu_engine_device_added_cb(FuDeviceList *device_list, FuDevice *device, FuEngine
 	fu_engine_ensure_device_display_required_inhibit(self, device);
 	fu_engine_ensure_device_system_inhibit(self, device);
 	fu_engine_ensure_device_maybe_remove_affects_fde(self, device);
+	fu_engine_invalidate_releases(self);
 	fu_engine_acquiesce_reset(self);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_ADDED], 0, device);
 }
@@ -692,6 +783,8 @@ static void
 fu_engine_device_removed_cb(FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
 	fu_engine_device_runner_device_removed(self, device);
+	fu_engine_invalidate_security_attrs_for_device(self, device);
+	fu_engine_invalidate_releases(self);
 	fu_engine_acquiesce_reset(self);
 	g_signal_handlers_disconnect_by_data(device, self);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
@@ -1126,6 +1219,28 @@ fu_engine_modify_remote(FuEngine *self,
 	    NULL,
 	};
 
+	/* the client got a not-modified response for this signature */
+	if (g_strcmp0(key, "MetadataNotModified") == 0) {
+		g_autoptr(FwupdRemote) remote = NULL;
+		remote = fu_remote_list_get_by_id(self->remote_list, remote_id, error);
+		if (remote == NULL)
+			return FALSE;
+		if (fwupd_remote_get_checksum(remote) == NULL ||
+		    g_strcmp0(value, fwupd_remote_get_checksum(remote)) != 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "signature checksum %s does not match for %s",
+				    value,
+				    remote_id);
+			return FALSE;
+		}
+		if (!fu_remote_touch(remote, error))
+			return FALSE;
+		fu_engine_emit_changed(self);
+		return TRUE;
+	}
+
 	/* check keys are valid */
 	if (!g_strv_contains(keys, key)) {
 		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "key %s not supported", key);
@@ -1592,27 +1707,10 @@ fu_engine_verify_update(FuEngine *self,
 static XbNode *
 fu_engine_get_component_by_guid(FuEngine *self, const gchar *guid)
 {
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(XbNode) component = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
-
-	/* no components in silo */
-	if (self->query_component_by_guid == NULL)
-		return NULL;
-
-	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	component = xb_silo_query_first_with_context(self->silo,
-						     self->query_component_by_guid,
-						     &context,
-						     &error_local);
-	if (component == NULL) {
-		if (!g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) &&
-		    !g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			g_warning("ignoring: %s", error_local->message);
+	GPtrArray *components = g_hash_table_lookup(self->components_by_guid, guid);
+	if (components == NULL)
 		return NULL;
-	}
-	return g_object_ref(component);
+	return g_object_ref(g_ptr_array_index(components, 0));
 }
 
 XbNode *
@@ -2941,11 +3039,15 @@ fu_engine_install_release(FuEngine *self,
 		    G_CHECKSUM_SHA256,
 		    G_CHECKSUM_SHA1,
 		};
-		for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-			g_autofree gchar *checksum =
-			    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-			if (checksum == NULL)
-				return FALSE;
+		g_autoptr(GPtrArray) checksums = NULL;
+		checksums = fu_input_stream_compute_checksums(stream,
+							      checksum_types,
+							      G_N_ELEMENTS(checksum_types),
+							      error);
+		if (checksums == NULL)
+			return FALSE;
+		for (guint i = 0; i < checksums->len; i++) {
+			const gchar *checksum = g_ptr_array_index(checksums, i);
 			fwupd_release_add_checksum(FWUPD_RELEASE(release), checksum);
 		}
 	}
@@ -4222,6 +4324,75 @@ fu_engine_search_query_create(FuEngine *self, GError **error)
 	return TRUE;
 }
 
+static void
+fu_engine_add_component_guids(FuEngine *self, XbNode *component)
+{
+	g_autoptr(GPtrArray) children = xb_node_get_children(component);
+
+	for (guint i = 0; children != NULL && i < children->len; i++) {
+		XbNode *provides = g_ptr_array_index(children, i);
+		g_autoptr(GPtrArray) firmwares = NULL;
+
+		if (g_strcmp0(xb_node_get_element(provides), "provides") != 0)
+			continue;
+		firmwares = xb_node_get_children(provides);
+		for (guint j = 0; firmwares != NULL && j < firmwares->len; j++) {
+			XbNode *firmware = g_ptr_array_index(firmwares, j);
+			const gchar *guid = xb_node_get_text(firmware);
+			GPtrArray *components;
+
+			if (g_strcmp0(xb_node_get_element(firmware), "firmware") != 0 ||
+			    g_strcmp0(xb_node_get_attr(firmware, "type"), "flashed") != 0 ||
+			    guid == NULL)
+				continue;
+			components = g_hash_table_lookup(self->components_by_guid, guid);
+			if (components == NULL) {
+				components = g_ptr_array_new_with_free_func(
+				    (GDestroyNotify)g_object_unref);
+				g_hash_table_insert(self->components_by_guid,
+						    g_strdup(guid),
+						    components);
+			}
+
+			/* the GUID is listed more than once by this component */
+			if (components->len > 0 &&
+			    g_ptr_array_index(components, components->len - 1) == component)
+				continue;
+			g_ptr_array_add(components, g_object_ref(component));
+		}
+	}
+}
+
+/* same results as query_component_by_guid, but for all the GUIDs with one query */
+static gboolean
+fu_engine_ensure_components_by_guid(FuEngine *self, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) components = NULL;
+
+	components =
+	    xb_silo_query(self->silo,
+			  "components/component/provides/firmware[@type='flashed']/../..",
+			  0,
+			  &error_local);
+	if (components == NULL) {
+		if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return TRUE;
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	for (guint i = 0; i < components->len; i++) {
+		XbNode *component = g_ptr_array_index(components, i);
+		fu_engine_add_component_guids(self, component);
+	}
+	g_debug("%u GUIDs now in silo", g_hash_table_size(self->components_by_guid));
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_engine_create_silo_index(FuEngine *self, GError **error)
 {
@@ -4230,6 +4401,10 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 	g_autoptr(GError) error_container_checksum2 = NULL;
 	g_autoptr(GError) error_tag_by_guid_version = NULL;
 
+	/* the old silo nodes are no longer valid */
+	g_hash_table_remove_all(self->components_by_guid);
+	fu_engine_invalidate_releases(self);
+
 	/* print what we've got */
 	components = xb_silo_query(self->silo, "components/component[@type='firmware']", 0, NULL);
 	if (components == NULL)
@@ -4280,6 +4455,8 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 		g_prefix_error_literal(error, "failed to prepare query: ");
 		return FALSE;
 	}
+	if (!fu_engine_ensure_components_by_guid(self, error))
+		return FALSE;
 
 	/* old-style <checksum target="container"> and new-style <artifact> */
 	self->query_container_checksum1 =
@@ -4582,17 +4759,11 @@ fu_engine_load_metadata_store_local(FuEngine *self,
 	return TRUE;
 }
 
-static gboolean
-fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **error)
+static XbBuilder *
+fu_engine_metadata_builder_new(FuEngine *self)
 {
-	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
-	g_autoptr(GFile) xmlb = NULL;
-	g_autoptr(GPtrArray) remotes = NULL;
 	g_autoptr(XbBuilder) builder = xb_builder_new();
 
-	/* clear existing silo */
-	g_clear_object(&self->silo);
-
 #ifdef SOURCE_VERSION
 	/* invalidate the cache if the fwupd version changes */
 	xb_builder_append_guid(builder, SOURCE_VERSION);
@@ -4604,161 +4775,466 @@ fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **
 					     XB_SILO_PROFILE_FLAG_XPATH |
 						 XB_SILO_PROFILE_FLAG_DEBUG);
 	}
+	return g_steal_pointer(&builder);
+}
 
-	/* load each enabled metadata file */
-	remotes = fu_remote_list_get_all(self->remote_list);
-	for (guint i = 0; i < remotes->len; i++) {
-		const gchar *path = NULL;
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GFile) file = NULL;
-		g_autoptr(XbBuilderFixup) fixup = NULL;
-		g_autoptr(XbBuilderNode) custom = NULL;
-		g_autoptr(XbBuilderSource) source = xb_builder_source_new();
-
-		FwupdRemote *remote = g_ptr_array_index(remotes, i);
-		if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
-			continue;
-		path = fwupd_remote_get_filename_cache(remote);
-		if (!g_file_test(path, G_FILE_TEST_EXISTS))
-			continue;
+static gboolean
+fu_engine_load_metadata_store_remote(FuEngine *self,
+				     XbBuilder *builder,
+				     FwupdRemote *remote,
+				     GError **error)
+{
+	const gchar *path = fwupd_remote_get_filename_cache(remote);
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(XbBuilderFixup) fixup = NULL;
+	g_autoptr(XbBuilderNode) custom = NULL;
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
 
-		/* generate all metadata on demand */
-		if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
-			g_info("loading metadata for remote '%s'", fwupd_remote_get_id(remote));
-			if (!fu_engine_create_metadata(self, builder, remote, &error_local)) {
-				g_warning("failed to generate remote %s: %s",
-					  fwupd_remote_get_id(remote),
-					  error_local->message);
-			}
-			continue;
-		}
+	/* generate all metadata on demand */
+	if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
+		g_info("loading metadata for remote '%s'", fwupd_remote_get_id(remote));
+		return fu_engine_create_metadata(self, builder, remote, error);
+	}
 
-		/* save the remote-id in the custom metadata space */
-		file = g_file_new_for_path(path);
-		if (!xb_builder_source_load_file(source,
-						 file,
-						 XB_BUILDER_SOURCE_FLAG_NONE,
-						 NULL,
-						 &error_local)) {
-			g_warning("failed to load remote %s: %s",
-				  fwupd_remote_get_id(remote),
-				  error_local->message);
-			continue;
-		}
+	/* save the remote-id in the custom metadata space */
+	file = g_file_new_for_path(path);
+	if (!xb_builder_source_load_file(source, file, XB_BUILDER_SOURCE_FLAG_NONE, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
 
-		/* fix up any legacy installed files */
-		fixup = xb_builder_fixup_new("AppStreamUpgrade",
-					     fu_engine_appstream_upgrade_cb,
-					     self,
-					     NULL);
-		xb_builder_fixup_set_max_depth(fixup, 3);
-		xb_builder_source_add_fixup(source, fixup);
+	/* fix up any legacy installed files */
+	fixup = xb_builder_fixup_new("AppStreamUpgrade",
+				     fu_engine_appstream_upgrade_cb,
+				     self,
+				     NULL);
+	xb_builder_fixup_set_max_depth(fixup, 3);
+	xb_builder_source_add_fixup(source, fixup);
 
-		/* add metadata */
-		custom = xb_builder_node_new("custom");
-		xb_builder_node_insert_text(custom,
-					    "value",
-					    path,
-					    "key",
-					    "fwupd::FilenameCache",
-					    NULL);
-		xb_builder_node_insert_text(custom,
-					    "value",
-					    fwupd_remote_get_id(remote),
-					    "key",
-					    "fwupd::RemoteId",
-					    NULL);
-		xb_builder_source_set_info(source, custom);
+	/* add metadata */
+	custom = xb_builder_node_new("custom");
+	xb_builder_node_insert_text(custom, "value", path, "key", "fwupd::FilenameCache", NULL);
+	xb_builder_node_insert_text(custom,
+				    "value",
+				    fwupd_remote_get_id(remote),
+				    "key",
+				    "fwupd::RemoteId",
+				    NULL);
+	xb_builder_source_set_info(source, custom);
+	xb_builder_import_source(builder, source);
 
-		/* we need to watch for changes? */
-		xb_builder_import_source(builder, source);
-	}
+	/* success */
+	return TRUE;
+}
 
+static gboolean
+fu_engine_load_metadata_store_local_all(FuEngine *self, XbBuilder *builder, GError **error)
+{
 	/* add any client-side data, e.g. BKC tags */
 	if (!fu_engine_load_metadata_store_local(self,
 						 builder,
 						 FU_PATH_KIND_LOCALSTATEDIR_PKG,
 						 error))
 		return FALSE;
-	if (!fu_engine_load_metadata_store_local(self, builder, FU_PATH_KIND_DATADIR_PKG, error))
-		return FALSE;
+	return fu_engine_load_metadata_store_local(self, builder, FU_PATH_KIND_DATADIR_PKG, error);
+}
 
-	/* on a read-only filesystem don't care about the cache GUID */
-	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
-		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
+/* compiles the builder to CACHEDIR_PKG/metadata.d, or loads it if the sources are unchanged */
+static XbSilo *
+fu_engine_metadata_builder_ensure(FuEngine *self,
+				  XbBuilder *builder,
+				  const gchar *id,
+				  FuEngineLoadFlags flags,
+				  XbBuilderCompileFlags compile_flags,
+				  GError **error)
+{
+	g_autofree gchar *basename = g_strdup_printf("%s.xmlb", id);
+	g_autofree gchar *xmlbfn = NULL;
+	g_autoptr(GFile) xmlb = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(XbSilo) silo = NULL;
 
-	/* ensure silo is up to date */
-	if (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) {
-		g_autoptr(GFileIOStream) iostr = NULL;
-		xmlb = g_file_new_tmp(NULL, &iostr, error);
-		if (xmlb == NULL)
-			return FALSE;
-	} else {
-		g_autofree gchar *xmlbfn = NULL;
-		xmlbfn = fu_context_build_filename(self->ctx,
-						   error,
-						   FU_PATH_KIND_CACHEDIR_PKG,
-						   "metadata.xmlb",
-						   NULL);
-		if (xmlbfn == NULL)
-			return FALSE;
-		xmlb = g_file_new_for_path(xmlbfn);
-	}
-	self->silo = xb_builder_ensure(builder, xmlb, compile_flags, NULL, error);
-	if (self->silo == NULL) {
-		g_prefix_error_literal(error, "cannot create metadata.xmlb: ");
-		return FALSE;
+	/* on a read-only filesystem never write the cache */
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY) {
+		silo = xb_builder_compile(builder, compile_flags, NULL, error);
+		if (silo == NULL) {
+			fwupd_error_convert(error);
+			g_prefix_error(error, "cannot compile %s: ", id);
+			return NULL;
+		}
+		g_info("compiled metadata for %s in %.1fms",
+		       id,
+		       g_timer_elapsed(timer, NULL) * 1000.f);
+		return g_steal_pointer(&silo);
 	}
 
-	/* success */
-	return fu_engine_create_silo_index(self, error);
-}
-
-static void
-fu_engine_remote_list_ensure_p2p_policy_remote(FuEngine *self, FwupdRemote *remote)
-{
-	if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DOWNLOAD) {
-		FuP2pPolicy p2p_policy = fu_engine_get_p2p_policy(self);
-		if (p2p_policy & FU_P2P_POLICY_METADATA)
-			fwupd_remote_add_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA);
-		else
-			fwupd_remote_remove_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA);
-		if (p2p_policy & FU_P2P_POLICY_FIRMWARE)
-			fwupd_remote_add_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE);
-		else
-			fwupd_remote_remove_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE);
+	xmlbfn = fu_context_build_filename(self->ctx,
+					   error,
+					   FU_PATH_KIND_CACHEDIR_PKG,
+					   "metadata.d",
+					   basename,
+					   NULL);
+	if (xmlbfn == NULL)
+		return NULL;
+	if (!fu_path_mkdir_parent(xmlbfn, error))
+		return NULL;
+	xmlb = g_file_new_for_path(xmlbfn);
+	silo = xb_builder_ensure(builder, xmlb, compile_flags, NULL, error);
+	if (silo == NULL) {
+		g_prefix_error(error, "cannot create %s: ", basename);
+		return NULL;
 	}
+	g_info("loaded metadata for %s in %.1fms", id, g_timer_elapsed(timer, NULL) * 1000.f);
+	return g_steal_pointer(&silo);
 }
 
-static void
-fu_engine_config_changed_cb(FuConfig *config, FuEngine *self)
+/* deletes any CACHEDIR_PKG/metadata.d silo that is not in @ids, e.g. for a disabled remote */
+static gboolean
+fu_engine_metadata_builder_prune(FuEngine *self, GPtrArray *ids, GError **error)
 {
-	g_autoptr(GPtrArray) remotes = fu_remote_list_get_all(self->remote_list);
+	const gchar *tmp;
+	g_autofree gchar *dirname = NULL;
+	g_autoptr(GDir) dir = NULL;
 
-	/* sync */
-	fu_engine_config_reload(self);
+	dirname = fu_context_build_filename(self->ctx,
+					    error,
+					    FU_PATH_KIND_CACHEDIR_PKG,
+					    "metadata.d",
+					    NULL);
+	if (dirname == NULL)
+		return FALSE;
+	if (!g_file_test(dirname, G_FILE_TEST_EXISTS))
+		return TRUE;
+	dir = g_dir_open(dirname, 0, error);
+	if (dir == NULL)
+		return FALSE;
+	while ((tmp = g_dir_read_name(dir)) != NULL) {
+		g_autofree gchar *fn = NULL;
+		g_autofree gchar *id = NULL;
+		g_autoptr(GFile) file = NULL;
 
-	/* amend P2P policy */
-	for (guint i = 0; i < remotes->len; i++) {
-		FwupdRemote *remote = g_ptr_array_index(remotes, i);
-		fu_engine_remote_list_ensure_p2p_policy_remote(self, remote);
+		if (!g_str_has_suffix(tmp, ".xmlb"))
+			continue;
+		id = g_strndup(tmp, strlen(tmp) - strlen(".xmlb"));
+		if (g_ptr_array_find_with_equal_func(ids, id, g_str_equal, NULL))
+			continue;
+		fn = g_build_filename(dirname, tmp, NULL);
+		g_debug("deleting stale metadata silo %s", fn);
+		file = g_file_new_for_path(fn);
+		if (!g_file_delete(file, NULL, error))
+			return FALSE;
 	}
+	return TRUE;
 }
 
-static void
-fu_engine_metadata_changed(FuEngine *self)
+static XbBuilderNode *
+fu_engine_metadata_builder_node_from_node(XbNode *n)
+{
+	const gchar *attr_name = NULL;
+	const gchar *attr_value = NULL;
+	XbNodeAttrIter iter;
+	g_autoptr(XbBuilderNode) bn = xb_builder_node_new(xb_node_get_element(n));
+	g_autoptr(XbNode) child = xb_node_get_child(n);
+
+	/* the text was already normalized when the part was compiled */
+	xb_builder_node_add_flag(bn, XB_BUILDER_NODE_FLAG_LITERAL_TEXT);
+	if (xb_node_get_text(n) != NULL)
+		xb_builder_node_set_text(bn, xb_node_get_text(n), -1);
+	if (xb_node_get_tail(n) != NULL)
+		xb_builder_node_set_tail(bn, xb_node_get_tail(n), -1);
+	xb_node_attr_iter_init(&iter, n);
+	while (xb_node_attr_iter_next(&iter, &attr_name, &attr_value))
+		xb_builder_node_set_attr(bn, attr_name, attr_value);
+	while (child != NULL) {
+		g_autoptr(XbBuilderNode) bc = fu_engine_metadata_builder_node_from_node(child);
+		XbNode *next = xb_node_get_next(child);
+		xb_builder_node_add_child(bn, bc);
+		g_object_unref(child);
+		child = next;
+	}
+	return g_steal_pointer(&bn);
+}
+
+static XbSilo *
+fu_engine_load_metadata_store_merged(FuEngine *self,
+				     GFile *xmlb,
+				     const gchar *key,
+				     FuEngineLoadFlags flags)
 {
+	const gchar *tmp = NULL;
 	g_autoptr(GError) error_local = NULL;
-	if (!fu_engine_load_metadata_store(self, self->load_flags, &error_local))
-		g_warning("Failed to reload metadata store: %s", error_local->message);
+	g_autoptr(XbNode) n = NULL;
+	g_autoptr(XbSilo) silo = xb_silo_new();
 
-	/* set device properties from the metadata */
-	fu_engine_md_refresh_devices(self);
+	if (!xb_silo_load_from_file(silo, xmlb, XB_SILO_LOAD_FLAG_NONE, NULL, &error_local)) {
+		g_debug("ignoring merged metadata: %s", error_local->message);
+		return NULL;
+	}
 
-	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	/* on a read-only filesystem don't care about the key */
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
+		return g_steal_pointer(&silo);
+	n = xb_silo_query_first(silo, "custom/value[@key='fwupd::MetadataKey']", NULL);
+	if (n != NULL)
+		tmp = xb_node_get_text(n);
+	if (g_strcmp0(tmp, key) != 0) {
+		g_debug("merged metadata key changed from %s, rebuilding", tmp);
+		return NULL;
+	}
+	return g_steal_pointer(&silo);
+}
 
-	/* make the UI update */
+static XbSilo *
+fu_engine_load_metadata_store_cached(FuEngine *self,
+				     GPtrArray *remotes,
+				     FuEngineLoadFlags flags,
+				     XbBuilderCompileFlags compile_flags,
+				     GError **error)
+{
+	g_autofree gchar *xmlbfn = NULL;
+	g_autoptr(GFile) xmlb = NULL;
+	g_autoptr(GPtrArray) ids = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) silos = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GString) key = g_string_new(NULL);
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbBuilder) builder_local = fu_engine_metadata_builder_new(self);
+	g_autoptr(XbBuilderNode) custom = NULL;
+	g_autoptr(XbSilo) silo = NULL;
+	g_autoptr(XbSilo) silo_local = NULL;
+
+	xmlbfn = fu_context_build_filename(self->ctx,
+					   error,
+					   FU_PATH_KIND_CACHEDIR_PKG,
+					   "metadata.xmlb",
+					   NULL);
+	if (xmlbfn == NULL)
+		return NULL;
+	xmlb = g_file_new_for_path(xmlbfn);
+
+	/* on a read-only filesystem use the merged silo as-is without building any parts */
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY) {
+		silo = fu_engine_load_metadata_store_merged(self, xmlb, NULL, flags);
+		if (silo != NULL)
+			return g_steal_pointer(&silo);
+	}
+
+	/* each remote gets a silo of its own, so that refreshing one does not reparse the others */
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index(remotes, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(XbBuilder) builder_remote = NULL;
+		g_autoptr(XbSilo) silo_remote = NULL;
+
+		if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
+			continue;
+		if (!g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_EXISTS))
+			continue;
+		builder_remote = fu_engine_metadata_builder_new(self);
+		if (!fu_engine_load_metadata_store_remote(self,
+							  builder_remote,
+							  remote,
+							  &error_local)) {
+			g_warning("failed to load remote %s: %s",
+				  fwupd_remote_get_id(remote),
+				  error_local->message);
+			continue;
+		}
+		silo_remote = fu_engine_metadata_builder_ensure(self,
+								builder_remote,
+								fwupd_remote_get_id(remote),
+								flags,
+								compile_flags,
+								&error_local);
+		if (silo_remote == NULL) {
+			g_warning("failed to load remote %s: %s",
+				  fwupd_remote_get_id(remote),
+				  error_local->message);
+			continue;
+		}
+		g_ptr_array_add(ids, g_strdup(fwupd_remote_get_id(remote)));
+		g_ptr_array_add(silos, g_steal_pointer(&silo_remote));
+	}
+
+	/* client-side data is small, so all of it goes into one silo */
+	if (!fu_engine_load_metadata_store_local_all(self, builder_local, error))
+		return NULL;
+	silo_local = fu_engine_metadata_builder_ensure(self,
+						       builder_local,
+						       "local",
+						       flags,
+						       compile_flags,
+						       error);
+	if (silo_local == NULL)
+		return NULL;
+	g_ptr_array_add(ids, g_strdup("local"));
+	g_ptr_array_add(silos, g_steal_pointer(&silo_local));
+
+	/* the merged silo only has to be rebuilt if one of the parts has changed */
+	for (guint i = 0; i < silos->len; i++) {
+		XbSilo *silo_tmp = g_ptr_array_index(silos, i);
+		if (key->len > 0)
+			g_string_append_c(key, ',');
+		g_string_append(key, xb_silo_get_guid(silo_tmp));
+	}
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0) {
+		silo = fu_engine_load_metadata_store_merged(self, xmlb, key->str, flags);
+		if (silo != NULL)
+			return g_steal_pointer(&silo);
+		if (!fu_engine_metadata_builder_prune(self, ids, error))
+			return NULL;
+	}
+
+	/* copy the already-compiled nodes, which is much quicker than parsing the XML again */
+	for (guint i = 0; i < silos->len; i++) {
+		XbSilo *silo_tmp = g_ptr_array_index(silos, i);
+		g_autoptr(XbNode) n = xb_silo_get_root(silo_tmp);
+		while (n != NULL) {
+			g_autoptr(XbBuilderNode) bn = fu_engine_metadata_builder_node_from_node(n);
+			XbNode *next = xb_node_get_next(n);
+			xb_builder_import_node(builder, bn);
+			g_object_unref(n);
+			n = next;
+		}
+	}
+	custom = xb_builder_node_new("custom");
+	xb_builder_node_insert_text(custom, "value", key->str, "key", "fwupd::MetadataKey", NULL);
+	xb_builder_import_node(builder, custom);
+	silo = xb_builder_compile(builder, compile_flags, NULL, error);
+	if (silo == NULL) {
+		fwupd_error_convert(error);
+		g_prefix_error_literal(error, "cannot create metadata.xmlb: ");
+		return NULL;
+	}
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0 &&
+	    !xb_silo_save_to_file(silo, xmlb, NULL, error)) {
+		fwupd_error_convert(error);
+		g_prefix_error_literal(error, "cannot save metadata.xmlb: ");
+		return NULL;
+	}
+	g_info("merged %u metadata silos in %.1fms",
+	       silos->len,
+	       g_timer_elapsed(timer, NULL) * 1000.f);
+	return g_steal_pointer(&silo);
+}
+
+static XbSilo *
+fu_engine_load_metadata_store_uncached(FuEngine *self,
+				       GPtrArray *remotes,
+				       XbBuilderCompileFlags compile_flags,
+				       GError **error)
+{
+	g_autoptr(GFile) xmlb = NULL;
+	g_autoptr(GFileIOStream) iostr = NULL;
+	g_autoptr(XbBuilder) builder = fu_engine_metadata_builder_new(self);
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* load each enabled metadata file */
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index(remotes, i);
+		g_autoptr(GError) error_local = NULL;
+
+		if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
+			continue;
+		if (!g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_EXISTS))
+			continue;
+		if (!fu_engine_load_metadata_store_remote(self, builder, remote, &error_local)) {
+			g_warning("failed to load remote %s: %s",
+				  fwupd_remote_get_id(remote),
+				  error_local->message);
+		}
+	}
+	if (!fu_engine_load_metadata_store_local_all(self, builder, error))
+		return NULL;
+
+	/* ensure silo is up to date */
+	xmlb = g_file_new_tmp(NULL, &iostr, error);
+	if (xmlb == NULL)
+		return NULL;
+	silo = xb_builder_ensure(builder, xmlb, compile_flags, NULL, error);
+	if (silo == NULL) {
+		g_prefix_error_literal(error, "cannot create metadata.xmlb: ");
+		return NULL;
+	}
+	return g_steal_pointer(&silo);
+}
+
+static gboolean
+fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **error)
+{
+	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
+	g_autoptr(GPtrArray) remotes = fu_remote_list_get_all(self->remote_list);
+
+	/* clear existing silo */
+	g_clear_object(&self->silo);
+
+	/* on a read-only filesystem don't care about the cache GUID */
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
+		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
+
+	/* ensure silo is up to date */
+	if (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) {
+		self->silo =
+		    fu_engine_load_metadata_store_uncached(self, remotes, compile_flags, error);
+	} else {
+		self->silo = fu_engine_load_metadata_store_cached(self,
+								  remotes,
+								  flags,
+								  compile_flags,
+								  error);
+	}
+	if (self->silo == NULL)
+		return FALSE;
+
+	/* success */
+	return fu_engine_create_silo_index(self, error);
+}
+
+static void
+fu_engine_remote_list_ensure_p2p_policy_remote(FuEngine *self, FwupdRemote *remote)
+{
+	if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DOWNLOAD) {
+		FuP2pPolicy p2p_policy = fu_engine_get_p2p_policy(self);
+		if (p2p_policy & FU_P2P_POLICY_METADATA)
+			fwupd_remote_add_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA);
+		else
+			fwupd_remote_remove_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA);
+		if (p2p_policy & FU_P2P_POLICY_FIRMWARE)
+			fwupd_remote_add_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE);
+		else
+			fwupd_remote_remove_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE);
+	}
+}
+
+static void
+fu_engine_config_changed_cb(FuConfig *config, FuEngine *self)
+{
+	g_autoptr(GPtrArray) remotes = fu_remote_list_get_all(self->remote_list);
+
+	/* sync */
+	fu_engine_config_reload(self);
+
+	/* amend P2P policy */
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index(remotes, i);
+		fu_engine_remote_list_ensure_p2p_policy_remote(self, remote);
+	}
+}
+
+static void
+fu_engine_metadata_changed(FuEngine *self)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (!fu_engine_load_metadata_store(self, self->load_flags, &error_local))
+		g_warning("Failed to reload metadata store: %s", error_local->message);
+
+	/* set device properties from the metadata */
+	fu_engine_md_refresh_devices(self);
+
+	/* invalidate host security attributes */
+	fu_engine_invalidate_security_attrs(self);
+
+	/* make the UI update */
 	fu_engine_emit_changed(self);
 }
 
@@ -5047,7 +5523,7 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 	fu_engine_md_refresh_devices(self);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self);
 
 	/* make the UI update */
 	fu_engine_emit_changed(self);
@@ -5301,7 +5777,7 @@ fu_engine_get_details(FuEngine *self,
 	};
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(GPtrArray) details = NULL;
-	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) checksums = NULL;
 	g_autoptr(FuCabinet) cabinet = NULL;
 	g_autoptr(GPtrArray) rels_by_csum = NULL;
 
@@ -5319,13 +5795,12 @@ fu_engine_get_details(FuEngine *self,
 		return NULL;
 
 	/* calculate the checksums of the blob */
-	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-		g_autofree gchar *checksum =
-		    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-		if (checksum == NULL)
-			return NULL;
-		g_ptr_array_add(checksums, g_steal_pointer(&checksum));
-	}
+	checksums = fu_input_stream_compute_checksums(stream,
+						      checksum_types,
+						      G_N_ELEMENTS(checksum_types),
+						      error);
+	if (checksums == NULL)
+		return NULL;
 
 	/* does this exist in any enabled remote */
 	for (guint i = 0; i < checksums->len; i++) {
@@ -5932,13 +6407,85 @@ fu_engine_get_branch_fallback(const gchar *nullable_branch)
 	return nullable_branch;
 }
 
+/* everything about the device and request that the requirement checks use */
+static gchar *
+fu_engine_get_releases_cache_key(FuEngineRequest *request, FuDevice *device)
+{
+	const gchar *values[] = {
+	    fu_device_get_id(device),
+	    fu_device_get_version(device),
+	    fu_device_get_version_lowest(device),
+	    fu_device_get_branch(device),
+	    fu_engine_request_get_locale(request),
+	};
+	GString *str = g_string_new(NULL);
+
+	for (guint i = 0; i < G_N_ELEMENTS(values); i++)
+		g_string_append_printf(str, "%s:", values[i] != NULL ? values[i] : "");
+	g_string_append_printf(str,
+			       "%u:%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%u:%u",
+			       fu_device_get_guids(device)->len,
+			       (guint64)fu_device_get_flags(device),
+			       (guint64)fu_engine_request_get_feature_flags(request),
+			       fu_engine_request_has_flag(request,
+							  FU_ENGINE_REQUEST_FLAG_NO_REQUIREMENTS),
+			       fu_engine_request_has_flag(request,
+							  FU_ENGINE_REQUEST_FLAG_ANY_RELEASE));
+	return g_string_free(str, FALSE);
+}
+
+static GPtrArray *
+fu_engine_get_releases_for_device_guids(FuEngine *self,
+					FuEngineRequest *request,
+					FuDevice *device)
+{
+	GPtrArray *device_guids = fu_device_get_guids(device);
+	g_autoptr(GPtrArray) releases =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	/* get all the components that provide any of these GUIDs */
+	for (guint j = 0; j < device_guids->len; j++) {
+		const gchar *guid = g_ptr_array_index(device_guids, j);
+		GPtrArray *components = g_hash_table_lookup(self->components_by_guid, guid);
+
+		if (components == NULL) {
+			g_debug("%s was not found", guid);
+			continue;
+		}
+
+		/* find all the releases that pass all the requirements */
+		g_debug("%s matched %u components", guid, components->len);
+		for (guint i = 0; i < components->len; i++) {
+			XbNode *component = XB_NODE(g_ptr_array_index(components, i));
+			g_autoptr(GError) error_tmp = NULL;
+			if (!fu_engine_add_releases_for_device_component(self,
+									 request,
+									 device,
+									 component,
+									 releases,
+									 &error_tmp)) {
+				g_debug("%s", error_tmp->message);
+				continue;
+			}
+		}
+		g_debug("%s matched %u releases", guid, releases->len);
+
+		/* if we're only checking for SUPPORTED then *any* release is good enough */
+		if (fu_engine_request_has_flag(request, FU_ENGINE_REQUEST_FLAG_ANY_RELEASE) &&
+		    releases->len > 0)
+			break;
+	}
+	return g_steal_pointer(&releases);
+}
+
 GPtrArray *
 fu_engine_get_releases_for_device(FuEngine *self,
 				  FuEngineRequest *request,
 				  FuDevice *device,
 				  GError **error)
 {
-	GPtrArray *device_guids;
+	GPtrArray *releases_cached;
+	g_autofree gchar *key = NULL;
 	g_autoptr(GPtrArray) branches = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 
@@ -5984,47 +6531,18 @@ fu_engine_get_releases_for_device(FuEngine *self,
 		return NULL;
 	}
 
-	/* get all the components that provide any of these GUIDs */
-	device_guids = fu_device_get_guids(device);
-	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	for (guint j = 0; j < device_guids->len; j++) {
-		const gchar *guid = g_ptr_array_index(device_guids, j);
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) components = NULL;
-		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
-
-		xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		components = xb_silo_query_with_context(self->silo,
-							self->query_component_by_guid,
-							&context,
-							&error_local);
-		if (components == NULL) {
-			g_debug("%s was not found: %s", guid, error_local->message);
-			continue;
-		}
-
-		/* find all the releases that pass all the requirements */
-		g_debug("%s matched %u components", guid, components->len);
-		for (guint i = 0; i < components->len; i++) {
-			XbNode *component = XB_NODE(g_ptr_array_index(components, i));
-			g_autoptr(GError) error_tmp = NULL;
-			if (!fu_engine_add_releases_for_device_component(self,
-									 request,
-									 device,
-									 component,
-									 releases,
-									 &error_tmp)) {
-				g_debug("%s", error_tmp->message);
-				continue;
-			}
-		}
-		g_debug("%s matched %u releases", guid, releases->len);
-
-		/* if we're only checking for SUPPORTED then *any* release is good enough */
-		if (fu_engine_request_has_flag(request, FU_ENGINE_REQUEST_FLAG_ANY_RELEASE) &&
-		    releases->len > 0)
-			break;
+	/* the requirements have already been checked for the device as it is now */
+	key = fu_engine_get_releases_cache_key(request, device);
+	releases_cached = g_hash_table_lookup(self->releases_by_device, key);
+	if (releases_cached != NULL) {
+		releases =
+		    fu_ptr_array_copy(releases_cached, (GCopyFunc)g_object_ref, g_object_unref);
+	} else {
+		releases = fu_engine_get_releases_for_device_guids(self, request, device);
+		g_hash_table_insert(
+		    self->releases_by_device,
+		    g_steal_pointer(&key),
+		    fu_ptr_array_copy(releases, (GCopyFunc)g_object_ref, g_object_unref));
 	}
 
 	/* are there multiple branches available */
@@ -6319,6 +6837,7 @@ fu_engine_add_approved_firmware(FuEngine *self, const gchar *checksum)
 		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	}
 	g_hash_table_add(self->approved_firmware, g_strdup(checksum));
+	fu_engine_invalidate_releases(self);
 }
 
 gchar *
@@ -6348,37 +6867,16 @@ fu_engine_self_sign(FuEngine *self, const gchar *value, FuJcatSignFlags flags, G
 	return fwupd_jcat_blob_get_data_as_string(jcat_signature);
 }
 
-/**
- * fu_engine_get_upgrades:
- * @self: a #FuEngine
- * @request: a #FuEngineRequest
- * @device_id: a device ID
- * @error: (nullable): optional return location for an error
- *
- * Gets the upgrades available for a specific device.
- *
- * Returns: (transfer container) (element-type FwupdDevice): results
- **/
-GPtrArray *
-fu_engine_get_upgrades(FuEngine *self,
-		       FuEngineRequest *request,
-		       const gchar *device_id,
-		       GError **error)
+static GPtrArray *
+fu_engine_get_upgrades_for_device(FuEngine *self,
+				  FuEngineRequest *request,
+				  FuDevice *device,
+				  GError **error)
 {
-	g_autoptr(FuDevice) device = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 	g_autoptr(GPtrArray) releases_tmp = NULL;
 	g_autoptr(GString) error_str = g_string_new(NULL);
 
-	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
-	g_return_val_if_fail(device_id != NULL, NULL);
-	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
-
-	/* find the device */
-	device = fu_device_list_get_by_id(self->device_list, device_id, error);
-	if (device == NULL)
-		return NULL;
-
 	/* there is no point checking each release */
 	if (!fu_device_is_updatable(device)) {
 		g_set_error_literal(error,
@@ -6482,6 +6980,93 @@ fu_engine_get_upgrades(FuEngine *self,
 	return g_steal_pointer(&releases);
 }
 
+/**
+ * fu_engine_get_upgrades:
+ * @self: a #FuEngine
+ * @request: a #FuEngineRequest
+ * @device_id: a device ID
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the upgrades available for a specific device.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): results
+ **/
+GPtrArray *
+fu_engine_get_upgrades(FuEngine *self,
+		       FuEngineRequest *request,
+		       const gchar *device_id,
+		       GError **error)
+{
+	g_autoptr(FuDevice) device = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
+	g_return_val_if_fail(device_id != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* find the device */
+	device = fu_device_list_get_by_id(self->device_list, device_id, error);
+	if (device == NULL)
+		return NULL;
+	return fu_engine_get_upgrades_for_device(self, request, device, error);
+}
+
+/**
+ * fu_engine_get_upgrades_all:
+ * @self: a #FuEngine
+ * @request: a #FuEngineRequest
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the upgrades available for all the devices, which saves the client asking for each device.
+ * Devices without any upgrades are not included.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): devices with the upgrades as releases
+ **/
+GPtrArray *
+fu_engine_get_upgrades_all(FuEngine *self, FuEngineRequest *request, GError **error)
+{
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) results =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
+	g_return_val_if_fail(FU_IS_ENGINE_REQUEST(request), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	devices = fu_engine_get_devices(self, error);
+	if (devices == NULL)
+		return NULL;
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		g_autoptr(FwupdDevice) result = NULL;
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) releases = NULL;
+
+		releases = fu_engine_get_upgrades_for_device(self, request, device, &error_local);
+		if (releases == NULL) {
+			g_autofree gchar *id_display = fu_device_get_id_display(device);
+			g_debug("no upgrades for %s: %s", id_display, error_local->message);
+			continue;
+		}
+
+		/* do not add the releases to the real device */
+		result = fwupd_device_new();
+		fwupd_device_incorporate(result, FWUPD_DEVICE(device));
+		for (guint j = 0; j < releases->len; j++) {
+			FwupdRelease *rel = g_ptr_array_index(releases, j);
+			fwupd_device_add_release(result, rel);
+		}
+		g_ptr_array_add(results, g_steal_pointer(&result));
+	}
+	if (results->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    "No upgrades for any device");
+		return NULL;
+	}
+	return g_steal_pointer(&results);
+}
+
 /**
  * fu_engine_clear_results:
  * @self: a #FuEngine
@@ -7116,7 +7701,7 @@ fu_engine_context_security_changed_cb(FuContext *ctx, gpointer user_data)
 	FuEngine *self = FU_ENGINE(user_data);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self);
 
 	/* make UI refresh */
 	fu_engine_emit_changed(self);
@@ -7228,9 +7813,6 @@ fu_engine_add_plugin_filter(FuEngine *self, const gchar *plugin_glob)
 static gboolean
 fu_engine_plugin_check_supported_cb(FuPlugin *plugin, const gchar *guid, FuEngine *self)
 {
-	g_autoptr(XbNode) n = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
-
 	if (fu_context_get_config_bool(self->ctx, "EnumerateAllDevices"))
 		return TRUE;
 
@@ -7239,12 +7821,7 @@ fu_engine_plugin_check_supported_cb(FuPlugin *plugin, const gchar *guid, FuEngin
 		g_debug("no components in silo");
 		return FALSE;
 	}
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	n = xb_silo_query_first_with_context(self->silo,
-					     self->query_component_by_guid,
-					     &context,
-					     NULL);
-	return n != NULL;
+	return g_hash_table_contains(self->components_by_guid, guid);
 }
 
 const gchar *
@@ -7764,19 +8341,52 @@ fu_engine_ensure_security_attrs(FuEngine *self)
 		return;
 
 	/* built in */
-	fu_engine_ensure_security_attrs_supported_cpu(self);
-	fu_engine_ensure_security_attrs_tainted(self);
-
-	/* call into devices */
+	fu_security_attrs_cache_rewind(self->host_security_attrs_cache);
+	if (!fu_security_attrs_cache_restore(self->host_security_attrs_cache,
+					     "core",
+					     self->host_security_attrs)) {
+		fu_engine_ensure_security_attrs_supported_cpu(self);
+		fu_engine_ensure_security_attrs_tainted(self);
+		fu_security_attrs_cache_add(self->host_security_attrs_cache,
+					    "core",
+					    self->host_security_attrs);
+	}
+
+	/* call into devices, unless nothing they depend on has changed */
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index(devices, i);
+		FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(device);
+		g_autofree gchar *source = NULL;
+
+		if (device_class->add_security_attrs == NULL)
+			continue;
+		source = g_strdup_printf("device:%s", fu_device_get_id(device));
+		if (fu_security_attrs_cache_restore(self->host_security_attrs_cache,
+						    source,
+						    self->host_security_attrs))
+			continue;
 		fu_device_add_security_attrs(device, self->host_security_attrs);
+		fu_security_attrs_cache_add(self->host_security_attrs_cache,
+					    source,
+					    self->host_security_attrs);
 	}
 
-	/* call into plugins */
+	/* call into plugins, unless nothing they depend on has changed */
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index(plugins, j);
+		g_autofree gchar *source = NULL;
+
+		if (!fu_plugin_has_add_security_attrs(plugin_tmp))
+			continue;
+		source = g_strdup_printf("plugin:%s", fu_plugin_get_name(plugin_tmp));
+		if (fu_security_attrs_cache_restore(self->host_security_attrs_cache,
+						    source,
+						    self->host_security_attrs))
+			continue;
 		fu_plugin_runner_add_security_attrs(plugin_tmp, self->host_security_attrs);
+		fu_security_attrs_cache_add(self->host_security_attrs_cache,
+					    source,
+					    self->host_security_attrs);
 	}
 
 	/* sanity check */
@@ -8273,9 +8883,31 @@ fu_engine_backend_device_added_run_plugins(FuEngine *self, FuDevice *device, FuP
 	}
 }
 
+typedef struct {
+	FuBackend *backend;
+	FuDevice *device;
+	GError *error;	  /* (nullable) */
+	gdouble duration; /* s */
+	gboolean probed;
+} FuEngineProbeHelper;
+
+static void
+fu_engine_probe_helper_free(FuEngineProbeHelper *helper)
+{
+	g_object_unref(helper->backend);
+	g_object_unref(helper->device);
+	if (helper->error != NULL)
+		g_error_free(helper->error);
+	g_free(helper);
+}
+
 static void
-fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *progress)
+fu_engine_backend_device_added(FuEngine *self,
+			       FuDevice *device,
+			       FuEngineProbeHelper *helper,
+			       FuProgress *progress)
 {
+	gboolean ret;
 	g_autoptr(GError) error_local = NULL;
 
 	/* progress */
@@ -8291,9 +8923,16 @@ fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *pro
 		g_debug("%s added %s", fu_device_get_backend_id(device), str);
 	}
 
-	/* add any extra quirks */
+	/* add any extra quirks, unless this was already done on a worker thread */
 	fu_device_set_context(device, self->ctx);
-	if (!fu_device_probe(device, &error_local)) {
+	if (helper != NULL) {
+		ret = helper->error == NULL;
+		if (!ret)
+			error_local = g_error_copy(helper->error);
+	} else {
+		ret = fu_device_probe(device, &error_local);
+	}
+	if (!ret) {
 		if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) &&
 		    !g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT)) {
 			g_warning("failed to probe device %s: %s",
@@ -8308,6 +8947,8 @@ fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *pro
 		return;
 	}
 	fu_progress_step_done(progress);
+	if (helper != NULL)
+		fu_progress_set_step_duration(progress, 0, helper->duration);
 
 	/* check if the device needs emulation-tag */
 	fu_engine_ensure_device_emulation_tag(self, device);
@@ -8332,7 +8973,7 @@ fu_engine_backend_device_added_cb(FuBackend *backend, FuDevice *device, FuEngine
 	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(GPtrArray) possible_plugins = NULL;
 
-	fu_engine_backend_device_added(self, device, progress);
+	fu_engine_backend_device_added(self, device, NULL, progress);
 
 	/* free data cached during ->probe */
 	fu_device_probe_complete(device);
@@ -8723,6 +9364,23 @@ fu_engine_win32_registry_get_string(HKEY hkey,
 }
 #endif
 
+static void
+fu_engine_backend_watch(FuEngine *self, FuBackend *backend)
+{
+	g_signal_connect(FU_BACKEND(backend),
+			 "device-added",
+			 G_CALLBACK(fu_engine_backend_device_added_cb),
+			 self);
+	g_signal_connect(FU_BACKEND(backend),
+			 "device-removed",
+			 G_CALLBACK(fu_engine_backend_device_removed_cb),
+			 self);
+	g_signal_connect(FU_BACKEND(backend),
+			 "device-changed",
+			 G_CALLBACK(fu_engine_backend_device_changed_cb),
+			 self);
+}
+
 static gboolean
 fu_engine_backends_coldplug_backend_add_devices(FuEngine *self,
 						FuBackend *backend,
@@ -8738,7 +9396,7 @@ fu_engine_backends_coldplug_backend_add_devices(FuEngine *self,
 		FuDevice *device = g_ptr_array_index(devices, i);
 		g_autoptr(GPtrArray) possible_plugins = NULL;
 
-		fu_engine_backend_device_added(self, device, fu_progress_get_child(progress));
+		fu_engine_backend_device_added(self, device, NULL, fu_progress_get_child(progress));
 		fu_progress_step_done(progress);
 
 		/* free data cached during ->probe */
@@ -8783,25 +9441,202 @@ fu_engine_backends_coldplug_backend(FuEngine *self,
 	fu_progress_step_done(progress);
 
 	/* success */
-	g_signal_connect(FU_BACKEND(backend),
-			 "device-added",
-			 G_CALLBACK(fu_engine_backend_device_added_cb),
-			 self);
-	g_signal_connect(FU_BACKEND(backend),
-			 "device-removed",
-			 G_CALLBACK(fu_engine_backend_device_removed_cb),
-			 self);
-	g_signal_connect(FU_BACKEND(backend),
-			 "device-changed",
-			 G_CALLBACK(fu_engine_backend_device_changed_cb),
-			 self);
+	fu_engine_backend_watch(self, backend);
 	return TRUE;
 }
 
+static void
+fu_engine_backends_coldplug_error(FuBackend *backend, const GError *error)
+{
+	if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+		g_debug("ignoring coldplug failure %s: %s",
+			fu_backend_get_name(backend),
+			error->message);
+	} else {
+		g_warning("failed to coldplug backend %s: %s",
+			  fu_backend_get_name(backend),
+			  error->message);
+	}
+}
+
+/* this is run in a worker thread, or in the main thread if the pool could not be used */
+static void
+fu_engine_backends_probe_thread_cb(gpointer data, gpointer user_data)
+{
+	FuEngineProbeHelper *helper = (FuEngineProbeHelper *)data;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* any error is reported when the device is added in the main thread */
+	(void)fu_device_probe(helper->device, &helper->error);
+	helper->duration = g_timer_elapsed(timer, NULL);
+	helper->probed = TRUE;
+}
+
+static void
+fu_engine_backends_coldplug_backend_add_probed(FuEngine *self,
+					       FuBackend *backend,
+					       GPtrArray *helpers,
+					       FuProgress *progress)
+{
+	g_autoptr(GPtrArray) helpers_backend = g_ptr_array_new();
+
+	/* the helpers are already in the same order as fu_backend_get_devices() */
+	for (guint i = 0; i < helpers->len; i++) {
+		FuEngineProbeHelper *helper = g_ptr_array_index(helpers, i);
+		if (helper->backend == backend)
+			g_ptr_array_add(helpers_backend, helper);
+	}
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_NO_PROFILE);
+	fu_progress_set_name(progress, fu_backend_get_name(backend));
+	fu_progress_set_steps(progress, helpers_backend->len);
+	for (guint i = 0; i < helpers_backend->len; i++) {
+		FuEngineProbeHelper *helper = g_ptr_array_index(helpers_backend, i);
+		g_autoptr(GPtrArray) possible_plugins = NULL;
+
+		fu_engine_backend_device_added(self,
+					       helper->device,
+					       helper,
+					       fu_progress_get_child(progress));
+		fu_progress_step_done(progress);
+
+		/* free data cached during ->probe */
+		fu_device_probe_complete(helper->device);
+
+		/* there's no point keeping this in the cache */
+		possible_plugins = fu_device_get_possible_plugins(helper->device);
+		if (possible_plugins == NULL) {
+			g_debug("removing %s from backend cache as no possible plugin",
+				fu_device_get_backend_id(helper->device));
+			fu_backend_device_removed(backend, helper->device);
+		}
+	}
+}
+
+/*
+ * The backends have to enumerate in the thread they were created in, but the device ->probe()
+ * vfuncs mostly block on sysfs and descriptor reads, and can be run on a bounded pool of worker
+ * threads. The plugins are then run on each device in the main thread in the same order as the
+ * serial coldplug so that the device list is populated deterministically.
+ */
+static void
+fu_engine_backends_coldplug_threaded(FuEngine *self, guint threads_max, FuProgress *progress)
+{
+	GPtrArray *backends = fu_context_get_backends(self->ctx);
+	GThreadPool *pool;
+	g_autoptr(GPtrArray) backends_ok = g_ptr_array_new();
+	g_autoptr(GPtrArray) helpers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_probe_helper_free);
+	g_autoptr(GError) error_pool = NULL;
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_NO_PROFILE);
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 1, "coldplug");
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 49, "probe");
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 50, "add-devices");
+
+	/* enumerate each backend */
+	fu_progress_set_id(fu_progress_get_child(progress), G_STRLOC);
+	fu_progress_set_steps(fu_progress_get_child(progress), backends->len);
+	for (guint i = 0; i < backends->len; i++) {
+		FuBackend *backend = g_ptr_array_index(backends, i);
+		FuProgress *progress_child = fu_progress_get_child(progress);
+		FuProgress *progress_backend = fu_progress_get_child(progress_child);
+		g_autoptr(GError) error_backend = NULL;
+
+		if (!fu_backend_get_enabled(backend)) {
+			fu_progress_step_done(progress_child);
+			continue;
+		}
+		fu_progress_set_name(progress_backend, fu_backend_get_name(backend));
+		if (!fu_backend_coldplug(backend, progress_backend, &error_backend)) {
+			fu_engine_backends_coldplug_error(backend, error_backend);
+			fu_progress_finished(progress_backend);
+			fu_progress_step_done(progress_child);
+			continue;
+		}
+		g_ptr_array_add(backends_ok, backend);
+		fu_progress_step_done(progress_child);
+	}
+	fu_progress_step_done(progress);
+
+	/* probe all the devices from all the backends at the same time */
+	for (guint i = 0; i < backends_ok->len; i++) {
+		FuBackend *backend = g_ptr_array_index(backends_ok, i);
+		g_autoptr(GPtrArray) devices = fu_backend_get_devices(backend);
+		for (guint j = 0; j < devices->len; j++) {
+			FuDevice *device = g_ptr_array_index(devices, j);
+			FuEngineProbeHelper *helper = g_new0(FuEngineProbeHelper, 1);
+			helper->backend = g_object_ref(backend);
+			helper->device = g_object_ref(device);
+			fu_device_set_context(device, self->ctx);
+			g_ptr_array_add(helpers, helper);
+		}
+	}
+	pool = g_thread_pool_new(fu_engine_backends_probe_thread_cb,
+				 self,
+				 (gint)threads_max,
+				 FALSE,
+				 &error_pool);
+	if (pool == NULL) {
+		g_warning("failed to create coldplug thread pool: %s", error_pool->message);
+	} else {
+		gboolean immediate = FALSE;
+		for (guint i = 0; i < helpers->len; i++) {
+			FuEngineProbeHelper *helper = g_ptr_array_index(helpers, i);
+			if (!g_thread_pool_push(pool, helper, &error_pool)) {
+				g_warning("failed to push to coldplug thread pool: %s",
+					  error_pool->message);
+				immediate = TRUE;
+				break;
+			}
+		}
+		/* when shutting down immediately any queued helpers are not run */
+		g_thread_pool_free(pool, immediate, TRUE);
+	}
+
+	/* fall back to probing in the main thread */
+	for (guint i = 0; i < helpers->len; i++) {
+		FuEngineProbeHelper *helper = g_ptr_array_index(helpers, i);
+		if (!helper->probed)
+			fu_engine_backends_probe_thread_cb(helper, self);
+	}
+	g_debug("probed %u devices using %u threads", helpers->len, threads_max);
+	fu_progress_step_done(progress);
+
+	/* run the plugins on each device in order */
+	fu_progress_set_id(fu_progress_get_child(progress), G_STRLOC);
+	fu_progress_set_steps(fu_progress_get_child(progress), backends_ok->len);
+	for (guint i = 0; i < backends_ok->len; i++) {
+		FuBackend *backend = g_ptr_array_index(backends_ok, i);
+		FuProgress *progress_child = fu_progress_get_child(progress);
+		FuProgress *progress_backend = fu_progress_get_child(progress_child);
+		fu_engine_backends_coldplug_backend_add_probed(self,
+							       backend,
+							       helpers,
+							       progress_backend);
+		fu_progress_step_done(progress_child);
+		fu_engine_backend_watch(self, backend);
+	}
+	fu_progress_step_done(progress);
+}
+
 static void
 fu_engine_backends_coldplug(FuEngine *self, FuProgress *progress)
 {
 	GPtrArray *backends = fu_context_get_backends(self->ctx);
+	guint64 threads_max = fu_context_get_config_u64(self->ctx, "ColdplugThreads");
+
+	/* probe devices on a pool of worker threads */
+	if (threads_max > 1 && threads_max != G_MAXUINT64) {
+		threads_max = MIN(threads_max, FU_ENGINE_COLDPLUG_THREADS_MAX);
+		fu_engine_backends_coldplug_threaded(self, threads_max, progress);
+		return;
+	}
+
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, backends->len);
 	for (guint i = 0; i < backends->len; i++) {
@@ -8816,17 +9651,7 @@ fu_engine_backends_coldplug(FuEngine *self, FuProgress *progress)
 							 backend,
 							 fu_progress_get_child(progress),
 							 &error_backend)) {
-			if (g_error_matches(error_backend,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED)) {
-				g_debug("ignoring coldplug failure %s: %s",
-					fu_backend_get_name(backend),
-					error_backend->message);
-			} else {
-				g_warning("failed to coldplug backend %s: %s",
-					  fu_backend_get_name(backend),
-					  error_backend->message);
-			}
+			fu_engine_backends_coldplug_error(backend, error_backend);
 			fu_progress_finished(fu_progress_get_child(progress));
 		}
 		fu_progress_step_done(progress);
@@ -8867,12 +9692,14 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 					FU_CONTEXT_LOAD_FLAG_WATCH_FILES |
 					FU_CONTEXT_LOAD_FLAG_PATH_STORE_ENV;
 	FuPlugin *plugin_uefi;
+	FuSnapshotWriter *devices_file;
 	GPtrArray *backends = fu_context_get_backends(self->ctx);
 	GPtrArray *plugins = fu_plugin_list_get_all(self->plugin_list);
 	const gchar *host_emulate = g_getenv("FWUPD_HOST_EMULATE");
 	const gchar *keyring_path;
 	g_autofree gchar *pkidir_fw = NULL;
 	g_autofree gchar *pkidir_md = NULL;
+	g_autofree gchar *jcat_cachefn = NULL;
 	g_autoptr(GError) error_json_devices = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -8952,6 +9779,18 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 					      NULL);
 	if (pkidir_md != NULL)
 		fu_jcat_context_add_public_keys(self->jcat_context, pkidir_md);
+	/* the results are trusted, so this is kept with the other daemon state and not in the
+	 * cache directory */
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0 &&
+	    (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) == 0) {
+		jcat_cachefn = fu_context_build_filename(self->ctx,
+							 NULL,
+							 FU_PATH_KIND_LOCALSTATEDIR_PKG,
+							 "jcat.cache",
+							 NULL);
+		if (jcat_cachefn != NULL)
+			fu_jcat_context_set_cache_path(self->jcat_context, jcat_cachefn);
+	}
 
 	/* cache machine ID so we can use it from a sandboxed app */
 #ifdef _WIN32
@@ -9177,8 +10016,12 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 	fu_progress_step_done(progress);
 
 	/* update the devices JSON file */
-	if (!fu_engine_update_devices_file(self, &error_json_devices))
+	devices_file = fu_engine_ensure_devices_file(self, &error_json_devices);
+	if (devices_file == NULL) {
+		g_debug("ignoring update devices file: %s", error_json_devices->message);
+	} else if (!fu_snapshot_writer_flush(devices_file, &error_json_devices)) {
 		g_info("failed to update list of devices: %s", error_json_devices->message);
+	}
 
 	fu_engine_set_status(self, FWUPD_STATUS_IDLE);
 	self->load_flags |= FU_ENGINE_LOAD_FLAG_READY;
@@ -9464,6 +10307,7 @@ fu_engine_constructed(GObject *obj)
 	/* defaults changed here will also be reflected in the fwupd.conf man page */
 	fu_config_set_default(config, "fwupd", "ApprovedFirmware", NULL);
 	fu_config_set_default(config, "fwupd", "ArchiveSizeMax", archive_size_max_default);
+	fu_config_set_default(config, "fwupd", "ColdplugThreads", "0");
 	fu_config_set_default(config, "fwupd", "DisabledDevices", NULL);
 	fu_config_set_default(config, "fwupd", "DisabledPlugins", "");
 	fu_config_set_default(config, "fwupd", "EnumerateAllDevices", "false");
@@ -9631,8 +10475,17 @@ fu_engine_init(FuEngine *self)
 	self->plugin_list = fu_plugin_list_new();
 	self->plugin_filter = g_ptr_array_new_with_free_func(g_free);
 	self->host_security_attrs = fu_security_attrs_new();
+	self->host_security_attrs_cache = fu_security_attrs_cache_new();
 	self->local_monitors = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->search_queries = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->components_by_guid = g_hash_table_new_full(g_str_hash,
+							  g_str_equal,
+							  g_free,
+							  (GDestroyNotify)g_ptr_array_unref);
+	self->releases_by_device = g_hash_table_new_full(g_str_hash,
+							  g_str_equal,
+							  g_free,
+							  (GDestroyNotify)g_ptr_array_unref);
 	self->acquiesce_loop = g_main_loop_new(NULL, FALSE);
 	self->device_changed_allowlist =
 	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
@@ -9653,6 +10506,17 @@ fu_engine_finalize(GObject *obj)
 {
 	FuEngine *self = FU_ENGINE(obj);
 
+	/* do not lose the last changes */
+	if (self->devices_file != NULL) {
+		if (fu_snapshot_writer_is_busy(self->devices_file)) {
+			g_autoptr(GError) error_local = NULL;
+			if (!fu_snapshot_writer_flush(self->devices_file, &error_local))
+				g_info("failed to update list of devices: %s",
+				       error_local->message);
+		}
+		g_object_unref(self->devices_file);
+	}
+
 	for (guint i = 0; i < self->local_monitors->len; i++) {
 		GFileMonitor *monitor = g_ptr_array_index(self->local_monitors, i);
 		g_file_monitor_cancel(monitor);
@@ -9684,6 +10548,7 @@ fu_engine_finalize(GObject *obj)
 
 	g_free(self->host_machine_id);
 	g_object_unref(self->host_security_attrs);
+	g_object_unref(self->host_security_attrs_cache);
 	g_object_unref(self->idle);
 	g_object_unref(self->remote_list);
 	g_object_unref(self->history);
@@ -9692,6 +10557,8 @@ fu_engine_finalize(GObject *obj)
 	g_ptr_array_unref(self->plugin_filter);
 	g_ptr_array_unref(self->local_monitors);
 	g_ptr_array_unref(self->search_queries);
+	g_hash_table_unref(self->components_by_guid);
+	g_hash_table_unref(self->releases_by_device);
 	g_hash_table_unref(self->device_changed_allowlist);
 	g_object_unref(self->plugin_list);
 	g_ptr_array_unref(self->disabled_devices);
@@ -27,8 +27,16 @@ struct _FuJcatContext {
 	GPtrArray *public_keys;
 	gchar *keyring_path;
 	guint32 blob_kinds;
+	gchar *cache_path;
+	GKeyFile *cache;   /* nullable, loaded on first use */
+	gchar *keyring_id; /* nullable, SHA256 of the public keys */
 };
 
+/* a cached signature is verified again after this long, so that revoked or expired certificates
+ * are noticed eventually */
+#define FU_JCAT_CONTEXT_CACHE_MAX_AGE	  (24 * 60 * 60) /* s */
+#define FU_JCAT_CONTEXT_CACHE_MAX_ENTRIES 256
+
 G_DEFINE_TYPE(FuJcatContext, fu_jcat_context, G_TYPE_OBJECT)
 
 static void
@@ -36,6 +44,10 @@ fu_jcat_context_finalize(GObject *obj)
 {
 	FuJcatContext *self = FU_JCAT_CONTEXT(obj);
 	g_free(self->keyring_path);
+	g_free(self->cache_path);
+	g_free(self->keyring_id);
+	if (self->cache != NULL)
+		g_key_file_unref(self->cache);
 	g_ptr_array_unref(self->engines);
 	g_ptr_array_unref(self->public_keys);
 	G_OBJECT_CLASS(fu_jcat_context_parent_class)->finalize(obj);
@@ -90,6 +102,9 @@ fu_jcat_context_add_public_keys(FuJcatContext *self, const gchar *path)
 	}
 	while ((fn_tmp = g_dir_read_name(dir)) != NULL)
 		g_ptr_array_add(self->public_keys, g_build_filename(path, fn_tmp, NULL));
+
+	/* any cached results were for a different keyring */
+	g_clear_pointer(&self->keyring_id, g_free);
 }
 
 /* private */
@@ -115,6 +130,29 @@ fu_jcat_context_set_keyring_path(FuJcatContext *self, const gchar *path)
 	self->keyring_path = g_strdup(path);
 }
 
+/**
+ * fu_jcat_context_set_cache_path:
+ * @self: #FuJcatContext
+ * @path: (nullable): A filename
+ *
+ * Sets the file used to remember successful signature verifications, so that unchanged metadata
+ * and payloads do not need to be verified again when the process is restarted.
+ *
+ * Results are keyed by the SHA256 of the data, the signature, the verify flags and the public
+ * keys, and are verified again after a day.
+ *
+ * Any entry in this file is trusted without running the crypto, so @path must only be writable
+ * by the same user that can change the public keys.
+ **/
+void
+fu_jcat_context_set_cache_path(FuJcatContext *self, const gchar *path)
+{
+	g_return_if_fail(FU_IS_JCAT_CONTEXT(self));
+	g_free(self->cache_path);
+	self->cache_path = g_strdup(path);
+	g_clear_pointer(&self->cache, g_key_file_unref);
+}
+
 /**
  * fu_jcat_context_get_keyring_path:
  * @self: #FuJcatContext
@@ -175,6 +213,218 @@ fu_jcat_context_get_engine(FuJcatContext *self, FwupdJcatBlobKind kind, GError *
 	return NULL;
 }
 
+static gint
+fu_jcat_context_strcmp_cb(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(const gchar **)a, *(const gchar **)b);
+}
+
+static gboolean
+fu_jcat_context_ensure_keyring_id(FuJcatContext *self, GError **error)
+{
+	g_autoptr(GChecksum) csum = NULL;
+	g_autoptr(GPtrArray) fns = NULL;
+
+	/* already done */
+	if (self->keyring_id != NULL)
+		return TRUE;
+
+	/* the directory order is not stable */
+	csum = g_checksum_new(G_CHECKSUM_SHA256);
+	fns = fu_ptr_array_copy(self->public_keys, (GCopyFunc)g_strdup, g_free);
+	g_ptr_array_sort(fns, fu_jcat_context_strcmp_cb);
+	for (guint i = 0; i < fns->len; i++) {
+		const gchar *fn = g_ptr_array_index(fns, i);
+		g_autoptr(GBytes) blob = NULL;
+
+		blob = fu_bytes_get_contents(fn, error);
+		if (blob == NULL)
+			return FALSE;
+		g_checksum_update(csum, (const guchar *)fn, strlen(fn) + 1);
+		g_checksum_update(csum,
+				  (const guchar *)g_bytes_get_data(blob, NULL),
+				  g_bytes_get_size(blob));
+	}
+	self->keyring_id = g_strdup(g_checksum_get_string(csum));
+	return TRUE;
+}
+
+/* each field is prefixed by its length so that moving bytes between fields changes the key */
+static void
+fu_jcat_context_checksum_update_field(GChecksum *csum, const guint8 *buf, gsize bufsz)
+{
+	guint8 lenbuf[8] = {0x0};
+
+	fu_memwrite_uint64(lenbuf, bufsz, G_LITTLE_ENDIAN);
+	g_checksum_update(csum, lenbuf, sizeof(lenbuf));
+	g_checksum_update(csum, buf, bufsz);
+}
+
+static gchar *
+fu_jcat_context_build_cache_key(FuJcatContext *self,
+				FuJcatEngine *engine,
+				GBytes *data,
+				GBytes *blob_signature,
+				FuJcatVerifyFlags flags,
+				GError **error)
+{
+	FwupdJcatBlobKind kind = fu_jcat_engine_get_kind(engine);
+	g_autofree gchar *kind_flags = NULL;
+	g_autoptr(GChecksum) csum = g_checksum_new(G_CHECKSUM_SHA256);
+
+	if (!fu_jcat_context_ensure_keyring_id(self, error))
+		return NULL;
+	kind_flags = g_strdup_printf("%s:%u", fwupd_jcat_blob_kind_to_string(kind), (guint)flags);
+	fu_jcat_context_checksum_update_field(csum,
+					      (const guint8 *)kind_flags,
+					      strlen(kind_flags));
+	fu_jcat_context_checksum_update_field(csum,
+					      (const guint8 *)self->keyring_id,
+					      strlen(self->keyring_id));
+	fu_jcat_context_checksum_update_field(csum,
+					      g_bytes_get_data(blob_signature, NULL),
+					      g_bytes_get_size(blob_signature));
+	fu_jcat_context_checksum_update_field(csum,
+					      g_bytes_get_data(data, NULL),
+					      g_bytes_get_size(data));
+	return g_strdup(g_checksum_get_string(csum));
+}
+
+static void
+fu_jcat_context_ensure_cache(FuJcatContext *self)
+{
+	g_autoptr(GError) error_local = NULL;
+
+	/* already done */
+	if (self->cache != NULL)
+		return;
+
+	self->cache = g_key_file_new();
+	if (!g_file_test(self->cache_path, G_FILE_TEST_EXISTS))
+		return;
+	if (!g_key_file_load_from_file(self->cache,
+				       self->cache_path,
+				       G_KEY_FILE_NONE,
+				       &error_local)) {
+		g_debug("ignoring %s: %s", self->cache_path, error_local->message);
+		g_key_file_unref(self->cache);
+		self->cache = g_key_file_new();
+	}
+}
+
+static FuJcatResult *
+fu_jcat_context_cache_lookup(FuJcatContext *self, FuJcatEngine *engine, const gchar *key)
+{
+	gint64 verified;
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+	g_autofree gchar *authority = NULL;
+
+	fu_jcat_context_ensure_cache(self);
+	if (!g_key_file_has_group(self->cache, key))
+		return NULL;
+	verified = g_key_file_get_int64(self->cache, key, "Verified", NULL);
+	if (verified > now || now - verified > FU_JCAT_CONTEXT_CACHE_MAX_AGE) {
+		g_debug("cached result for %s has expired", key);
+		return NULL;
+	}
+	authority = g_key_file_get_string(self->cache, key, "Authority", NULL);
+	return g_object_new(FU_TYPE_JCAT_RESULT,
+			    "engine",
+			    engine,
+			    "timestamp",
+			    g_key_file_get_int64(self->cache, key, "Timestamp", NULL),
+			    "authority",
+			    authority,
+			    NULL);
+}
+
+static void
+fu_jcat_context_cache_add(FuJcatContext *self, const gchar *key, FuJcatResult *result)
+{
+	gsize groupsz = 0;
+	g_autoptr(GError) error_local = NULL;
+	g_auto(GStrv) groups = NULL;
+
+	fu_jcat_context_ensure_cache(self);
+	g_key_file_set_int64(self->cache,
+			     key,
+			     "Verified",
+			     g_get_real_time() / G_USEC_PER_SEC);
+	g_key_file_set_int64(self->cache, key, "Timestamp", fu_jcat_result_get_timestamp(result));
+	if (fu_jcat_result_get_authority(result) != NULL) {
+		g_key_file_set_string(self->cache,
+				      key,
+				      "Authority",
+				      fu_jcat_result_get_authority(result));
+	}
+
+	/* remove the oldest entry */
+	groups = g_key_file_get_groups(self->cache, &groupsz);
+	if (groupsz > FU_JCAT_CONTEXT_CACHE_MAX_ENTRIES) {
+		const gchar *group_oldest = NULL;
+		gint64 verified_oldest = G_MAXINT64;
+		for (guint i = 0; groups[i] != NULL; i++) {
+			gint64 verified =
+			    g_key_file_get_int64(self->cache, groups[i], "Verified", NULL);
+			if (verified < verified_oldest) {
+				verified_oldest = verified;
+				group_oldest = groups[i];
+			}
+		}
+		if (group_oldest != NULL)
+			g_key_file_remove_group(self->cache, group_oldest, NULL);
+	}
+
+	/* not fatal */
+	if (!fu_path_mkdir_parent(self->cache_path, &error_local) ||
+	    !g_key_file_save_to_file(self->cache, self->cache_path, &error_local))
+		g_debug("failed to save %s: %s", self->cache_path, error_local->message);
+}
+
+static FuJcatResult *
+fu_jcat_context_pubkey_verify(FuJcatContext *self,
+			      FuJcatEngine *engine,
+			      GBytes *data,
+			      GBytes *blob_signature,
+			      FuJcatVerifyFlags flags,
+			      GError **error)
+{
+	g_autofree gchar *key = NULL;
+	g_autoptr(FuJcatResult) result = NULL;
+
+	/* not enabled */
+	if (self->cache_path == NULL)
+		return fu_jcat_engine_pubkey_verify(engine, data, blob_signature, flags, error);
+
+	/* already verified */
+	if (blob_signature != NULL) {
+		g_autoptr(GError) error_local = NULL;
+		key = fu_jcat_context_build_cache_key(self,
+						      engine,
+						      data,
+						      blob_signature,
+						      flags,
+						      &error_local);
+		if (key == NULL)
+			g_debug("not using cache: %s", error_local->message);
+	}
+	if (key != NULL) {
+		result = fu_jcat_context_cache_lookup(self, engine, key);
+		if (result != NULL) {
+			g_debug("using cached result for %s", key);
+			return g_steal_pointer(&result);
+		}
+	}
+
+	/* only successful results are saved */
+	result = fu_jcat_engine_pubkey_verify(engine, data, blob_signature, flags, error);
+	if (result == NULL)
+		return NULL;
+	if (key != NULL)
+		fu_jcat_context_cache_add(self, key, result);
+	return g_steal_pointer(&result);
+}
+
 /**
  * fu_jcat_context_verify_blob:
  * @self: #FuJcatContext
@@ -215,7 +465,7 @@ fu_jcat_context_verify_blob(FuJcatContext *self,
 	}
 	if (fu_jcat_engine_get_method(engine) == FWUPD_JCAT_BLOB_METHOD_CHECKSUM)
 		return fu_jcat_engine_self_verify(engine, data, blob_signature, flags, error);
-	return fu_jcat_engine_pubkey_verify(engine, data, blob_signature, flags, error);
+	return fu_jcat_context_pubkey_verify(self, engine, data, blob_signature, flags, error);
 }
 
 /**
@@ -328,11 +578,12 @@ fu_jcat_context_verify_item(FuJcatContext *self,
 		}
 		if (fu_jcat_engine_get_method(engine) != FWUPD_JCAT_BLOB_METHOD_SIGNATURE)
 			continue;
-		result = fu_jcat_engine_pubkey_verify(engine,
-						      data,
-						      fwupd_jcat_blob_get_data(blob),
-						      flags,
-						      &error_local);
+		result = fu_jcat_context_pubkey_verify(self,
+						       engine,
+						       data,
+						       fwupd_jcat_blob_get_data(blob),
+						       flags,
+						       &error_local);
 		if (result == NULL) {
 			g_debug("signature failure: %s", error_local->message);
 			continue;
@@ -488,11 +739,12 @@ fu_jcat_context_verify_target(FuJcatContext *self,
 				error_local->message);
 			continue;
 		}
-		result = fu_jcat_engine_pubkey_verify(engine,
-						      fwupd_jcat_blob_get_data(blob_target),
-						      fwupd_jcat_blob_get_data(blob),
-						      flags,
-						      &error_local);
+		result = fu_jcat_context_pubkey_verify(self,
+						       engine,
+						       fwupd_jcat_blob_get_data(blob_target),
+						       fwupd_jcat_blob_get_data(blob),
+						       flags,
+						       &error_local);
 		if (result == NULL) {
 			g_debug("signature failure: %s", error_local->message);
 			continue;
@@ -28,6 +28,8 @@ void
 fu_jcat_context_set_keyring_path(FuJcatContext *self, const gchar *path) G_GNUC_NON_NULL(1);
 const gchar *
 fu_jcat_context_get_keyring_path(FuJcatContext *self) G_GNUC_NON_NULL(1);
+void
+fu_jcat_context_set_cache_path(FuJcatContext *self, const gchar *path) G_GNUC_NON_NULL(1);
 FuJcatResult *
 fu_jcat_context_verify_blob(FuJcatContext *self,
 			    GBytes *data,
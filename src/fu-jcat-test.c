@@ -563,6 +563,127 @@ fu_jcat_context_verify_item_sign_func(void)
 	g_clear_error(&error);
 }
 
+static void
+fu_jcat_context_verify_item_cache_func(void)
+{
+	FuJcatResult *result;
+	gboolean ret;
+	g_autofree gchar *cachefn = NULL;
+	g_autofree gchar *fn_pass = NULL;
+	g_autofree gchar *fn_sig = NULL;
+	g_autofree gchar *pki_dir = NULL;
+	g_auto(GStrv) groups = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) data_fwbin = NULL;
+	g_autoptr(GBytes) data_sig = NULL;
+	g_autoptr(GBytes) data_split = NULL;
+	g_autoptr(GBytes) data_split_sig = NULL;
+	g_autoptr(GByteArray) buf_split_sig = g_byte_array_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdJcatBlob) blob = NULL;
+	g_autoptr(FwupdJcatBlob) blob_split = NULL;
+	g_autoptr(FuJcatResult) result_split = NULL;
+	g_autoptr(FwupdJcatItem) item = fwupd_jcat_item_new("filename.bin");
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+	g_autoptr(GPtrArray) results1 = NULL;
+	g_autoptr(GPtrArray) results2 = NULL;
+	g_autoptr(GPtrArray) results3 = NULL;
+	g_autoptr(FuJcatContext) context1 = fu_jcat_context_new();
+	g_autoptr(FuJcatContext) context2 = fu_jcat_context_new();
+	g_autoptr(FuJcatContext) context3 = fu_jcat_context_new();
+
+	tmpdir = fu_temporary_directory_new("jcat-context-cache", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	cachefn = fu_temporary_directory_build(tmpdir, "jcat.cache", NULL);
+	pki_dir = g_test_build_filename(G_TEST_DIST, "tests", "pki", NULL);
+
+	fn_pass = g_test_build_filename(G_TEST_DIST, "tests", "colorhug", "firmware.bin", NULL);
+	data_fwbin = fu_bytes_get_contents(fn_pass, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fwbin);
+	fn_sig = g_test_build_filename(G_TEST_DIST, "tests", "colorhug", "firmware.bin.p7b", NULL);
+	data_sig = fu_bytes_get_contents(fn_sig, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_sig);
+	blob = fwupd_jcat_blob_new(FWUPD_JCAT_BLOB_KIND_PKCS7, data_sig, FWUPD_JCAT_BLOB_FLAG_NONE);
+	fwupd_jcat_item_add_blob(item, blob);
+
+	/* verify, which saves the result */
+	fu_jcat_context_add_public_keys(context1, pki_dir);
+	fu_jcat_context_allow_blob_kind(context1, FWUPD_JCAT_BLOB_KIND_PKCS7);
+	fu_jcat_context_set_cache_path(context1, cachefn);
+	results1 = fu_jcat_context_verify_item(context1,
+					       data_fwbin,
+					       item,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS |
+						   FU_JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(results1);
+	g_assert_cmpint(results1->len, ==, 1);
+	ret = g_key_file_load_from_file(kf, cachefn, G_KEY_FILE_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	groups = g_key_file_get_groups(kf, NULL);
+	g_assert_cmpint(g_strv_length(groups), ==, 1);
+
+	/* a new process with the same keys uses the cached result */
+	fu_jcat_context_add_public_keys(context2, pki_dir);
+	fu_jcat_context_allow_blob_kind(context2, FWUPD_JCAT_BLOB_KIND_PKCS7);
+	fu_jcat_context_set_cache_path(context2, cachefn);
+	results2 = fu_jcat_context_verify_item(context2,
+					       data_fwbin,
+					       item,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS |
+						   FU_JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(results2);
+	g_assert_cmpint(results2->len, ==, 1);
+	result = g_ptr_array_index(results2, 0);
+	g_assert_cmpint(fu_jcat_result_get_kind(result), ==, FWUPD_JCAT_BLOB_KIND_PKCS7);
+	g_assert_cmpint(fu_jcat_result_get_timestamp(result),
+			==,
+			fu_jcat_result_get_timestamp(g_ptr_array_index(results1, 0)));
+	g_assert_cmpstr(fu_jcat_result_get_authority(result),
+			==,
+			"O=Linux Vendor Firmware Project,CN=LVFS CA");
+
+	/* moving the start of the data onto the end of the signature is not the same entry */
+	fu_byte_array_append_bytes(buf_split_sig, data_sig);
+	g_byte_array_append(buf_split_sig, g_bytes_get_data(data_fwbin, NULL), 0x10);
+	data_split_sig = g_bytes_new(buf_split_sig->data, buf_split_sig->len);
+	data_split =
+	    fu_bytes_new_offset(data_fwbin, 0x10, g_bytes_get_size(data_fwbin) - 0x10, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_split);
+	blob_split = fwupd_jcat_blob_new(FWUPD_JCAT_BLOB_KIND_PKCS7,
+					 data_split_sig,
+					 FWUPD_JCAT_BLOB_FLAG_NONE);
+	result_split = fu_jcat_context_verify_blob(context2,
+						   data_split,
+						   blob_split,
+						   FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS |
+						       FU_JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+						   &error);
+	g_assert_nonnull(error);
+	g_assert_null(result_split);
+	g_clear_error(&error);
+
+	/* without the public keys the cached result does not apply */
+	fu_jcat_context_allow_blob_kind(context3, FWUPD_JCAT_BLOB_KIND_PKCS7);
+	fu_jcat_context_set_cache_path(context3, cachefn);
+	results3 = fu_jcat_context_verify_item(context3,
+					       data_fwbin,
+					       item,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS |
+						   FU_JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+					       &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(results3);
+}
+
 static void
 fu_jcat_context_verify_item_target_func(void)
 {
@@ -740,6 +861,7 @@ main(int argc, char **argv)
 	g_test_add_func("/jcat/context/verify/blob/disallow",
 			fu_jcat_context_verify_blob_disallow_func);
 	g_test_add_func("/jcat/context/verify/item/sign", fu_jcat_context_verify_item_sign_func);
+	g_test_add_func("/jcat/context/verify/item/cache", fu_jcat_context_verify_item_cache_func);
 	g_test_add_func("/jcat/context/verify/item/csum", fu_jcat_context_verify_item_csum_func);
 	g_test_add_func("/jcat/context/verify/item/target",
 			fu_jcat_context_verify_item_target_func);
@@ -294,6 +294,43 @@ fu_remote_clean(FwupdRemote *self, GError **error)
 	return fwupd_remote_ensure_mtime(self, error);
 }
 
+/**
+ * fu_remote_touch:
+ * @self: a #FwupdRemote
+ * @error: (nullable): optional return location for an error
+ *
+ * Marks the cached metadata as current, typically because the server reported it had not changed.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_remote_touch(FwupdRemote *self, GError **error)
+{
+	g_autoptr(GFile) file = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_REMOTE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (fwupd_remote_get_filename_cache(self) == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no filename cache set");
+		return FALSE;
+	}
+	file = g_file_new_for_path(fwupd_remote_get_filename_cache(self));
+	if (!g_file_set_attribute_uint64(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					 (guint64)g_get_real_time() / G_USEC_PER_SEC,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return fwupd_remote_ensure_mtime(self, error);
+}
+
 static void
 fu_remote_init(FuRemote *self)
 {
@@ -23,6 +23,8 @@ fu_remote_save_to_filename(FwupdRemote *self,
 			   GError **error) G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_remote_clean(FwupdRemote *self, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_remote_touch(FwupdRemote *self, GError **error) G_GNUC_NON_NULL(1);
 
 FwupdRemote *
 fu_remote_new(void);
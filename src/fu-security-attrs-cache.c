@@ -0,0 +1,201 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuSecurityAttrsCache"
+
+#include "config.h"
+
+#include "fu-security-attrs-cache.h"
+#include "fu-security-attrs-private.h"
+
+/*
+ * Caches the host security attributes added by each source, e.g. a plugin or device, so that only
+ * the sources whose inputs have changed have to be asked again.
+ *
+ * Sources can look at and modify the attributes added by the sources before them, so the sources
+ * are always added in the same order and everything after the first source that is not cached is
+ * added again. The attributes are modified in place by later sources and when depsolving, so the
+ * state set by each source is saved when added and restored when used from the cache.
+ */
+
+struct _FuSecurityAttrsCache {
+	GObject parent_instance;
+	GPtrArray *entries; /* (element-type FuSecurityAttrsCacheEntry) */
+	GHashTable *stale;  /* (element-type utf8) removed but going to be asked again */
+	guint idx;	    /* of the next source expected */
+	guint offset;	    /* into the attrs when the source is not cached */
+};
+
+G_DEFINE_TYPE(FuSecurityAttrsCache, fu_security_attrs_cache, G_TYPE_OBJECT)
+
+typedef struct {
+	FwupdSecurityAttr *attr;
+	FwupdSecurityAttrFlags flags;
+	FwupdSecurityAttrResult result;
+	guint obsoletes_len;
+} FuSecurityAttrsCacheItem;
+
+typedef struct {
+	gchar *source;
+	GArray *items; /* (element-type FuSecurityAttrsCacheItem) */
+} FuSecurityAttrsCacheEntry;
+
+static void
+fu_security_attrs_cache_item_clear(FuSecurityAttrsCacheItem *item)
+{
+	g_object_unref(item->attr);
+}
+
+static void
+fu_security_attrs_cache_entry_free(FuSecurityAttrsCacheEntry *entry)
+{
+	g_array_unref(entry->items);
+	g_free(entry->source);
+	g_free(entry);
+}
+
+static void
+fu_security_attrs_cache_truncate(FuSecurityAttrsCache *self, guint idx)
+{
+	for (guint i = idx; i < self->entries->len; i++) {
+		FuSecurityAttrsCacheEntry *entry = g_ptr_array_index(self->entries, i);
+		g_hash_table_add(self->stale, g_strdup(entry->source));
+	}
+	g_ptr_array_set_size(self->entries, idx);
+}
+
+/* called before adding the first source */
+void
+fu_security_attrs_cache_rewind(FuSecurityAttrsCache *self)
+{
+	g_return_if_fail(FU_IS_SECURITY_ATTRS_CACHE(self));
+	g_hash_table_remove_all(self->stale);
+	self->idx = 0;
+}
+
+/* returns FALSE if the source has to be asked, and then fu_security_attrs_cache_add() called */
+gboolean
+fu_security_attrs_cache_restore(FuSecurityAttrsCache *self,
+				const gchar *source,
+				FuSecurityAttrs *attrs)
+{
+	FuSecurityAttrsCacheEntry *entry = NULL;
+	g_autoptr(GPtrArray) attrs_all = NULL;
+
+	g_return_val_if_fail(FU_IS_SECURITY_ATTRS_CACHE(self), FALSE);
+	g_return_val_if_fail(source != NULL, FALSE);
+	g_return_val_if_fail(FU_IS_SECURITY_ATTRS(attrs), FALSE);
+
+	if (self->idx < self->entries->len)
+		entry = g_ptr_array_index(self->entries, self->idx);
+	if (entry == NULL || g_strcmp0(entry->source, source) != 0) {
+		/* everything from here has to be added again */
+		fu_security_attrs_cache_truncate(self, self->idx);
+		attrs_all = fu_security_attrs_get_all_mutable(attrs);
+		self->offset = attrs_all->len;
+		return FALSE;
+	}
+
+	/* undo anything done by the later sources or when depsolving */
+	for (guint i = 0; i < entry->items->len; i++) {
+		FuSecurityAttrsCacheItem *item =
+		    &g_array_index(entry->items, FuSecurityAttrsCacheItem, i);
+		GPtrArray *obsoletes = fwupd_security_attr_get_obsoletes(item->attr);
+		fwupd_security_attr_set_flags(item->attr, item->flags);
+		fwupd_security_attr_set_result(item->attr, item->result);
+		if (obsoletes->len > item->obsoletes_len)
+			g_ptr_array_set_size(obsoletes, item->obsoletes_len);
+		fu_security_attrs_append_internal(attrs, item->attr);
+	}
+	self->idx++;
+	return TRUE;
+}
+
+/* saves the attributes added since fu_security_attrs_cache_restore() returned FALSE */
+void
+fu_security_attrs_cache_add(FuSecurityAttrsCache *self, const gchar *source, FuSecurityAttrs *attrs)
+{
+	FuSecurityAttrsCacheEntry *entry;
+	g_autoptr(GPtrArray) attrs_all = NULL;
+
+	g_return_if_fail(FU_IS_SECURITY_ATTRS_CACHE(self));
+	g_return_if_fail(source != NULL);
+	g_return_if_fail(FU_IS_SECURITY_ATTRS(attrs));
+	g_return_if_fail(self->idx == self->entries->len);
+
+	entry = g_new0(FuSecurityAttrsCacheEntry, 1);
+	entry->source = g_strdup(source);
+	entry->items = g_array_new(FALSE, FALSE, sizeof(FuSecurityAttrsCacheItem));
+	g_array_set_clear_func(entry->items, (GDestroyNotify)fu_security_attrs_cache_item_clear);
+	attrs_all = fu_security_attrs_get_all_mutable(attrs);
+	for (guint i = self->offset; i < attrs_all->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs_all, i);
+		FuSecurityAttrsCacheItem item = {
+		    .attr = g_object_ref(attr),
+		    .flags = fwupd_security_attr_get_flags(attr),
+		    .result = fwupd_security_attr_get_result(attr),
+		    .obsoletes_len = fwupd_security_attr_get_obsoletes(attr)->len,
+		};
+		g_array_append_val(entry->items, item);
+	}
+	g_ptr_array_add(self->entries, entry);
+	g_hash_table_remove(self->stale, source);
+	self->idx++;
+}
+
+/* returns FALSE if the source was not asked last time, and so might be anywhere in the order */
+gboolean
+fu_security_attrs_cache_invalidate(FuSecurityAttrsCache *self, const gchar *source)
+{
+	g_return_val_if_fail(FU_IS_SECURITY_ATTRS_CACHE(self), FALSE);
+	g_return_val_if_fail(source != NULL, FALSE);
+
+	for (guint i = 0; i < self->entries->len; i++) {
+		FuSecurityAttrsCacheEntry *entry = g_ptr_array_index(self->entries, i);
+		if (g_strcmp0(entry->source, source) == 0) {
+			fu_security_attrs_cache_truncate(self, i);
+			return TRUE;
+		}
+	}
+	return g_hash_table_contains(self->stale, source);
+}
+
+void
+fu_security_attrs_cache_invalidate_all(FuSecurityAttrsCache *self)
+{
+	g_return_if_fail(FU_IS_SECURITY_ATTRS_CACHE(self));
+	fu_security_attrs_cache_truncate(self, 0);
+}
+
+static void
+fu_security_attrs_cache_finalize(GObject *obj)
+{
+	FuSecurityAttrsCache *self = FU_SECURITY_ATTRS_CACHE(obj);
+	g_ptr_array_unref(self->entries);
+	g_hash_table_unref(self->stale);
+	G_OBJECT_CLASS(fu_security_attrs_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_security_attrs_cache_class_init(FuSecurityAttrsCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_security_attrs_cache_finalize;
+}
+
+static void
+fu_security_attrs_cache_init(FuSecurityAttrsCache *self)
+{
+	self->entries =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_security_attrs_cache_entry_free);
+	self->stale = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+}
+
+FuSecurityAttrsCache *
+fu_security_attrs_cache_new(void)
+{
+	return g_object_new(FU_TYPE_SECURITY_ATTRS_CACHE, NULL);
+}
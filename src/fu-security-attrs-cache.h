@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_SECURITY_ATTRS_CACHE (fu_security_attrs_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuSecurityAttrsCache,
+		     fu_security_attrs_cache,
+		     FU,
+		     SECURITY_ATTRS_CACHE,
+		     GObject)
+
+FuSecurityAttrsCache *
+fu_security_attrs_cache_new(void);
+void
+fu_security_attrs_cache_rewind(FuSecurityAttrsCache *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_security_attrs_cache_restore(FuSecurityAttrsCache *self,
+				const gchar *source,
+				FuSecurityAttrs *attrs) G_GNUC_NON_NULL(1, 2, 3);
+void
+fu_security_attrs_cache_add(FuSecurityAttrsCache *self, const gchar *source, FuSecurityAttrs *attrs)
+    G_GNUC_NON_NULL(1, 2, 3);
+gboolean
+fu_security_attrs_cache_invalidate(FuSecurityAttrsCache *self, const gchar *source)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_security_attrs_cache_invalidate_all(FuSecurityAttrsCache *self) G_GNUC_NON_NULL(1);
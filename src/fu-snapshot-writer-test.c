@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-snapshot-writer.h"
+
+typedef struct {
+	guint snapshot_cnt;
+	gint64 value;
+} FuSnapshotWriterTestHelper;
+
+static FwupdJsonObject *
+fu_snapshot_writer_test_snapshot_cb(gpointer user_data)
+{
+	FuSnapshotWriterTestHelper *helper = (FuSnapshotWriterTestHelper *)user_data;
+	FwupdJsonObject *json_obj = fwupd_json_object_new();
+	fwupd_json_object_add_integer(json_obj, "Value", helper->value);
+	helper->snapshot_cnt++;
+	return json_obj;
+}
+
+static void
+fu_snapshot_writer_test_wait(FuSnapshotWriter *writer)
+{
+	while (fu_snapshot_writer_is_busy(writer))
+		g_main_context_iteration(NULL, TRUE);
+}
+
+static void
+fu_snapshot_writer_func(void)
+{
+	gboolean ret;
+	FuSnapshotWriterTestHelper helper = {0};
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *data = NULL;
+	g_autoptr(FuSnapshotWriter) writer = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = fu_temporary_directory_new("snapshot-writer", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	filename = fu_temporary_directory_build(tmpdir, "devices.json", NULL);
+	writer = fu_snapshot_writer_new(filename, fu_snapshot_writer_test_snapshot_cb, &helper);
+	fu_snapshot_writer_set_delay(writer, 10);
+
+	/* a burst of changes is written once */
+	helper.value = 1;
+	for (guint i = 0; i < 100; i++)
+		fu_snapshot_writer_queue(writer);
+	fu_snapshot_writer_test_wait(writer);
+	g_assert_cmpint(helper.snapshot_cnt, ==, 1);
+	g_assert_cmpint(fu_snapshot_writer_get_write_cnt(writer), ==, 1);
+	g_assert_cmpint(fu_snapshot_writer_get_suppressed_cnt(writer), ==, 99);
+	ret = g_file_get_contents(filename, &data, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_nonnull(g_strstr_len(data, -1, "\"Value\": 1"));
+
+	/* same contents are not written again */
+	fu_snapshot_writer_queue(writer);
+	fu_snapshot_writer_test_wait(writer);
+	g_assert_cmpint(helper.snapshot_cnt, ==, 2);
+	g_assert_cmpint(fu_snapshot_writer_get_write_cnt(writer), ==, 1);
+	g_assert_cmpint(fu_snapshot_writer_get_suppressed_cnt(writer), ==, 100);
+
+	/* flushing writes the new contents now */
+	helper.value = 2;
+	fu_snapshot_writer_queue(writer);
+	ret = fu_snapshot_writer_flush(writer, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_snapshot_writer_is_busy(writer));
+	g_assert_cmpint(fu_snapshot_writer_get_write_cnt(writer), ==, 2);
+	g_clear_pointer(&data, g_free);
+	ret = g_file_get_contents(filename, &data, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_nonnull(g_strstr_len(data, -1, "\"Value\": 2"));
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/snapshot-writer", fu_snapshot_writer_func);
+	return g_test_run();
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuSnapshotWriter"
+
+#include "config.h"
+
+#include "fu-snapshot-writer.h"
+
+/*
+ * Writes a JSON snapshot to a file, coalescing all the changes queued within a short window into
+ * one write.
+ *
+ * The snapshot is built on the main thread and is then serialized and written atomically on a
+ * worker thread. The write is skipped if the contents are the same as the last write.
+ */
+
+#define FU_SNAPSHOT_WRITER_DELAY_DEFAULT 500 /* ms */
+
+struct _FuSnapshotWriter {
+	GObject parent_instance;
+	gchar *filename;
+	FuSnapshotWriterFunc func;
+	gpointer user_data; /* noref */
+	guint delay;
+	guint timeout_id;
+	gboolean in_flight;
+	gboolean pending; /* queued while in flight */
+	guint64 seq;	  /* of the last snapshot built */
+	GMutex mutex;	  /* serializes writes, and protects seq_written and checksum */
+	guint64 seq_written;
+	gchar *checksum; /* nullable, of the last contents written */
+	gint write_cnt;	 /* atomic */
+	gint suppressed_cnt; /* atomic */
+};
+
+G_DEFINE_TYPE(FuSnapshotWriter, fu_snapshot_writer, G_TYPE_OBJECT)
+
+typedef struct {
+	FwupdJsonObject *json_obj;
+	guint64 seq;
+} FuSnapshotWriterHelper;
+
+static void
+fu_snapshot_writer_helper_free(FuSnapshotWriterHelper *helper)
+{
+	fwupd_json_object_unref(helper->json_obj);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuSnapshotWriterHelper, fu_snapshot_writer_helper_free)
+
+static FuSnapshotWriterHelper *
+fu_snapshot_writer_helper_new(FuSnapshotWriter *self)
+{
+	FuSnapshotWriterHelper *helper = g_new0(FuSnapshotWriterHelper, 1);
+	helper->json_obj = self->func(self->user_data);
+	helper->seq = ++self->seq;
+	return helper;
+}
+
+/* called from the worker thread, or from the main thread when flushing */
+static gboolean
+fu_snapshot_writer_write(FuSnapshotWriter *self, FuSnapshotWriterHelper *helper, GError **error)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_autoptr(GString) data = NULL;
+
+	data = fwupd_json_object_to_string(helper->json_obj, FWUPD_JSON_EXPORT_FLAG_INDENT);
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA256, data->str, data->len);
+
+	/* a newer snapshot has already been written, or nothing changed */
+	locker = g_mutex_locker_new(&self->mutex);
+	if (helper->seq < self->seq_written || g_strcmp0(checksum, self->checksum) == 0) {
+		g_atomic_int_inc(&self->suppressed_cnt);
+		return TRUE;
+	}
+	if (!g_file_set_contents(self->filename, data->str, data->len, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	g_free(self->checksum);
+	self->checksum = g_steal_pointer(&checksum);
+	self->seq_written = helper->seq;
+	g_atomic_int_inc(&self->write_cnt);
+	return TRUE;
+}
+
+static void
+fu_snapshot_writer_thread_cb(GTask *task,
+			     gpointer source_object,
+			     gpointer task_data,
+			     GCancellable *cancellable)
+{
+	FuSnapshotWriter *self = FU_SNAPSHOT_WRITER(source_object);
+	FuSnapshotWriterHelper *helper = (FuSnapshotWriterHelper *)task_data;
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_snapshot_writer_write(self, helper, &error_local)) {
+		g_task_return_error(task, g_steal_pointer(&error_local));
+		return;
+	}
+	g_task_return_boolean(task, TRUE);
+}
+
+static void
+fu_snapshot_writer_start(FuSnapshotWriter *self);
+
+static void
+fu_snapshot_writer_ready_cb(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	FuSnapshotWriter *self = FU_SNAPSHOT_WRITER(source_object);
+	g_autoptr(GError) error_local = NULL;
+
+	self->in_flight = FALSE;
+	if (!g_task_propagate_boolean(G_TASK(res), &error_local))
+		g_info("failed to write %s: %s", self->filename, error_local->message);
+
+	/* changed again while writing */
+	if (self->pending) {
+		self->pending = FALSE;
+		fu_snapshot_writer_start(self);
+	}
+}
+
+static void
+fu_snapshot_writer_start(FuSnapshotWriter *self)
+{
+	g_autoptr(GTask) task = g_task_new(self, NULL, fu_snapshot_writer_ready_cb, NULL);
+
+	self->in_flight = TRUE;
+	g_task_set_task_data(task,
+			     fu_snapshot_writer_helper_new(self),
+			     (GDestroyNotify)fu_snapshot_writer_helper_free);
+	g_task_run_in_thread(task, fu_snapshot_writer_thread_cb);
+}
+
+static gboolean
+fu_snapshot_writer_timeout_cb(gpointer user_data)
+{
+	FuSnapshotWriter *self = FU_SNAPSHOT_WRITER(user_data);
+
+	self->timeout_id = 0;
+	if (self->in_flight) {
+		self->pending = TRUE;
+		return G_SOURCE_REMOVE;
+	}
+	fu_snapshot_writer_start(self);
+	return G_SOURCE_REMOVE;
+}
+
+void
+fu_snapshot_writer_set_delay(FuSnapshotWriter *self, guint delay)
+{
+	g_return_if_fail(FU_IS_SNAPSHOT_WRITER(self));
+	self->delay = delay;
+}
+
+/* any other changes queued before the snapshot is built are coalesced into the same write */
+void
+fu_snapshot_writer_queue(FuSnapshotWriter *self)
+{
+	g_return_if_fail(FU_IS_SNAPSHOT_WRITER(self));
+
+	/* already going to be included */
+	if (self->timeout_id != 0 || self->pending) {
+		g_atomic_int_inc(&self->suppressed_cnt);
+		return;
+	}
+	self->timeout_id = g_timeout_add(self->delay, fu_snapshot_writer_timeout_cb, self);
+}
+
+/* builds and writes a snapshot now, cancelling any queued write */
+gboolean
+fu_snapshot_writer_flush(FuSnapshotWriter *self, GError **error)
+{
+	g_autoptr(FuSnapshotWriterHelper) helper = NULL;
+
+	g_return_val_if_fail(FU_IS_SNAPSHOT_WRITER(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	g_clear_handle_id(&self->timeout_id, g_source_remove);
+	self->pending = FALSE;
+	helper = fu_snapshot_writer_helper_new(self);
+	return fu_snapshot_writer_write(self, helper, error);
+}
+
+gboolean
+fu_snapshot_writer_is_busy(FuSnapshotWriter *self)
+{
+	g_return_val_if_fail(FU_IS_SNAPSHOT_WRITER(self), FALSE);
+	return self->timeout_id != 0 || self->pending || self->in_flight;
+}
+
+guint
+fu_snapshot_writer_get_write_cnt(FuSnapshotWriter *self)
+{
+	g_return_val_if_fail(FU_IS_SNAPSHOT_WRITER(self), G_MAXUINT);
+	return (guint)g_atomic_int_get(&self->write_cnt);
+}
+
+/* coalesced into another write, or the contents did not change */
+guint
+fu_snapshot_writer_get_suppressed_cnt(FuSnapshotWriter *self)
+{
+	g_return_val_if_fail(FU_IS_SNAPSHOT_WRITER(self), G_MAXUINT);
+	return (guint)g_atomic_int_get(&self->suppressed_cnt);
+}
+
+static void
+fu_snapshot_writer_finalize(GObject *obj)
+{
+	FuSnapshotWriter *self = FU_SNAPSHOT_WRITER(obj);
+	if (self->timeout_id != 0)
+		g_source_remove(self->timeout_id);
+	g_mutex_clear(&self->mutex);
+	g_free(self->checksum);
+	g_free(self->filename);
+	G_OBJECT_CLASS(fu_snapshot_writer_parent_class)->finalize(obj);
+}
+
+static void
+fu_snapshot_writer_class_init(FuSnapshotWriterClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_snapshot_writer_finalize;
+}
+
+static void
+fu_snapshot_writer_init(FuSnapshotWriter *self)
+{
+	self->delay = FU_SNAPSHOT_WRITER_DELAY_DEFAULT;
+	g_mutex_init(&self->mutex);
+}
+
+/* @user_data must outlive any queued write */
+FuSnapshotWriter *
+fu_snapshot_writer_new(const gchar *filename, FuSnapshotWriterFunc func, gpointer user_data)
+{
+	FuSnapshotWriter *self = g_object_new(FU_TYPE_SNAPSHOT_WRITER, NULL);
+	self->filename = g_strdup(filename);
+	self->func = func;
+	self->user_data = user_data;
+	return self;
+}
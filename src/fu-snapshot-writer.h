@@ -0,0 +1,31 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_SNAPSHOT_WRITER (fu_snapshot_writer_get_type())
+G_DECLARE_FINAL_TYPE(FuSnapshotWriter, fu_snapshot_writer, FU, SNAPSHOT_WRITER, GObject)
+
+/* builds the snapshot on the main thread, which must not be modified after it is returned */
+typedef FwupdJsonObject *(*FuSnapshotWriterFunc)(gpointer user_data);
+
+FuSnapshotWriter *
+fu_snapshot_writer_new(const gchar *filename, FuSnapshotWriterFunc func, gpointer user_data)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_snapshot_writer_set_delay(FuSnapshotWriter *self, guint delay) G_GNUC_NON_NULL(1);
+void
+fu_snapshot_writer_queue(FuSnapshotWriter *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_snapshot_writer_flush(FuSnapshotWriter *self, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_snapshot_writer_is_busy(FuSnapshotWriter *self) G_GNUC_NON_NULL(1);
+guint
+fu_snapshot_writer_get_write_cnt(FuSnapshotWriter *self) G_GNUC_NON_NULL(1);
+guint
+fu_snapshot_writer_get_suppressed_cnt(FuSnapshotWriter *self) G_GNUC_NON_NULL(1);
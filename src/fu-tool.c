@@ -34,6 +34,7 @@
 #include "fu-engine-helper.h"
 #include "fu-engine-requirements.h"
 #include "fu-engine.h"
+#include "fu-firmware-private.h"
 #include "fu-history.h"
 #include "fu-jcat-context.h"
 #include "fu-plugin-private.h"
@@ -3231,8 +3232,14 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 		if (firmware_type == NULL)
 			return FALSE;
 	} else if (g_strcmp0(values[1], "auto") == 0) {
+		g_autoptr(GBytes) prefix = NULL;
 		g_autoptr(GPtrArray) gtype_ids = fu_context_get_firmware_gtype_ids(ctx);
 		g_autoptr(GPtrArray) firmware_auto_types = g_ptr_array_new_with_free_func(g_free);
+
+		/* read once to skip the types where the magic does not match */
+		prefix = fu_firmware_read_magic_prefix(stream, 0x0, error);
+		if (prefix == NULL)
+			return FALSE;
 		for (guint i = 0; i < gtype_ids->len; i++) {
 			const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
 			GType gtype_tmp;
@@ -3252,6 +3259,12 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 					    gtype_id);
 				return FALSE;
 			}
+			if (!fu_firmware_gtype_matches_magic(gtype_tmp,
+							     prefix,
+							     FU_FIRMWARE_PARSE_FLAG_NO_SEARCH)) {
+				g_debug("magic does not match %s", gtype_id);
+				continue;
+			}
 			firmware_tmp = g_object_new(gtype_tmp, NULL);
 			if (fu_firmware_has_flag(firmware_tmp, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
 				continue;
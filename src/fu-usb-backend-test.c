@@ -11,6 +11,7 @@
 #include "fu-context-private.h"
 #include "fu-device-private.h"
 #include "fu-usb-backend.h"
+#include "fu-usb-device-private.h"
 
 static void
 fu_usb_backend_hotplug_cb(FuBackend *backend, FuDevice *device, gpointer user_data)
@@ -239,6 +240,129 @@ fu_usb_backend_invalid_func(void)
 	g_assert_false(fu_device_has_icon(device_tmp, "computer"));
 }
 
+static void
+fu_usb_device_add_bulk_event(FuUsbDevice *usb_device, const gchar *data, gint64 status)
+{
+	gsize datasz = strlen(data);
+	g_autofree gchar *data_base64 = fu_base64_encode((const guint8 *)data, datasz);
+	g_autofree gchar *id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+
+	id = g_strdup_printf("BulkTransfer:Endpoint=0x01,Data=%s,Length=0x%x",
+			     data_base64,
+			     (guint)datasz);
+	event = fu_device_event_new(id);
+	if (status != LIBUSB_TRANSFER_COMPLETED)
+		fu_device_event_set_i64(event, "Status", status);
+	else
+		fu_device_event_set_data(event, "Data", (const guint8 *)data, datasz);
+	fu_device_add_event(FU_DEVICE(usb_device), event);
+}
+
+static void
+fu_usb_device_bulk_transfer_chunks_func(void)
+{
+	gboolean ret;
+	const gchar *data = "helloworld!!";
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(FuDevice) device1 = NULL;
+	g_autoptr(FuDevice) device2 = NULL;
+	g_autoptr(FuProgress) progress1 = fu_progress_new(G_STRLOC);
+	g_autoptr(FuProgress) progress2 = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob = g_bytes_new_static(data, strlen(data));
+	g_autoptr(GError) error = NULL;
+
+	chunks = fu_chunk_array_new_from_bytes(blob,
+					       FU_CHUNK_ADDR_OFFSET_NONE,
+					       FU_CHUNK_PAGESZ_NONE,
+					       4,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+
+	/* each chunk is loaded from the emulation in order */
+	device1 = g_object_new(FU_TYPE_USB_DEVICE, "context", ctx, NULL);
+	fu_device_add_flag(device1, FWUPD_DEVICE_FLAG_EMULATED);
+	fu_usb_device_add_bulk_event(FU_USB_DEVICE(device1), "hell", LIBUSB_TRANSFER_COMPLETED);
+	fu_usb_device_add_bulk_event(FU_USB_DEVICE(device1), "owor", LIBUSB_TRANSFER_COMPLETED);
+	fu_usb_device_add_bulk_event(FU_USB_DEVICE(device1), "ld!!", LIBUSB_TRANSFER_COMPLETED);
+	ret = fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(device1),
+						 0x01,
+						 chunks,
+						 8,
+						 1000,
+						 progress1,
+						 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_progress_get_percentage(progress1), ==, 100);
+
+	/* the failing chunk is reported */
+	device2 = g_object_new(FU_TYPE_USB_DEVICE, "context", ctx, NULL);
+	fu_device_add_flag(device2, FWUPD_DEVICE_FLAG_EMULATED);
+	fu_usb_device_add_bulk_event(FU_USB_DEVICE(device2), "hell", LIBUSB_TRANSFER_COMPLETED);
+	fu_usb_device_add_bulk_event(FU_USB_DEVICE(device2), "owor", LIBUSB_TRANSFER_TIMED_OUT);
+	ret = fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(device2),
+						 0x01,
+						 chunks,
+						 8,
+						 1000,
+						 progress2,
+						 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT);
+	g_assert_nonnull(g_strstr_len(error->message, -1, "chunk 0x1"));
+	g_assert_false(ret);
+}
+
+static void
+fu_usb_device_bulk_transfer_chunks_async_func(void)
+{
+	gboolean ret;
+	const gchar *data = "helloworld!!";
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(FuDevice) device = NULL;
+	g_autoptr(FuProgress) progress1 = fu_progress_new(G_STRLOC);
+	g_autoptr(FuProgress) progress2 = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob = g_bytes_new_static(data, strlen(data));
+	g_autoptr(GError) error = NULL;
+
+	chunks = fu_chunk_array_new_from_bytes(blob,
+					       FU_CHUNK_ADDR_OFFSET_NONE,
+					       FU_CHUNK_PAGESZ_NONE,
+					       4,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+
+	/* not emulated or recording, so the transfers are queued */
+	device = g_object_new(FU_TYPE_USB_DEVICE, "context", ctx, NULL);
+	ret = fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(device),
+						 0x81,
+						 chunks,
+						 8,
+						 1000,
+						 progress1,
+						 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* nothing is submitted to a device that is not open */
+	ret = fu_usb_device_bulk_transfer_chunks(FU_USB_DEVICE(device),
+						 0x01,
+						 chunks,
+						 8,
+						 1000,
+						 progress2,
+						 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL);
+	g_assert_nonnull(g_strstr_len(error->message, -1, "not been opened"));
+	g_assert_false(ret);
+	g_assert_cmpint(fu_progress_get_percentage(progress2), ==, 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -246,5 +370,9 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/usb-backend", fu_usb_backend_func);
 	g_test_add_func("/fwupd/usb-backend/invalid", fu_usb_backend_invalid_func);
+	g_test_add_func("/fwupd/usb-device/bulk-transfer-chunks",
+			fu_usb_device_bulk_transfer_chunks_func);
+	g_test_add_func("/fwupd/usb-device/bulk-transfer-chunks{async}",
+			fu_usb_device_bulk_transfer_chunks_async_func);
 	return g_test_run();
 }
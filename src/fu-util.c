@@ -2271,6 +2271,7 @@ static gboolean
 fu_util_download_metadata(FuUtil *self, GError **error)
 {
 	gboolean download_remote_enabled = FALSE;
+	FwupdClientDownloadFlags download_flags = self->download_flags;
 	guint devices_supported_cnt = 0;
 	guint devices_updatable_cnt = 0;
 	guint refresh_cnt = 0;
@@ -2281,6 +2282,10 @@ fu_util_download_metadata(FuUtil *self, GError **error)
 	remotes = fwupd_client_get_remotes(self->client, self->cancellable, error);
 	if (remotes == NULL)
 		return FALSE;
+
+	/* only download signatures that have changed on the server, unless forced */
+	if ((self->flags & FWUPD_INSTALL_FLAG_FORCE) == 0)
+		download_flags |= FWUPD_CLIENT_DOWNLOAD_FLAG_IF_MODIFIED;
 	for (guint i = 0; i < remotes->len; i++) {
 		FwupdRemote *remote = g_ptr_array_index(remotes, i);
 		if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
@@ -2309,7 +2314,7 @@ fu_util_download_metadata(FuUtil *self, GError **error)
 					 fwupd_remote_get_id(remote));
 		if (!fwupd_client_refresh_remote(self->client,
 						 remote,
-						 self->download_flags,
+						 download_flags,
 						 self->cancellable,
 						 error))
 			return FALSE;